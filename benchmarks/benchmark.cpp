@@ -0,0 +1,72 @@
+#include "./benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace lava::benchmarks;
+
+namespace {
+    constexpr const uint32_t WARMUP_RUNS_COUNT = 3u;
+}
+
+void BenchmarkRunner::add(const std::string& name, Function function, uint32_t samplesCount)
+{
+    m_benchmarks.emplace_back(Benchmark{name, std::move(function), samplesCount});
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run(const std::string& filter)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<BenchmarkResult> results;
+    std::vector<double> samples;
+
+    for (auto& benchmark : m_benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos) continue;
+
+        std::cerr << "[benchmarks] " << benchmark.name << "..." << std::endl;
+
+        for (auto i = 0u; i < WARMUP_RUNS_COUNT; ++i) {
+            benchmark.function();
+        }
+
+        samples.resize(benchmark.samplesCount);
+        for (auto& sample : samples) {
+            auto start = Clock::now();
+            benchmark.function();
+            sample = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        result.samplesCount = samples.size();
+        result.min = samples.front();
+        result.median = samples[samples.size() / 2u];
+        result.p99 = samples[std::min<size_t>(samples.size() - 1u, (samples.size() * 99u) / 100u)];
+        results.emplace_back(result);
+    }
+
+    return results;
+}
+
+void BenchmarkRunner::writeJson(std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+    stream << std::fixed << std::setprecision(1);
+    stream << "{" << std::endl;
+    stream << "    \"unit\": \"ns\"," << std::endl;
+    stream << "    \"benchmarks\": [";
+
+    for (auto i = 0u; i < results.size(); ++i) {
+        const auto& result = results[i];
+        stream << ((i == 0u) ? "" : ",") << std::endl;
+        stream << "        {\"name\": \"" << result.name << "\", \"samples\": " << result.samplesCount
+               << ", \"min\": " << result.min << ", \"median\": " << result.median << ", \"p99\": " << result.p99 << "}";
+    }
+
+    stream << std::endl << "    ]" << std::endl;
+    stream << "}" << std::endl;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace lava::sill {
+    class GameEngine;
+}
+
+namespace lava::benchmarks {
+    /**
+     * Timings of one benchmark, in nanoseconds per run.
+     */
+    struct BenchmarkResult {
+        std::string name;
+        uint32_t samplesCount = 0u;
+        double min = 0.0;
+        double median = 0.0;
+        double p99 = 0.0;
+    };
+
+    /**
+     * Runs registered benchmarks and reports their timings.
+     *
+     * Each benchmark function is run a few times to warm caches up,
+     * then timed for each sample. Setup should be done before registering,
+     * and captured by the function.
+     */
+    class BenchmarkRunner {
+    public:
+        using Function = std::function<void()>;
+
+    public:
+        /// Register a benchmark, named "module.subject.case".
+        void add(const std::string& name, Function function, uint32_t samplesCount = 100u);
+
+        /// Run all benchmarks which name contains the filter.
+        std::vector<BenchmarkResult> run(const std::string& filter = "");
+
+        /// Write results as JSON, so that runs can be compared.
+        static void writeJson(std::ostream& stream, const std::vector<BenchmarkResult>& results);
+
+    private:
+        struct Benchmark {
+            std::string name;
+            Function function;
+            uint32_t samplesCount;
+        };
+
+    private:
+        std::vector<Benchmark> m_benchmarks;
+    };
+
+    /// Prevent the compiler from optimizing away a computed value.
+    template <class T>
+    inline void doNotOptimize(const T& value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /// Shared by benchmarks needing a window and a GPU, created on first call.
+    sill::GameEngine& gameEngine();
+
+    void registerChamberBenchmarks(BenchmarkRunner& runner);
+    void registerMagmaBenchmarks(BenchmarkRunner& runner);
+    void registerMagmaEngineBenchmarks(BenchmarkRunner& runner);
+    void registerSillBenchmarks(BenchmarkRunner& runner);
+}
@@ -0,0 +1,208 @@
+#include "./benchmark.hpp"
+
+#include <lava/chamber.hpp>
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using namespace lava;
+using namespace lava::benchmarks;
+
+namespace {
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    void registerThreadBenchmarks(BenchmarkRunner& runner)
+    {
+        runner.add("chamber.thread-pool.parallel-for", [] {
+            static std::vector<float> values(1u << 20u, 1.f);
+            chamber::defaultThreadPool().parallelFor(values.size(), 4096u, [](uint32_t begin, uint32_t end) {
+                for (auto i = begin; i < end; ++i) {
+                    values[i] = values[i] * 0.5f + 1.f;
+                }
+            });
+            doNotOptimize(values[0]);
+        });
+
+        runner.add("chamber.thread-pool.jobs-1000", [] {
+            auto& threadPool = chamber::defaultThreadPool();
+            for (auto i = 0u; i < 1000u; ++i) {
+                threadPool.job([] {});
+            }
+            threadPool.wait();
+        });
+
+        runner.add("chamber.thread.job-100", [] {
+            static chamber::Thread thread;
+            for (auto i = 0u; i < 100u; ++i) {
+                thread.job([] {});
+                thread.wait();
+            }
+        });
+    }
+
+    void registerBucketAllocatorBenchmarks(BenchmarkRunner& runner)
+    {
+        struct Item {
+            uint64_t values[6];
+        };
+
+        runner.add("chamber.bucket-allocator.allocate-deallocate-10000", [] {
+            static chamber::BucketAllocator allocator;
+            static std::vector<Item*> items(10000u);
+            for (auto& item : items) {
+                item = allocator.allocate<Item>();
+            }
+            // Interleaved deallocation, to stress free lists.
+            for (auto i = 0u; i < items.size(); i += 2u) allocator.deallocate(items[i]);
+            for (auto i = 1u; i < items.size(); i += 2u) allocator.deallocate(items[i]);
+        });
+    }
+
+    void registerStringToolsBenchmarks(BenchmarkRunner& runner)
+    {
+        // Mixing 1, 2, 3 and 4 bytes long codepoints.
+        auto text = std::make_shared<std::string>();
+        for (auto i = 0u; i < 4096u; ++i) {
+            *text += u8"lava été 溶岩 🌋 ";
+        }
+        auto wideText = std::make_shared<std::wstring>(chamber::utf8to16(*text));
+
+        runner.add("chamber.string-tools.utf8to16", [text] {
+            auto result = chamber::utf8to16(*text);
+            doNotOptimize(result.size());
+        });
+
+        runner.add("chamber.string-tools.utf16to8", [wideText] {
+            auto result = chamber::utf16to8(*wideText);
+            doNotOptimize(result.size());
+        });
+
+        runner.add("chamber.string-tools.utf8-codepoints", [text] {
+            auto u = reinterpret_cast<const uint8_t*>(text->data());
+            auto end = u + text->size();
+            uint32_t sum = 0u;
+            uint8_t bytesLength = 0u;
+            while (u < end) {
+                sum += chamber::utf8Codepoint(u, bytesLength);
+                u += bytesLength;
+            }
+            doNotOptimize(sum);
+        });
+
+        runner.add("chamber.string-tools.utf8-decode", [text] {
+            std::vector<uint32_t> codepoints(text->size());
+            auto count = chamber::utf8Decode(*text, codepoints.data());
+            doNotOptimize(count);
+        });
+
+        runner.add("chamber.string-tools.utf8-validate", [text] {
+            auto valid = chamber::utf8Validate(*text);
+            doNotOptimize(valid);
+        });
+    }
+
+    void registerLexerBenchmarks(BenchmarkRunner& runner)
+    {
+        auto code = std::make_shared<std::string>(readFile("./data/shaders/materials/rm-material.shmag"));
+
+        runner.add("chamber.lexer.rm-material", [code] {
+            chamber::Lexer lexer(*code);
+            auto tokensCount = 0u;
+            while (lexer.nextToken()) {
+                tokensCount += 1u;
+            }
+            doNotOptimize(tokensCount);
+        });
+    }
+
+    void registerMathBenchmarks(BenchmarkRunner& runner)
+    {
+        constexpr const uint32_t count = 10000u;
+
+        struct Data {
+            std::vector<glm::vec3> points;
+            std::vector<glm::vec3> outPoints;
+            std::vector<float> x, y, z, radius;
+            std::vector<uint8_t> visibles;
+            std::vector<glm::quat> q0s, q1s, outQuats;
+            std::vector<float> ts;
+            glm::vec4 planes[6];
+            glm::mat4 matrix;
+        };
+
+        auto data = std::make_shared<Data>();
+        std::mt19937 generator(42u);
+        std::uniform_real_distribution<float> distribution(-100.f, 100.f);
+        for (auto i = 0u; i < count; ++i) {
+            data->points.emplace_back(distribution(generator), distribution(generator), distribution(generator));
+            data->x.emplace_back(distribution(generator));
+            data->y.emplace_back(distribution(generator));
+            data->z.emplace_back(distribution(generator));
+            data->radius.emplace_back(std::abs(distribution(generator)) / 10.f);
+            data->q0s.emplace_back(glm::normalize(glm::quat(distribution(generator), distribution(generator), distribution(generator), distribution(generator))));
+            data->q1s.emplace_back(glm::normalize(glm::quat(distribution(generator), distribution(generator), distribution(generator), distribution(generator))));
+            data->ts.emplace_back((distribution(generator) + 100.f) / 200.f);
+        }
+        data->outPoints.resize(count);
+        data->visibles.resize(count);
+        data->outQuats.resize(count);
+        data->matrix = glm::rotate(glm::translate(glm::mat4(1.f), glm::vec3(1.f, 2.f, 3.f)), 0.5f, glm::vec3(0.f, 0.f, 1.f));
+        for (auto i = 0u; i < 6u; ++i) {
+            auto axis = glm::vec3(0.f);
+            axis[i / 2u] = (i % 2u) ? 1.f : -1.f;
+            data->planes[i] = glm::vec4(axis, 50.f);
+        }
+
+        runner.add("chamber.math.transform-points-10000", [data] {
+            chamber::math::transformPoints(data->matrix, data->points.data(), data->outPoints.data(), count);
+            doNotOptimize(data->outPoints[0]);
+        });
+
+        runner.add("chamber.math.transform-points-10000.glm", [data] {
+            for (auto i = 0u; i < count; ++i) {
+                data->outPoints[i] = glm::vec3(data->matrix * glm::vec4(data->points[i], 1.f));
+            }
+            doNotOptimize(data->outPoints[0]);
+        });
+
+        runner.add("chamber.math.min-max-10000", [data] {
+            glm::vec3 min, max;
+            chamber::math::minMax(data->points.data(), count, min, max);
+            doNotOptimize(min);
+            doNotOptimize(max);
+        });
+
+        runner.add("chamber.math.spheres-inside-planes-10000", [data] {
+            chamber::math::SpheresSoa spheres{data->x.data(), data->y.data(), data->z.data(), data->radius.data()};
+            chamber::math::spheresInsidePlanes(data->planes, 6u, spheres, count, data->visibles.data());
+            doNotOptimize(data->visibles[0]);
+        });
+
+        runner.add("chamber.math.nlerp-10000", [data] {
+            chamber::math::nlerp(data->q0s.data(), data->q1s.data(), data->ts.data(), data->outQuats.data(), count);
+            doNotOptimize(data->outQuats[0]);
+        });
+
+        runner.add("chamber.math.slerp-10000", [data] {
+            chamber::math::slerp(data->q0s.data(), data->q1s.data(), data->ts.data(), data->outQuats.data(), count);
+            doNotOptimize(data->outQuats[0]);
+        });
+    }
+}
+
+void benchmarks::registerChamberBenchmarks(BenchmarkRunner& runner)
+{
+    registerThreadBenchmarks(runner);
+    registerBucketAllocatorBenchmarks(runner);
+    registerStringToolsBenchmarks(runner);
+    registerLexerBenchmarks(runner);
+    registerMathBenchmarks(runner);
+}
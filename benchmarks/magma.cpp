@@ -0,0 +1,142 @@
+#include "./benchmark.hpp"
+
+#include <lava/chamber.hpp>
+#include <lava/core.hpp>
+#include <lava/magma.hpp>
+#include <lava/sill/game-engine.hpp>
+
+// Internal headers expect what magma's precompiled header provides.
+#include <vulkan/vulkan.hpp>
+
+#include <magma/shmag-reader.hpp>
+#include <magma/vulkan/stages/forward-renderer-stage.hpp>
+
+#include <memory>
+#include <random>
+
+using namespace lava;
+using namespace lava::benchmarks;
+
+namespace {
+    void registerShmagReaderBenchmarks(BenchmarkRunner& runner)
+    {
+        // @note Read results are cached by file content, so this is mostly the cache hit,
+        // chamber.lexer.rm-material measures the lexing itself.
+        runner.add("magma.shmag-reader.rm-material-cached", [] {
+            magma::ShmagReader shmagReader("./data/shaders/materials/rm-material.shmag");
+            doNotOptimize(shmagReader.processedString().size());
+        });
+    }
+
+    /**
+     * Frustum::canSee() one sphere at a time against the batched version.
+     */
+    void registerFrustumBenchmarks(BenchmarkRunner& runner)
+    {
+        constexpr const uint32_t count = 10000u;
+
+        struct Data {
+            magma::Frustum frustum;
+            std::vector<BoundingSphere> boundingSpheres;
+            std::vector<float> x, y, z, radius;
+            std::vector<uint8_t> visibles;
+        };
+
+        auto data = std::make_shared<Data>();
+
+        // 90° pyramid looking at +X
+        auto& frustum = data->frustum;
+        frustum.forward = glm::vec3(1.f, 0.f, 0.f);
+        frustum.near = 0.1f;
+        frustum.far = 100.f;
+        frustum.leftNormal = glm::normalize(glm::vec3(-1.f, 1.f, 0.f));
+        frustum.rightNormal = glm::normalize(glm::vec3(-1.f, -1.f, 0.f));
+        frustum.topNormal = glm::normalize(glm::vec3(-1.f, 0.f, 1.f));
+        frustum.bottomNormal = glm::normalize(glm::vec3(-1.f, 0.f, -1.f));
+        frustum.leftDistance = frustum.rightDistance = frustum.topDistance = frustum.bottomDistance = 0.f;
+
+        std::mt19937 generator(42u);
+        std::uniform_real_distribution<float> distribution(-100.f, 100.f);
+        for (auto i = 0u; i < count; ++i) {
+            BoundingSphere boundingSphere;
+            boundingSphere.center = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+            boundingSphere.radius = std::abs(distribution(generator)) / 20.f;
+            data->boundingSpheres.emplace_back(boundingSphere);
+            data->x.emplace_back(boundingSphere.center.x);
+            data->y.emplace_back(boundingSphere.center.y);
+            data->z.emplace_back(boundingSphere.center.z);
+            data->radius.emplace_back(boundingSphere.radius);
+        }
+        data->visibles.resize(count);
+
+        runner.add("magma.frustum.can-see-10000", [data] {
+            for (auto i = 0u; i < count; ++i) {
+                data->visibles[i] = data->frustum.canSee(data->boundingSpheres[i]);
+            }
+            doNotOptimize(data->visibles.data());
+        });
+
+        runner.add("magma.frustum.can-see-10000.batch", [data] {
+            chamber::math::SpheresSoa spheres{data->x.data(), data->y.data(), data->z.data(), data->radius.data()};
+            data->frustum.canSee(spheres, count, data->visibles.data());
+            doNotOptimize(data->visibles.data());
+        });
+    }
+
+    /**
+     * CPU side of ForwardRendererStage::record(), on meshes scattered around the camera,
+     * one in four being translucent so that both orders of render queues are sorted.
+     */
+    void registerForwardRendererBenchmarks(BenchmarkRunner& runner)
+    {
+        constexpr const uint32_t count = 10000u;
+
+        auto& engine = gameEngine();
+        auto& scene = engine.scene();
+
+        // Not bound to any render target, it only drives the culling.
+        auto& camera = scene.makeCamera(Extent2d{1920u, 1080u});
+
+        // A tetrahedron is enough to get a bounding sphere.
+        const std::vector<glm::vec3> positions = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, 0.f, 1.f}};
+        const std::vector<uint16_t> indices = {0u, 2u, 1u, 0u, 1u, 3u, 0u, 3u, 2u, 1u, 2u, 3u};
+
+        std::mt19937 generator(42u);
+        std::uniform_real_distribution<float> distribution(-100.f, 100.f);
+        for (auto i = 0u; i < count; ++i) {
+            auto& mesh = scene.makeMesh();
+            mesh.verticesCount(positions.size());
+            mesh.verticesPositions(positions);
+            mesh.indices(indices);
+            mesh.translation(glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+            mesh.scaling(std::abs(distribution(generator)) / 20.f);
+            if (i % 4u == 0u) {
+                mesh.renderCategory(RenderCategory::Translucent);
+            }
+        }
+
+        // Uploads geometries and builds the scene's BVH.
+        engine.renderEngine().update();
+
+        auto stage = std::make_shared<magma::ForwardRendererStage>(scene);
+        stage->init(camera);
+
+        // @note Culling allocates from the frame arena, which the render engine resets after each frame.
+        runner.add("magma.forward-renderer.fill-render-queues-10000", [stage, frameId = 0u]() mutable {
+            stage->fillRenderQueues(frameId);
+            chamber::frameArena.endFrame();
+            frameId = (frameId + 1u) % magma::FRAME_IDS_COUNT;
+        });
+    }
+}
+
+void benchmarks::registerMagmaBenchmarks(BenchmarkRunner& runner)
+{
+    registerShmagReaderBenchmarks(runner);
+    registerFrustumBenchmarks(runner);
+}
+
+void benchmarks::registerMagmaEngineBenchmarks(BenchmarkRunner& runner)
+{
+    registerForwardRendererBenchmarks(runner);
+}
@@ -0,0 +1,59 @@
+/**
+ * Runs lava micro-benchmarks and prints their timings as JSON.
+ *
+ * Usage: lava-benchmarks [--filter <substring>] [--output <file.json>] [--engine]
+ *
+ * Benchmarks needing a full game engine (and thus a window and a GPU)
+ * are only run with --engine.
+ */
+
+#include "./benchmark.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace lava::benchmarks;
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    std::string outputPath;
+    bool withEngine = false;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--engine") == 0) {
+            withEngine = true;
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--output <file.json>] [--engine]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    BenchmarkRunner runner;
+    registerChamberBenchmarks(runner);
+    registerMagmaBenchmarks(runner);
+    if (withEngine) {
+        registerMagmaEngineBenchmarks(runner);
+        registerSillBenchmarks(runner);
+    }
+
+    auto results = runner.run(filter);
+
+    if (outputPath.empty()) {
+        BenchmarkRunner::writeJson(std::cout, results);
+    }
+    else {
+        std::ofstream file(outputPath);
+        BenchmarkRunner::writeJson(file, results);
+    }
+
+    return EXIT_SUCCESS;
+}
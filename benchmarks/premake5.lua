@@ -0,0 +1,12 @@
+------------------------------------------
+-- Benchmarks - Performance regressions --
+------------------------------------------
+
+project "lava-benchmarks"
+    kind "ConsoleApp"
+    files "*.cpp"
+    useSill()
+
+    -- Internal headers, included as <magma/...>, stages being driven directly
+    includedirs "../source"
+    useVulkanHeaders()
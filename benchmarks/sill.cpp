@@ -0,0 +1,60 @@
+#include "./benchmark.hpp"
+
+#include <lava/sill.hpp>
+
+#include <memory>
+
+using namespace lava;
+using namespace lava::benchmarks;
+
+namespace {
+    void registerTransformBenchmarks(BenchmarkRunner& runner, sill::GameEngine& engine)
+    {
+        // A root with 10 chains of 100 entities each.
+        auto& root = engine.make<sill::Entity>("benchmarks.transform-root");
+        auto& rootTransform = root.ensure<sill::TransformComponent>();
+        for (auto i = 0u; i < 10u; ++i) {
+            auto* parent = &root;
+            for (auto j = 0u; j < 100u; ++j) {
+                auto& entity = engine.make<sill::Entity>();
+                entity.ensure<sill::TransformComponent>();
+                parent->addChild(entity);
+                parent = &entity;
+            }
+        }
+
+        runner.add("sill.transform-component.propagation-1000", [&rootTransform] {
+            rootTransform.translate(glm::vec3(0.f, 0.f, 0.001f));
+            doNotOptimize(rootTransform.worldTransform());
+        });
+    }
+
+    void registerGlbBenchmarks(BenchmarkRunner& runner, sill::GameEngine& engine)
+    {
+        // @note The entity is never handed to the engine but destroyed right away,
+        // so that entities and meshes do not pile up, which means their destruction is measured too.
+        // The file is generated by scripts/benchmarks/generate-cubes-glb.py.
+        runner.add(
+            "sill.glb-mesh.cubes",
+            [&engine] {
+                auto entity = std::make_unique<sill::Entity>(engine);
+                auto& meshComponent = entity->make<sill::MeshComponent>();
+                sill::makers::glbMeshMaker("./data/benchmarks/cubes.glb")(meshComponent);
+                entity.reset();
+                engine.renderEngine().update();
+            },
+            20u);
+    }
+}
+
+sill::GameEngine& benchmarks::gameEngine()
+{
+    static auto engine = std::make_unique<sill::GameEngine>();
+    return *engine;
+}
+
+void benchmarks::registerSillBenchmarks(BenchmarkRunner& runner)
+{
+    registerTransformBenchmarks(runner, gameEngine());
+    registerGlbBenchmarks(runner, gameEngine());
+}
@@ -260,7 +260,7 @@ void unserializeLevel(GameState& gameState, const std::string& path)
     gameState.level.name = levelJson["name"];
     gameState.level.path = path;
 
-    logger.info("vr-puzzle") << "Loading level '" << gameState.level.name << "'..." << std::endl;
+    $log_info("vr-puzzle") << "Loading level '" << gameState.level.name << "'..." << std::endl;
 
     const auto playerJson = levelJson["player"];
     gameState.player.position = unserializeVec3(playerJson["position"]);
@@ -299,7 +299,7 @@ void unserializeLevel(GameState& gameState, const std::string& path)
 
 void serializeLevel(GameState& gameState, const std::string& path)
 {
-    logger.info("vr-puzzle") << "Saving level '" << gameState.level.name << "' to " << path << "..." << std::endl;
+    $log_info("vr-puzzle") << "Saving level '" << gameState.level.name << "' to " << path << "..." << std::endl;
 
     nlohmann::json levelJson;
 
@@ -21,8 +21,17 @@ function useVulkan()
     linkoptions("-pthread")
 end
 
-function buildWithVulkan()
+-- For projects including magma's internal headers, the library itself being linked by magma.
+function useVulkanHeaders()
     includedirs(externalPath .. "/include")
+
+    defines { "VULKAN_HPP_DISPATCH_LOADER_DYNAMIC",
+              "VULKAN_HPP_NO_NODISCARD_WARNINGS",
+              "VULKAN_HPP_NO_EXCEPTIONS" }
+end
+
+function buildWithVulkan()
+    useVulkanHeaders()
     libdirs(externalPath .. "/lib")
 
     if os.host() == "windows" then
@@ -31,10 +40,6 @@ function buildWithVulkan()
         links { "vulkan" }
     end
 
-    defines { "VULKAN_HPP_DISPATCH_LOADER_DYNAMIC",
-              "VULKAN_HPP_NO_NODISCARD_WARNINGS",
-              "VULKAN_HPP_NO_EXCEPTIONS" }
-
     useVulkan()
 end
 
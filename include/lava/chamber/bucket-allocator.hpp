@@ -1,42 +1,52 @@
 #pragma once
 
 #include <cassert> // @fixme Have our own assert
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <vector>
-#include <cstring> // memset
 
 namespace lava::chamber {
     /**
-     * An ever-growing allocator that allocate fixed-size buckets.
+     * A slab allocator that allocates fixed-size slots within buckets.
      *
-     * The buckets' size is determined at the very first allocation.
-     * A bucket is destroyed only when there is nothing more in it.
+     * Allocations are grouped by size classes, each owning its buckets.
+     * Every slot is prefixed by its bucket address, so that deallocating is O(1).
+     * Freed slots are kept in an intrusive free list and reused first,
+     * so that resources stay dense. A bucket is released when there is nothing more in it.
+     *
+     * @note Objects still alive when the allocator is destroyed are not destructed.
      */
     class BucketAllocator {
-        static constexpr const uint32_t INSTANCES_PER_BUCKET = 100u;
+    public:
+        static constexpr const uint32_t SLOTS_PER_BUCKET = 64u;
+        static constexpr const size_t SLOT_ALIGNMENT = alignof(std::max_align_t);
+
+        struct Stats {
+            uint32_t sizeClassesCount = 0u;
+            uint32_t bucketsCount = 0u;
+            uint32_t slotsCount = 0u;
+            uint32_t allocationsCount = 0u;
+            size_t reservedBytes = 0u;
+            size_t usedBytes = 0u;
+
+            float occupancy() const { return (slotsCount == 0u) ? 0.f : float(allocationsCount) / float(slotsCount); }
+        };
 
     public:
+        BucketAllocator() = default;
+
+        BucketAllocator(const BucketAllocator&) = delete;
+        BucketAllocator& operator=(const BucketAllocator&) = delete;
+
         template <class T, typename... Args>
         inline T* allocateSized(size_t allocationSize, Args&&... args)
         {
-            // If we don't know the bucketSize, set it
-            if (m_bucketSize == 0u) {
-                m_bucketSize = INSTANCES_PER_BUCKET * allocationSize;
-                addBucket();
-            }
-
-            assert(allocationSize <= m_bucketSize);
-
-            // Make a new bucket if last one is not big enough
-            if ((m_bucketSize - m_buckets.back().usedBytes) < allocationSize) {
-                addBucket();
-            }
-
-            uint8_t* pointer = m_buckets.back().data.get() + m_buckets.back().usedBytes;
-            m_buckets.back().usedBytes += allocationSize;
+            static_assert(alignof(T) <= SLOT_ALIGNMENT, "Over-aligned types are not supported.");
+            assert(allocationSize >= sizeof(T));
 
             // Construct in-place the object
+            auto pointer = allocateRaw(allocationSize);
             T* tPointer = new (pointer) T(std::forward<Args>(args)...);
 
             return tPointer;
@@ -51,50 +61,50 @@ namespace lava::chamber {
         template <class T>
         void deallocate(T* tPointer)
         {
+            if (tPointer == nullptr) return;
+
             // Calling destructor
             tPointer->~T();
 
-            Bucket* tBucket = nullptr;
-            for (auto& bucket : m_buckets) {
-                if (reinterpret_cast<uint8_t*>(tPointer) >= bucket.data.get() &&
-                    reinterpret_cast<uint8_t*>(tPointer) < bucket.data.get() + m_bucketSize) {
-                    tBucket = &bucket;
-                    break;
-                }
-            }
-
-            // Deallocating something not allocated by us!
-            if (tBucket == nullptr) {
-                assert(false);
-                return;
-            }
-
-            // Clearing memory for debug
-            memset(reinterpret_cast<uint8_t*>(tPointer), 0, sizeof(T));
-
-            // @fixme Also move the bucket to last if empty
-            tBucket->allocationsCount -= 1u;
+            deallocateRaw(tPointer);
         }
 
-    protected:
-        void addBucket()
-        {
-            // @fixme If any, move last bucket to front (because it is full)
-            // And do not reallocate if the new back is not full
-            // Well... check if that's a good idea first ;)
+        /// Occupancy of all size classes.
+        Stats stats() const;
 
-            m_buckets.emplace_back();
-            m_buckets.back().data = std::make_unique<uint8_t[]>(m_bucketSize);
-        }
+    protected:
+        struct SizeClass;
 
         struct Bucket {
+            SizeClass* sizeClass = nullptr;
             std::unique_ptr<uint8_t[]> data = nullptr;
-            uint32_t usedBytes = 0u;
+            void* freeList = nullptr;        //!< Freed slots, each one pointing to the next.
+            uint32_t untouchedSlotIndex = 0u; //!< Slots after that one have never been used.
             uint32_t allocationsCount = 0u;
+
+            // Within the size class list of buckets having free slots.
+            Bucket* previousAvailable = nullptr;
+            Bucket* nextAvailable = nullptr;
         };
 
+        struct SizeClass {
+            size_t slotSize = 0u; //!< Including the bucket prefix.
+            std::vector<std::unique_ptr<Bucket>> buckets;
+            Bucket* availableBuckets = nullptr;
+            uint32_t allocationsCount = 0u;
+        };
+
+        void* allocateRaw(size_t allocationSize);
+        void deallocateRaw(void* pointer);
+
+        SizeClass& findSizeClass(size_t slotSize);
+        Bucket& addBucket(SizeClass& sizeClass);
+        void removeBucket(Bucket& bucket);
+        void linkAvailable(Bucket& bucket);
+        void unlinkAvailable(Bucket& bucket);
+
     private:
-        uint32_t m_bucketSize = 0u;
-        std::vector<Bucket> m_buckets;
+        std::vector<std::unique_ptr<SizeClass>> m_sizeClasses;
+        SizeClass* m_lastSizeClass = nullptr;
     };
 }
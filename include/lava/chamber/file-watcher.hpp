@@ -2,17 +2,32 @@
 
 #include <lava/chamber/file-watch-event.hpp>
 
+#include <chrono>
 #include <optional>
 #include <string>
 
 namespace lava::chamber {
+    /**
+     * Watches files and directories changes.
+     *
+     * Events are collected in the background, and coalesced per path:
+     * a burst of events on the same file is reported once it has been quiet
+     * for the coalescing delay.
+     */
     class FileWatcher {
     public:
         FileWatcher();
         ~FileWatcher();
 
-        /// Watch a file or a directory. Returns a watch Id.
-        uint32_t watch(const fs::Path& path);
+        /**
+         * Watch a file or a directory. Returns a watch Id.
+         * When recursive, all sub-directories (even the future ones)
+         * are watched, reporting the same watch Id.
+         */
+        uint32_t watch(const fs::Path& path, bool recursive = false);
+
+        /// How long a path should be quiet before its event is reported (default is 50ms), can be called from any thread.
+        void coalescingDelay(std::chrono::milliseconds delay);
 
         /// Grab the next event if any.
         std::optional<FileWatchEvent> pollEvent();
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lava::chamber {
+    /**
+     * Bump allocator, everything allocated is released at once by reset().
+     *
+     * Memory is taken from chunks, and when more than one chunk was needed,
+     * they are merged into a bigger one on reset so that the next cycles never allocate.
+     */
+    class LinearArena {
+    public:
+        LinearArena(uint32_t chunkSize = 64u * 1024u);
+        ~LinearArena();
+
+        LinearArena(const LinearArena&) = delete;
+        LinearArena& operator=(const LinearArena&) = delete;
+
+        /// Never fails, alignment should be a power of two.
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /// Forget all allocations, their memory being reused.
+        void reset();
+
+        /// Bytes allocated since the last reset (alignment padding included).
+        size_t used() const { return m_used; }
+
+        /// Maximum of used() ever reached.
+        size_t highWaterMark() const { return m_highWaterMark; }
+
+    private:
+        struct Chunk {
+            std::unique_ptr<uint8_t[]> data;
+            size_t size = 0u;
+        };
+
+    private:
+        std::vector<Chunk> m_chunks;
+        size_t m_chunkSize = 0u;
+        size_t m_offset = 0u; //!< Within the last chunk.
+        size_t m_used = 0u;
+        size_t m_highWaterMark = 0u;
+    };
+
+    /**
+     * Per-thread linear arenas, all reset at frame boundaries.
+     *
+     * Meant for transient allocations that do not survive the current frame,
+     * typically through FrameVector.
+     * endFrame() should not be called while other threads use their arenas.
+     * Each arena is owned by its thread, and freed when that one exits.
+     */
+    class FrameArena {
+    public:
+        FrameArena();
+
+        /// The arena of the calling thread.
+        LinearArena& local();
+
+        /// Reset all arenas, reporting the sum of their high-water marks to the tracker.
+        void endFrame();
+
+    private:
+        uint32_t m_id = 0u; //!< Unique, as addresses can be reused.
+
+        std::mutex m_arenasMutex;
+        std::vector<std::weak_ptr<LinearArena>> m_arenas;
+    };
+
+    /// Default frame arena, reset at the end of each rendered frame.
+    extern FrameArena frameArena;
+
+    /**
+     * STL-compatible allocator over a LinearArena, deallocation does nothing.
+     */
+    template <class T>
+    class ArenaAllocator {
+    public:
+        using value_type = T;
+
+        ArenaAllocator(LinearArena& arena)
+            : m_arena(&arena)
+        {
+        }
+
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& other)
+            : m_arena(&other.arena())
+        {
+        }
+
+        T* allocate(size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T*, size_t) {}
+
+        LinearArena& arena() const { return *m_arena; }
+
+        template <class U>
+        bool operator==(const ArenaAllocator<U>& other) const { return m_arena == &other.arena(); }
+        template <class U>
+        bool operator!=(const ArenaAllocator<U>& other) const { return m_arena != &other.arena(); }
+
+    private:
+        LinearArena* m_arena = nullptr;
+    };
+
+    /**
+     * Vector living in the calling thread's frame arena, valid until the end of the frame.
+     *
+     * ```c++
+     * FrameVector<const Mesh*> meshes(frameArena.local());
+     * ```
+     */
+    template <class T>
+    using FrameVector = std::vector<T, ArenaAllocator<T>>;
+}
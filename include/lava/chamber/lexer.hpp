@@ -3,20 +3,26 @@
 #include <lava/chamber/token-type.hpp>
 
 #include <optional>
+#include <string>
 #include <string_view>
 
 #define LAVA_STB_C_LEXER
 #include <lava/chamber/stb/c_lexer.h>
 
 namespace lava::chamber {
-    /// Simple wrapper over stb's lexer.
+    /**
+     * Simple wrapper over stb's lexer.
+     *
+     * Tokens are views into the code, which should therefore outlive them.
+     * The spacing might be a view into the lexer, valid until the next token.
+     */
     class Lexer {
     public:
         struct Token {
             TokenType type;
-            std::string spacing; // Spacing before token
-            std::string string;
-            double number = 0.0; // @note Integers are converted to numbers anyway.
+            std::string_view spacing; // Spacing before token, comments stripped
+            std::string_view string;  // @note Strings are kept without quotes and escape sequences are not processed.
+            double number = 0.0;      // @note Integers are converted to numbers anyway.
         };
 
         struct TokenContext {
@@ -33,7 +39,8 @@ namespace lava::chamber {
 
     private:
         stb_lexer m_lexer;
-        char m_buffer[100];
+        char m_buffer[16]; //!< Only used by stb for numbers suffixes.
+        std::string m_spacingStorage; //!< Spacing around comments.
         Token m_token;
     };
 }
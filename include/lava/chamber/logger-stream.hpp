@@ -1,11 +1,14 @@
 #pragma once
 
+#include <array>
 #include <iostream>
 
 #include <lava/chamber/call-stack.hpp>
 #include <lava/core/macros.hpp>
 
 namespace lava::chamber {
+    class LoggerBackend;
+
     enum class LoggerKind {
         Unknown,
         Info,
@@ -13,18 +16,17 @@ namespace lava::chamber {
 
     /**
      * Stream managing colors and reset upon line end.
+     *
+     * Each thread has its own stream, which formats full lines
+     * and hands them to the backend. When the current level is filtered out,
+     * the stream is put in a failed state so that nothing gets formatted.
      */
     class LoggerStream : public std::ostream, std::streambuf {
     public:
         /**
          * The reset string will be applied before each std::endl.
          */
-        LoggerStream(std::ostream& stream, const std::string& resetString);
-
-        /**
-         * The targetted stream.
-         */
-        std::ostream& stream() { return *m_stream; }
+        LoggerStream(LoggerBackend& backend, const std::string& resetString, uint32_t infoLogLevel);
 
         /**
          * Add a one-time spacing.
@@ -36,22 +38,39 @@ namespace lava::chamber {
          * A negative one, will remove previous ones.
          */
         LoggerStream& tab(int8_t spacingLength);
+        uint8_t tabs() const { return m_tabs; }
+
+        /**
+         * Set the kind of the next lines, enabling or disabling the stream.
+         */
+        LoggerKind kind() const { return m_kind; }
+        void kind(LoggerKind kind);
+
+        /**
+         * Hand pending characters to the backend.
+         */
+        void flushPending();
 
     protected:
         int overflow(int c) override;
+        int sync() override;
 
         std::string tabsString();
+        void updateEnabled();
+        void emitLine();
 
     private:
-        std::ostream* m_stream = nullptr;
+        LoggerBackend& m_backend;
 
         $property(std::string, resetString);
         $property(std::string, prefixString);
         $property(bool, autoExit, = false);
-        $property(LoggerKind, kind, = LoggerKind::Unknown);
 
-        bool m_beenReset = true;
+        LoggerKind m_kind = LoggerKind::Unknown;
         uint8_t m_tabs = 0u;
-        uint32_t m_infoLogLevel = 0u;
+        uint32_t m_infoLogLevel = -1u;
+
+        std::array<char, 256u> m_buffer;
+        std::string m_line;
     };
 }
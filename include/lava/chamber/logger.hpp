@@ -1,17 +1,30 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <lava/chamber/logger-stream.hpp>
 
 namespace lava::chamber {
     /**
      * Logger with different messages levels.
+     *
+     * It is safe to use from any thread, each one having its own stream.
+     * Lines are written asynchronously, except for errors
+     * which flush everything before exiting.
+     *
+     * Info messages deeper than LAVA_INFO_LOG_LEVEL tabs are not even formatted,
+     * and $log_info() does not evaluate its arguments in that case.
+     * Defining LAVA_CHAMBER_LOGGER_NO_INFO compiles $log_info() out of the translation unit,
+     * and forces the level to zero when building chamber for the remaining info() calls.
      */
     class Logger {
     public:
         Logger();
+        ~Logger();
 
         /**
          * Log with the same type and category as the last one.
@@ -23,6 +36,11 @@ namespace lava::chamber {
          */
         LoggerStream& info(const std::string& category);
 
+        /**
+         * Whether info lines would be written at the current tabs level of the calling thread.
+         */
+        bool infoEnabled();
+
         /**
          * Log an output with warning level.
          */
@@ -33,8 +51,21 @@ namespace lava::chamber {
          */
         LoggerStream& error(const std::string& category);
 
+        /**
+         * Write all pending lines, from the calling thread.
+         */
+        void flush();
+
+    protected:
+        /// The stream of the calling thread.
+        LoggerStream& stream();
+
     private:
-        LoggerStream m_stream;
+        std::unique_ptr<LoggerBackend> m_backend;
+        uint32_t m_infoLogLevel = -1u;
+
+        std::mutex m_streamsMutex;
+        std::vector<std::unique_ptr<LoggerStream>> m_streams;
     };
 
     /**
@@ -42,3 +73,23 @@ namespace lava::chamber {
      */
     extern Logger logger;
 }
+
+/**
+ * Log an information line, skipping the whole expression when it would be filtered.
+ *
+ * @note As the tabs level of the stream is kept from line to line,
+ * calls that use tab() should stay on logger.info() to keep it balanced.
+ */
+#if defined(LAVA_CHAMBER_LOGGER_NO_INFO)
+#define $log_info(category)                                                                                                      \
+    if (true) {                                                                                                                  \
+    }                                                                                                                            \
+    else                                                                                                                         \
+        lava::chamber::logger.info(category)
+#else
+#define $log_info(category)                                                                                                      \
+    if (!lava::chamber::logger.infoEnabled()) {                                                                                  \
+    }                                                                                                                            \
+    else                                                                                                                         \
+        lava::chamber::logger.info(category)
+#endif
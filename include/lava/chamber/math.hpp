@@ -1,4 +1,5 @@
 #pragma once
 
+#include <lava/chamber/math/batch.hpp>
 #include <lava/chamber/math/constants.hpp>
 #include <lava/chamber/math/trigonometry.hpp>
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <lava/core/bounding-sphere.hpp>
+
+#include <cstdint>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+/**
+ * Kernels working on whole arrays at once.
+ *
+ * On x86_64, they use SSE and switch to AVX2 at runtime when the CPU supports it.
+ * Other architectures get the scalar fallbacks.
+ * Unless specified, outputs can be the same arrays as inputs.
+ */
+namespace lava::chamber::math {
+    /// Transform points by the matrix, considering them with w = 1.
+    void transformPoints(const glm::mat4& matrix, const glm::vec3* points, glm::vec3* outPoints, uint32_t count);
+
+    /// Transform spheres by the matrix, radii being scaled by the biggest axis scaling.
+    void transformSpheres(const glm::mat4& matrix, const BoundingSphere* spheres, BoundingSphere* outSpheres, uint32_t count);
+
+    /// Axis-aligned bounding box of the points, count should not be zero.
+    void minMax(const glm::vec3* points, uint32_t count, glm::vec3& min, glm::vec3& max);
+
+    /// Spheres, as a structure of arrays.
+    struct SpheresSoa {
+        const float* x = nullptr;
+        const float* y = nullptr;
+        const float* z = nullptr;
+        const float* radius = nullptr;
+    };
+
+    /**
+     * Test spheres against half-spaces, each plane (n, d) keeping points p such as dot(n, p) <= d.
+     * visibles[i] is set to 1 if the sphere i touches all half-spaces, 0 otherwise.
+     */
+    void spheresInsidePlanes(const glm::vec4* planes, uint32_t planesCount, const SpheresSoa& spheres, uint32_t count,
+                             uint8_t* visibles);
+
+    /// Normalized linear interpolation of quaternions, taking the shortest path.
+    void nlerp(const glm::quat* q0s, const glm::quat* q1s, const float* ts, glm::quat* outQuats, uint32_t count);
+
+    /// Spherical linear interpolation of quaternions, same as glm::slerp.
+    void slerp(const glm::quat* q0s, const glm::quat* q1s, const float* ts, glm::quat* outQuats, uint32_t count);
+}
@@ -1,5 +1,15 @@
 #pragma once
 
+#include <lava/core/macros/common.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace lava::chamber {
 #define PROFILER_COLOR_UPDATE 0xFFAEC6CF     // Entity update
 #define PROFILER_COLOR_RENDER 0xFFFFB347     // Command buffer creation
@@ -9,12 +19,128 @@ namespace lava::chamber {
 #define PROFILER_COLOR_INIT 0xFFB19CD9       // Initializing/one-time context
 }
 
-// @note Currently no intrusive profiling tool is used.
-// Hence, all of these are dummy.
-// They might get removed.
+namespace lava::chamber {
+    /**
+     * Intrusive profiler, recording scoped zones.
+     *
+     * Each thread records into its own ring buffer, without any lock,
+     * and the whole is dumped as a Chrome trace (readable by chrome://tracing
+     * or Perfetto) when profiling stops.
+     * Starting and stopping wait for the events being written,
+     * and the events of exited threads are freed once dumped.
+     *
+     * Use it through the macros below, which are compiled out
+     * unless PROFILE_ENABLED is defined.
+     */
+    class Profiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Events kept per thread, the oldest ones are overwritten.
+        static constexpr const uint32_t EVENTS_PER_THREAD = 1u << 15u;
+
+        struct Event {
+            const char* name = nullptr;
+            uint32_t color = 0u;
+            uint64_t begin = 0u; //!< In nanoseconds since profiling start.
+            uint64_t end = 0u;
+        };
+
+    public:
+        /// Clear all previous events and start recording.
+        void start();
+
+        /// Stop recording and dump everything as a JSON trace into dumpFile.
+        void stop(const std::string& dumpFile);
+
+        bool active() const { return m_active.load(std::memory_order_relaxed); }
+
+        /// Current timestamp, as expected by record().
+        uint64_t now() const
+        {
+            auto sinceStart = Clock::now().time_since_epoch() - Clock::duration(m_startTime.load(std::memory_order_relaxed));
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(sinceStart).count();
+        }
+
+        /// Record a zone for the current thread.
+        void record(const char* name, uint32_t color, uint64_t begin, uint64_t end);
+
+        /// Name the current thread within the trace.
+        void threadName(const char* threadName);
+
+    protected:
+        struct ThreadEvents {
+            uint32_t threadId = 0u;
+            std::string threadName;
+            std::atomic<uint64_t> eventsCount = 0u; //!< Total ever recorded, the ring index is that modulo capacity.
+            std::atomic<bool> recording = false;   //!< While an event is being written.
+            std::unique_ptr<Event[]> events = std::make_unique<Event[]>(EVENTS_PER_THREAD);
+        };
+
+        ThreadEvents& currentThreadEvents();
+
+        /// Wait for the events being written, recording should be inactive.
+        void waitRecordings();
+
+        /// Free the events of threads that have exited, once they are not needed anymore.
+        void forgetExitedThreads();
+
+    private:
+        std::atomic<bool> m_active = false;
+        std::atomic<Clock::rep> m_startTime = Clock::now().time_since_epoch().count();
+
+        // Only locked when a thread records for the first time and when starting or dumping.
+        // The threads own their events too, so that the ones left only referenced here have exited.
+        std::mutex m_threadsEventsMutex;
+        std::vector<std::shared_ptr<ThreadEvents>> m_threadsEvents;
+        uint32_t m_threadsCount = 0u;
+    };
+
+    /**
+     * Default profiler.
+     */
+    extern Profiler profiler;
+
+    /**
+     * Records its lifetime as a zone.
+     */
+    class ProfilerZone {
+    public:
+        ProfilerZone(const char* name, uint32_t color = 0u)
+        {
+            if (!profiler.active()) return;
+            m_name = name;
+            m_color = color;
+            m_begin = profiler.now();
+        }
+
+        ~ProfilerZone()
+        {
+            if (m_name == nullptr) return;
+            profiler.record(m_name, m_color, m_begin, profiler.now());
+        }
+
+    private:
+        const char* m_name = nullptr;
+        uint32_t m_color = 0u;
+        uint64_t m_begin = 0u;
+    };
+
+    /// Allows PROFILE_FUNCTION() to be used without any color.
+    constexpr uint32_t profilerColor(uint32_t color = 0u) { return color; }
+}
 
 namespace lava::chamber {
-// #define PROFILE_ENABLED
+#if defined(PROFILE_ENABLED)
+#define PROFILE_FUNCTION(...)                                                                                                    \
+    lava::chamber::ProfilerZone $cat(profilerZone_, __COUNTER__)(__PRETTY_FUNCTION__, lava::chamber::profilerColor(__VA_ARGS__))
+#define PROFILE_BLOCK(...) lava::chamber::ProfilerZone $cat(profilerZone_, __COUNTER__)(__VA_ARGS__)
+
+    inline void startProfiling() { profiler.start(); }
+    inline void stopProfiling(std::string dumpFile = "") { profiler.stop(dumpFile.empty() ? "./profile.json" : dumpFile); }
+
+    inline void profilerThreadName(const char* threadName) { profiler.threadName(threadName); }
+#else
 #define PROFILE_FUNCTION(...) /* empty */
 #define PROFILE_BLOCK(...)    /* empty */
 
@@ -22,4 +148,5 @@ namespace lava::chamber {
     inline void stopProfiling(std::string /* dumpFile */ = "") {}
 
     inline void profilerThreadName(const char* /* threadName */) {}
+#endif
 }
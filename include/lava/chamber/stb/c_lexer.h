@@ -512,6 +512,19 @@ static int stb__clex_parse_string(stb_lexer *lexer, char *p, int type)
 {
    char *start = p;
    char delim = *p++; // grab the " or ' for later matching
+   #ifdef LAVA_STB_C_LEXER
+   // @note Escape sequences are kept as-is, lexer->string points into the input and is not null-terminated.
+   while (p != lexer->eof && *p != delim) {
+      if (*p == '\\' && p+1 != lexer->eof)
+         ++p;
+      ++p;
+   }
+   if (p == lexer->eof)
+      return stb__clex_token(lexer, CLEX_parse_error, start, p-1);
+   lexer->string = start+1;
+   lexer->string_len = (int) (p - start - 1);
+   return stb__clex_token(lexer, type, start, p);
+   #else
    char *out = lexer->string_storage;
    char *outend = lexer->string_storage + lexer->string_storage_len;
    while (*p != delim) {
@@ -535,6 +548,7 @@ static int stb__clex_parse_string(stb_lexer *lexer, char *p, int type)
    lexer->string = lexer->string_storage;
    lexer->string_len = (int) (out - lexer->string_storage);
    return stb__clex_token(lexer, type, start, p);
+   #endif
 }
 
 int stb_c_lexer_get_token(stb_lexer *lexer)
@@ -554,14 +568,13 @@ int stb_c_lexer_get_token(stb_lexer *lexer)
       }
       #else
       #ifdef LAVA_STB_C_LEXER
+      // @note Not copied to the string storage, lexer->string points into the input and is not null-terminated.
       if (p != lexer->eof && stb__clex_iswhite(*p)) {
-         lexer->string = lexer->string_storage;
          int n = 0;
          do {
-            lexer->string[n] = p[n];
             ++n;
          } while (p + n != lexer->eof && stb__clex_iswhite(p[n]));
-         lexer->string[n] = 0;
+         lexer->string = p;
          lexer->string_len = n;
          return stb__clex_token(lexer, CLEX_white, p, p+n-1);
       }
@@ -618,6 +631,13 @@ int stb_c_lexer_get_token(stb_lexer *lexer)
              STB_C_LEX_DOLLAR_IDENTIFIER( || *p == '$' ) )
          {
             int n = 0;
+            #ifdef LAVA_STB_C_LEXER
+            // @note Not copied to the string storage, lexer->string points into the input and is not null-terminated.
+            lexer->string = p;
+            do {
+               ++n;
+            } while (
+            #else
             lexer->string = lexer->string_storage;
             lexer->string_len = n;
             do {
@@ -626,13 +646,18 @@ int stb_c_lexer_get_token(stb_lexer *lexer)
                lexer->string[n] = p[n];
                ++n;
             } while (
+            #endif
                   (p[n] >= 'a' && p[n] <= 'z')
                || (p[n] >= 'A' && p[n] <= 'Z')
                || (p[n] >= '0' && p[n] <= '9') // allow digits in middle of identifier
                || p[n] == '_' || (unsigned char) p[n] >= 128
                 STB_C_LEX_DOLLAR_IDENTIFIER( || p[n] == '$' )
             );
+            #ifdef LAVA_STB_C_LEXER
+            lexer->string_len = n;
+            #else
             lexer->string[n] = 0;
+            #endif
             return stb__clex_token(lexer, CLEX_id, p, p+n-1);
          }
 
@@ -28,8 +28,23 @@ namespace lava::chamber {
     std::string utf16to8(const std::wstring& ws);
 
     /// Convert a UTF8 string to UTF16.
+    /// @note Invalid sequences are converted to U+FFFD.
     std::wstring utf8to16(const std::string& s);
 
+    /**
+     * Decode a whole UTF-8 buffer at once, runs of ASCII characters being handled 16 bytes at a time.
+     *
+     * codepoints (and byteOffsets, if any) should be able to hold u8Text.size() values,
+     * byteOffsets receiving the first byte index of each codepoint.
+     * Invalid sequences are decoded as U+FFFD and set valid to false.
+     * Returns the number of decoded codepoints.
+     */
+    uint32_t utf8Decode(u8string_view u8Text, uint32_t* codepoints, uint32_t* byteOffsets = nullptr, bool* valid = nullptr);
+    std::vector<uint32_t> utf8Decode(u8string_view u8Text);
+
+    /// Whether the whole buffer is valid UTF-8 (no overlong encodings, surrogates or truncated sequences).
+    bool utf8Validate(u8string_view u8Text);
+
     // bytesLength will be set to 1, 2, 3 or 4 given the read bytes count.
     // @note Undefined behavior if u is not a valid UTF-8 codepoint start.
     uint32_t utf8Codepoint(const uint8_t* u, uint8_t& bytesLength);
@@ -1,35 +1,118 @@
 #pragma once
 
-#include <lava/chamber/thread.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace lava::chamber {
+    struct Job;
+
     /**
-     * On-demand thread pool, meaning that all threads will wait for new jobs
-     * to execute and never stop until destructed.
+     * Handle to a job submitted to a ThreadPool.
+     *
+     * It can be waited on or used as a dependency for other jobs.
+     * A default-constructed handle is considered done.
      */
-    class ThreadPool {
-        static constexpr auto POOL_SIZE = 6u;
+    class JobHandle {
+        friend class ThreadPool;
+
+    public:
+        JobHandle() = default;
+
+        /// Whether the job has been executed.
+        bool done() const;
+
+    private:
+        JobHandle(std::shared_ptr<Job> job)
+            : m_job(std::move(job))
+        {
+        }
 
+    private:
+        std::shared_ptr<Job> m_job;
+    };
+
+    /**
+     * Work-stealing thread pool.
+     *
+     * Each worker owns a deque of jobs, it pops its own jobs LIFO
+     * and steals from the other workers FIFO when it has nothing left.
+     * Threads waiting for a job to be done help executing pending jobs.
+     */
+    class ThreadPool {
     public:
-        ThreadPool();
+        /// A threadsCount of zero means one worker per hardware thread, minus the caller one.
+        ThreadPool(uint32_t threadsCount = 0u);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Number of workers.
+        uint32_t threadsCount() const { return m_workers.size(); }
 
         /// Add a job to be done.
-        void job(const std::function<void()>& job);
+        JobHandle job(std::function<void()> job);
+
+        /// Add a job to be done once all its dependencies are.
+        JobHandle job(std::function<void()> job, const std::vector<JobHandle>& dependencies);
+
+        /// Add a job to be done right after the specified one.
+        JobHandle then(const JobHandle& dependency, std::function<void()> job) { return this->job(std::move(job), {dependency}); }
+
+        /// Wait for a specific job to be done.
+        void wait(const JobHandle& jobHandle);
 
-        /// Wait for the all jobs and threads to be done.
+        /// Wait for the all jobs to be done.
         void wait();
 
+        /**
+         * Call `fn(begin, end)` over chunks of [0, count) in parallel
+         * and wait for them to be done.
+         * A grainSize of zero lets the pool choose chunks' size.
+         */
+        void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn);
+
     protected:
-        // Start a job on the specified thread.
-        void startJob(Thread& thread, const std::function<void()>& job);
+        struct Worker {
+            std::deque<std::shared_ptr<Job>> jobs;
+            std::mutex mutex;
+            std::thread thread;
+        };
+
+        void run(uint32_t workerIndex);
+
+        // Push a job whose dependencies are all done.
+        void schedule(std::shared_ptr<Job> job);
 
-        // Called automatically whenever a job within a thread finishes.
-        void jobFinished(Thread& thread);
+        // Pop a job from our own worker or steal one from others.
+        std::shared_ptr<Job> popJob();
+
+        // Execute the job then schedule its continuations.
+        void execute(Job& job);
+
+        // Execute one pending job if any, returns false if nothing was done.
+        bool help();
 
     private:
-        std::array<Thread, POOL_SIZE> m_threads;
-        std::vector<Thread*> m_availableThreads;
-        std::vector<std::function<void()>> m_pendingJobs;
-        std::mutex m_mutex;
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<uint32_t> m_nextWorkerIndex = 0u;
+        std::atomic<uint32_t> m_pendingJobsCount = 0u;    //!< Jobs scheduled, not yet popped.
+        std::atomic<uint32_t> m_unfinishedJobsCount = 0u; //!< Jobs added, not yet executed.
+
+        bool m_stopping = false;
+        std::mutex m_sleepMutex;
+        std::condition_variable m_sleepCondition;
     };
+
+    /**
+     * Default thread pool, shared by all subsystems.
+     */
+    ThreadPool& defaultThreadPool();
 }
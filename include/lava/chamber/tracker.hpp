@@ -1,21 +1,179 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 namespace lava::chamber {
+    /**
+     * Name of a tracked metric, hashed at compile-time when declared constexpr.
+     *
+     * ```c++
+     * constexpr TrackerKey DRAW_CALLS_KEY("draw-calls.renderer");
+     * tracker.add(DRAW_CALLS_KEY);
+     * ```
+     */
+    class TrackerKey {
+    public:
+        constexpr TrackerKey(const char* name)
+            : m_name(name)
+            , m_hash(hash(name))
+        {
+        }
+
+        constexpr const char* name() const { return m_name; }
+        constexpr uint64_t hash() const { return m_hash; }
+
+    protected:
+        // FNV-1a, never zero as it is the empty-slot marker.
+        static constexpr uint64_t hash(const char* name)
+        {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (; *name != '\0'; ++name) {
+                hash = (hash ^ static_cast<uint8_t>(*name)) * 0x100000001b3ull;
+            }
+            return (hash != 0u) ? hash : 1u;
+        }
+
+    private:
+        const char* m_name = nullptr;
+        uint64_t m_hash = 0u;
+    };
+
+    enum class TrackerMetricKind {
+        Counter,   //!< Summed over all threads, reset each frame.
+        Gauge,     //!< Last value set, kept across frames.
+        Histogram, //!< Distribution of samples, reset each frame.
+    };
+
+    /**
+     * All metrics values for one frame.
+     */
+    struct TrackerFrame {
+        struct Metric {
+            const char* name = nullptr;
+            uint64_t hash = 0u;
+            TrackerMetricKind kind = TrackerMetricKind::Counter;
+            double value = 0.0; //!< Counter or gauge value, histogram mean.
+
+            // Histograms only.
+            uint32_t count = 0u;
+            double min = 0.0;
+            double max = 0.0;
+            double p50 = 0.0; //!< Approximated with power-of-two buckets.
+            double p99 = 0.0;
+        };
+
+        uint64_t frameId = 0u;
+        float duration = 0.f; //!< In seconds, since previous frame end.
+        std::vector<Metric> metrics;
+
+        /// Find a metric by key, nullptr if it was not tracked that frame.
+        const Metric* find(const TrackerKey& key) const;
+    };
+
     /**
      * Tracking multiple data.
+     *
+     * Each thread writes to its own shard, without any lock nor atomic read-modify-write:
+     * shards are double-buffered, and the frame end merge flips which half is written,
+     * only waiting for the writes still going to the other half.
+     * Shards of exited threads are merged one last time, then freed.
+     * The last frames are kept for querying and exporting.
      */
     class Tracker {
     public:
-        /**
-         * Access the specified counter.
-         */
-        uint32_t& counter(const std::string& category);
+        static constexpr const uint32_t FRAMES_HISTORY_COUNT = 128u;
+        static constexpr const uint32_t METRICS_PER_SHARD = 256u;
+        static constexpr const uint32_t HISTOGRAMS_PER_SHARD = 32u;
+        static constexpr const uint32_t HISTOGRAM_BUCKETS_COUNT = 48u;
+
+    public:
+        /// Increment a counter for the current frame.
+        void add(const TrackerKey& key, uint64_t value = 1u);
+
+        /// Set the value of a gauge.
+        void gauge(const TrackerKey& key, double value);
+
+        /// Add a sample to a histogram for the current frame.
+        void sample(const TrackerKey& key, double value);
+
+        /// Merge all threads metrics into a new frame.
+        /// @note Should be called from one thread at a time.
+        void endFrame();
+
+        /// Value of a counter or gauge for the last ended frame.
+        double counter(const TrackerKey& key) const;
+
+        /// Last ended frames, 0 being the most recent one.
+        const TrackerFrame& frame(uint32_t age = 0u) const;
+        uint32_t framesCount() const { return std::min<uint64_t>(m_framesCount, FRAMES_HISTORY_COUNT); }
+
+        /// Export all kept frames as CSV, one line per frame, one column per metric.
+        void exportCsv(std::ostream& stream) const;
+
+    protected:
+        struct Shard {
+            struct Metric {
+                uint64_t hash = 0u;
+                const char* name = nullptr;
+                TrackerMetricKind kind = TrackerMetricKind::Counter;
+                uint64_t counter = 0u;
+                double gauge = 0.0;
+                uint64_t gaugeStamp = 0u; //!< When it has been set, to know which thread set it last. Zero if not set.
+            };
+
+            struct Histogram {
+                uint64_t hash = 0u;
+                const char* name = nullptr;
+                uint32_t count = 0u;
+                double sum = 0.0;
+                double min = 0.0;
+                double max = 0.0;
+                std::array<uint32_t, HISTOGRAM_BUCKETS_COUNT> buckets = {};
+            };
+
+            /// Only one half is written at a time, the other one being merged.
+            struct Half {
+                std::array<Metric, METRICS_PER_SHARD> metrics;
+                std::array<Histogram, HISTOGRAMS_PER_SHARD> histograms;
+            };
+
+            std::array<Half, 2u> halves;
+            std::atomic<bool> writing = false; //!< Whether the owning thread is writing.
+            std::atomic<bool> retired = false; //!< Whether the owning thread exited.
+        };
+
+        /// Gauges are kept across frames, even if their thread exited.
+        struct Gauge {
+            uint64_t hash = 0u;
+            const char* name = nullptr;
+            double value = 0.0;
+        };
+
+        /// Mark the current thread's shard as being written, returning the half to write to.
+        Shard::Half& beginWrite(Shard& shard);
+        void endWrite(Shard& shard);
+        void warnFull(const TrackerKey& key);
+
+        Shard& currentThreadShard();
 
     private:
-        std::unordered_map<std::string, uint32_t> m_counters;
+        std::mutex m_shardsMutex;
+        std::vector<std::shared_ptr<Shard>> m_shards;
+        std::atomic<uint32_t> m_writtenHalf = 0u;
+        std::atomic<bool> m_fullWarned = false;
+
+        std::vector<Gauge> m_gauges;
+        std::array<TrackerFrame, FRAMES_HISTORY_COUNT> m_frames;
+        uint64_t m_framesCount = 0u;
+        uint64_t m_lastFrameEndTime = 0u;
     };
 
     /**
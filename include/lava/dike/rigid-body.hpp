@@ -28,6 +28,7 @@ namespace lava::dike {
 
         // @note The indices have to be tighly packed, therefore we use a vector directly.
         void addMeshShape(const glm::mat4& localTransform, VectorView<glm::vec3> vertices, const std::vector<uint16_t>& indices);
+        void addMeshShape(const glm::mat4& localTransform, VectorView<glm::vec3> vertices, const std::vector<uint32_t>& indices);
 
         // Physics world
         bool enabled() const;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <lava/core/bounding-sphere.hpp>
+#include <lava/core/ray.hpp>
+
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace lava::magma {
+    class Frustum;
+    class Mesh;
+}
+
+namespace lava::magma {
+    /**
+     * Dynamic bounding-volume hierarchy over meshes' bounding spheres.
+     *
+     * Leaves are axis-aligned boxes around the spheres, fattened by a margin,
+     * so that small moves do not change the tree. Moving out of it reinserts the leaf,
+     * where it costs the least (surface heuristic), and the tree is kept balanced with rotations.
+     *
+     * Queries call back with each mesh whose box touches the volume,
+     * this is conservative and meshes should be tested more precisely afterwards if needed.
+     * Queries can run concurrently, but not while the tree is being modified.
+     */
+    class Bvh {
+    public:
+        static constexpr const uint32_t NULL_NODE = -1u;
+
+    public:
+        /// Add a leaf for the mesh, returning its id.
+        uint32_t insert(Mesh& mesh, const BoundingSphere& boundingSphere);
+
+        /// Remove a leaf, its id might be reused.
+        void remove(uint32_t leaf);
+
+        /// Update the bounding sphere of a leaf, returns true if the tree has been modified.
+        bool move(uint32_t leaf, const BoundingSphere& boundingSphere);
+
+        /**
+         * @name Queries
+         */
+        /// @{
+        /// Meshes that might be within the frustum.
+        template <class Callback>
+        void query(const Frustum& frustum, Callback callback) const;
+
+        /// Meshes that might be within all half-spaces, each plane (n, d) keeping points p such as dot(n, p) <= d.
+        template <class Callback>
+        void query(const glm::vec4* planes, uint32_t planesCount, Callback callback) const;
+
+        /// Meshes that might intersect the sphere.
+        template <class Callback>
+        void query(const BoundingSphere& sphere, Callback callback) const;
+
+        /// Meshes that might be hit by the ray.
+        template <class Callback>
+        void query(const Ray& ray, Callback callback) const;
+        /// @}
+
+        /**
+         * @name Statistics
+         */
+        /// @{
+        uint32_t leavesCount() const { return m_leavesCount; }
+        uint32_t height() const { return (m_root == NULL_NODE) ? 0u : m_nodes[m_root].height; }
+        /// @}
+
+    protected:
+        struct Node {
+            glm::vec3 min;
+            glm::vec3 max;
+            Mesh* mesh = nullptr;             //!< Only for leaves.
+            uint32_t parent = NULL_NODE;      //!< Next free node when not in use.
+            uint32_t children[2] = {NULL_NODE, NULL_NODE};
+            int32_t height = -1;              //!< 0 for leaves, -1 for free nodes.
+
+            bool leaf() const { return children[0] == NULL_NODE; }
+        };
+
+        /// Depth-first traversal, calling back for each leaf whose box overlaps.
+        template <class Overlaps, class Callback>
+        void traverse(Overlaps overlaps, Callback callback) const;
+
+        uint32_t allocateNode();
+        void freeNode(uint32_t index);
+        void insertLeaf(uint32_t leaf);
+        void removeLeaf(uint32_t leaf);
+        void refit(uint32_t index);
+        uint32_t balance(uint32_t index);
+
+    private:
+        std::vector<Node> m_nodes;
+        uint32_t m_root = NULL_NODE;
+        uint32_t m_freeNode = NULL_NODE;
+        uint32_t m_leavesCount = 0u;
+    };
+}
+
+#include <lava/magma/bvh.inl>
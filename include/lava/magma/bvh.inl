@@ -0,0 +1,104 @@
+#pragma once
+
+#include <lava/magma/frustum.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <limits>
+
+namespace lava::magma {
+    template <class Callback>
+    inline void Bvh::query(const Frustum& frustum, Callback callback) const
+    {
+        const auto planes = frustum.planes();
+        query(planes.data(), planes.size(), callback);
+    }
+
+    template <class Callback>
+    inline void Bvh::query(const glm::vec4* planes, uint32_t planesCount, Callback callback) const
+    {
+        traverse(
+            [planes, planesCount](const glm::vec3& min, const glm::vec3& max) {
+                const auto center = (min + max) * 0.5f;
+                const auto extent = (max - min) * 0.5f;
+                for (auto i = 0u; i < planesCount; ++i) {
+                    const glm::vec3 normal(planes[i]);
+                    // Closest corner of the box to the half-space
+                    if (glm::dot(normal, center) - glm::dot(glm::abs(normal), extent) > planes[i].w) return false;
+                }
+                return true;
+            },
+            callback);
+    }
+
+    template <class Callback>
+    inline void Bvh::query(const BoundingSphere& sphere, Callback callback) const
+    {
+        traverse(
+            [&sphere](const glm::vec3& min, const glm::vec3& max) {
+                const auto delta = glm::clamp(sphere.center, min, max) - sphere.center;
+                return glm::dot(delta, delta) <= sphere.radius * sphere.radius;
+            },
+            callback);
+    }
+
+    template <class Callback>
+    inline void Bvh::query(const Ray& ray, Callback callback) const
+    {
+        // @note Zero components are not inverted, as 0 * inf would be NaN
+        // when the origin lies on a slab plane.
+        glm::vec3 inverseDirection(0.f);
+        for (auto i = 0u; i < 3u; ++i) {
+            if (ray.direction[i] != 0.f) inverseDirection[i] = 1.f / ray.direction[i];
+        }
+
+        traverse(
+            [&ray, &inverseDirection](const glm::vec3& min, const glm::vec3& max) {
+                // Slabs intersection, only considering what is in front of the origin
+                auto tEnter = 0.f;
+                auto tExit = std::numeric_limits<float>::infinity();
+                for (auto i = 0u; i < 3u; ++i) {
+                    // Parallel to the slab, the origin has to be within.
+                    if (ray.direction[i] == 0.f) {
+                        if (ray.origin[i] < min[i] || ray.origin[i] > max[i]) return false;
+                        continue;
+                    }
+
+                    const auto t0 = (min[i] - ray.origin[i]) * inverseDirection[i];
+                    const auto t1 = (max[i] - ray.origin[i]) * inverseDirection[i];
+                    tEnter = std::max(tEnter, std::min(t0, t1));
+                    tExit = std::min(tExit, std::max(t0, t1));
+                }
+                return tExit >= tEnter;
+            },
+            callback);
+    }
+
+    template <class Overlaps, class Callback>
+    inline void Bvh::traverse(Overlaps overlaps, Callback callback) const
+    {
+        if (m_root == NULL_NODE) return;
+
+        // @note The tree being balanced, its height stays way below that.
+        constexpr const uint32_t STACK_SIZE = 128u;
+        uint32_t stack[STACK_SIZE];
+        auto stackSize = 0u;
+        stack[stackSize++] = m_root;
+
+        while (stackSize > 0u) {
+            const auto& node = m_nodes[stack[--stackSize]];
+            if (!overlaps(node.min, node.max)) continue;
+
+            if (node.leaf()) {
+                callback(*node.mesh);
+            }
+            else {
+                assert(stackSize + 2u <= STACK_SIZE);
+                stack[stackSize++] = node.children[0];
+                stack[stackSize++] = node.children[1];
+            }
+        }
+    }
+}
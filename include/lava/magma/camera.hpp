@@ -6,6 +6,7 @@
 #include <lava/core/transform.hpp>
 #include <lava/magma/frustum.hpp>
 #include <lava/magma/polygon-mode.hpp>
+#include <lava/magma/readback.hpp>
 #include <lava/magma/render-image.hpp>
 #include <lava/magma/ubos.hpp>
 
@@ -44,6 +45,12 @@ namespace lava::magma {
         RenderImage renderImage() const;
         RenderImage depthRenderImage() const;
 
+        /**
+         * Copy the current render image to the CPU, without stalling.
+         * The callback is called during a later RenderEngine::update().
+         */
+        void readback(ReadbackCallback callback, const ReadbackOptions& options = {});
+
         /// How meshes should be renderered within this camera.
         PolygonMode polygonMode() const { return m_polygonMode; }
         void polygonMode(PolygonMode polygonMode);
@@ -58,6 +65,15 @@ namespace lava::magma {
         bool frustumCullingEnabled() const { return m_frustumCullingEnabled; }
         void frustumCullingEnabled(bool frustumCullingEnabled) { m_frustumCullingEnabled = frustumCullingEnabled; }
 
+        /**
+         * Whether meshes hidden behind others are not drawn.
+         * Only works along frustum culling, and without MSAA.
+         * This tests against the depth of a previous frame, so something appearing
+         * from behind an occluder might pop in a few frames late.
+         */
+        bool occlusionCullingEnabled() const { return m_occlusionCullingEnabled; }
+        void occlusionCullingEnabled(bool occlusionCullingEnabled) { m_occlusionCullingEnabled = occlusionCullingEnabled; }
+
         /**
          * Whether the camera is used to render in a VR render target.
          * When true, meshes tagged as non-vrRenderable will not be displayed.
@@ -138,6 +154,7 @@ namespace lava::magma {
         PolygonMode m_polygonMode = PolygonMode::Fill;
         Frustum m_frustum;
         bool m_frustumCullingEnabled = true;
+        bool m_occlusionCullingEnabled = false;
         bool m_vrAimed = false;
 
         // ----- Init-time configuration
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <lava/chamber/math/batch.hpp>
 #include <lava/core/bounding-sphere.hpp>
+#include <array>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
 namespace lava::magma {
     /**
@@ -33,5 +36,11 @@ namespace lava::magma {
 
         /// Checks if any part of the bounding sphere is inside the frustum.
         bool canSee(const BoundingSphere& boundingSphere) const;
+
+        /// Checks multiple bounding spheres at once, visibles[i] being 1 if the sphere i can be seen.
+        void canSee(const chamber::math::SpheresSoa& boundingSpheres, uint32_t count, uint8_t* visibles) const;
+
+        /// The six planes (n, d), each keeping points p such as dot(n, p) <= d.
+        std::array<glm::vec4, 6> planes() const;
     };
 }
@@ -4,6 +4,8 @@
 #include <lava/magma/render-image.hpp>
 #include <lava/magma/ubos.hpp>
 
+#include <array>
+
 namespace lava::magma {
     class LightAft;
     class Scene;
@@ -46,6 +48,13 @@ namespace lava::magma {
         /// Whether the light should cast dynamic shadows.
         bool shadowsEnabled() const { return m_shadowsEnabled; }
         void shadowsEnabled(bool shadowsEnabled) { m_shadowsEnabled = shadowsEnabled; }
+
+        /**
+         * How many frames between two refreshes of a shadows cascade, the first cascade being the closest to the camera.
+         * Far cascades can be refreshed less often, their shadows lagging behind what moves.
+         */
+        uint32_t shadowsCascadeRefreshPeriod(uint32_t cascadeIndex) const { return m_shadowsCascadesRefreshPeriods[cascadeIndex]; }
+        void shadowsCascadeRefreshPeriod(uint32_t cascadeIndex, uint32_t refreshPeriod);
         /// @}
 
         /**
@@ -68,5 +77,6 @@ namespace lava::magma {
         // ----- Rendering
         glm::vec3 m_shadowsDirection = glm::vec3(1, 0, 0);
         bool m_shadowsEnabled = false;
+        std::array<uint32_t, SHADOWS_CASCADES_COUNT> m_shadowsCascadesRefreshPeriods;
     };
 }
@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
+#include <lava/chamber/math/batch.hpp>
 #include <lava/core/bounding-sphere.hpp>
 #include <lava/core/macros/aft.hpp>
 #include <lava/core/render-category.hpp>
@@ -35,7 +36,7 @@ namespace lava::magma {
 
         /// Whether the mesh should be rendered.
         bool enabled() const { return m_enabled && (m_ubos.size() > 0u); }
-        void enabled(bool enabled) { m_enabled = enabled; }
+        void enabled(bool enabled);
 
         /**
          * @name Transform
@@ -84,6 +85,15 @@ namespace lava::magma {
             }
             return m_instancesInfos[instanceIndex].boundingSphere;
         }
+
+        /// World-space bounding spheres of all instances, as a structure of arrays for batch culling.
+        chamber::math::SpheresSoa instancesBoundingSpheres() {
+            if (m_boundingSphereDirty) {
+                updateBoundingSpheres();
+            }
+            return {m_instancesBoundingSpheresX.data(), m_instancesBoundingSpheresY.data(), m_instancesBoundingSpheresZ.data(),
+                    m_instancesBoundingSpheresRadius.data()};
+        }
         /// @}
 
         /**
@@ -116,10 +126,18 @@ namespace lava::magma {
 
         const std::vector<UnlitVertex>& unlitVertices() const { return m_unlitVertices; };
         const std::vector<Vertex>& vertices() const { return m_vertices; };
-        const std::vector<uint16_t>& indices() const { return m_indices; };
         std::vector<UnlitVertex>& unlitVertices() { return m_unlitVertices; };
         std::vector<Vertex>& vertices() { return m_vertices; };
-        std::vector<uint16_t>& indices() { return m_indices; };
+
+        /**
+         * Indices are stored on 16 bits, unless the vertices count requires 32 bits.
+         * Only one of indices16() and indices32() is filled, according to indicesWide().
+         */
+        bool indicesWide() const { return m_indicesWide; }
+        uint32_t indicesCount() const { return m_indicesWide ? m_indices32.size() : m_indices16.size(); }
+        uint32_t index(uint32_t i) const { return m_indicesWide ? m_indices32[i] : m_indices16[i]; }
+        const std::vector<uint16_t>& indices16() const { return m_indices16; };
+        const std::vector<uint32_t>& indices32() const { return m_indices32; };
 
         /// From current vertices positions, compute flat normals.
         void computeFlatNormals();
@@ -138,11 +156,15 @@ namespace lava::magma {
 
         /// Whether the mesh can cast shadows.
         bool shadowsCastable() const { return m_shadowsCastable; }
-        void shadowsCastable(bool shadowsCastable) { m_shadowsCastable = shadowsCastable; }
+        void shadowsCastable(bool shadowsCastable);
+
+        /// Whether the mesh is not expected to move, its shadows are then cached until it does.
+        bool shadowsStatic() const { return m_shadowsStatic; }
+        void shadowsStatic(bool shadowsStatic);
 
         /// Decides how to render the mesh.
         RenderCategory renderCategory() const { return m_renderCategory; }
-        void renderCategory(RenderCategory renderCategory) { m_renderCategory = renderCategory; }
+        void renderCategory(RenderCategory renderCategory);
 
         /// Whether the mesh should be rendered if the render target is a VR one.
         bool vrRenderable() const { return m_vrRenderable; }
@@ -167,6 +189,8 @@ namespace lava::magma {
         /// @}
 
     private:
+        void boundingSpheresChanged();
+        void staticShadowsChanged();
         void updateUbo(uint32_t instanceIndex);
         void updateTransform(uint32_t instanceIndex);
         void updateBoundingSpheres();
@@ -196,18 +220,26 @@ namespace lava::magma {
         // Geometry-space bounding box dimenstion which is centered at m_boundingSphereGeometry.center.
         glm::vec3 m_boundingBoxExtentGeometry;
         bool m_boundingSphereDirty = true;
+        // Copies of instances' bounding spheres, split per component.
+        std::vector<float> m_instancesBoundingSpheresX;
+        std::vector<float> m_instancesBoundingSpheresY;
+        std::vector<float> m_instancesBoundingSpheresZ;
+        std::vector<float> m_instancesBoundingSpheresRadius;
 
         // ----- Geometry
         std::vector<Vertex> m_temporaryVertices; // Only used for tangents generation.
         std::vector<UnlitVertex> m_unlitVertices;
         std::vector<Vertex> m_vertices;
-        std::vector<uint16_t> m_indices;
+        std::vector<uint16_t> m_indices16;
+        std::vector<uint32_t> m_indices32;
+        bool m_indicesWide = false;
 
         // ----- Material
         MaterialPtr m_material = nullptr;
         RenderCategory m_renderCategory = RenderCategory::Opaque;
         bool m_translucent = false;
         bool m_shadowsCastable = true;
+        bool m_shadowsStatic = false;
         bool m_vrRenderable = true;
 
         // ----- Shader data
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <lava/core/extent.hpp>
+
+namespace lava::magma {
+    /**
+     * What part of a rendered image to read back.
+     */
+    struct ReadbackOptions {
+        /// Top-left corner of the region, in pixels.
+        uint32_t x = 0u;
+        uint32_t y = 0u;
+
+        /// Size of the region, in pixels. Zero means up to the image's border.
+        Extent2d extent = {0u, 0u};
+
+        /// The region is shrunk by this factor on the GPU, before being read.
+        uint32_t downscale = 1u;
+    };
+
+    /**
+     * Pixels read back, as RGBA with 8 bits per channel, rows being tightly packed.
+     *
+     * @note The data is only valid during the callback, copy it to keep it.
+     */
+    struct ReadbackPixels {
+        const uint8_t* data = nullptr;
+        Extent2d extent = {0u, 0u};
+    };
+
+    /**
+     * Called during a later RenderEngine::update(), once the GPU is done copying.
+     *
+     * When the read could not happen, like when the target is destroyed before, pixels.data is nullptr.
+     */
+    using ReadbackCallback = std::function<void(const ReadbackPixels& pixels)>;
+}
@@ -102,6 +102,14 @@ namespace lava::magma {
         const VrEngine& vr() const { return m_vrEngine; }
         /// @}
 
+        /**
+         * How many frames the GPU can be late, between 1 and 2 (default).
+         * With 1, each frame waits for the previous one to be done,
+         * which lowers latency but leaves the CPU idle meanwhile.
+         */
+        uint32_t framesInFlightCount() const;
+        void framesInFlightCount(uint32_t framesInFlightCount);
+
         /// Enable extra logging for next draw.
         void logTrackingOnce();
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <lava/magma/readback.hpp>
 #include <lava/magma/render-targets/i-render-target.hpp>
 
 #include <lava/core/extent.hpp>
@@ -30,6 +31,12 @@ namespace lava::magma {
         Extent2d extent() const;
         void extent(const Extent2d& extent);
 
+        /**
+         * Copy what is presented next to the CPU, without stalling.
+         * The callback is called during a later RenderEngine::update().
+         */
+        void readback(ReadbackCallback callback, const ReadbackOptions& options = {});
+
         // Getters
         WsHandle handle() const;
 
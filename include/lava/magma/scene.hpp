@@ -3,6 +3,7 @@
 #include <lava/chamber/bucket-allocator.hpp>
 #include <lava/core/extent.hpp>
 #include <lava/core/macros/aft.hpp>
+#include <lava/magma/bvh.hpp>
 #include <lava/magma/msaa.hpp>
 #include <lava/magma/renderer-type.hpp>
 
@@ -116,6 +117,27 @@ namespace lava::magma {
         const std::vector<Flat*>& flats() const { return m_flats; }
         /// @}
 
+        /**
+         * @name Spatial queries
+         *
+         * Meshes are indexed by their bounding spheres, in a hierarchy refitted during each update.
+         * Depthless meshes are kept apart, as they are always rendered around the camera.
+         */
+        /// @{
+        const Bvh& meshesBvh() const { return m_meshesBvh; }
+        const std::vector<Mesh*>& depthlessMeshes() const { return m_depthlessMeshes; }
+
+        /// Refit the hierarchy with the meshes that changed since the last call.
+        void updateMeshesBvh();
+
+        /// Called by meshes when their bounding sphere or their render category changed.
+        void meshChanged(Mesh& mesh) { m_changedMeshes.emplace_back(&mesh); }
+
+        /// Increased each time a static shadows caster changes, so that cached shadow maps know they are outdated.
+        uint32_t staticShadowsVersion() const { return m_staticShadowsVersion; }
+        void staticShadowsChanged() { m_staticShadowsVersion += 1u; }
+        /// @}
+
         /**
          * @name Environment
          */
@@ -176,6 +198,13 @@ namespace lava::magma {
         std::vector<Material*> m_materials;
         std::vector<Mesh*> m_meshes;
         std::vector<Flat*> m_flats;
+
+        // ----- Spatial queries
+        Bvh m_meshesBvh;
+        std::unordered_map<const Mesh*, uint32_t> m_meshesBvhLeaves; // Bvh::NULL_NODE for depthless meshes.
+        std::vector<Mesh*> m_depthlessMeshes;
+        std::vector<Mesh*> m_changedMeshes;
+        uint32_t m_staticShadowsVersion = 0u;
     };
 }
 
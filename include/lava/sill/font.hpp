@@ -63,6 +63,9 @@ namespace lava::sill {
         // the xOffset being updated accordingly.
         std::vector<GlyphInfo> glyphsInfos(u8string_view u8Text, bool skipBlank = true);
 
+        // Same as above, but filling the provided list, so that its capacity is reused.
+        void glyphsInfos(u8string_view u8Text, std::vector<GlyphInfo>& glyphsInfos, bool skipBlank = true);
+
         // Get the glyphInfo corresponding to the provided byteIndex.
         // The relative xOffset and such are now absolute.
         GlyphInfo glyphInfoAtByte(u8string_view u8Text, uint32_t byteIndex);
@@ -86,6 +89,10 @@ namespace lava::sill {
         uint32_t m_textureHeight = 0u;
         uint32_t m_nextGlyphStartPosition = 1u; //< Next empty position within texture.
 
+        // Decoding scratch, kept to not reallocate for each text.
+        std::vector<uint32_t> m_codepoints;
+        std::vector<uint32_t> m_byteOffsets;
+
         // Low-level font info.
         std::vector<std::unique_ptr<FontInfo>> m_fontInfos;
 
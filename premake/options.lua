@@ -23,3 +23,4 @@ end
 -- Add command-line options
 setOption("windowingSystem", _OPTIONS["windowing-system"])
 setOption("audioSystem", _OPTIONS["audio-system"])
+setOption("profiler", _OPTIONS["profiler"])
@@ -54,6 +54,15 @@ workspace "lava-renderer"
     -- Includes
 
     include "premake"
+
+    -- Profiling (options are known only once premake/ is included)
+
+    if options.profiler == "on" then
+        defines { "PROFILE_ENABLED" }
+    end
+
     include "external"
     include "source"
     include "examples"
+    include "benchmarks"
+    include "tests"
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+# Generates data/benchmarks/cubes.glb, used by the sill.glb-mesh.cubes benchmark.
+# A 4x4x4 grid of nodes, 2 units apart, all sharing the same unit cube mesh.
+#
+# Usage: ./scripts/benchmarks/generate-cubes-glb.py [output.glb]
+
+import json
+import struct
+import sys
+
+GRID_SIZE = 4
+SPACING = 2.0
+
+# One face per axis direction: normal, then its 4 corners counter-clockwise seen from outside.
+FACES = [
+    ((1, 0, 0), [(1, -1, -1), (1, 1, -1), (1, 1, 1), (1, -1, 1)]),
+    ((-1, 0, 0), [(-1, -1, -1), (-1, -1, 1), (-1, 1, 1), (-1, 1, -1)]),
+    ((0, 1, 0), [(-1, 1, -1), (-1, 1, 1), (1, 1, 1), (1, 1, -1)]),
+    ((0, -1, 0), [(-1, -1, -1), (1, -1, -1), (1, -1, 1), (-1, -1, 1)]),
+    ((0, 0, 1), [(-1, -1, 1), (1, -1, 1), (1, 1, 1), (-1, 1, 1)]),
+    ((0, 0, -1), [(-1, -1, -1), (-1, 1, -1), (1, 1, -1), (1, -1, -1)]),
+]
+UVS = [(0, 0), (1, 0), (1, 1), (0, 1)]
+
+
+def pad(data, byte):
+    return data + byte * ((4 - len(data) % 4) % 4)
+
+
+def cube_buffers():
+    positions, normals, uvs, indices = [], [], [], []
+    for normal, corners in FACES:
+        first = len(positions)
+        for corner, uv in zip(corners, UVS):
+            positions.append([0.5 * c for c in corner])
+            normals.append(normal)
+            uvs.append(uv)
+        indices += [first, first + 1, first + 2, first, first + 2, first + 3]
+
+    def floats(vectors):
+        return b"".join(struct.pack("<%df" % len(v), *v) for v in vectors)
+
+    return [floats(positions), floats(normals), floats(uvs), struct.pack("<%dH" % len(indices), *indices)], len(positions), len(indices)
+
+
+def main():
+    output_path = sys.argv[1] if len(sys.argv) > 1 else "./data/benchmarks/cubes.glb"
+
+    buffers, vertices_count, indices_count = cube_buffers()
+
+    buffer_views = []
+    offset = 0
+    for buffer in buffers:
+        buffer_views.append({"buffer": 0, "byteOffset": offset, "byteLength": len(buffer)})
+        offset += len(buffer)
+    binary = b"".join(buffers)
+
+    nodes = [{"name": "cubes", "children": list(range(1, GRID_SIZE ** 3 + 1))}]
+    for x in range(GRID_SIZE):
+        for y in range(GRID_SIZE):
+            for z in range(GRID_SIZE):
+                nodes.append({"name": "cube-%d-%d-%d" % (x, y, z), "mesh": 0,
+                              "translation": [x * SPACING, y * SPACING, z * SPACING]})
+
+    document = {
+        "asset": {"version": "2.0"},
+        "scene": 0,
+        "scenes": [{"nodes": [0]}],
+        "nodes": nodes,
+        "meshes": [{"name": "cube", "primitives": [{
+            "attributes": {"POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2},
+            "indices": 3, "material": 0, "mode": 4}]}],
+        "materials": [{"name": "grey", "pbrMetallicRoughness": {
+            "baseColorFactor": [0.8, 0.8, 0.8, 1.0], "metallicFactor": 0.0, "roughnessFactor": 0.5}}],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": vertices_count, "type": "VEC3",
+             "min": [-0.5, -0.5, -0.5], "max": [0.5, 0.5, 0.5]},
+            {"bufferView": 1, "componentType": 5126, "count": vertices_count, "type": "VEC3"},
+            {"bufferView": 2, "componentType": 5126, "count": vertices_count, "type": "VEC2"},
+            {"bufferView": 3, "componentType": 5123, "count": indices_count, "type": "SCALAR"},
+        ],
+        "bufferViews": buffer_views,
+        "buffers": [{"byteLength": len(binary)}],
+    }
+
+    json_chunk = pad(json.dumps(document, separators=(",", ":")).encode(), b" ")
+    binary_chunk = pad(binary, b"\0")
+    length = 12 + 8 + len(json_chunk) + 8 + len(binary_chunk)
+
+    with open(output_path, "wb") as file:
+        file.write(struct.pack("<4sII", b"glTF", 2, length))
+        file.write(struct.pack("<I4s", len(json_chunk), b"JSON") + json_chunk)
+        file.write(struct.pack("<I4s", len(binary_chunk), b"BIN\0") + binary_chunk)
+
+
+if __name__ == "__main__":
+    main()
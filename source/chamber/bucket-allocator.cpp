@@ -0,0 +1,163 @@
+#include <lava/chamber/bucket-allocator.hpp>
+
+using namespace lava::chamber;
+
+namespace {
+    // Each slot starts with the address of its bucket, padded to keep the alignment.
+    constexpr const size_t SLOT_PREFIX_SIZE = BucketAllocator::SLOT_ALIGNMENT;
+
+    size_t alignedSize(size_t size)
+    {
+        return (size + BucketAllocator::SLOT_ALIGNMENT - 1u) & ~(BucketAllocator::SLOT_ALIGNMENT - 1u);
+    }
+}
+
+BucketAllocator::Stats BucketAllocator::stats() const
+{
+    Stats stats;
+    stats.sizeClassesCount = m_sizeClasses.size();
+    for (const auto& sizeClass : m_sizeClasses) {
+        stats.bucketsCount += sizeClass->buckets.size();
+        stats.slotsCount += sizeClass->buckets.size() * SLOTS_PER_BUCKET;
+        stats.allocationsCount += sizeClass->allocationsCount;
+        stats.reservedBytes += sizeClass->buckets.size() * SLOTS_PER_BUCKET * sizeClass->slotSize;
+        stats.usedBytes += sizeClass->allocationsCount * sizeClass->slotSize;
+    }
+    return stats;
+}
+
+// ----- Internal
+
+void* BucketAllocator::allocateRaw(size_t allocationSize)
+{
+    auto& sizeClass = findSizeClass(SLOT_PREFIX_SIZE + alignedSize(allocationSize));
+
+    // Reusing a bucket that has some space left, the first one being the last freed into.
+    auto bucket = sizeClass.availableBuckets;
+    if (bucket == nullptr) {
+        bucket = &addBucket(sizeClass);
+    }
+
+    uint8_t* slot = nullptr;
+    if (bucket->freeList != nullptr) {
+        slot = reinterpret_cast<uint8_t*>(bucket->freeList);
+        bucket->freeList = *reinterpret_cast<void**>(slot + SLOT_PREFIX_SIZE);
+    }
+    else {
+        slot = bucket->data.get() + bucket->untouchedSlotIndex * sizeClass.slotSize;
+        bucket->untouchedSlotIndex += 1u;
+    }
+
+    bucket->allocationsCount += 1u;
+    sizeClass.allocationsCount += 1u;
+
+    if (bucket->allocationsCount == SLOTS_PER_BUCKET) {
+        unlinkAvailable(*bucket);
+    }
+
+    *reinterpret_cast<Bucket**>(slot) = bucket;
+    return slot + SLOT_PREFIX_SIZE;
+}
+
+void BucketAllocator::deallocateRaw(void* pointer)
+{
+    auto slot = reinterpret_cast<uint8_t*>(pointer) - SLOT_PREFIX_SIZE;
+    auto bucket = *reinterpret_cast<Bucket**>(slot);
+
+    // Deallocating something not allocated by us!
+    if (bucket == nullptr || bucket->sizeClass == nullptr) {
+        assert(false);
+        return;
+    }
+
+    auto& sizeClass = *bucket->sizeClass;
+    *reinterpret_cast<Bucket**>(slot) = nullptr;
+    *reinterpret_cast<void**>(pointer) = bucket->freeList;
+    bucket->freeList = slot;
+
+    if (bucket->allocationsCount == SLOTS_PER_BUCKET) {
+        linkAvailable(*bucket);
+    }
+
+    bucket->allocationsCount -= 1u;
+    sizeClass.allocationsCount -= 1u;
+
+    // Keeping the last bucket, so that one allocating/deallocating in loop does not thrash.
+    if (bucket->allocationsCount == 0u && sizeClass.buckets.size() > 1u) {
+        removeBucket(*bucket);
+    }
+}
+
+BucketAllocator::SizeClass& BucketAllocator::findSizeClass(size_t slotSize)
+{
+    // There is usually one size class per allocator.
+    if (m_lastSizeClass != nullptr && m_lastSizeClass->slotSize == slotSize) {
+        return *m_lastSizeClass;
+    }
+
+    for (auto& sizeClass : m_sizeClasses) {
+        if (sizeClass->slotSize == slotSize) {
+            m_lastSizeClass = sizeClass.get();
+            return *sizeClass;
+        }
+    }
+
+    auto& sizeClass = m_sizeClasses.emplace_back(std::make_unique<SizeClass>());
+    sizeClass->slotSize = slotSize;
+    m_lastSizeClass = sizeClass.get();
+    return *sizeClass;
+}
+
+BucketAllocator::Bucket& BucketAllocator::addBucket(SizeClass& sizeClass)
+{
+    auto& bucket = sizeClass.buckets.emplace_back(std::make_unique<Bucket>());
+    bucket->sizeClass = &sizeClass;
+    bucket->data = std::make_unique<uint8_t[]>(SLOTS_PER_BUCKET * sizeClass.slotSize);
+
+    linkAvailable(*bucket);
+    return *bucket;
+}
+
+void BucketAllocator::removeBucket(Bucket& bucket)
+{
+    unlinkAvailable(bucket);
+
+    auto& buckets = bucket.sizeClass->buckets;
+    for (auto iBucket = buckets.begin(); iBucket != buckets.end(); ++iBucket) {
+        if (iBucket->get() == &bucket) {
+            buckets.erase(iBucket);
+            break;
+        }
+    }
+}
+
+void BucketAllocator::linkAvailable(Bucket& bucket)
+{
+    auto& sizeClass = *bucket.sizeClass;
+
+    bucket.previousAvailable = nullptr;
+    bucket.nextAvailable = sizeClass.availableBuckets;
+    if (sizeClass.availableBuckets != nullptr) {
+        sizeClass.availableBuckets->previousAvailable = &bucket;
+    }
+    sizeClass.availableBuckets = &bucket;
+}
+
+void BucketAllocator::unlinkAvailable(Bucket& bucket)
+{
+    auto& sizeClass = *bucket.sizeClass;
+
+    if (bucket.previousAvailable != nullptr) {
+        bucket.previousAvailable->nextAvailable = bucket.nextAvailable;
+    }
+    else if (sizeClass.availableBuckets == &bucket) {
+        sizeClass.availableBuckets = bucket.nextAvailable;
+    }
+
+    if (bucket.nextAvailable != nullptr) {
+        bucket.nextAvailable->previousAvailable = bucket.previousAvailable;
+    }
+
+    bucket.previousAvailable = nullptr;
+    bucket.nextAvailable = nullptr;
+}
@@ -0,0 +1,58 @@
+#include "./file-watch-coalescer.hpp"
+
+using namespace lava::chamber;
+
+namespace {
+    using Type = FileWatchEvent::Type;
+}
+
+void FileWatchCoalescer::add(FileWatchEvent&& event, Clock::time_point now)
+{
+    const auto deadline = now + delay();
+    auto key = event.path.string();
+    auto pendingIndexIt = m_pendingIndices.find(key);
+
+    if (pendingIndexIt == m_pendingIndices.end()) {
+        m_pendingIndices[key] = m_pendingEvents.size();
+        m_pendingEvents.emplace_back(PendingEvent{std::move(event), false, deadline});
+        return;
+    }
+
+    auto& pendingEvent = m_pendingEvents[pendingIndexIt->second];
+    pendingEvent.deadline = deadline;
+
+    if (pendingEvent.cancelled) {
+        pendingEvent.cancelled = false;
+        pendingEvent.event.type = event.type;
+    }
+    else if (pendingEvent.event.type == Type::Created) {
+        // Modified after creation is still a creation.
+        pendingEvent.cancelled = (event.type == Type::Deleted);
+    }
+    else {
+        pendingEvent.event.type = (event.type == Type::Deleted) ? Type::Deleted : Type::Modified;
+    }
+}
+
+std::optional<FileWatchEvent> FileWatchCoalescer::pop(Clock::time_point now)
+{
+    for (auto i = 0u; i < m_pendingEvents.size(); ++i) {
+        if (m_pendingEvents[i].deadline > now) continue;
+
+        auto pendingEvent = std::move(m_pendingEvents[i]);
+        m_pendingEvents.erase(m_pendingEvents.begin() + i);
+        m_pendingIndices.erase(pendingEvent.event.path.string());
+        for (auto j = i; j < m_pendingEvents.size(); ++j) {
+            m_pendingIndices[m_pendingEvents[j].event.path.string()] = j;
+        }
+
+        if (pendingEvent.cancelled) {
+            --i;
+            continue;
+        }
+
+        return std::move(pendingEvent.event);
+    }
+
+    return std::nullopt;
+}
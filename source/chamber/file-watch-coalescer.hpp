@@ -0,0 +1,50 @@
+#pragma once
+
+#include <lava/chamber/file-watch-event.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace lava::chamber {
+    /**
+     * Merges bursts of events happening on the same path.
+     *
+     * An event is released only once its path has been quiet for the coalescing delay,
+     * so that an editor saving a file in multiple steps generates one event.
+     * Successive types are merged: Created then Modified is Created,
+     * Deleted then Created is Modified, Created then Deleted is nothing.
+     *
+     * Only the delay can be changed from any thread, events belong to the consumer one.
+     */
+    class FileWatchCoalescer {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /// Register a raw event, received at the specified time.
+        void add(FileWatchEvent&& event, Clock::time_point now);
+
+        /// Grab the next event that has been quiet long enough, if any.
+        std::optional<FileWatchEvent> pop(Clock::time_point now);
+
+        /// How long a path should be quiet for its event to be released.
+        Clock::duration delay() const { return m_delay.load(std::memory_order_relaxed); }
+        void delay(Clock::duration delay) { m_delay.store(delay, std::memory_order_relaxed); }
+
+    private:
+        struct PendingEvent {
+            FileWatchEvent event;
+            bool cancelled = false; //!< Created then deleted, nothing to report.
+            Clock::time_point deadline;
+        };
+
+    private:
+        std::atomic<Clock::duration> m_delay = Clock::duration(std::chrono::milliseconds(50));
+
+        // Events are kept in arrival order, the map giving the index of the path.
+        std::vector<PendingEvent> m_pendingEvents;
+        std::unordered_map<std::string, uint32_t> m_pendingIndices;
+    };
+}
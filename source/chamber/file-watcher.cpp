@@ -12,7 +12,8 @@ using namespace lava::chamber;
 
 $pimpl_class(FileWatcher);
 
-$pimpl_method(FileWatcher, uint32_t, watch, const fs::Path&, path);
+$pimpl_method(FileWatcher, uint32_t, watch, const fs::Path&, path, bool, recursive);
+$pimpl_method(FileWatcher, void, coalescingDelay, std::chrono::milliseconds, delay);
 
 std::optional<FileWatchEvent> FileWatcher::pollEvent()
 {
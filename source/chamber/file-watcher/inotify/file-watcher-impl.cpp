@@ -1,102 +1,195 @@
 #include "./file-watcher-impl.hpp"
 
-#include <fcntl.h>
 #include <lava/chamber/logger.hpp>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
 #include <unistd.h>
 
-using namespace lava;
+using namespace lava::chamber;
 
 namespace {
-    void waitEvents(int fileDescriptor, const std::atomic<bool>* watching,
-                    const std::unordered_map<int, fs::Path>* watchDescriptors, std::queue<chamber::FileWatchEvent>* eventsQueue)
-    {
-        constexpr const auto eventBufferSize = sizeof(inotify_event) + 512u + 1u;
-        static char buffer[eventBufferSize];
+    // @todo Let the user configure the mask
+    constexpr const uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO;
 
-        while (*watching) {
-            const auto length = read(fileDescriptor, buffer, eventBufferSize);
-            if (!length || !*watching) break;
-            auto& iEvent = *reinterpret_cast<inotify_event*>(buffer);
+    // Enough for a lot of events, inotify never splits one across reads.
+    constexpr const auto EVENTS_BUFFER_SIZE = 16u * 1024u;
+}
 
-            chamber::FileWatchEvent event;
-            event.path = watchDescriptors->at(iEvent.wd);
-            event.watchId = iEvent.wd;
+FileWatcher::Impl::Impl()
+{
+    m_inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    m_stopDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 
-            if (iEvent.len) event.path /= iEvent.name;
+    if (m_inotifyDescriptor == -1 || m_epollDescriptor == -1 || m_stopDescriptor == -1) {
+        logger.warning("chamber.file-watcher") << "Unable to initialize inotify, no file will be watched." << std::endl;
+        return;
+    }
 
-            switch (iEvent.mask) {
-            case IN_ACCESS: continue;
-            case IN_ATTRIB: continue;
-            case IN_CLOSE_WRITE: continue;
-            case IN_CLOSE_NOWRITE: continue;
-            case IN_CREATE: event.type = chamber::FileWatchEvent::Type::Created; break;
-            case IN_DELETE: event.type = chamber::FileWatchEvent::Type::Deleted; break;
-            case IN_DELETE_SELF: event.type = chamber::FileWatchEvent::Type::Deleted; break;
-            case IN_MODIFY: event.type = chamber::FileWatchEvent::Type::Modified; break;
-            case IN_MOVE_SELF: event.type = chamber::FileWatchEvent::Type::Created; break;
-            case IN_MOVED_FROM: event.type = chamber::FileWatchEvent::Type::Deleted; break;
-            case IN_MOVED_TO: event.type = chamber::FileWatchEvent::Type::Created; break;
-            case IN_OPEN: continue;
-            default: continue;
-            }
+    epoll_event epollEvent = {};
+    epollEvent.events = EPOLLIN;
+    epollEvent.data.fd = m_inotifyDescriptor;
+    epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, m_inotifyDescriptor, &epollEvent);
+    epollEvent.data.fd = m_stopDescriptor;
+    epoll_ctl(m_epollDescriptor, EPOLL_CTL_ADD, m_stopDescriptor, &epollEvent);
 
-            eventsQueue->emplace(event);
-        }
-    }
+    m_watchThread = std::thread(&FileWatcher::Impl::run, this);
 }
 
-using namespace lava::chamber;
-
-FileWatcher::Impl::Impl()
-    // @todo Let the user configure the mask
-    : m_mask(IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO)
-    , m_fileDescriptor(inotify_init())
-    , m_watchThread(waitEvents, m_fileDescriptor, &m_watching, &m_watchDescriptors, &m_eventsQueue)
+FileWatcher::Impl::~Impl()
 {
+    if (m_watchThread.joinable()) {
+        uint64_t stop = 1u;
+        [[maybe_unused]] auto written = write(m_stopDescriptor, &stop, sizeof(stop));
+        m_watchThread.join();
+    }
+
+    // @note Closing the inotify descriptor removes all its watches.
+    for (auto descriptor : {m_inotifyDescriptor, m_epollDescriptor, m_stopDescriptor}) {
+        if (descriptor != -1) close(descriptor);
+    }
 }
 
-FileWatcher::Impl::~Impl()
+uint32_t FileWatcher::Impl::watch(const fs::Path& path, bool recursive)
 {
-    m_watching = false;
+    std::error_code errorCode;
+    auto effectivePath = std::filesystem::canonical(path, errorCode);
+
+    uint32_t watchId = -1u;
+    if (!errorCode && m_inotifyDescriptor != -1) {
+        std::scoped_lock lock(m_watchesMutex);
+        watchId = addWatches(effectivePath, m_nextWatchId, recursive, true);
+        if (watchId == m_nextWatchId) m_nextWatchId += 1u;
+    }
 
-    for (const auto& watchDescriptor : m_watchDescriptors) {
-        inotify_rm_watch(m_fileDescriptor, watchDescriptor.first);
+    if (watchId == -1u) {
+        logger.warning("chamber.file-watcher") << "Unable to watch " << path << "." << std::endl;
     }
 
-    // @note To break the blocking read from waitEvents(),
-    // we access /dev/null right here - generating an event.
-    auto watchDescriptor = inotify_add_watch(m_fileDescriptor, "/dev/null", IN_ALL_EVENTS);
-    std::ifstream file("/dev/null");
-    file.close();
-    m_watchThread.join();
-    inotify_rm_watch(m_fileDescriptor, watchDescriptor);
+    return watchId;
+}
 
-    close(m_fileDescriptor);
+void FileWatcher::Impl::coalescingDelay(std::chrono::milliseconds delay)
+{
+    m_coalescer.delay(delay);
 }
 
-uint32_t FileWatcher::Impl::watch(const fs::Path& path)
+std::optional<FileWatchEvent> FileWatcher::Impl::popEvent()
 {
-    auto effectivePath = fs::canonical(path);
+    while (auto rawEvent = m_rawEvents.pop()) {
+        m_coalescer.add(std::move(rawEvent->event), rawEvent->time);
+    }
 
-    // @note Can't make that descriptor non-blocking using fcntl for some reason.
-    // This led us to us a thread.
-    auto watchDescriptor = inotify_add_watch(m_fileDescriptor, effectivePath.c_str(), m_mask);
+    return m_coalescer.pop(FileWatchCoalescer::Clock::now());
+}
 
-    if (watchDescriptor == -1) {
-        logger.warning("chamber.file-watcher") << "Unable to watch " << path << "." << std::endl;
-        return -1u;
+// ----- Internal
+
+void FileWatcher::Impl::run()
+{
+    epoll_event epollEvents[2];
+
+    while (true) {
+        auto count = epoll_wait(m_epollDescriptor, epollEvents, 2, -1);
+        if (count == -1) {
+            if (errno == EINTR) continue;
+            logger.warning("chamber.file-watcher") << "Waiting for events failed, stopping." << std::endl;
+            return;
+        }
+
+        for (auto i = 0; i < count; ++i) {
+            if (epollEvents[i].data.fd == m_stopDescriptor) return;
+            readEvents();
+        }
     }
+}
+
+void FileWatcher::Impl::readEvents()
+{
+    alignas(inotify_event) char buffer[EVENTS_BUFFER_SIZE];
+
+    // Non-blocking descriptor, reading until nothing is left.
+    while (true) {
+        const auto length = read(m_inotifyDescriptor, buffer, EVENTS_BUFFER_SIZE);
+        if (length <= 0) break;
+
+        const auto time = FileWatchCoalescer::Clock::now();
+        std::scoped_lock lock(m_watchesMutex);
+
+        for (auto offset = 0l; offset < length;) {
+            const auto& iEvent = *reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + iEvent.len;
 
-    m_watchDescriptors[watchDescriptor] = effectivePath;
-    return watchDescriptor;
+            if (iEvent.mask & IN_Q_OVERFLOW) {
+                logger.warning("chamber.file-watcher") << "Events queue overflowed, some changes were lost." << std::endl;
+                continue;
+            }
+
+            auto watchIt = m_watches.find(iEvent.wd);
+            if (watchIt == m_watches.end()) continue;
+
+            // Watch removed by the system (its path has been deleted).
+            if (iEvent.mask & IN_IGNORED) {
+                m_watches.erase(watchIt);
+                continue;
+            }
+
+            // @note Copied, adding watches below might invalidate the reference.
+            const auto watchInfo = watchIt->second;
+
+            FileWatchEvent event;
+            event.path = watchInfo.path;
+            event.watchId = watchInfo.watchId;
+            if (iEvent.len) event.path /= iEvent.name;
+
+            if (iEvent.mask & (IN_CREATE | IN_MOVED_TO)) {
+                event.type = FileWatchEvent::Type::Created;
+                if ((iEvent.mask & IN_ISDIR) && watchInfo.recursive) {
+                    addWatches(event.path, watchInfo.watchId, true, false);
+                }
+            }
+            else if (iEvent.mask & (IN_DELETE | IN_MOVED_FROM)) {
+                event.type = FileWatchEvent::Type::Deleted;
+            }
+            else if (iEvent.mask & IN_DELETE_SELF) {
+                // Sub-directories deletion has already been reported by their parent.
+                if (!watchInfo.root) continue;
+                event.type = FileWatchEvent::Type::Deleted;
+            }
+            else if (iEvent.mask & IN_MODIFY) {
+                event.type = FileWatchEvent::Type::Modified;
+            }
+            else {
+                continue;
+            }
+
+            m_rawEvents.push(RawEvent{std::move(event), time});
+        }
+    }
 }
 
-std::optional<FileWatchEvent> FileWatcher::Impl::popEvent()
+uint32_t FileWatcher::Impl::addWatches(const fs::Path& path, uint32_t watchId, bool recursive, bool root)
 {
-    if (m_eventsQueue.empty()) return std::nullopt;
+    auto watchDescriptor = inotify_add_watch(m_inotifyDescriptor, path.c_str(), WATCH_MASK);
+    if (watchDescriptor == -1) return -1u;
+
+    // Watching an already watched path gives back the same descriptor.
+    auto [watchIt, inserted] = m_watches.try_emplace(watchDescriptor, WatchInfo{path, watchId, recursive, root});
+    if (!inserted) {
+        watchIt->second.recursive |= recursive;
+        watchIt->second.root |= root;
+        watchId = watchIt->second.watchId;
+    }
+
+    if (!recursive) return watchId;
+
+    // @note Symbolic links are not followed, to prevent cycles.
+    std::error_code errorCode;
+    for (const auto& entry : std::filesystem::directory_iterator(path, errorCode)) {
+        if (entry.is_symlink(errorCode) || !entry.is_directory(errorCode)) continue;
+        addWatches(entry.path(), watchId, true, false);
+    }
 
-    auto event = m_eventsQueue.front();
-    m_eventsQueue.pop();
-    return event;
+    return watchId;
 }
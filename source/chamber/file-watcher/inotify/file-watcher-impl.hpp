@@ -2,25 +2,61 @@
 
 #include <lava/chamber/file-watcher.hpp>
 
+#include "../../file-watch-coalescer.hpp"
+#include "../../mpsc-queue.hpp"
+
+#include <mutex>
+
 namespace lava::chamber {
-    /// Inotify implementation of the FileWatcher.
+    /**
+     * Inotify implementation of the FileWatcher.
+     *
+     * A background thread waits on epoll for either inotify events or the stop signal,
+     * decodes whole batches and hands raw events to the consumer through a lock-free queue.
+     */
     class FileWatcher::Impl {
     public:
         Impl();
         ~Impl();
 
         // FileWatcher
-        uint32_t watch(const fs::Path& path);
+        uint32_t watch(const fs::Path& path, bool recursive);
+        void coalescingDelay(std::chrono::milliseconds delay);
         std::optional<FileWatchEvent> popEvent();
 
+    protected:
+        void run();
+        void readEvents();
+
+        // Add inotify watches, returns the effective watch Id or -1u. Watches mutex should be locked.
+        uint32_t addWatches(const fs::Path& path, uint32_t watchId, bool recursive, bool root);
+
     private:
-        uint32_t m_mask;
-        int m_fileDescriptor = -1;
-        std::unordered_map<int, fs::Path> m_watchDescriptors;
-        std::queue<FileWatchEvent> m_eventsQueue;
+        struct WatchInfo {
+            fs::Path path;
+            uint32_t watchId = -1u;
+            bool recursive = false;
+            bool root = false; //!< Not a sub-directory of a recursive watch.
+        };
+
+        struct RawEvent {
+            FileWatchEvent event;
+            FileWatchCoalescer::Clock::time_point time;
+        };
+
+    private:
+        int m_inotifyDescriptor = -1;
+        int m_epollDescriptor = -1;
+        int m_stopDescriptor = -1;
+
+        std::mutex m_watchesMutex;
+        std::unordered_map<int, WatchInfo> m_watches;
+        uint32_t m_nextWatchId = 0u;
+
+        // Filled by the watch thread, consumed by popEvent().
+        MpscQueue<RawEvent> m_rawEvents;
+        FileWatchCoalescer m_coalescer;
 
-        // Thread
-        std::atomic<bool> m_watching{true};
         std::thread m_watchThread;
     };
 }
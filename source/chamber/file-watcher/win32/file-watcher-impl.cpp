@@ -2,7 +2,7 @@
 
 #include <lava/chamber/logger.hpp>
 
-using namespace lava;
+using namespace lava::chamber;
 
 namespace {
     static uint32_t sWatchId = 0u;
@@ -15,80 +15,10 @@ namespace {
                                                    // FILE_NOTIFY_CHANGE_CREATION | // Ignored (creation time)
                                                    // FILE_NOTIFY_CHANGE_SECURITY // Ignored
                                                    0x0;
-
-    void waitEvents(std::vector<chamber::WatchHandleInfo>* handlesInfos, const std::atomic<bool>* watching,
-                    std::queue<chamber::FileWatchEvent>* eventsQueue)
-    {
-        // @note All these bytes are for filenames and such
-        FILE_NOTIFY_INFORMATION fileNotifyInformations[1024];
-        std::vector<HANDLE> overlappedEvents;
-        std::vector<uint32_t> handleInfoIndexes;
-
-        while (*watching) {
-            if (!handlesInfos->size()) continue;
-
-            overlappedEvents.clear();
-            for (auto& handleInfo : *handlesInfos) {
-                ReadDirectoryChangesW(handleInfo.handle, &fileNotifyInformations, sizeof(fileNotifyInformations), true,
-                                      fileNotifyFilter, nullptr, &handleInfo.overlapped, nullptr);
-
-                overlappedEvents.emplace_back(handleInfo.overlapped.hEvent);
-            }
-
-            auto waitStatus = WaitForMultipleObjects(overlappedEvents.size(), overlappedEvents.data(), false, 200);
-            switch (waitStatus) {
-            case WAIT_ABANDONED: break;
-            case WAIT_TIMEOUT: break;
-            case WAIT_FAILED: break;
-            default: {
-                // If there is a next entry offset, there should have been more to do!
-                if (fileNotifyInformations[0].NextEntryOffset) {
-                    chamber::logger.warning("chamber.file-watcher") << "Might have lost some information..." << std::endl;
-                }
-
-                // @note FileName is not null terminated
-                auto fileName = fileNotifyInformations[0].FileName;
-                fs::Path path(fileName, fileName + fileNotifyInformations[0].FileNameLength / sizeof(fileName[0]));
-
-                const auto& handleInfo = handlesInfos->at(waitStatus - WAIT_OBJECT_0);
-                if (!handleInfo.directory) {
-                    // If watching a file, ignore other file change in this directory
-                    if (handleInfo.path.filename() != path) break;
-                    path = handleInfo.path;
-                }
-                else {
-                    path = handleInfo.path / path;
-                }
-
-                chamber::FileWatchEvent event;
-                event.path = path;
-                event.watchId = handleInfo.watchId;
-
-                switch (fileNotifyInformations[0].Action) {
-                case FILE_ACTION_ADDED: event.type = chamber::FileWatchEvent::Type::Created; break;
-                case FILE_ACTION_REMOVED: event.type = chamber::FileWatchEvent::Type::Deleted; break;
-                case FILE_ACTION_MODIFIED: event.type = chamber::FileWatchEvent::Type::Modified; break;
-                case FILE_ACTION_RENAMED_OLD_NAME: event.type = chamber::FileWatchEvent::Type::Deleted; break;
-                case FILE_ACTION_RENAMED_NEW_NAME: event.type = chamber::FileWatchEvent::Type::Created; break;
-                default: {
-                    chamber::logger.warning("chamber.file-watcher")
-                        << "File notify action is unknown: " << fileNotifyInformations[0].Action << "." << std::endl;
-                    continue;
-                }
-                }
-
-                eventsQueue->emplace(event);
-                break;
-            }
-            }
-        }
-    }
 }
 
-using namespace lava::chamber;
-
 FileWatcher::Impl::Impl()
-    : m_watchThread(waitEvents, &m_watchHandlesInfos, &m_watching, &m_eventsQueue)
+    : m_watchThread(&FileWatcher::Impl::run, this)
 {
 }
 
@@ -98,43 +28,147 @@ FileWatcher::Impl::~Impl()
     m_watchThread.join();
 
     for (const auto& handleInfo : m_watchHandlesInfos) {
-        FindCloseChangeNotification(handleInfo.handle);
+        CancelIo(handleInfo->handle);
+        CloseHandle(handleInfo->overlapped.hEvent);
+        CloseHandle(handleInfo->handle);
     }
 }
 
-uint32_t FileWatcher::Impl::watch(const fs::Path& path)
+uint32_t FileWatcher::Impl::watch(const fs::Path& path, bool recursive)
 {
-    WatchHandleInfo handleInfo;
+    std::error_code errorCode;
+    auto handleInfo = std::make_unique<WatchHandleInfo>();
 
-    handleInfo.path = fs::canonical(path);
-    handleInfo.directory = fs::isDirectory(handleInfo.path);
+    handleInfo->path = std::filesystem::canonical(path, errorCode);
+    handleInfo->directory = fs::isDirectory(handleInfo->path);
+    handleInfo->recursive = recursive && handleInfo->directory;
 
     // If watching a file, watch its directory...
-    auto watchedPath = handleInfo.directory ? handleInfo.path : handleInfo.path.parent_path();
-    handleInfo.handle = CreateFile(watchedPath.c_str(), GENERIC_READ | FILE_LIST_DIRECTORY,
-                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
-                                   FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    auto watchedPath = handleInfo->directory ? handleInfo->path : handleInfo->path.parent_path();
+    handleInfo->handle = errorCode ? INVALID_HANDLE_VALUE
+                                   : CreateFile(watchedPath.c_str(), GENERIC_READ | FILE_LIST_DIRECTORY,
+                                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                                                OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
 
-    if (handleInfo.handle == INVALID_HANDLE_VALUE) {
+    if (handleInfo->handle == INVALID_HANDLE_VALUE) {
         logger.warning("chamber.file-watcher") << "Unable to watch " << path << "." << std::endl;
         return -1u;
     }
 
     auto watchId = sWatchId++;
 
-    handleInfo.watchId = watchId;
-    handleInfo.overlapped.OffsetHigh = 0;
-    handleInfo.overlapped.hEvent = CreateEvent(nullptr, true, false, nullptr);
+    handleInfo->watchId = watchId;
+    handleInfo->overlapped = {};
+    handleInfo->overlapped.hEvent = CreateEvent(nullptr, true, false, nullptr);
 
-    m_watchHandlesInfos.emplace_back(handleInfo);
+    std::scoped_lock lock(m_watchHandlesMutex);
+    m_watchHandlesInfos.emplace_back(std::move(handleInfo));
     return watchId;
 }
 
+void FileWatcher::Impl::coalescingDelay(std::chrono::milliseconds delay)
+{
+    m_coalescer.delay(delay);
+}
+
 std::optional<FileWatchEvent> FileWatcher::Impl::popEvent()
 {
-    if (m_eventsQueue.empty()) return std::nullopt;
+    while (auto rawEvent = m_rawEvents.pop()) {
+        m_coalescer.add(std::move(rawEvent->event), rawEvent->time);
+    }
+
+    return m_coalescer.pop(FileWatchCoalescer::Clock::now());
+}
 
-    auto event = m_eventsQueue.front();
-    m_eventsQueue.pop();
-    return event;
+// ----- Internal
+
+void FileWatcher::Impl::run()
+{
+    std::vector<HANDLE> overlappedEvents;
+    std::vector<WatchHandleInfo*> handlesInfos;
+
+    while (m_watching) {
+        overlappedEvents.clear();
+        handlesInfos.clear();
+
+        {
+            std::scoped_lock lock(m_watchHandlesMutex);
+            for (auto& handleInfo : m_watchHandlesInfos) {
+                if (!handleInfo->pending) {
+                    handleInfo->pending = ReadDirectoryChangesW(
+                        handleInfo->handle, handleInfo->buffer.data(), handleInfo->buffer.size() * sizeof(DWORD),
+                        handleInfo->recursive, fileNotifyFilter, nullptr, &handleInfo->overlapped, nullptr);
+                }
+
+                overlappedEvents.emplace_back(handleInfo->overlapped.hEvent);
+                handlesInfos.emplace_back(handleInfo.get());
+            }
+        }
+
+        // @note Timing out regularly to check for new watches and stopping.
+        if (overlappedEvents.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            continue;
+        }
+
+        auto waitStatus = WaitForMultipleObjects(overlappedEvents.size(), overlappedEvents.data(), false, 200);
+        if (waitStatus < WAIT_OBJECT_0 || waitStatus >= WAIT_OBJECT_0 + overlappedEvents.size()) continue;
+
+        auto& handleInfo = *handlesInfos[waitStatus - WAIT_OBJECT_0];
+        handleInfo.pending = false;
+
+        DWORD bytesCount = 0u;
+        GetOverlappedResult(handleInfo.handle, &handleInfo.overlapped, &bytesCount, false);
+        ResetEvent(handleInfo.overlapped.hEvent);
+
+        // The buffer was too small to hold all changes.
+        if (bytesCount == 0u) {
+            logger.warning("chamber.file-watcher") << "Too many changes at once, some were lost." << std::endl;
+            continue;
+        }
+
+        const auto time = FileWatchCoalescer::Clock::now();
+        auto bytes = reinterpret_cast<const uint8_t*>(handleInfo.buffer.data());
+        while (true) {
+            const auto& fileNotifyInformation = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(bytes);
+
+            // @note FileName is not null terminated
+            auto fileName = fileNotifyInformation.FileName;
+            fs::Path path(fileName, fileName + fileNotifyInformation.FileNameLength / sizeof(fileName[0]));
+
+            auto ignored = false;
+            if (!handleInfo.directory) {
+                // If watching a file, ignore other file change in this directory
+                ignored = (handleInfo.path.filename() != path);
+                path = handleInfo.path;
+            }
+            else {
+                path = handleInfo.path / path;
+            }
+
+            FileWatchEvent event;
+            event.path = path;
+            event.watchId = handleInfo.watchId;
+
+            switch (fileNotifyInformation.Action) {
+            case FILE_ACTION_ADDED: event.type = FileWatchEvent::Type::Created; break;
+            case FILE_ACTION_REMOVED: event.type = FileWatchEvent::Type::Deleted; break;
+            case FILE_ACTION_MODIFIED: event.type = FileWatchEvent::Type::Modified; break;
+            case FILE_ACTION_RENAMED_OLD_NAME: event.type = FileWatchEvent::Type::Deleted; break;
+            case FILE_ACTION_RENAMED_NEW_NAME: event.type = FileWatchEvent::Type::Created; break;
+            default: {
+                logger.warning("chamber.file-watcher")
+                    << "File notify action is unknown: " << fileNotifyInformation.Action << "." << std::endl;
+                ignored = true;
+            }
+            }
+
+            if (!ignored) {
+                m_rawEvents.push(RawEvent{std::move(event), time});
+            }
+
+            if (fileNotifyInformation.NextEntryOffset == 0u) break;
+            bytes += fileNotifyInformation.NextEntryOffset;
+        }
+    }
 }
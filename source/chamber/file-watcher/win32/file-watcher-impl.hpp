@@ -3,6 +3,10 @@
 #include <lava/core/filesystem.hpp>
 #include <lava/chamber/file-watcher.hpp>
 
+#include "../../file-watch-coalescer.hpp"
+#include "../../mpsc-queue.hpp"
+
+#include <mutex>
 #include <windows.h>
 
 namespace lava::chamber {
@@ -10,8 +14,11 @@ namespace lava::chamber {
         fs::Path path;
         uint32_t watchId;
         bool directory = false;
+        bool recursive = false;
         HANDLE handle;
         OVERLAPPED overlapped;
+        bool pending = false; //!< Whether a ReadDirectoryChangesW is in flight.
+        std::vector<DWORD> buffer = std::vector<DWORD>(4096u); //!< DWORD-aligned, as required.
     };
 
     /// Win32 implementation of the FileWatcher.
@@ -21,12 +28,26 @@ namespace lava::chamber {
         ~Impl();
 
         // FileWatcher
-        uint32_t watch(const fs::Path& path);
+        uint32_t watch(const fs::Path& path, bool recursive);
+        void coalescingDelay(std::chrono::milliseconds delay);
         std::optional<FileWatchEvent> popEvent();
 
+    protected:
+        void run();
+
     private:
-        std::vector<WatchHandleInfo> m_watchHandlesInfos;
-        std::queue<FileWatchEvent> m_eventsQueue;
+        struct RawEvent {
+            FileWatchEvent event;
+            FileWatchCoalescer::Clock::time_point time;
+        };
+
+    private:
+        std::mutex m_watchHandlesMutex;
+        std::vector<std::unique_ptr<WatchHandleInfo>> m_watchHandlesInfos;
+
+        // Filled by the watch thread, consumed by popEvent().
+        MpscQueue<RawEvent> m_rawEvents;
+        FileWatchCoalescer m_coalescer;
 
         // Thread
         std::atomic<bool> m_watching{true};
@@ -0,0 +1,134 @@
+#include <lava/chamber/frame-arena.hpp>
+
+#include <lava/chamber/tracker.hpp>
+
+using namespace lava;
+
+chamber::FrameArena chamber::frameArena;
+
+using namespace lava::chamber;
+
+namespace {
+    constexpr TrackerKey FRAME_ARENA_USED_KEY("frame-arena.used-bytes");
+    constexpr TrackerKey FRAME_ARENA_HIGH_WATER_MARK_KEY("frame-arena.high-water-mark-bytes");
+
+    std::atomic<uint32_t> g_frameArenasCount = 0u;
+
+    // The calling thread owns its arenas, the frame arenas only keep weak references to them.
+    thread_local std::vector<std::pair<uint32_t, std::shared_ptr<LinearArena>>> g_currentThreadArenas;
+    thread_local uint32_t g_currentThreadFrameArenaId = 0u;
+    thread_local LinearArena* g_currentThreadArena = nullptr;
+}
+
+// ----- LinearArena
+
+LinearArena::LinearArena(uint32_t chunkSize)
+    : m_chunkSize(chunkSize)
+{
+}
+
+LinearArena::~LinearArena() = default;
+
+void* LinearArena::allocate(size_t size, size_t alignment)
+{
+    if (!m_chunks.empty()) {
+        auto& chunk = m_chunks.back();
+        auto address = reinterpret_cast<uintptr_t>(chunk.data.get()) + m_offset;
+        auto padding = (alignment - address % alignment) % alignment;
+
+        if (m_offset + padding + size <= chunk.size) {
+            m_offset += padding + size;
+            m_used += padding + size;
+            m_highWaterMark = std::max(m_highWaterMark, m_used);
+            return reinterpret_cast<void*>(address + padding);
+        }
+    }
+
+    // Not enough space, new chunk, big enough even for huge requests.
+    Chunk chunk;
+    chunk.size = std::max(m_chunkSize, size + alignment);
+    chunk.data = std::make_unique<uint8_t[]>(chunk.size);
+
+    auto address = reinterpret_cast<uintptr_t>(chunk.data.get());
+    auto padding = (alignment - address % alignment) % alignment;
+    m_chunks.emplace_back(std::move(chunk));
+
+    m_offset = padding + size;
+    m_used += padding + size;
+    m_highWaterMark = std::max(m_highWaterMark, m_used);
+    return reinterpret_cast<void*>(address + padding);
+}
+
+void LinearArena::reset()
+{
+    // Merging chunks, so that the same usage fits in one next time.
+    if (m_chunks.size() > 1u) {
+        size_t totalSize = 0u;
+        for (const auto& chunk : m_chunks) {
+            totalSize += chunk.size;
+        }
+
+        m_chunks.clear();
+        m_chunks.emplace_back();
+        m_chunks.back().size = totalSize;
+        m_chunks.back().data = std::make_unique<uint8_t[]>(totalSize);
+    }
+
+    m_offset = 0u;
+    m_used = 0u;
+}
+
+// ----- FrameArena
+
+FrameArena::FrameArena()
+    : m_id(++g_frameArenasCount)
+{
+}
+
+LinearArena& FrameArena::local()
+{
+    if (g_currentThreadFrameArenaId == m_id) {
+        return *g_currentThreadArena;
+    }
+
+    // The thread might have used another frame arena in-between.
+    auto threadArena = std::find_if(g_currentThreadArenas.begin(), g_currentThreadArenas.end(),
+                                    [this](const auto& threadArena) { return threadArena.first == m_id; });
+    if (threadArena == g_currentThreadArenas.end()) {
+        auto arena = std::make_shared<LinearArena>();
+        {
+            std::scoped_lock lock(m_arenasMutex);
+            m_arenas.emplace_back(arena);
+        }
+        g_currentThreadArenas.emplace_back(m_id, std::move(arena));
+        threadArena = g_currentThreadArenas.end() - 1u;
+    }
+
+    g_currentThreadFrameArenaId = m_id;
+    g_currentThreadArena = threadArena->second.get();
+    return *g_currentThreadArena;
+}
+
+void FrameArena::endFrame()
+{
+    std::scoped_lock lock(m_arenasMutex);
+
+    size_t used = 0u;
+    size_t highWaterMark = 0u;
+    for (auto iArena = m_arenas.begin(); iArena != m_arenas.end();) {
+        // The thread has exited, freeing its arena.
+        auto arena = iArena->lock();
+        if (!arena) {
+            iArena = m_arenas.erase(iArena);
+            continue;
+        }
+
+        used += arena->used();
+        highWaterMark += arena->highWaterMark();
+        arena->reset();
+        ++iArena;
+    }
+
+    tracker.gauge(FRAME_ARENA_USED_KEY, used);
+    tracker.gauge(FRAME_ARENA_HIGH_WATER_MARK_KEY, highWaterMark);
+}
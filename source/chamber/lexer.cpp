@@ -11,94 +11,97 @@ using namespace lava::chamber;
 
 Lexer::Lexer(std::string_view code)
 {
-    stb_c_lexer_init(&m_lexer, code.data(), code.data() + code.size(), m_buffer, 100);
+    stb_c_lexer_init(&m_lexer, code.data(), code.data() + code.size(), m_buffer, sizeof(m_buffer));
 }
 
 std::optional<Lexer::Token> Lexer::nextToken()
 {
-    if (!stb_c_lexer_get_token(&m_lexer)) {
-        return std::nullopt;
-    }
-
-    m_token.spacing.clear();
-    while (m_lexer.token == CLEX_white) {
-        m_token.spacing += m_lexer.string;
+    // Comments are skipped by stb, splitting the spacing in multiple runs.
+    // Only then the spacing is copied, as it is no more contiguous in the code.
+    std::string_view spacing;
+    while (true) {
         if (!stb_c_lexer_get_token(&m_lexer)) {
             return std::nullopt;
         }
+        if (m_lexer.token != CLEX_white) break;
+
+        std::string_view white(m_lexer.string, m_lexer.string_len);
+        if (spacing.empty()) {
+            spacing = white;
+        }
+        else if (spacing.data() + spacing.size() == white.data()) {
+            spacing = std::string_view(spacing.data(), spacing.size() + white.size());
+        }
+        else {
+            if (spacing.data() != m_spacingStorage.data()) {
+                m_spacingStorage.assign(spacing);
+            }
+            m_spacingStorage += white;
+            spacing = m_spacingStorage;
+        }
     }
 
+    m_token.spacing = spacing;
+    m_token.string = std::string_view(m_lexer.where_firstchar, m_lexer.where_lastchar - m_lexer.where_firstchar + 1);
+
     switch (m_lexer.token) {
     case CLEX_id: {
         m_token.type = TokenType::Identifier;
-        m_token.string = m_lexer.string;
         break;
     }
     case CLEX_dqstring: {
         m_token.type = TokenType::String;
-        m_token.string = m_lexer.string;
+        m_token.string = std::string_view(m_lexer.string, m_lexer.string_len);
         break;
     }
     case CLEX_floatlit: {
         m_token.type = TokenType::Number;
-        m_token.string = std::to_string(m_lexer.real_number);
         m_token.number = m_lexer.real_number;
         break;
     }
     case CLEX_intlit: {
         m_token.type = TokenType::Number;
-        m_token.string = std::to_string(m_lexer.int_number);
         m_token.number = static_cast<double>(m_lexer.int_number);
         break;
     }
     case CLEX_eq: {
         m_token.type = TokenType::EqualEqual;
-        m_token.string = "==";
         break;
     }
     case CLEX_noteq: {
         m_token.type = TokenType::NotEqual;
-        m_token.string = "!=";
         break;
     }
     case CLEX_lesseq: {
         m_token.type = TokenType::LessOrEqual;
-        m_token.string = "<=";
         break;
     }
     case CLEX_greatereq: {
         m_token.type = TokenType::GreaterOrEqual;
-        m_token.string = ">=";
         break;
     }
     case CLEX_pluseq: {
         m_token.type = TokenType::PlusEqual;
-        m_token.string = "+=";
         break;
     }
     case CLEX_minuseq: {
         m_token.type = TokenType::MinusEqual;
-        m_token.string = "-=";
         break;
     }
     case CLEX_muleq: {
         m_token.type = TokenType::MultiplyEqual;
-        m_token.string = "*=";
         break;
     }
     case CLEX_diveq: {
         m_token.type = TokenType::DivideEqual;
-        m_token.string = "/=";
         break;
     }
     case CLEX_andand: {
         m_token.type = TokenType::AndAnd;
-        m_token.string = "&&";
         break;
     }
     case CLEX_oror: {
         m_token.type = TokenType::OrOr;
-        m_token.string = "||";
         break;
     }
     default: {
@@ -107,7 +110,6 @@ std::optional<Lexer::Token> Lexer::nextToken()
         }
         else if (m_lexer.token <= 255) {
             char character = static_cast<char>(m_lexer.token);
-            m_token.string = character;
 
             switch (m_lexer.token) {
             case ';': m_token.type = TokenType::Semicolon; break;
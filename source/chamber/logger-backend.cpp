@@ -0,0 +1,78 @@
+#include "./logger-backend.hpp"
+
+using namespace lava::chamber;
+
+namespace {
+    // Wake-ups are not synchronized with pushes, so the writer never sleeps longer than that.
+    constexpr const std::chrono::milliseconds WRITER_MAX_SLEEP(10);
+}
+
+LoggerBackend::LoggerBackend(std::ostream& stream)
+    : m_stream(stream)
+{
+    m_thread = std::thread(&LoggerBackend::run, this);
+}
+
+LoggerBackend::~LoggerBackend()
+{
+    stop();
+}
+
+void LoggerBackend::push(std::string&& record)
+{
+    m_records.push(std::move(record));
+
+    m_wakeCondition.notify_one();
+}
+
+void LoggerBackend::flush()
+{
+    while (writeBatch()) {
+    }
+}
+
+void LoggerBackend::stop()
+{
+    bool wasStopping = false;
+    {
+        std::scoped_lock lock(m_wakeMutex);
+        wasStopping = m_stopping;
+        m_stopping = true;
+    }
+
+    if (!wasStopping) {
+        m_wakeCondition.notify_one();
+        m_thread.join();
+    }
+
+    flush();
+}
+
+// ----- Internal
+
+void LoggerBackend::run()
+{
+    while (true) {
+        if (writeBatch()) continue;
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        if (m_stopping) break;
+        m_wakeCondition.wait_for(lock, WRITER_MAX_SLEEP);
+    }
+}
+
+bool LoggerBackend::writeBatch()
+{
+    std::scoped_lock lock(m_consumerMutex);
+
+    m_batch.clear();
+    while (auto record = m_records.pop()) {
+        m_batch += *record;
+    }
+
+    if (m_batch.empty()) return false;
+
+    m_stream.write(m_batch.data(), m_batch.size());
+    m_stream.flush();
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "./mpsc-queue.hpp"
+
+namespace lava::chamber {
+    /**
+     * Writes log records from a background thread.
+     *
+     * Producers push full records to a lock-free multiple-producers
+     * single-consumer queue, the writer thread concatenates
+     * all available records and writes them at once.
+     */
+    class LoggerBackend {
+    public:
+        LoggerBackend(std::ostream& stream);
+        ~LoggerBackend();
+
+        /// Add a record to be written, from any thread.
+        void push(std::string&& record);
+
+        /// Write all pending records from the calling thread.
+        void flush();
+
+        /// Stop the writer thread and write what is left from the calling thread.
+        void stop();
+
+    protected:
+        void run();
+
+        // Write all available records, returns false if nothing was written.
+        bool writeBatch();
+
+    private:
+        std::ostream& m_stream;
+        MpscQueue<std::string> m_records;
+
+        std::mutex m_consumerMutex; //!< Only one thread writes at a time.
+        std::string m_batch;
+
+        bool m_stopping = false;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wakeCondition;
+        std::thread m_thread;
+    };
+}
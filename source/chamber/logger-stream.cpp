@@ -2,15 +2,19 @@
 
 #include <lava/chamber/string-tools.hpp>
 
+#include <sstream>
+
+#include "./logger-backend.hpp"
+
 using namespace lava::chamber;
 
-LoggerStream::LoggerStream(std::ostream& stream, const std::string& resetString)
+LoggerStream::LoggerStream(LoggerBackend& backend, const std::string& resetString, uint32_t infoLogLevel)
     : std::ostream(this)
-    , m_stream(&stream)
+    , m_backend(backend)
     , m_resetString(resetString)
+    , m_infoLogLevel(infoLogLevel)
 {
-    auto infoLogLevelEnv = getenv("LAVA_INFO_LOG_LEVEL");
-    m_infoLogLevel = (infoLogLevelEnv) ? std::atoi(infoLogLevelEnv) : -1u;
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
 }
 
 LoggerStream& LoggerStream::operator[](uint8_t i)
@@ -23,42 +27,85 @@ LoggerStream& LoggerStream::operator[](uint8_t i)
 LoggerStream& LoggerStream::tab(int8_t i)
 {
     m_tabs += i;
+    updateEnabled();
     return *this;
 }
 
-std::string LoggerStream::tabsString()
+void LoggerStream::kind(LoggerKind kind)
 {
-    static const std::string tab("| ");
-    return tab * m_tabs;
+    // Lines written with the previous kind are to be emitted with the previous prefix.
+    flushPending();
+
+    m_kind = kind;
+    updateEnabled();
+}
+
+void LoggerStream::flushPending()
+{
+    for (auto c = pbase(); c != pptr(); ++c) {
+        if (*c == '\n') {
+            emitLine();
+        }
+        else {
+            m_line += *c;
+        }
+    }
+
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
 }
 
+// ----- Internal
+
 int LoggerStream::overflow(int c)
 {
-    if (m_kind == LoggerKind::Info && m_tabs >= m_infoLogLevel) {
-        return 0;
+    flushPending();
+
+    if (c != std::streambuf::traits_type::eof()) {
+        *pptr() = std::streambuf::traits_type::to_char_type(c);
+        pbump(1);
     }
 
-    if (c == '\n') {
-        stream() << resetString();
-        stream().flush();
-        m_beenReset = true;
+    return std::streambuf::traits_type::not_eof(c);
+}
 
-        if (m_autoExit) {
-            stream() << std::endl;
+int LoggerStream::sync()
+{
+    flushPending();
+    return 0;
+}
 
-            CallStack callStack;
-            callStack.refresh(4);
-            m_stream->put(c);
-            stream() << callStack;
-            exit(1);
-        }
+std::string LoggerStream::tabsString()
+{
+    static const std::string tab("| ");
+    return tab * m_tabs;
+}
+
+void LoggerStream::updateEnabled()
+{
+    // A failed stream skips all formatting.
+    if (m_kind == LoggerKind::Info && m_tabs >= m_infoLogLevel) {
+        setstate(std::ios::badbit);
     }
-    else if (m_beenReset) {
-        stream() << prefixString() << tabsString();
-        m_beenReset = false;
+    else {
+        clear();
     }
+}
+
+void LoggerStream::emitLine()
+{
+    m_backend.push(prefixString() + tabsString() + m_line + resetString() + '\n');
+    m_line.clear();
 
-    m_stream->put(c);
+    if (m_autoExit) {
+        CallStack callStack;
+        callStack.refresh(6);
 
-    return 0;
+        std::ostringstream callStackString;
+        callStackString << std::endl << callStack;
+        m_backend.push(callStackString.str());
+
+        // Everything has to be written before leaving, and nothing else afterwards.
+        m_backend.stop();
+        exit(1);
+    }
 }
@@ -3,55 +3,112 @@
 #include <lava/chamber/math.hpp>
 #include <lava/chamber/string-tools.hpp>
 
+#include "./logger-backend.hpp"
+
 using namespace lava;
 
 chamber::Logger chamber::logger;
 
 namespace {
+    thread_local chamber::Logger* g_currentThreadLogger = nullptr;
+    thread_local chamber::LoggerStream* g_currentThreadStream = nullptr;
+
     std::string spacing(const std::string& string)
     {
         static const std::string space(" ");
-        static uint32_t maxStringLength = 0u;
+        static std::atomic<uint32_t> maxStringLength = 0u;
         uint32_t stringLength = string.size();
-        maxStringLength = std::max(maxStringLength, stringLength);
-        return space * (maxStringLength - stringLength);
+
+        auto currentMaxStringLength = maxStringLength.load();
+        while (currentMaxStringLength < stringLength && !maxStringLength.compare_exchange_weak(currentMaxStringLength, stringLength)) {
+        }
+
+        return space * (std::max(currentMaxStringLength, stringLength) - stringLength);
     }
 }
 
 using namespace lava::chamber;
 
 Logger::Logger()
-    : m_stream(std::cout, "\e[0m")
+    : m_backend(std::make_unique<LoggerBackend>(std::cout))
 {
+    auto infoLogLevelEnv = getenv("LAVA_INFO_LOG_LEVEL");
+    m_infoLogLevel = (infoLogLevelEnv) ? std::atoi(infoLogLevelEnv) : -1u;
+
+    // @note Only overrides the level, plain info() calls are still there.
+#if defined(LAVA_CHAMBER_LOGGER_NO_INFO)
+    m_infoLogLevel = 0u;
+#endif
 }
 
+// @note The backend writes everything that is left when destroyed.
+Logger::~Logger() = default;
+
 LoggerStream& Logger::log()
 {
-    return m_stream;
+    return stream();
 }
 
 LoggerStream& Logger::info(const std::string& category)
 {
-    m_stream.kind(LoggerKind::Info);
-    m_stream.autoExit(false);
-    m_stream.prefixString("\e[1m[" + category + "] \e[32m" + spacing(category));
-    return m_stream;
+    auto& stream = this->stream();
+    stream.kind(LoggerKind::Info);
+    stream.autoExit(false);
+
+    // Nothing will be written, no need to build the prefix,
+    // but the previous one should not be used for later lines.
+    if (stream.bad()) {
+        stream.prefixString().clear();
+        return stream;
+    }
+
+    stream.prefixString("\e[1m[" + category + "] \e[32m" + spacing(category));
+    return stream;
+}
+
+bool Logger::infoEnabled()
+{
+    return stream().tabs() < m_infoLogLevel;
 }
 
 LoggerStream& Logger::warning(const std::string& category)
 {
     static const std::string follow("/!\\ ");
-    m_stream.kind(LoggerKind::Unknown);
-    m_stream.autoExit(false);
-    m_stream.prefixString("\e[1m[" + category + "] \e[33m" + follow + spacing(category + follow));
-    return m_stream;
+    auto& stream = this->stream();
+    stream.kind(LoggerKind::Unknown);
+    stream.autoExit(false);
+    stream.prefixString("\e[1m[" + category + "] \e[33m" + follow + spacing(category + follow));
+    return stream;
 }
 
 LoggerStream& Logger::error(const std::string& category)
 {
     static const std::string follow("//!\\\\ ");
-    m_stream.kind(LoggerKind::Unknown);
-    m_stream.autoExit(true);
-    m_stream.prefixString("\e[1m[" + category + "] \e[31m" + follow + spacing(category + follow));
-    return m_stream;
+    auto& stream = this->stream();
+    stream.kind(LoggerKind::Unknown);
+    stream.autoExit(true);
+    stream.prefixString("\e[1m[" + category + "] \e[31m" + follow + spacing(category + follow));
+    return stream;
+}
+
+void Logger::flush()
+{
+    stream().flushPending();
+    m_backend->flush();
+}
+
+// ----- Internal
+
+LoggerStream& Logger::stream()
+{
+    if (g_currentThreadLogger == this) {
+        return *g_currentThreadStream;
+    }
+
+    std::scoped_lock lock(m_streamsMutex);
+    auto& stream = m_streams.emplace_back(std::make_unique<LoggerStream>(*m_backend, "\e[0m", m_infoLogLevel));
+
+    g_currentThreadLogger = this;
+    g_currentThreadStream = stream.get();
+    return *stream;
 }
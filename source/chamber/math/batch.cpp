@@ -0,0 +1,350 @@
+#include <lava/chamber/math/batch.hpp>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#define LAVA_CHAMBER_MATH_SSE
+#if defined(__GNUC__)
+#define LAVA_CHAMBER_MATH_AVX2
+#define LAVA_CHAMBER_MATH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace lava;
+
+namespace {
+    static_assert(sizeof(glm::vec3) == 3u * sizeof(float), "Batch kernels expect packed glm::vec3.");
+    static_assert(sizeof(glm::quat) == 4u * sizeof(float), "Batch kernels expect packed glm::quat.");
+    static_assert(sizeof(BoundingSphere) == 4u * sizeof(float), "Batch kernels expect packed bounding spheres.");
+
+#if defined(LAVA_CHAMBER_MATH_AVX2)
+    bool hasAvx2()
+    {
+        static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+        return hasAvx2;
+    }
+#endif
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    /// Matrix elements, each broadcast once for a whole batch.
+    struct SseMatrix {
+        __m128 m[4][3];
+
+        SseMatrix(const glm::mat4& matrix)
+        {
+            for (auto c = 0u; c < 4u; ++c) {
+                for (auto r = 0u; r < 3u; ++r) {
+                    m[c][r] = _mm_set1_ps(matrix[c][r]);
+                }
+            }
+        }
+
+        /// Transforms four points, given and returned as x, y and z lanes.
+        void transformPoints(__m128& x, __m128& y, __m128& z) const
+        {
+            auto outX = _mm_add_ps(_mm_mul_ps(m[0][0], x), m[3][0]);
+            auto outY = _mm_add_ps(_mm_mul_ps(m[0][1], x), m[3][1]);
+            auto outZ = _mm_add_ps(_mm_mul_ps(m[0][2], x), m[3][2]);
+            outX = _mm_add_ps(outX, _mm_mul_ps(m[1][0], y));
+            outY = _mm_add_ps(outY, _mm_mul_ps(m[1][1], y));
+            outZ = _mm_add_ps(outZ, _mm_mul_ps(m[1][2], y));
+            x = _mm_add_ps(outX, _mm_mul_ps(m[2][0], z));
+            y = _mm_add_ps(outY, _mm_mul_ps(m[2][1], z));
+            z = _mm_add_ps(outZ, _mm_mul_ps(m[2][2], z));
+        }
+    };
+
+    /// From three registers xyzx yzxy zxyz to x, y and z lanes of four points.
+    inline void deinterleaveVec3(__m128 v0, __m128 v1, __m128 v2, __m128& x, __m128& y, __m128& z)
+    {
+        auto x23 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(0, 1, 3, 2));
+        auto y01 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0, 0, 0, 1));
+        auto y23 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2, 2, 3, 3));
+        auto z01 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1, 1, 2, 2));
+        auto z23 = _mm_shuffle_ps(v2, v2, _MM_SHUFFLE(3, 3, 0, 0));
+        x = _mm_shuffle_ps(v0, x23, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm_shuffle_ps(y01, y23, _MM_SHUFFLE(2, 0, 2, 0));
+        z = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2, 0, 2, 0));
+    }
+
+    /// Inverse of deinterleaveVec3.
+    inline void interleaveVec3(__m128 x, __m128 y, __m128 z, __m128& v0, __m128& v1, __m128& v2)
+    {
+        auto xy01 = _mm_unpacklo_ps(x, y);
+        auto xy23 = _mm_unpackhi_ps(x, y);
+        auto z0x1 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0));
+        auto y1z1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1));
+        auto z23xy3 = _mm_shuffle_ps(z, xy23, _MM_SHUFFLE(3, 2, 3, 2));
+        v0 = _mm_shuffle_ps(xy01, z0x1, _MM_SHUFFLE(2, 0, 1, 0));
+        v1 = _mm_shuffle_ps(y1z1, xy23, _MM_SHUFFLE(1, 0, 2, 0));
+        v2 = _mm_shuffle_ps(z23xy3, z23xy3, _MM_SHUFFLE(1, 3, 2, 0));
+    }
+#endif
+
+#if defined(LAVA_CHAMBER_MATH_AVX2)
+    LAVA_CHAMBER_MATH_TARGET_AVX2
+    uint32_t spheresInsidePlanesAvx2(const glm::vec4* planes, uint32_t planesCount, const chamber::math::SpheresSoa& spheres,
+                                     uint32_t count, uint8_t* visibles)
+    {
+        auto i = 0u;
+        for (; i + 8u <= count; i += 8u) {
+            auto x = _mm256_loadu_ps(spheres.x + i);
+            auto y = _mm256_loadu_ps(spheres.y + i);
+            auto z = _mm256_loadu_ps(spheres.z + i);
+            auto r = _mm256_loadu_ps(spheres.radius + i);
+
+            auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (auto p = 0u; p < planesCount; ++p) {
+                const auto& plane = planes[p];
+                auto distance = _mm256_mul_ps(_mm256_set1_ps(plane.x), x);
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+                distance = _mm256_sub_ps(distance, r);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_set1_ps(plane.w), _CMP_LE_OQ));
+            }
+
+            auto mask = _mm256_movemask_ps(inside);
+            for (auto j = 0u; j < 8u; ++j) {
+                visibles[i + j] = (mask >> j) & 1u;
+            }
+        }
+        return i;
+    }
+#endif
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    uint32_t spheresInsidePlanesSse(const glm::vec4* planes, uint32_t planesCount, const chamber::math::SpheresSoa& spheres,
+                                    uint32_t count, uint8_t* visibles)
+    {
+        auto i = 0u;
+        for (; i + 4u <= count; i += 4u) {
+            auto x = _mm_loadu_ps(spheres.x + i);
+            auto y = _mm_loadu_ps(spheres.y + i);
+            auto z = _mm_loadu_ps(spheres.z + i);
+            auto r = _mm_loadu_ps(spheres.radius + i);
+
+            auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (auto p = 0u; p < planesCount; ++p) {
+                const auto& plane = planes[p];
+                auto distance = _mm_mul_ps(_mm_set1_ps(plane.x), x);
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.y), y));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+                distance = _mm_sub_ps(distance, r);
+                inside = _mm_and_ps(inside, _mm_cmple_ps(distance, _mm_set1_ps(plane.w)));
+            }
+
+            auto mask = _mm_movemask_ps(inside);
+            for (auto j = 0u; j < 4u; ++j) {
+                visibles[i + j] = (mask >> j) & 1u;
+            }
+        }
+        return i;
+    }
+#endif
+}
+
+void chamber::math::transformPoints(const glm::mat4& matrix, const glm::vec3* points, glm::vec3* outPoints, uint32_t count)
+{
+    auto i = 0u;
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    // Four points at once, loaded as three registers, all read before being written
+    // so that points and outPoints can be the same.
+    const SseMatrix sseMatrix(matrix);
+    for (; i + 4u <= count; i += 4u) {
+        auto floats = &points[i].x;
+        auto outFloats = &outPoints[i].x;
+        __m128 x, y, z;
+        deinterleaveVec3(_mm_loadu_ps(floats), _mm_loadu_ps(floats + 4u), _mm_loadu_ps(floats + 8u), x, y, z);
+        sseMatrix.transformPoints(x, y, z);
+
+        __m128 v0, v1, v2;
+        interleaveVec3(x, y, z, v0, v1, v2);
+        _mm_storeu_ps(outFloats, v0);
+        _mm_storeu_ps(outFloats + 4u, v1);
+        _mm_storeu_ps(outFloats + 8u, v2);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        outPoints[i] = glm::vec3(matrix * glm::vec4(points[i], 1.f));
+    }
+}
+
+void chamber::math::transformSpheres(const glm::mat4& matrix, const BoundingSphere* spheres, BoundingSphere* outSpheres,
+                                     uint32_t count)
+{
+    const auto scaleSquared = std::max(glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+                                       std::max(glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+                                                glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))));
+    const auto scale = std::sqrt(scaleSquared);
+
+    auto i = 0u;
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    // Four spheres at once, transposed to x, y, z and radius lanes.
+    const SseMatrix sseMatrix(matrix);
+    const auto sseScale = _mm_set1_ps(scale);
+    for (; i + 4u <= count; i += 4u) {
+        auto x = _mm_loadu_ps(&spheres[i].center.x);
+        auto y = _mm_loadu_ps(&spheres[i + 1u].center.x);
+        auto z = _mm_loadu_ps(&spheres[i + 2u].center.x);
+        auto r = _mm_loadu_ps(&spheres[i + 3u].center.x);
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+
+        sseMatrix.transformPoints(x, y, z);
+        r = _mm_mul_ps(r, sseScale);
+
+        _MM_TRANSPOSE4_PS(x, y, z, r);
+        _mm_storeu_ps(&outSpheres[i].center.x, x);
+        _mm_storeu_ps(&outSpheres[i + 1u].center.x, y);
+        _mm_storeu_ps(&outSpheres[i + 2u].center.x, z);
+        _mm_storeu_ps(&outSpheres[i + 3u].center.x, r);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        auto radius = spheres[i].radius * scale;
+        outSpheres[i].center = glm::vec3(matrix * glm::vec4(spheres[i].center, 1.f));
+        outSpheres[i].radius = radius;
+    }
+}
+
+void chamber::math::minMax(const glm::vec3* points, uint32_t count, glm::vec3& min, glm::vec3& max)
+{
+    min = points[0];
+    max = points[0];
+    auto i = 0u;
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    // Four points at once, as three registers: xyzx yzxy zxyz.
+    if (count >= 4u) {
+        auto floats = &points[0].x;
+        auto min0 = _mm_loadu_ps(floats);
+        auto min1 = _mm_loadu_ps(floats + 4u);
+        auto min2 = _mm_loadu_ps(floats + 8u);
+        auto max0 = min0;
+        auto max1 = min1;
+        auto max2 = min2;
+
+        for (i = 4u; i + 4u <= count; i += 4u) {
+            auto v0 = _mm_loadu_ps(floats + 3u * i);
+            auto v1 = _mm_loadu_ps(floats + 3u * i + 4u);
+            auto v2 = _mm_loadu_ps(floats + 3u * i + 8u);
+            min0 = _mm_min_ps(min0, v0);
+            min1 = _mm_min_ps(min1, v1);
+            min2 = _mm_min_ps(min2, v2);
+            max0 = _mm_max_ps(max0, v0);
+            max1 = _mm_max_ps(max1, v1);
+            max2 = _mm_max_ps(max2, v2);
+        }
+
+        alignas(16) float m[12];
+        _mm_store_ps(m, min0);
+        _mm_store_ps(m + 4u, min1);
+        _mm_store_ps(m + 8u, min2);
+        min.x = std::min(std::min(m[0], m[3]), std::min(m[6], m[9]));
+        min.y = std::min(std::min(m[1], m[4]), std::min(m[7], m[10]));
+        min.z = std::min(std::min(m[2], m[5]), std::min(m[8], m[11]));
+
+        _mm_store_ps(m, max0);
+        _mm_store_ps(m + 4u, max1);
+        _mm_store_ps(m + 8u, max2);
+        max.x = std::max(std::max(m[0], m[3]), std::max(m[6], m[9]));
+        max.y = std::max(std::max(m[1], m[4]), std::max(m[7], m[10]));
+        max.z = std::max(std::max(m[2], m[5]), std::max(m[8], m[11]));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        min = glm::min(min, points[i]);
+        max = glm::max(max, points[i]);
+    }
+}
+
+void chamber::math::spheresInsidePlanes(const glm::vec4* planes, uint32_t planesCount, const SpheresSoa& spheres,
+                                        uint32_t count, uint8_t* visibles)
+{
+    auto i = 0u;
+
+#if defined(LAVA_CHAMBER_MATH_AVX2)
+    if (hasAvx2()) {
+        i = spheresInsidePlanesAvx2(planes, planesCount, spheres, count, visibles);
+    }
+#endif
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    if (i == 0u) {
+        i = spheresInsidePlanesSse(planes, planesCount, spheres, count, visibles);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        const glm::vec3 center(spheres.x[i], spheres.y[i], spheres.z[i]);
+        auto inside = true;
+        for (auto p = 0u; p < planesCount && inside; ++p) {
+            inside = (glm::dot(glm::vec3(planes[p]), center) - spheres.radius[i] <= planes[p].w);
+        }
+        visibles[i] = inside;
+    }
+}
+
+void chamber::math::nlerp(const glm::quat* q0s, const glm::quat* q1s, const float* ts, glm::quat* outQuats, uint32_t count)
+{
+    auto i = 0u;
+
+#if defined(LAVA_CHAMBER_MATH_SSE)
+    // Four quaternions at once, transposed to x, y, z and w lanes.
+    const auto signMask = _mm_set1_ps(-0.f);
+    for (; i + 4u <= count; i += 4u) {
+        auto x0 = _mm_loadu_ps(&q0s[i].x);
+        auto y0 = _mm_loadu_ps(&q0s[i + 1u].x);
+        auto z0 = _mm_loadu_ps(&q0s[i + 2u].x);
+        auto w0 = _mm_loadu_ps(&q0s[i + 3u].x);
+        _MM_TRANSPOSE4_PS(x0, y0, z0, w0);
+        auto x1 = _mm_loadu_ps(&q1s[i].x);
+        auto y1 = _mm_loadu_ps(&q1s[i + 1u].x);
+        auto z1 = _mm_loadu_ps(&q1s[i + 2u].x);
+        auto w1 = _mm_loadu_ps(&q1s[i + 3u].x);
+        _MM_TRANSPOSE4_PS(x1, y1, z1, w1);
+
+        // Shortest path: flip q1 if the dot product is negative.
+        auto dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, x1), _mm_mul_ps(y0, y1)),
+                              _mm_add_ps(_mm_mul_ps(z0, z1), _mm_mul_ps(w0, w1)));
+        auto sign = _mm_and_ps(dot, signMask);
+        auto t = _mm_loadu_ps(ts + i);
+        auto x = _mm_add_ps(x0, _mm_mul_ps(t, _mm_sub_ps(_mm_xor_ps(x1, sign), x0)));
+        auto y = _mm_add_ps(y0, _mm_mul_ps(t, _mm_sub_ps(_mm_xor_ps(y1, sign), y0)));
+        auto z = _mm_add_ps(z0, _mm_mul_ps(t, _mm_sub_ps(_mm_xor_ps(z1, sign), z0)));
+        auto w = _mm_add_ps(w0, _mm_mul_ps(t, _mm_sub_ps(_mm_xor_ps(w1, sign), w0)));
+
+        auto lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w)));
+        auto length = _mm_sqrt_ps(lengthSquared);
+        x = _mm_div_ps(x, length);
+        y = _mm_div_ps(y, length);
+        z = _mm_div_ps(z, length);
+        w = _mm_div_ps(w, length);
+
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&outQuats[i].x, x);
+        _mm_storeu_ps(&outQuats[i + 1u].x, y);
+        _mm_storeu_ps(&outQuats[i + 2u].x, z);
+        _mm_storeu_ps(&outQuats[i + 3u].x, w);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        auto q1 = (glm::dot(q0s[i], q1s[i]) < 0.f) ? -q1s[i] : q1s[i];
+        outQuats[i] = glm::normalize(q0s[i] + ts[i] * (q1 - q0s[i]));
+    }
+}
+
+void chamber::math::slerp(const glm::quat* q0s, const glm::quat* q1s, const float* ts, glm::quat* outQuats, uint32_t count)
+{
+    // @note Transcendental functions are not vectorized,
+    // nlerp is the fast alternative when quaternions are close.
+    for (auto i = 0u; i < count; ++i) {
+        outQuats[i] = glm::slerp(q0s[i], q1s[i], ts[i]);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+namespace lava::chamber {
+    /**
+     * Unbounded lock-free queue, with multiple producers and a single consumer.
+     *
+     * Values are pushed to the head and popped from the tail,
+     * a stub node keeping the queue never empty (Vyukov's design).
+     */
+    template <class T>
+    class MpscQueue {
+    public:
+        MpscQueue()
+            : m_head(&m_stub)
+            , m_tail(&m_stub)
+        {
+        }
+
+        ~MpscQueue()
+        {
+            while (pop()) {
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        /// Can be called from any thread.
+        void push(T value)
+        {
+            auto node = new Node;
+            node->value = std::move(value);
+            pushNode(node);
+        }
+
+        /**
+         * Consumer side only.
+         * Might return nothing while a producer is in the middle of a push,
+         * the value will be available on next call.
+         */
+        std::optional<T> pop()
+        {
+            auto node = popNode();
+            if (node == nullptr) return std::nullopt;
+
+            auto value = std::move(node->value);
+            delete node;
+            return value;
+        }
+
+    protected:
+        struct Node {
+            std::atomic<Node*> next = nullptr;
+            std::optional<T> value;
+        };
+
+        void pushNode(Node* node)
+        {
+            node->next.store(nullptr, std::memory_order_relaxed);
+            auto previousHead = m_head.exchange(node, std::memory_order_acq_rel);
+            previousHead->next.store(node, std::memory_order_release);
+        }
+
+        Node* popNode()
+        {
+            auto tail = m_tail;
+            auto next = tail->next.load(std::memory_order_acquire);
+
+            // Skipping the stub
+            if (tail == &m_stub) {
+                if (next == nullptr) return nullptr;
+                m_tail = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+
+            if (next != nullptr) {
+                m_tail = next;
+                return tail;
+            }
+
+            // A producer is in the middle of a push.
+            if (tail != m_head.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+
+            // Tail is the last node, putting the stub back so that it can be popped.
+            pushNode(&m_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next != nullptr) {
+                m_tail = next;
+                return tail;
+            }
+
+            return nullptr;
+        }
+
+    private:
+        std::atomic<Node*> m_head;
+        Node* m_tail = nullptr;
+        Node m_stub;
+    };
+}
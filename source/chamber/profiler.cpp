@@ -0,0 +1,172 @@
+#include <lava/chamber/profiler.hpp>
+
+#include <lava/chamber/logger.hpp>
+
+using namespace lava;
+
+chamber::Profiler chamber::profiler;
+
+namespace {
+    thread_local chamber::Profiler* g_currentThreadProfiler = nullptr;
+    thread_local std::shared_ptr<void> g_currentThreadEvents = nullptr; //!< Released when the thread exits.
+
+    const char* colorCategory(uint32_t color)
+    {
+        switch (color) {
+        case PROFILER_COLOR_UPDATE: return "update";
+        case PROFILER_COLOR_RENDER: return "render";
+        case PROFILER_COLOR_DRAW: return "draw";
+        case PROFILER_COLOR_ALLOCATION: return "allocation";
+        case PROFILER_COLOR_REGISTER: return "register";
+        case PROFILER_COLOR_INIT: return "init";
+        default: break;
+        }
+        return "default";
+    }
+
+    void writeJsonString(std::ostream& stream, const char* string)
+    {
+        stream << '"';
+        for (auto c = string; *c != '\0'; ++c) {
+            if (*c == '"' || *c == '\\') stream << '\\';
+            if (static_cast<unsigned char>(*c) < 0x20u) continue;
+            stream << *c;
+        }
+        stream << '"';
+    }
+}
+
+using namespace lava::chamber;
+
+void Profiler::start()
+{
+    std::scoped_lock lock(m_threadsEventsMutex);
+
+    // Paused while resetting, so that no event is written in-between.
+    m_active = false;
+    waitRecordings();
+    forgetExitedThreads();
+
+    for (auto& threadEvents : m_threadsEvents) {
+        threadEvents->eventsCount = 0u;
+    }
+
+    m_startTime = Clock::now().time_since_epoch().count();
+    m_active = true;
+}
+
+void Profiler::stop(const std::string& dumpFile)
+{
+    if (!m_active.exchange(false)) return;
+
+    std::scoped_lock lock(m_threadsEventsMutex);
+    waitRecordings();
+
+    std::ofstream file(dumpFile);
+    if (!file.is_open()) {
+        logger.warning("chamber.profiler") << "Unable to write profile to " << dumpFile << "." << std::endl;
+        forgetExitedThreads();
+        return;
+    }
+
+    // Chrome trace event format, with durations in microseconds.
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    file << std::fixed << std::setprecision(3);
+
+    bool firstEvent = true;
+    for (const auto& threadEvents : m_threadsEvents) {
+        if (!threadEvents->threadName.empty()) {
+            file << (firstEvent ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << threadEvents->threadId
+                 << ",\"args\":{\"name\":";
+            writeJsonString(file, threadEvents->threadName.c_str());
+            file << "}}";
+            firstEvent = false;
+        }
+
+        uint64_t eventsCount = threadEvents->eventsCount.load(std::memory_order_acquire);
+        uint64_t firstEventIndex = (eventsCount > EVENTS_PER_THREAD) ? eventsCount - EVENTS_PER_THREAD : 0u;
+        for (auto i = firstEventIndex; i < eventsCount; ++i) {
+            const auto& event = threadEvents->events[i % EVENTS_PER_THREAD];
+            file << (firstEvent ? "" : ",\n") << "{\"ph\":\"X\",\"pid\":1,\"tid\":" << threadEvents->threadId << ",\"name\":";
+            writeJsonString(file, event.name);
+            file << ",\"cat\":\"" << colorCategory(event.color) << "\",\"ts\":" << event.begin / 1000.0
+                 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << "}";
+            firstEvent = false;
+        }
+
+        if (firstEventIndex != 0u) {
+            logger.warning("chamber.profiler") << "Thread " << threadEvents->threadId << " overflowed, " << firstEventIndex
+                                               << " oldest events were lost." << std::endl;
+        }
+    }
+
+    file << std::endl << "]}" << std::endl;
+
+    forgetExitedThreads();
+
+    $log_info("chamber.profiler") << "Profile written to " << dumpFile << "." << std::endl;
+}
+
+void Profiler::record(const char* name, uint32_t color, uint64_t begin, uint64_t end)
+{
+    if (!active()) return;
+
+    // Flagged before checking again, so that either start() and stop() wait for this event,
+    // or it is not written at all.
+    auto& threadEvents = currentThreadEvents();
+    threadEvents.recording = true;
+    if (!m_active) {
+        threadEvents.recording.store(false, std::memory_order_release);
+        return;
+    }
+
+    // Only this thread writes to its ring, the count publishes the event.
+    auto eventIndex = threadEvents.eventsCount.load(std::memory_order_relaxed);
+    auto& event = threadEvents.events[eventIndex % EVENTS_PER_THREAD];
+    event.name = name;
+    event.color = color;
+    event.begin = begin;
+    event.end = end;
+    threadEvents.eventsCount.store(eventIndex + 1u, std::memory_order_release);
+    threadEvents.recording.store(false, std::memory_order_release);
+}
+
+void Profiler::threadName(const char* threadName)
+{
+    auto& threadEvents = currentThreadEvents();
+
+    std::scoped_lock lock(m_threadsEventsMutex);
+    threadEvents.threadName = threadName;
+}
+
+// ----- Internal
+
+Profiler::ThreadEvents& Profiler::currentThreadEvents()
+{
+    if (g_currentThreadProfiler == this) {
+        return *reinterpret_cast<ThreadEvents*>(g_currentThreadEvents.get());
+    }
+
+    std::scoped_lock lock(m_threadsEventsMutex);
+    auto& threadEvents = m_threadsEvents.emplace_back(std::make_shared<ThreadEvents>());
+    threadEvents->threadId = ++m_threadsCount;
+
+    g_currentThreadProfiler = this;
+    g_currentThreadEvents = threadEvents;
+    return *threadEvents;
+}
+
+void Profiler::waitRecordings()
+{
+    for (const auto& threadEvents : m_threadsEvents) {
+        while (threadEvents->recording) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void Profiler::forgetExitedThreads()
+{
+    auto threadExited = [](const std::shared_ptr<ThreadEvents>& threadEvents) { return threadEvents.use_count() == 1; };
+    m_threadsEvents.erase(std::remove_if(m_threadsEvents.begin(), m_threadsEvents.end(), threadExited), m_threadsEvents.end());
+}
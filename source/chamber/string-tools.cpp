@@ -1,6 +1,104 @@
 #include <lava/chamber/string-tools.hpp>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LAVA_CHAMBER_STRING_TOOLS_SSE
+#endif
+
 namespace {
+    constexpr uint32_t REPLACEMENT_CODEPOINT = 0xFFFD;
+
+    /// Number of leading bytes below 0x80.
+    inline size_t asciiPrefixLength(const uint8_t* u, size_t size)
+    {
+        size_t i = 0u;
+#if defined(LAVA_CHAMBER_STRING_TOOLS_SSE)
+        for (; i + 16u <= size; i += 16u) {
+            auto mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i)));
+            if (mask != 0) return i + __builtin_ctz(mask);
+        }
+#endif
+        while (i < size && u[i] < 0x80) ++i;
+        return i;
+    }
+
+    /**
+     * Decode one non-ASCII codepoint, checking for truncated, overlong and surrogate sequences.
+     * bytesLength is always at least 1, so that invalid bytes are skipped one at a time.
+     */
+    inline uint32_t decodeMultiByte(const uint8_t* u, size_t size, uint8_t& bytesLength, bool& valid)
+    {
+        auto u0 = u[0];
+        uint32_t codepoint = 0u;
+        uint32_t minCodepoint = 0u;
+
+        if (u0 >= 0xC2 && u0 <= 0xDF) {
+            bytesLength = 2u;
+            codepoint = u0 & 0x1F;
+            minCodepoint = 0x80;
+        }
+        else if (u0 >= 0xE0 && u0 <= 0xEF) {
+            bytesLength = 3u;
+            codepoint = u0 & 0x0F;
+            minCodepoint = 0x800;
+        }
+        else if (u0 >= 0xF0 && u0 <= 0xF4) {
+            bytesLength = 4u;
+            codepoint = u0 & 0x07;
+            minCodepoint = 0x10000;
+        }
+        else {
+            bytesLength = 1u;
+            valid = false;
+            return REPLACEMENT_CODEPOINT;
+        }
+
+        if (bytesLength > size) {
+            bytesLength = 1u;
+            valid = false;
+            return REPLACEMENT_CODEPOINT;
+        }
+
+        for (auto i = 1u; i < bytesLength; ++i) {
+            if ((u[i] & 0xC0) != 0x80) {
+                bytesLength = 1u;
+                valid = false;
+                return REPLACEMENT_CODEPOINT;
+            }
+            codepoint = (codepoint << 6) | (u[i] & 0x3F);
+        }
+
+        if (codepoint < minCodepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF)) {
+            bytesLength = 1u;
+            valid = false;
+            return REPLACEMENT_CODEPOINT;
+        }
+
+        return codepoint;
+    }
+
+    inline void appendUtf8(std::string& s, uint32_t codepoint)
+    {
+        if (codepoint <= 0x7F) {
+            s += static_cast<char>(codepoint);
+        }
+        else if (codepoint <= 0x7FF) {
+            s += static_cast<char>(0xC0 | (codepoint >> 6));
+            s += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint <= 0xFFFF) {
+            s += static_cast<char>(0xE0 | (codepoint >> 12));
+            s += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+        else {
+            s += static_cast<char>(0xF0 | (codepoint >> 18));
+            s += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
     template <class Output, class String, class Character>
     inline std::vector<Output> generalSplit(const String& s, Character c)
     {
@@ -79,16 +177,151 @@ uint32_t chamber::nextWord(const std::string& line, std::string& word, uint32_t
 
 std::string chamber::utf16to8(const std::wstring& ws)
 {
-    using ConvertType = std::codecvt_utf8_utf16<wchar_t>;
-    std::wstring_convert<ConvertType, wchar_t> converter;
-    return converter.to_bytes(ws);
+    std::string s;
+    s.reserve(ws.size());
+
+    for (auto i = 0u; i < ws.size(); ++i) {
+        uint32_t codepoint = static_cast<uint32_t>(ws[i]);
+        if (codepoint <= 0x7F) {
+            s += static_cast<char>(codepoint);
+            continue;
+        }
+
+        // Surrogate pairs, even if wchar_t is 32 bits wide, to be symmetric with utf8to16.
+        if (codepoint >= 0xD800 && codepoint <= 0xDBFF && i + 1u < ws.size()) {
+            uint32_t low = static_cast<uint32_t>(ws[i + 1u]);
+            if (low >= 0xDC00 && low <= 0xDFFF) {
+                codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                ++i;
+            }
+        }
+
+        if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+            codepoint = REPLACEMENT_CODEPOINT;
+        }
+
+        appendUtf8(s, codepoint);
+    }
+
+    return s;
 }
 
 std::wstring chamber::utf8to16(const std::string& s)
 {
-    using ConvertType = std::codecvt_utf8_utf16<wchar_t>;
-    std::wstring_convert<ConvertType, wchar_t> converter;
-    return converter.from_bytes(s);
+    std::wstring ws;
+    ws.resize(s.size());
+
+    auto u = reinterpret_cast<const uint8_t*>(s.data());
+    size_t size = s.size();
+    size_t i = 0u;
+    size_t wsSize = 0u;
+    bool valid = true;
+
+    while (i < size) {
+        auto asciiLength = asciiPrefixLength(u + i, size - i);
+        for (auto j = 0u; j < asciiLength; ++j) {
+            ws[wsSize + j] = u[i + j];
+        }
+        i += asciiLength;
+        wsSize += asciiLength;
+        if (i == size) break;
+
+        uint8_t bytesLength;
+        auto codepoint = decodeMultiByte(u + i, size - i, bytesLength, valid);
+        i += bytesLength;
+
+        // A 4-bytes sequence always gives 2 UTF-16 units, so ws is big enough.
+        if (codepoint >= 0x10000) {
+            codepoint -= 0x10000;
+            ws[wsSize++] = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+            ws[wsSize++] = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+        }
+        else {
+            ws[wsSize++] = static_cast<wchar_t>(codepoint);
+        }
+    }
+
+    ws.resize(wsSize);
+    return ws;
+}
+
+uint32_t chamber::utf8Decode(u8string_view u8Text, uint32_t* codepoints, uint32_t* byteOffsets, bool* valid)
+{
+    auto u = reinterpret_cast<const uint8_t*>(u8Text.data());
+    size_t size = u8Text.size();
+    size_t i = 0u;
+    uint32_t count = 0u;
+    bool allValid = true;
+
+    while (i < size) {
+#if defined(LAVA_CHAMBER_STRING_TOOLS_SSE)
+        // Widening 16 ASCII bytes to 16 codepoints at once.
+        const auto zero = _mm_setzero_si128();
+        for (; i + 16u <= size; i += 16u, count += 16u) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+            if (_mm_movemask_epi8(bytes) != 0) break;
+
+            auto low = _mm_unpacklo_epi8(bytes, zero);
+            auto high = _mm_unpackhi_epi8(bytes, zero);
+            auto out = reinterpret_cast<__m128i*>(codepoints + count);
+            _mm_storeu_si128(out + 0u, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(out + 1u, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(out + 2u, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(out + 3u, _mm_unpackhi_epi16(high, zero));
+
+            if (byteOffsets != nullptr) {
+                auto offsets = _mm_add_epi32(_mm_set1_epi32(i), _mm_setr_epi32(0, 1, 2, 3));
+                auto outOffsets = reinterpret_cast<__m128i*>(byteOffsets + count);
+                for (auto j = 0u; j < 4u; ++j) {
+                    _mm_storeu_si128(outOffsets + j, offsets);
+                    offsets = _mm_add_epi32(offsets, _mm_set1_epi32(4));
+                }
+            }
+        }
+        if (i == size) break;
+#endif
+
+        if (u[i] < 0x80) {
+            if (byteOffsets != nullptr) byteOffsets[count] = i;
+            codepoints[count++] = u[i++];
+            continue;
+        }
+
+        uint8_t bytesLength;
+        if (byteOffsets != nullptr) byteOffsets[count] = i;
+        codepoints[count++] = decodeMultiByte(u + i, size - i, bytesLength, allValid);
+        i += bytesLength;
+    }
+
+    if (valid != nullptr) *valid = allValid;
+    return count;
+}
+
+std::vector<uint32_t> chamber::utf8Decode(u8string_view u8Text)
+{
+    std::vector<uint32_t> codepoints(u8Text.size());
+    codepoints.resize(utf8Decode(u8Text, codepoints.data()));
+    return codepoints;
+}
+
+bool chamber::utf8Validate(u8string_view u8Text)
+{
+    auto u = reinterpret_cast<const uint8_t*>(u8Text.data());
+    size_t size = u8Text.size();
+    size_t i = 0u;
+    bool valid = true;
+
+    while (i < size) {
+        i += asciiPrefixLength(u + i, size - i);
+        if (i == size) break;
+
+        uint8_t bytesLength;
+        decodeMultiByte(u + i, size - i, bytesLength, valid);
+        if (!valid) return false;
+        i += bytesLength;
+    }
+
+    return true;
 }
 
 uint32_t chamber::utf8Codepoint(const uint8_t* u, uint8_t& bytesLength)
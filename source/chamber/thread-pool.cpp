@@ -1,54 +1,263 @@
 #include <lava/chamber/thread-pool.hpp>
 
+#include <lava/chamber/profiler.hpp>
+
 using namespace lava::chamber;
 
-ThreadPool::ThreadPool()
+namespace lava::chamber {
+    struct Job {
+        std::function<void()> function;
+        std::atomic<uint32_t> pendingDependenciesCount = 1u; //!< One more while being added.
+
+        std::mutex continuationsMutex;
+        std::vector<std::shared_ptr<Job>> continuations;
+        std::atomic<bool> done = false;
+    };
+}
+
+namespace {
+    // Which worker of which pool is the current thread.
+    thread_local ThreadPool* g_currentThreadPool = nullptr;
+    thread_local uint32_t g_currentWorkerIndex = 0u;
+}
+
+bool JobHandle::done() const
 {
-    for (auto& thread : m_threads) {
-        m_availableThreads.emplace_back(&thread);
+    return (m_job == nullptr) || m_job->done.load(std::memory_order_acquire);
+}
+
+ThreadPool& lava::chamber::defaultThreadPool()
+{
+    static ThreadPool threadPool;
+    return threadPool;
+}
+
+ThreadPool::ThreadPool(uint32_t threadsCount)
+{
+    if (threadsCount == 0u) {
+        auto hardwareThreadsCount = std::thread::hardware_concurrency();
+        threadsCount = (hardwareThreadsCount > 1u) ? hardwareThreadsCount - 1u : 1u;
+    }
+
+    m_workers.reserve(threadsCount);
+    for (auto i = 0u; i < threadsCount; ++i) {
+        m_workers.emplace_back(std::make_unique<Worker>());
+    }
+
+    // Started once all workers exist, as they might steal from each other.
+    for (auto i = 0u; i < threadsCount; ++i) {
+        m_workers[i]->thread = std::thread(&ThreadPool::run, this, i);
     }
 }
 
-void ThreadPool::job(const std::function<void()>& job)
+ThreadPool::~ThreadPool()
 {
-    std::scoped_lock lock(m_mutex);
+    wait();
 
-    if (m_availableThreads.empty()) {
-        m_pendingJobs.emplace_back(job);
-        return;
+    {
+        std::scoped_lock lock(m_sleepMutex);
+        m_stopping = true;
     }
+    m_sleepCondition.notify_all();
 
-    auto& thread = *m_availableThreads.back();
-    m_availableThreads.pop_back();
-    startJob(thread, job);
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+JobHandle ThreadPool::job(std::function<void()> job)
+{
+    return this->job(std::move(job), {});
+}
+
+JobHandle ThreadPool::job(std::function<void()> function, const std::vector<JobHandle>& dependencies)
+{
+    auto job = std::make_shared<Job>();
+    job->function = std::move(function);
+    m_unfinishedJobsCount += 1u;
+
+    for (const auto& dependency : dependencies) {
+        if (dependency.m_job == nullptr) continue;
+
+        std::scoped_lock lock(dependency.m_job->continuationsMutex);
+        if (!dependency.m_job->done) {
+            job->pendingDependenciesCount += 1u;
+            dependency.m_job->continuations.emplace_back(job);
+        }
+    }
+
+    // Releasing the guard dependency, scheduling right now if nothing else is pending.
+    if (job->pendingDependenciesCount.fetch_sub(1u) == 1u) {
+        schedule(job);
+    }
+
+    return JobHandle(std::move(job));
+}
+
+void ThreadPool::wait(const JobHandle& jobHandle)
+{
+    while (!jobHandle.done()) {
+        if (!help()) {
+            std::this_thread::yield();
+        }
+    }
 }
 
 void ThreadPool::wait()
 {
-    for (auto& thread : m_threads) {
-        thread.wait();
+    while (m_unfinishedJobsCount.load() != 0u) {
+        if (!help()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& fn)
+{
+    if (count == 0u) return;
+
+    // Aiming for a few chunks per worker, so that stealing can balance the load.
+    if (grainSize == 0u) {
+        auto chunksCount = 4u * (m_workers.size() + 1u);
+        grainSize = std::max(1u, static_cast<uint32_t>((count + chunksCount - 1u) / chunksCount));
+    }
+
+    std::vector<JobHandle> jobHandles;
+    jobHandles.reserve(count / grainSize + 1u);
+    for (auto begin = grainSize; begin < count; begin += grainSize) {
+        auto end = std::min(begin + grainSize, count);
+        jobHandles.emplace_back(job([&fn, begin, end] { fn(begin, end); }));
+    }
+
+    // The first chunk is done by the caller.
+    fn(0u, std::min(grainSize, count));
+
+    for (const auto& jobHandle : jobHandles) {
+        wait(jobHandle);
     }
 }
 
 // ----- Internal
 
-void ThreadPool::startJob(Thread& thread, const std::function<void()>& job)
+void ThreadPool::run(uint32_t workerIndex)
+{
+    g_currentThreadPool = this;
+    g_currentWorkerIndex = workerIndex;
+
+    auto threadName = "thread-pool." + std::to_string(workerIndex);
+    profilerThreadName(threadName.c_str());
+
+    while (true) {
+        if (help()) continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this] { return m_stopping || m_pendingJobsCount.load() != 0u; });
+        if (m_stopping && m_pendingJobsCount.load() == 0u) {
+            break;
+        }
+    }
+}
+
+void ThreadPool::schedule(std::shared_ptr<Job> job)
+{
+    // Workers push to their own deque, other threads spread jobs around.
+    auto workerIndex = (g_currentThreadPool == this) ? g_currentWorkerIndex : m_nextWorkerIndex++ % m_workers.size();
+    auto& worker = *m_workers[workerIndex];
+
+    {
+        std::scoped_lock lock(worker.mutex);
+        worker.jobs.emplace_back(std::move(job));
+    }
+
+    // @note Locking the sleep mutex, even empty, ensures that no worker
+    // misses the notification between its check and its wait.
+    m_pendingJobsCount += 1u;
+    { std::scoped_lock lock(m_sleepMutex); }
+    m_sleepCondition.notify_one();
+}
+
+std::shared_ptr<Job> ThreadPool::popJob()
 {
-    thread.job([this, job, &thread] {
-        job();
-        jobFinished(thread);
-    });
+    if (m_pendingJobsCount.load() == 0u) return nullptr;
+
+    const auto workersCount = m_workers.size();
+    const bool isWorker = (g_currentThreadPool == this);
+
+    // Own jobs first, most recent one is the most likely to be in cache.
+    if (isWorker) {
+        auto& worker = *m_workers[g_currentWorkerIndex];
+        std::scoped_lock lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            auto job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            m_pendingJobsCount -= 1u;
+            return job;
+        }
+    }
+
+    // Steal the oldest job of someone else, skipping busy workers at first.
+    auto steal = [this](Worker& worker) {
+        std::shared_ptr<Job> job;
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+            m_pendingJobsCount -= 1u;
+        }
+        return job;
+    };
+
+    auto firstWorkerIndex = isWorker ? g_currentWorkerIndex + 1u : 0u;
+    bool contended = false;
+    for (auto i = 0u; i < workersCount; ++i) {
+        auto& worker = *m_workers[(firstWorkerIndex + i) % workersCount];
+        std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            contended = true;
+            continue;
+        }
+
+        if (auto job = steal(worker)) return job;
+    }
+
+    // @note Jobs are pending but the workers holding them were busy,
+    // so we wait for their locks instead of spinning over try-locks.
+    if (contended) {
+        for (auto i = 0u; i < workersCount; ++i) {
+            auto& worker = *m_workers[(firstWorkerIndex + i) % workersCount];
+            std::scoped_lock lock(worker.mutex);
+            if (auto job = steal(worker)) return job;
+        }
+    }
+
+    return nullptr;
 }
 
-void ThreadPool::jobFinished(Thread& thread)
+void ThreadPool::execute(Job& job)
 {
-    std::scoped_lock lock(m_mutex);
+    job.function();
+    job.function = nullptr;
 
-    if (!m_pendingJobs.empty()) {
-        auto pendingJob = m_pendingJobs.back();
-        m_pendingJobs.pop_back();
-        startJob(thread, pendingJob);
-    } else {
-        m_availableThreads.emplace_back(&thread);
+    std::vector<std::shared_ptr<Job>> continuations;
+    {
+        std::scoped_lock lock(job.continuationsMutex);
+        job.done.store(true, std::memory_order_release);
+        continuations.swap(job.continuations);
     }
+
+    for (auto& continuation : continuations) {
+        if (continuation->pendingDependenciesCount.fetch_sub(1u) == 1u) {
+            schedule(std::move(continuation));
+        }
+    }
+
+    m_unfinishedJobsCount -= 1u;
+}
+
+bool ThreadPool::help()
+{
+    auto job = popJob();
+    if (job == nullptr) return false;
+
+    execute(*job);
+    return true;
 }
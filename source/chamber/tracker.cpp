@@ -1,12 +1,353 @@
 #include <lava/chamber/tracker.hpp>
 
+#include <lava/chamber/logger.hpp>
+
 using namespace lava;
 
 chamber::Tracker chamber::tracker;
 
+namespace {
+    // Keeps the current thread's shard alive, and retires it when the thread exits.
+    struct ThreadShard {
+        chamber::Tracker* tracker = nullptr;
+        std::shared_ptr<void> shard;
+        std::atomic<bool>* retired = nullptr;
+
+        ~ThreadShard()
+        {
+            if (retired != nullptr) retired->store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadShard g_currentThreadShard;
+
+    // Power-of-two buckets, centered so that [2^-24, 2^24[ is covered.
+    constexpr const int32_t HISTOGRAM_BUCKETS_OFFSET = 24;
+
+    uint32_t histogramBucketIndex(double value)
+    {
+        if (value <= 0.0) return 0u;
+        auto bucketIndex = std::ilogb(value) + HISTOGRAM_BUCKETS_OFFSET;
+        return std::clamp<int32_t>(bucketIndex, 0, chamber::Tracker::HISTOGRAM_BUCKETS_COUNT - 1u);
+    }
+
+    double histogramBucketUpperBound(uint32_t bucketIndex)
+    {
+        return std::ldexp(1.0, static_cast<int32_t>(bucketIndex) - HISTOGRAM_BUCKETS_OFFSET + 1);
+    }
+
+    template <class Slot, size_t N>
+    Slot* findSlot(std::array<Slot, N>& slots, const chamber::TrackerKey& key)
+    {
+        // Open addressing, slots are never removed.
+        for (auto i = 0u; i < N; ++i) {
+            auto& slot = slots[(key.hash() + i) % N];
+            if (slot.hash == key.hash()) return &slot;
+            if (slot.hash == 0u) {
+                slot.hash = key.hash();
+                slot.name = key.name();
+                return &slot;
+            }
+        }
+
+        return nullptr;
+    }
+
+    uint64_t nowNanoseconds()
+    {
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+    }
+}
+
 using namespace lava::chamber;
 
-uint32_t& Tracker::counter(const std::string& category)
+const TrackerFrame::Metric* TrackerFrame::find(const TrackerKey& key) const
+{
+    for (const auto& metric : metrics) {
+        if (metric.hash == key.hash()) return &metric;
+    }
+    return nullptr;
+}
+
+void Tracker::add(const TrackerKey& key, uint64_t value)
+{
+    auto& shard = currentThreadShard();
+    auto& half = beginWrite(shard);
+
+    auto metric = findSlot(half.metrics, key);
+    if (metric != nullptr) {
+        metric->kind = TrackerMetricKind::Counter;
+        metric->counter += value;
+    }
+
+    endWrite(shard);
+    if (metric == nullptr) warnFull(key);
+}
+
+void Tracker::gauge(const TrackerKey& key, double value)
+{
+    auto& shard = currentThreadShard();
+    auto& half = beginWrite(shard);
+
+    auto metric = findSlot(half.metrics, key);
+    if (metric != nullptr) {
+        metric->kind = TrackerMetricKind::Gauge;
+        metric->gauge = value;
+        metric->gaugeStamp = nowNanoseconds();
+    }
+
+    endWrite(shard);
+    if (metric == nullptr) warnFull(key);
+}
+
+void Tracker::sample(const TrackerKey& key, double value)
+{
+    auto& shard = currentThreadShard();
+    auto& half = beginWrite(shard);
+
+    auto histogram = findSlot(half.histograms, key);
+    if (histogram != nullptr) {
+        if (histogram->count == 0u) {
+            histogram->min = value;
+            histogram->max = value;
+        }
+        else {
+            histogram->min = std::min(histogram->min, value);
+            histogram->max = std::max(histogram->max, value);
+        }
+
+        histogram->count += 1u;
+        histogram->sum += value;
+        histogram->buckets[histogramBucketIndex(value)] += 1u;
+    }
+
+    endWrite(shard);
+    if (histogram == nullptr) warnFull(key);
+}
+
+void Tracker::endFrame()
+{
+    auto frameEndTime = nowNanoseconds();
+
+    auto& frame = m_frames[m_framesCount % FRAMES_HISTORY_COUNT];
+    frame.frameId = m_framesCount;
+    frame.duration = (m_lastFrameEndTime == 0u) ? 0.f : (frameEndTime - m_lastFrameEndTime) / 1'000'000'000.f;
+    frame.metrics.clear();
+
+    m_framesCount += 1u;
+    m_lastFrameEndTime = frameEndTime;
+
+    // Threads now write to the other half, the merged one is only waited for
+    // by the threads that were writing to it right before the flip.
+    const auto mergedHalfIndex = m_writtenHalf.load();
+    m_writtenHalf.store(1u - mergedHalfIndex);
+
+    // Kept aside so that gauges set by multiple threads resolve to the latest one.
+    std::vector<uint64_t> gaugeStamps;
+    std::vector<std::array<uint32_t, HISTOGRAM_BUCKETS_COUNT>> histogramsBuckets;
+
+    auto findOrAdd = [&frame](uint64_t hash, const char* name, TrackerMetricKind kind) -> uint32_t {
+        for (auto i = 0u; i < frame.metrics.size(); ++i) {
+            if (frame.metrics[i].hash == hash) return i;
+        }
+        auto& metric = frame.metrics.emplace_back();
+        metric.hash = hash;
+        metric.name = name;
+        metric.kind = kind;
+        return frame.metrics.size() - 1u;
+    };
+
+    std::scoped_lock shardsLock(m_shardsMutex);
+    std::vector<const Shard*> retiredShards;
+    for (auto& shard : m_shards) {
+        // Checked before waiting, so that no write of an exited thread can be missed.
+        const bool retired = shard->retired.load(std::memory_order_acquire);
+        if (retired) retiredShards.emplace_back(shard.get());
+        while (shard->writing.load()) {
+            std::this_thread::yield();
+        }
+
+        // A retired shard will not be written anymore, both halves are merged.
+        for (auto halfIndex = 0u; halfIndex < 2u; ++halfIndex) {
+            if (halfIndex != mergedHalfIndex && !retired) continue;
+            auto& half = shard->halves[halfIndex];
+
+            for (auto& shardMetric : half.metrics) {
+                if (shardMetric.hash == 0u) continue;
+
+                if (shardMetric.kind == TrackerMetricKind::Counter) {
+                    auto metricIndex = findOrAdd(shardMetric.hash, shardMetric.name, shardMetric.kind);
+                    frame.metrics[metricIndex].value += shardMetric.counter;
+                    shardMetric.counter = 0u;
+                    continue;
+                }
+
+                if (shardMetric.gaugeStamp == 0u) continue;
+                auto gaugeIt = std::find_if(m_gauges.begin(), m_gauges.end(),
+                                            [&](const Gauge& gauge) { return gauge.hash == shardMetric.hash; });
+                if (gaugeIt == m_gauges.end()) {
+                    gaugeIt = m_gauges.insert(m_gauges.end(), Gauge{shardMetric.hash, shardMetric.name, 0.0});
+                }
+                gaugeStamps.resize(m_gauges.size(), 0u);
+                auto gaugeIndex = gaugeIt - m_gauges.begin();
+                if (shardMetric.gaugeStamp >= gaugeStamps[gaugeIndex]) {
+                    gaugeIt->value = shardMetric.gauge;
+                    gaugeStamps[gaugeIndex] = shardMetric.gaugeStamp;
+                }
+                shardMetric.gaugeStamp = 0u;
+            }
+
+            for (auto& shardHistogram : half.histograms) {
+                if (shardHistogram.hash == 0u) continue;
+
+                auto metricIndex = findOrAdd(shardHistogram.hash, shardHistogram.name, TrackerMetricKind::Histogram);
+                auto& metric = frame.metrics[metricIndex];
+                histogramsBuckets.resize(frame.metrics.size(), {});
+
+                if (shardHistogram.count != 0u) {
+                    metric.min = (metric.count == 0u) ? shardHistogram.min : std::min(metric.min, shardHistogram.min);
+                    metric.max = (metric.count == 0u) ? shardHistogram.max : std::max(metric.max, shardHistogram.max);
+                    metric.count += shardHistogram.count;
+                    metric.value += shardHistogram.sum; // Summed for now, averaged below.
+
+                    for (auto i = 0u; i < HISTOGRAM_BUCKETS_COUNT; ++i) {
+                        histogramsBuckets[metricIndex][i] += shardHistogram.buckets[i];
+                    }
+                }
+
+                shardHistogram.count = 0u;
+                shardHistogram.sum = 0.0;
+                shardHistogram.buckets.fill(0u);
+            }
+        }
+    }
+
+    // Freeing the shards of exited threads
+    m_shards.erase(std::remove_if(m_shards.begin(), m_shards.end(),
+                                  [&](const auto& shard) {
+                                      return std::find(retiredShards.begin(), retiredShards.end(), shard.get()) != retiredShards.end();
+                                  }),
+                   m_shards.end());
+
+    // Gauges, even the ones not set this frame
+    for (const auto& gauge : m_gauges) {
+        auto metricIndex = findOrAdd(gauge.hash, gauge.name, TrackerMetricKind::Gauge);
+        frame.metrics[metricIndex].value = gauge.value;
+    }
+
+    // Finalizing histograms
+    for (auto metricIndex = 0u; metricIndex < frame.metrics.size(); ++metricIndex) {
+        auto& metric = frame.metrics[metricIndex];
+        if (metric.kind != TrackerMetricKind::Histogram || metric.count == 0u) continue;
+
+        metric.value /= metric.count;
+
+        const auto& buckets = histogramsBuckets[metricIndex];
+        auto p50Count = (metric.count + 1u) / 2u;
+        auto p99Count = metric.count - metric.count / 100u;
+        auto cumulatedCount = 0u;
+        for (auto i = 0u; i < HISTOGRAM_BUCKETS_COUNT; ++i) {
+            if (buckets[i] == 0u) continue;
+            auto bucketBound = std::min(histogramBucketUpperBound(i), metric.max);
+            if (cumulatedCount < p50Count && cumulatedCount + buckets[i] >= p50Count) metric.p50 = bucketBound;
+            if (cumulatedCount < p99Count && cumulatedCount + buckets[i] >= p99Count) metric.p99 = bucketBound;
+            cumulatedCount += buckets[i];
+        }
+    }
+}
+
+double Tracker::counter(const TrackerKey& key) const
+{
+    if (m_framesCount == 0u) return 0.0;
+
+    auto metric = frame().find(key);
+    return (metric != nullptr) ? metric->value : 0.0;
+}
+
+const TrackerFrame& Tracker::frame(uint32_t age) const
 {
-    return m_counters[category];
+    auto frameIndex = (m_framesCount + FRAMES_HISTORY_COUNT - 1u - age) % FRAMES_HISTORY_COUNT;
+    return m_frames[frameIndex];
+}
+
+void Tracker::exportCsv(std::ostream& stream) const
+{
+    // Columns are the union of all metrics seen in the kept frames.
+    std::vector<std::pair<uint64_t, std::string>> columns;
+    auto framesCount = this->framesCount();
+    for (auto age = framesCount; age-- > 0u;) {
+        for (const auto& metric : frame(age).metrics) {
+            auto columnIt = std::find_if(columns.begin(), columns.end(), [&](const auto& column) { return column.first == metric.hash; });
+            if (columnIt == columns.end()) {
+                columns.emplace_back(metric.hash, metric.name);
+            }
+        }
+    }
+
+    stream << "frame,duration";
+    for (const auto& column : columns) {
+        stream << "," << column.second;
+    }
+    stream << std::endl;
+
+    for (auto age = framesCount; age-- > 0u;) {
+        const auto& frame = this->frame(age);
+        stream << frame.frameId << "," << frame.duration;
+        for (const auto& column : columns) {
+            stream << ",";
+            for (const auto& metric : frame.metrics) {
+                if (metric.hash == column.first) {
+                    stream << metric.value;
+                    break;
+                }
+            }
+        }
+        stream << std::endl;
+    }
+}
+
+// ----- Internal
+
+Tracker::Shard::Half& Tracker::beginWrite(Shard& shard)
+{
+    // @note Sequentially consistent, so that endFrame() either sees us writing,
+    // or we see the half it flipped to.
+    shard.writing.store(true);
+    return shard.halves[m_writtenHalf.load()];
+}
+
+void Tracker::endWrite(Shard& shard)
+{
+    shard.writing.store(false, std::memory_order_release);
+}
+
+void Tracker::warnFull(const TrackerKey& key)
+{
+    if (m_fullWarned.exchange(true)) return;
+    logger.warning("chamber.tracker") << "No more slots in thread shard, '" << key.name() << "' and further new metrics are dropped."
+                                      << std::endl;
+}
+
+Tracker::Shard& Tracker::currentThreadShard()
+{
+    if (g_currentThreadShard.tracker == this) {
+        return *reinterpret_cast<Shard*>(g_currentThreadShard.shard.get());
+    }
+
+    // The thread was writing to another tracker, that shard is retired.
+    if (g_currentThreadShard.retired != nullptr) {
+        g_currentThreadShard.retired->store(true, std::memory_order_release);
+    }
+
+    auto shard = std::make_shared<Shard>();
+    {
+        std::scoped_lock lock(m_shardsMutex);
+        m_shards.emplace_back(shard);
+    }
+
+    g_currentThreadShard.tracker = this;
+    g_currentThreadShard.retired = &shard->retired;
+    g_currentThreadShard.shard = std::move(shard);
+    return *reinterpret_cast<Shard*>(g_currentThreadShard.shard.get());
 }
@@ -116,21 +116,12 @@ void RigidBody::Impl::addInfinitePlaneShape(const glm::vec3& offset, const glm::
 
 void RigidBody::Impl::addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const std::vector<uint16_t>& indices)
 {
-    btIndexedMesh indexedMesh;
-    indexedMesh.m_numTriangles = indices.size() / 3u;
-    indexedMesh.m_triangleIndexBase = reinterpret_cast<const uint8_t*>(&indices[0u]);
-    indexedMesh.m_triangleIndexStride = 3u * sizeof(uint16_t);
-    indexedMesh.m_numVertices = vertices.size();
-    indexedMesh.m_vertexBase = reinterpret_cast<const uint8_t*>(&vertices[0u]);
-    indexedMesh.m_vertexStride = vertices.stride();
-    indexedMesh.m_indexType = PHY_SHORT;
-    indexedMesh.m_vertexType = PHY_FLOAT;
-
-    auto& meshShapeArray = *m_meshShapeArrays.emplace_back(std::make_unique<btTriangleIndexVertexArray>());
-    meshShapeArray.addIndexedMesh(indexedMesh, PHY_SHORT);
+    addMeshShape(localTransform, vertices, reinterpret_cast<const uint8_t*>(&indices[0u]), indices.size(), PHY_SHORT, sizeof(uint16_t));
+}
 
-    auto pShape = std::make_unique<btBvhTriangleMeshShape>(&meshShapeArray, true);
-    addShape(localTransform, std::move(pShape));
+void RigidBody::Impl::addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const std::vector<uint32_t>& indices)
+{
+    addMeshShape(localTransform, vertices, reinterpret_cast<const uint8_t*>(&indices[0u]), indices.size(), PHY_INTEGER, sizeof(uint32_t));
 }
 
 // ----- Helpers
@@ -186,6 +177,26 @@ void RigidBody::Impl::addShape(const glm::mat4& localTransform, std::unique_ptr<
     updateShape();
 }
 
+void RigidBody::Impl::addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const uint8_t* indices,
+                                   uint32_t indicesCount, PHY_ScalarType indexType, uint32_t indexSize)
+{
+    btIndexedMesh indexedMesh;
+    indexedMesh.m_numTriangles = indicesCount / 3u;
+    indexedMesh.m_triangleIndexBase = indices;
+    indexedMesh.m_triangleIndexStride = 3u * indexSize;
+    indexedMesh.m_numVertices = vertices.size();
+    indexedMesh.m_vertexBase = reinterpret_cast<const uint8_t*>(&vertices[0u]);
+    indexedMesh.m_vertexStride = vertices.stride();
+    indexedMesh.m_indexType = indexType;
+    indexedMesh.m_vertexType = PHY_FLOAT;
+
+    auto& meshShapeArray = *m_meshShapeArrays.emplace_back(std::make_unique<btTriangleIndexVertexArray>());
+    meshShapeArray.addIndexedMesh(indexedMesh, indexType);
+
+    auto pShape = std::make_unique<btBvhTriangleMeshShape>(&meshShapeArray, true);
+    addShape(localTransform, std::move(pShape));
+}
+
 void RigidBody::Impl::updateShape()
 {
     if (m_rigidBody != nullptr) {
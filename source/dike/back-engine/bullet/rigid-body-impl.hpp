@@ -17,6 +17,7 @@ namespace lava::dike {
         void addSphereShape(const glm::vec3& offset, float diameter);
         void addInfinitePlaneShape(const glm::vec3& offset, const glm::vec3& normal);
         void addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const std::vector<uint16_t>& indices);
+        void addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const std::vector<uint32_t>& indices);
 
         // Physics world
         bool enabled() const { return m_enabled; }
@@ -36,6 +37,8 @@ namespace lava::dike {
     protected:
         // Internal
         void addShape(const glm::mat4& localTransform, std::unique_ptr<btCollisionShape>&& pShape);
+        void addMeshShape(const glm::mat4& localTransform, const VectorView<glm::vec3>& vertices, const uint8_t* indices,
+                          uint32_t indicesCount, PHY_ScalarType indexType, uint32_t indexSize);
         void updateShape();
 
     private:
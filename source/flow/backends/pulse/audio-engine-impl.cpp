@@ -44,7 +44,7 @@ void AudioEngineImpl::waitUntilContextReady()
     while (timeLimit >= time(nullptr)) {
         pa_mainloop_iterate(m_mainLoop, 0, nullptr);
         if (PA_CONTEXT_READY == pa_context_get_state(m_context)) {
-            logger.info("flow.pulse.audio-engine") << "Context connected." << std::endl;
+            $log_info("flow.pulse.audio-engine") << "Context connected." << std::endl;
             return;
         }
     }
@@ -23,8 +23,8 @@ void SoundBaseImpl::position(const glm::vec3& position)
 
 SoundBaseImpl::Buffer SoundBaseImpl::applyEffects(Buffer buffer)
 {
-    // Copy the data so we can modify them!
-    m_buffer = std::vector<float>(buffer.data, buffer.data + buffer.size);
+    // Copy the data so we can modify them, reusing the previous capacity.
+    m_buffer.assign(buffer.data, buffer.data + buffer.size);
     m_bufferSamplesCount = buffer.samplesCount;
 
     applyMonoEffects();
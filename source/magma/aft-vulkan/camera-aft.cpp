@@ -3,6 +3,8 @@
 #include <lava/magma/camera.hpp>
 #include <lava/magma/scene.hpp>
 
+#include "../vulkan/render-engine-impl.hpp"
+#include "../vulkan/render-image-impl.hpp"
 #include "./scene-aft.hpp"
 
 using namespace lava::magma;
@@ -13,6 +15,11 @@ CameraAft::CameraAft(Camera& fore, Scene& scene)
 {
 }
 
+CameraAft::~CameraAft()
+{
+    m_scene.engine().impl().readbackQueue().forget(this);
+}
+
 void CameraAft::render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t pushConstantOffset) const
 {
     commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
@@ -36,9 +43,28 @@ RenderImage CameraAft::foreDepthRenderImage() const
     return m_scene.aft().cameraDepthRenderImage(m_fore);
 }
 
+void CameraAft::foreReadback(ReadbackCallback callback, const ReadbackOptions& options)
+{
+    // @note The image is known only when the read happens, as it is recreated on resize.
+    auto imageInfo = [this] {
+        const auto renderImage = m_scene.aft().cameraRenderImage(m_fore);
+        const auto& renderImageImpl = renderImage.impl();
+
+        vulkan::ReadbackImageInfo info;
+        info.image = renderImageImpl.image();
+        info.format = renderImageImpl.format();
+        info.extent = renderImageImpl.extent();
+        info.layout = renderImageImpl.layout();
+        return info;
+    };
+
+    m_scene.engine().impl().readbackQueue().read(this, imageInfo, options, std::move(callback));
+}
+
 void CameraAft::foreExtentChanged()
 {
-    m_scene.aft().updateCamera(m_fore);
+    // @note Resizing sends many extent changes, only the last one matters.
+    m_scene.aft().updateCameraLater(m_fore);
 }
 
 void CameraAft::forePolygonModeChanged()
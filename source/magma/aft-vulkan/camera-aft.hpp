@@ -1,5 +1,6 @@
 #pragma once
 
+#include <lava/magma/readback.hpp>
 #include <lava/magma/render-image.hpp>
 
 namespace lava::magma {
@@ -11,6 +12,7 @@ namespace lava::magma {
     class CameraAft {
     public:
         CameraAft(Camera& fore, Scene& scene);
+        ~CameraAft();
 
         void render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t pushConstantOffset) const;
         void changeImageLayout(vk::ImageLayout imageLayout, vk::CommandBuffer commandBuffer);
@@ -18,6 +20,7 @@ namespace lava::magma {
         // ----- Fore
         RenderImage foreRenderImage() const;
         RenderImage foreDepthRenderImage() const;
+        void foreReadback(ReadbackCallback callback, const ReadbackOptions& options);
         void foreExtentChanged();
         void forePolygonModeChanged();
 
@@ -12,6 +12,13 @@ namespace lava::magma {
      */
     constexpr static const uint8_t FRAME_IDS_COUNT = 3u;
 
+    /**
+     * How many frames can be submitted to the GPU and not yet retired.
+     * Frame ids resources are written before waiting for a frame slot,
+     * so there is always one more frame id than frames in flight.
+     */
+    constexpr static const uint8_t FRAMES_IN_FLIGHT_COUNT = FRAME_IDS_COUNT - 1u;
+
     /**
      * Each shadow map cascade image size expressed in pixels.
      */
@@ -4,6 +4,7 @@
 #include <lava/magma/scene.hpp>
 #include <lava/magma/texture.hpp>
 
+#include "../helpers/hash.hpp"
 #include "../vulkan/render-engine-impl.hpp"
 #include "./scene-aft.hpp"
 #include "./texture-aft.hpp"
@@ -20,7 +21,8 @@ MaterialAft::MaterialAft(Material& fore, Scene& scene)
 
 MaterialAft::~MaterialAft()
 {
-    m_scene.engine().impl().device().waitIdle();
+    // @note UBOs are handled by their buffer holders.
+    m_scene.engine().impl().deletionQueue().destroyLater(std::move(m_descriptorSets));
 }
 
 void MaterialAft::init()
@@ -56,6 +58,14 @@ void MaterialAft::render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pip
                                      &m_descriptorSets[m_currentFrameId].get(), 0, nullptr);
 }
 
+bool MaterialAft::sameBindings(const MaterialAft& other) const
+{
+    if (&other == this) return true;
+    if (m_bindingsHash != other.m_bindingsHash) return false;
+    if (m_imageViews != other.m_imageViews || m_cubeImageView != other.m_cubeImageView) return false;
+    return std::memcmp(&m_fore.ubo(), &other.m_fore.ubo(), sizeof(MaterialUbo)) == 0;
+}
+
 // ----- Updates
 
 void MaterialAft::updateBindings()
@@ -68,6 +78,7 @@ void MaterialAft::updateBindings()
 
     // MaterialUbo
     m_uboHolders[m_currentFrameId].copy(0, m_fore.ubo());
+    m_bindingsHash = hashBytes(&m_fore.ubo(), sizeof(MaterialUbo));
 
     // Samplers
     const auto& engine = m_scene.engine().impl();
@@ -80,6 +91,7 @@ void MaterialAft::updateBindings()
     // Force all samplers to white image view by default.
     for (auto i = 0u; i < MATERIAL_SAMPLERS_SIZE; ++i) {
         vulkan::updateDescriptorSet(engine.device(), descriptorSet, imageView, sampler, imageLayout, binding, i);
+        m_imageViews[i] = imageView;
     }
 
     for (const auto& attributePair : m_fore.attributes()) {
@@ -102,6 +114,10 @@ void MaterialAft::updateBindings()
             // m_scene.materialDescriptorHolder().updateSet(descriptorSet, imageView, imageLayout, )
             vulkan::updateDescriptorSet(engine.device(), descriptorSet, imageView, sampler, imageLayout, binding,
                                         attribute.offset);
+            m_imageViews[attribute.offset] = imageView;
+
+            // @note Attributes are not iterated in a known order, so their hashes are xored.
+            m_bindingsHash ^= hashBytes(&imageView, sizeof(vk::ImageView), attribute.offset);
         }
     }
 
@@ -110,6 +126,7 @@ void MaterialAft::updateBindings()
     // Force white cube
     auto cubeImageView = engine.dummyCubeImageView();
     vulkan::updateDescriptorSet(engine.device(), descriptorSet, cubeImageView, sampler, imageLayout, binding + 1);
+    m_cubeImageView = cubeImageView;
 
     for (const auto& attributePair : m_fore.attributes()) {
         const auto& attribute = attributePair.second;
@@ -122,6 +139,8 @@ void MaterialAft::updateBindings()
             }
 
             vulkan::updateDescriptorSet(engine.device(), descriptorSet, cubeImageView, sampler, imageLayout, binding + 1);
+            m_cubeImageView = cubeImageView;
+            m_bindingsHash ^= hashBytes(&cubeImageView, sizeof(vk::ImageView), binding + 1);
         }
     }
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <lava/magma/ubos.hpp> // MATERIAL_SAMPLERS_SIZE
+
 #include "../vulkan/holders/ubo-holder.hpp"
 #include "./config.hpp"
 
@@ -18,6 +20,12 @@ namespace lava::magma {
         void update();
         void render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t descriptorSetIndex) const;
 
+        /// Same for materials binding identical data, which can then be bound one for another.
+        uint64_t bindingsHash() const { return m_bindingsHash; }
+
+        /// Whether both materials bind the same UBO content and image views, so that one can be bound for the other.
+        bool sameBindings(const MaterialAft& other) const;
+
         // ----- Fore
         void foreUboChanged() { m_uboDirty = true; }
         void foreGlobalUboChanged() { m_globalUboDirty = true; }
@@ -37,5 +45,8 @@ namespace lava::magma {
         std::array<vulkan::UboHolder, FRAME_IDS_COUNT> m_uboHolders;
         bool m_uboDirty = false;
         bool m_globalUboDirty = false;
+        uint64_t m_bindingsHash = 0u;
+        std::array<vk::ImageView, MATERIAL_SAMPLERS_SIZE> m_imageViews;
+        vk::ImageView m_cubeImageView;
     };
 }
@@ -4,6 +4,7 @@
 #include <lava/magma/mesh.hpp>
 #include <lava/magma/scene.hpp>
 
+#include "../helpers/hash.hpp"
 #include "../vulkan/render-engine-impl.hpp"
 #include "./material-aft.hpp"
 #include "./scene-aft.hpp"
@@ -16,65 +17,160 @@ MeshAft::MeshAft(Mesh& fore, Scene& scene)
     , m_scene(scene)
     , m_unlitVertexBufferHolder(m_scene.engine().impl(), "mesh.unlit-vertex")
     , m_vertexBufferHolder(m_scene.engine().impl(), "mesh.vertex")
-    , m_instanceBufferHolder(m_scene.engine().impl(), "mesh.instance")
     , m_indexBufferHolder(m_scene.engine().impl(), "mesh.index")
 {
+    m_instanceBuffers.reserve(FRAME_IDS_COUNT);
+    for (auto i = 0u; i < FRAME_IDS_COUNT; ++i) {
+        m_instanceBuffers.emplace_back(InstanceBuffer{{m_scene.engine().impl(), "mesh.instance#" + std::to_string(i)}});
+    }
+}
+
+MeshAft::~MeshAft()
+{
+    forgetGeometry();
 }
 
 void MeshAft::update()
 {
+    m_currentFrameId = (m_currentFrameId + 1u) % FRAME_IDS_COUNT;
+
     if (m_vertexBufferDirty) {
         createVertexBuffers();
     }
 
-    if (m_instanceBufferDirty) {
-        createInstanceBuffer();
+    // @note Done once both vertices and indices are uploaded, as they usually change one after the other.
+    if (m_geometryDirty) {
+        updateGeometry();
     }
+
+    updateInstanceBuffer();
 }
 
-void MeshAft::render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout,
-                     uint32_t materialDescriptorSetIndex) const
+void MeshAft::render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex,
+                     const vulkan::VisibleInstances* visibleInstances) const
 {
-    if (!m_fore.enabled() || m_fore.indices().empty()) return;
+    if (!renderable()) return;
 
     // Bind the material
-    // @todo :CleverMaterialBinding Have this in a more clever render loop, and not called by this mesh
-    // Fact is we shouldn't know about the correct descriptorSetIndex here
-    if (m_fore.material() != nullptr) {
-        m_fore.material()->aft().render(commandBuffer, pipelineLayout, materialDescriptorSetIndex);
-    }
-    else {
-        m_scene.fallbackMaterial()->aft().render(commandBuffer, pipelineLayout, materialDescriptorSetIndex);
-    }
+    // @note Render loops that care about redundant binds should use a vulkan::RenderQueue.
+    materialAft().render(commandBuffer, pipelineLayout, materialDescriptorSetIndex);
 
     // Add the vertex buffer
     vk::DeviceSize offsets[] = {0};
     commandBuffer.bindVertexBuffers(0, 1, &m_vertexBufferHolder.buffer(), offsets);
-    commandBuffer.bindVertexBuffers(1, 1, &m_instanceBufferHolder.buffer(), offsets);
-    commandBuffer.bindIndexBuffer(m_indexBufferHolder.buffer(), 0, vk::IndexType::eUint16);
+    auto instancesCount = bindInstances(commandBuffer, visibleInstances);
+    commandBuffer.bindIndexBuffer(m_indexBufferHolder.buffer(), 0, indexType());
 
     // Draw
-    commandBuffer.drawIndexed(m_fore.indices().size(), m_fore.instancesCount(), 0, 0, 0);
+    commandBuffer.drawIndexed(indicesCount(), instancesCount, 0, 0, 0);
 }
 
-void MeshAft::renderUnlit(vk::CommandBuffer commandBuffer) const
+void MeshAft::renderUnlit(vk::CommandBuffer commandBuffer, const vulkan::VisibleInstances* visibleInstances) const
 {
-    if (!m_fore.enabled() || m_fore.indices().empty()) return;
+    if (!renderable()) return;
 
     // Add the vertex buffer
     vk::DeviceSize offsets[] = {0};
     commandBuffer.bindVertexBuffers(0, 1, &m_unlitVertexBufferHolder.buffer(), offsets);
-    commandBuffer.bindVertexBuffers(1, 1, &m_instanceBufferHolder.buffer(), offsets);
-    commandBuffer.bindIndexBuffer(m_indexBufferHolder.buffer(), 0, vk::IndexType::eUint16);
+    auto instancesCount = bindInstances(commandBuffer, visibleInstances);
+    commandBuffer.bindIndexBuffer(m_indexBufferHolder.buffer(), 0, indexType());
 
     // Draw
-    commandBuffer.drawIndexed(m_fore.indices().size(), m_fore.instancesCount(), 0, 0, 0);
+    commandBuffer.drawIndexed(indicesCount(), instancesCount, 0, 0, 0);
+}
+
+// ----- Bindings
+
+bool MeshAft::renderable() const
+{
+    return m_fore.enabled() && m_fore.indicesCount() > 0u;
+}
+
+const MaterialAft& MeshAft::materialAft() const
+{
+    if (m_fore.material() != nullptr) {
+        return m_fore.material()->aft();
+    }
+    return m_scene.fallbackMaterial()->aft();
+}
+
+uint32_t MeshAft::indicesCount() const
+{
+    return m_fore.indicesCount();
+}
+
+vk::IndexType MeshAft::indexType() const
+{
+    return m_fore.indicesWide() ? vk::IndexType::eUint32 : vk::IndexType::eUint16;
+}
+
+uint32_t MeshAft::instances(const vulkan::VisibleInstances* visibleInstances, vk::Buffer& buffer, vk::DeviceSize& offset) const
+{
+    if (visibleInstances != nullptr && visibleInstances->buffer) {
+        buffer = visibleInstances->buffer;
+        offset = visibleInstances->offset;
+        return visibleInstances->count;
+    }
+
+    buffer = m_instanceBuffers[m_currentFrameId].holder.buffer();
+    offset = 0u;
+    return m_fore.instancesCount();
+}
+
+bool MeshAft::sameGeometry(const MeshAft& other) const
+{
+    const auto& vertices = m_fore.vertices();
+    const auto& otherVertices = other.m_fore.vertices();
+    if (vertices.size() != otherVertices.size()) return false;
+    if (m_fore.indicesCount() != other.m_fore.indicesCount() || m_fore.indicesWide() != other.m_fore.indicesWide()) return false;
+
+    if (std::memcmp(vertices.data(), otherVertices.data(), sizeof(Vertex) * vertices.size()) != 0) return false;
+
+    const auto& unlitVertices = m_fore.unlitVertices();
+    const auto& otherUnlitVertices = other.m_fore.unlitVertices();
+    if (unlitVertices.size() != otherUnlitVertices.size()) return false;
+    if (std::memcmp(unlitVertices.data(), otherUnlitVertices.data(), sizeof(UnlitVertex) * unlitVertices.size()) != 0) return false;
+
+    if (m_fore.indicesWide()) {
+        return std::memcmp(m_fore.indices32().data(), other.m_fore.indices32().data(), sizeof(uint32_t) * m_fore.indicesCount()) == 0;
+    }
+    return std::memcmp(m_fore.indices16().data(), other.m_fore.indices16().data(), sizeof(uint16_t) * m_fore.indicesCount()) == 0;
 }
 
 // ----- Fore
 
+void MeshAft::foreVerticesChanged()
+{
+    // Not uploaded yet, so no other mesh should be said to look the same.
+    forgetGeometry();
+    m_vertexBufferDirty = true;
+}
+
+void MeshAft::foreInstancesCountChanged()
+{
+    for (auto& instanceBuffer : m_instanceBuffers) {
+        instanceBuffer.dirtyBegin = 0u;
+        instanceBuffer.dirtyEnd = m_fore.instancesCount();
+    }
+}
+
+void MeshAft::foreUboChanged(uint32_t instanceIndex)
+{
+    for (auto& instanceBuffer : m_instanceBuffers) {
+        if (instanceBuffer.dirtyBegin == instanceBuffer.dirtyEnd) {
+            instanceBuffer.dirtyBegin = instanceIndex;
+            instanceBuffer.dirtyEnd = instanceIndex + 1u;
+        }
+        else {
+            instanceBuffer.dirtyBegin = std::min(instanceBuffer.dirtyBegin, instanceIndex);
+            instanceBuffer.dirtyEnd = std::max(instanceBuffer.dirtyEnd, instanceIndex + 1u);
+        }
+    }
+}
+
 void MeshAft::foreIndicesChanged()
 {
+    forgetGeometry();
     createIndexBuffer();
 }
 
@@ -93,31 +189,83 @@ void MeshAft::createVertexBuffers()
     m_vertexBufferHolder.copy(m_fore.vertices().data(), bufferSize);
 
     m_vertexBufferDirty = false;
+
+    m_verticesHash = hashBytes(m_fore.vertices().data(), bufferSize);
+    m_verticesHash = hashBytes(m_fore.unlitVertices().data(), sizeof(UnlitVertex) * m_fore.unlitVertices().size(), m_verticesHash);
+    m_geometryDirty = true;
 }
 
-void MeshAft::createInstanceBuffer()
+void MeshAft::updateInstanceBuffer()
 {
-    PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
-    m_scene.engine().impl().device().waitIdle();
+    auto& instanceBuffer = m_instanceBuffers[m_currentFrameId];
+    const auto instancesCount = m_fore.instancesCount();
 
-    vk::DeviceSize bufferSize = sizeof(MeshUbo) * m_fore.instancesCount();
-    m_instanceBufferHolder.create(vulkan::BufferKind::ShaderVertex, bufferSize);
-    m_instanceBufferHolder.copy(m_fore.ubos().data(), bufferSize);
+    // Growing geometrically, everything is uploaded to the new buffer.
+    // @note The previous buffer of this frame id is no more in flight, so it can be released.
+    if (instanceBuffer.capacity < instancesCount) {
+        PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
-    m_instanceBufferDirty = false;
+        instanceBuffer.capacity = std::max(instancesCount, 2u * instanceBuffer.capacity);
+        instanceBuffer.holder.create(vulkan::BufferKind::ShaderVertex, vulkan::BufferCpuIo::Direct,
+                                     sizeof(MeshUbo) * instanceBuffer.capacity);
+        instanceBuffer.dirtyBegin = 0u;
+        instanceBuffer.dirtyEnd = instancesCount;
+    }
+
+    // Only the changed instances are written.
+    instanceBuffer.dirtyEnd = std::min(instanceBuffer.dirtyEnd, instancesCount);
+    if (instanceBuffer.dirtyBegin < instanceBuffer.dirtyEnd) {
+        const auto dirtyCount = instanceBuffer.dirtyEnd - instanceBuffer.dirtyBegin;
+        instanceBuffer.holder.copy(m_fore.ubos().data() + instanceBuffer.dirtyBegin, sizeof(MeshUbo) * dirtyCount,
+                                   sizeof(MeshUbo) * instanceBuffer.dirtyBegin);
+    }
+
+    instanceBuffer.dirtyBegin = 0u;
+    instanceBuffer.dirtyEnd = 0u;
 }
 
 void MeshAft::createIndexBuffer()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
-    if (m_fore.indices().empty()) {
+    if (m_fore.indicesCount() == 0u) {
         logger.warning("magma.vulkan.mesh") << "No indices provided. The mesh will not be visible." << std::endl;
         return;
     }
 
-    vk::DeviceSize bufferSize = sizeof(uint16_t) * m_fore.indices().size();
+    const auto wide = m_fore.indicesWide();
+    vk::DeviceSize bufferSize = (wide ? sizeof(uint32_t) : sizeof(uint16_t)) * m_fore.indicesCount();
+    const void* data = wide ? static_cast<const void*>(m_fore.indices32().data()) : m_fore.indices16().data();
 
     m_indexBufferHolder.create(vulkan::BufferKind::ShaderIndex, bufferSize);
-    m_indexBufferHolder.copy(m_fore.indices().data(), bufferSize);
+    m_indexBufferHolder.copy(data, bufferSize);
+
+    m_indicesHash = hashBytes(data, bufferSize, wide ? 32u : 16u);
+    m_geometryDirty = true;
+}
+
+void MeshAft::updateGeometry()
+{
+    m_geometryDirty = false;
+
+    forgetGeometry();
+    m_geometryHash = hashBytes(&m_indicesHash, sizeof(uint64_t), m_verticesHash);
+    m_geometryId = m_scene.aft().geometryId(*this, m_geometryHash);
+}
+
+void MeshAft::forgetGeometry()
+{
+    if (m_geometryId == 0u) return;
+
+    m_scene.aft().forgetGeometry(*this, m_geometryHash);
+    m_geometryId = 0u;
+}
+
+uint32_t MeshAft::bindInstances(vk::CommandBuffer commandBuffer, const vulkan::VisibleInstances* visibleInstances) const
+{
+    vk::Buffer buffer;
+    vk::DeviceSize offset;
+    auto instancesCount = instances(visibleInstances, buffer, offset);
+    commandBuffer.bindVertexBuffers(1, 1, &buffer, &offset);
+    return instancesCount;
 }
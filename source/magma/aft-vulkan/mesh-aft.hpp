@@ -1,8 +1,11 @@
 #pragma once
 
 #include "../vulkan/holders/buffer-holder.hpp"
+#include "../vulkan/holders/visible-instances-holder.hpp"
+#include "./config.hpp"
 
 namespace lava::magma {
+    class MaterialAft;
     class Mesh;
     class Scene;
 }
@@ -11,22 +14,69 @@ namespace lava::magma {
     class MeshAft {
     public:
         MeshAft(Mesh& fore, Scene& scene);
+        ~MeshAft();
 
         void update();
-        void render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout,
-                    uint32_t materialDescriptorSetIndex) const;
-        void renderUnlit(vk::CommandBuffer commandBuffer) const;
+
+        /// Draw the mesh, only the visible instances if specified.
+        void render(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex,
+                    const vulkan::VisibleInstances* visibleInstances = nullptr) const;
+        void renderUnlit(vk::CommandBuffer commandBuffer, const vulkan::VisibleInstances* visibleInstances = nullptr) const;
+
+        /**
+         * @name Bindings
+         *
+         * What render() binds, for render loops that want to skip redundant binds.
+         */
+        /// @{
+        /// Whether there is anything to draw.
+        bool renderable() const;
+        /// The material, or the scene's fallback one.
+        const MaterialAft& materialAft() const;
+        const vk::Buffer& vertexBuffer() const { return m_vertexBufferHolder.buffer(); }
+        const vk::Buffer& unlitVertexBuffer() const { return m_unlitVertexBufferHolder.buffer(); }
+        const vk::Buffer& indexBuffer() const { return m_indexBufferHolder.buffer(); }
+        uint32_t indicesCount() const;
+        /// 16-bit or 32-bit, as the fore mesh stores its indices.
+        vk::IndexType indexType() const;
+        /// The instance buffer to bind, returning the count of instances to draw.
+        uint32_t instances(const vulkan::VisibleInstances* visibleInstances, vk::Buffer& buffer, vk::DeviceSize& offset) const;
+        /// Same for meshes with identical vertices and indices, which can then be drawn with each other's buffers, 0u if unknown.
+        uint32_t geometryId() const { return m_geometryId; }
+        /// @}
+
+        /// Whether both meshes have the same vertices and indices, byte per byte.
+        bool sameGeometry(const MeshAft& other) const;
 
         // ----- Fore
-        void foreVerticesChanged() { m_vertexBufferDirty = true; }
-        void foreInstancesCountChanged() { m_instanceBufferDirty = true; }
-        void foreUboChanged(uint32_t /* instanceIndex */) { m_instanceBufferDirty = true; }
+        void foreVerticesChanged();
+        void foreInstancesCountChanged();
+        void foreUboChanged(uint32_t instanceIndex);
         void foreIndicesChanged();
 
     protected:
         void createVertexBuffers();
-        void createInstanceBuffer();
+        void updateInstanceBuffer();
         void createIndexBuffer();
+        void updateGeometry();
+        void forgetGeometry();
+
+        /// Bind the instance buffer to use, returning the count of instances to draw.
+        uint32_t bindInstances(vk::CommandBuffer commandBuffer, const vulkan::VisibleInstances* visibleInstances) const;
+
+    protected:
+        /**
+         * Instances data, persistently mapped.
+         *
+         * There is one per frame id, so that the one being written
+         * is never the one used by a frame still in flight.
+         */
+        struct InstanceBuffer {
+            vulkan::BufferHolder holder;
+            uint32_t capacity = 0u;     //!< In instances.
+            uint32_t dirtyBegin = 0u;   //!< First instance to upload.
+            uint32_t dirtyEnd = 0u;     //!< One past the last instance to upload.
+        };
 
     private:
         Mesh& m_fore;
@@ -35,9 +85,14 @@ namespace lava::magma {
         // ----- Geometry
         vulkan::BufferHolder m_unlitVertexBufferHolder;
         vulkan::BufferHolder m_vertexBufferHolder;
-        vulkan::BufferHolder m_instanceBufferHolder;
+        std::vector<InstanceBuffer> m_instanceBuffers;
         vulkan::BufferHolder m_indexBufferHolder;
         bool m_vertexBufferDirty = false;
-        bool m_instanceBufferDirty = false;
+        uint64_t m_verticesHash = 0u;
+        uint64_t m_indicesHash = 0u;
+        uint64_t m_geometryHash = 0u;
+        uint32_t m_geometryId = 0u;
+        bool m_geometryDirty = false;
+        uint32_t m_currentFrameId = 0u;
     };
 }
@@ -80,9 +80,8 @@ void SceneAft::update()
     m_frameId = (m_frameId + 1u) % FRAME_IDS_COUNT;
 
     if (!m_pendingRemovedMeshes.empty()) {
-        // @note This is necessary because we are no waiting for device on each update.
-        m_engine.impl().device().waitIdle();
-
+        // @note GPU resources of the meshes are not destroyed right away,
+        // the engine's deletion queue keeps them until the frames using them are retired.
         // @note We need to store the count of removed mesh here,
         // because some others might be added during the removal.
         auto removedMeshCount = m_pendingRemovedMeshes.size();
@@ -92,6 +91,14 @@ void SceneAft::update()
         m_pendingRemovedMeshes.erase(m_pendingRemovedMeshes.begin(), m_pendingRemovedMeshes.begin() + removedMeshCount);
     }
 
+    for (auto camera : m_pendingUpdatedCameras) {
+        updateCamera(*camera);
+    }
+    m_pendingUpdatedCameras.clear();
+
+    // Stages are about to query it while recording
+    m_fore.updateMeshesBvh();
+
     // @todo Some light or cameras might be inactive,
     // we should add this concept.
     // We should also be sure this is not done too many times.
@@ -121,10 +128,6 @@ void SceneAft::update()
 
 void SceneAft::record()
 {
-    tracker.counter("draw-calls.shadows") = 0u;
-    tracker.counter("draw-calls.renderer") = 0u;
-    tracker.counter("draw-calls.flat-renderer") = 0u;
-
     m_commandBuffers.resize(0);
 
     // @note :ShadowsLightCameraPair The order here is important, because it is how everything
@@ -133,7 +136,7 @@ void SceneAft::record()
     // They all use the very same shadows stage to update,
     // but that does not matter as long as the command buffers within the threads
     // are all different and as long as the shadows stage does not keep local state for
-    // rendering.
+    // rendering, apart from the cascades which are per camera.
 
     // @todo Don't have notion of "active" cameras yet, so we update them all
     for (auto camera : m_fore.cameras()) {
@@ -197,6 +200,12 @@ void SceneAft::updateCamera(const Camera& camera)
     }
 }
 
+void SceneAft::updateCameraLater(const Camera& camera)
+{
+    if (std::find(m_pendingUpdatedCameras.begin(), m_pendingUpdatedCameras.end(), &camera) != m_pendingUpdatedCameras.end()) return;
+    m_pendingUpdatedCameras.emplace_back(&camera);
+}
+
 void SceneAft::changeCameraRenderImageLayout(const Camera& camera, vk::ImageLayout imageLayout, vk::CommandBuffer commandBuffer)
 {
     m_cameraBundles.at(&camera).rendererStage->changeRenderImageLayout(imageLayout, commandBuffer);
@@ -246,6 +255,47 @@ const glm::mat4& SceneAft::shadowsCascadeTransform(const Light& light, const Cam
     return m_lightBundles.at(&light).shadows.at(&camera).cascadeTransform(cascadeIndex);
 }
 
+// ----- Geometries
+
+uint32_t SceneAft::geometryId(const MeshAft& meshAft, uint64_t geometryHash)
+{
+    // @note Different geometries rarely share a hash, so this is usually one comparison at most.
+    auto& geometries = m_geometries[geometryHash];
+    for (auto& geometry : geometries) {
+        if (geometry.meshAfts.front()->sameGeometry(meshAft)) {
+            geometry.meshAfts.emplace_back(&meshAft);
+            return geometry.id;
+        }
+    }
+
+    Geometry geometry;
+    geometry.meshAfts.emplace_back(&meshAft);
+    geometry.id = m_nextGeometryId++;
+    geometries.emplace_back(std::move(geometry));
+    return geometries.back().id;
+}
+
+void SceneAft::forgetGeometry(const MeshAft& meshAft, uint64_t geometryHash)
+{
+    auto iGeometries = m_geometries.find(geometryHash);
+    if (iGeometries == m_geometries.end()) return;
+
+    // The next mesh, still having that geometry, becomes the one compared to.
+    auto& geometries = iGeometries->second;
+    for (auto& geometry : geometries) {
+        auto& meshAfts = geometry.meshAfts;
+        meshAfts.erase(std::remove(meshAfts.begin(), meshAfts.end(), &meshAft), meshAfts.end());
+    }
+
+    geometries.erase(std::remove_if(geometries.begin(), geometries.end(),
+                                    [](const Geometry& geometry) { return geometry.meshAfts.empty(); }),
+                     geometries.end());
+
+    if (geometries.empty()) {
+        m_geometries.erase(iGeometries);
+    }
+}
+
 // ----- Fore
 
 void SceneAft::foreAdd(Light& light)
@@ -327,6 +377,8 @@ void SceneAft::foreRemove(const Light& light)
 void SceneAft::foreRemove(const Camera& camera)
 {
     m_engine.impl().device().waitIdle();
+    m_pendingUpdatedCameras.erase(std::remove(m_pendingUpdatedCameras.begin(), m_pendingUpdatedCameras.end(), &camera),
+                                  m_pendingUpdatedCameras.end());
     m_fore.removeUnsafe(camera);
 }
 
@@ -337,7 +389,7 @@ void SceneAft::foreRemove(const Mesh& mesh)
 
 void SceneAft::foreRemove(const Flat& flat)
 {
-    m_engine.impl().device().waitIdle();
+    // @note Flats only own buffers, which are destroyed later by the deletion queue.
     m_fore.removeUnsafe(flat);
 }
 
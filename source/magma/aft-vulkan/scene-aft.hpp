@@ -15,6 +15,7 @@ namespace lava::magma {
     class Material;
     class Texture;
     class Mesh;
+    class MeshAft;
     class Flat;
     class ShadowsStage;
 }
@@ -57,6 +58,8 @@ namespace lava::magma {
         bool cameraDepthRenderImageValid(const Camera& camera) const;
 
         void updateCamera(const Camera& camera);
+        /// Same, but done during next update(), so that consecutive changes only rebuild once.
+        void updateCameraLater(const Camera& camera);
         void changeCameraRenderImageLayout(const Camera& camera, vk::ImageLayout imageLayout, vk::CommandBuffer commandBuffer);
         /// @}
 
@@ -77,6 +80,19 @@ namespace lava::magma {
         const glm::mat4& shadowsCascadeTransform(const Light& light, const Camera& camera, uint32_t cascadeIndex) const;
         /// @}
 
+        /**
+         * @name Geometries
+         *
+         * Meshes with identical vertices and indices, checked byte per byte, share the same geometry id,
+         * so that render queues can draw them all at once.
+         */
+        /// @{
+        /// Find or make the id of the mesh's geometry, which has just been uploaded.
+        uint32_t geometryId(const MeshAft& meshAft, uint64_t geometryHash);
+        /// The mesh's geometry is going to change, other meshes keep the id they had and can still be matched.
+        void forgetGeometry(const MeshAft& meshAft, uint64_t geometryHash);
+        /// @}
+
         /**
          * @name Descriptors
          */
@@ -140,6 +156,12 @@ namespace lava::magma {
             const Camera* shadowsFallbackCamera = nullptr;
         };
 
+        /// Meshes sharing that geometry, new ones being compared to the first.
+        struct Geometry {
+            std::vector<const MeshAft*> meshAfts;
+            uint32_t id = 0u;
+        };
+
     private:
         Scene& m_fore;
         RenderEngine& m_engine;
@@ -160,9 +182,14 @@ namespace lava::magma {
         // ----- Environment
         Environment m_environment;
 
+        // ----- Geometries
+        std::unordered_map<uint64_t, std::vector<Geometry>> m_geometries; // Stored per geometry hash
+        uint32_t m_nextGeometryId = 1u;
+
         // ----- Resources
         std::unordered_map<const Camera*, CameraBundle> m_cameraBundles;
         std::unordered_map<const Light*, LightBundle> m_lightBundles;
         std::vector<const Mesh*> m_pendingRemovedMeshes;
+        std::vector<const Camera*> m_pendingUpdatedCameras;
     };
 }
@@ -0,0 +1,262 @@
+#include <lava/magma/bvh.hpp>
+
+using namespace lava::magma;
+
+namespace {
+    // Leaves are fattened by this ratio of their radius.
+    constexpr const float FAT_MARGIN_RATIO = 0.1f;
+
+    struct Box {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    inline Box sphereBox(const lava::BoundingSphere& sphere, float margin)
+    {
+        const glm::vec3 extent(sphere.radius + margin);
+        return {sphere.center - extent, sphere.center + extent};
+    }
+
+    inline bool contains(const glm::vec3& min, const glm::vec3& max, const Box& box)
+    {
+        return glm::all(glm::lessThanEqual(min, box.min)) && glm::all(glm::greaterThanEqual(max, box.max));
+    }
+
+    // Half the surface area, what the cost of a node is based on.
+    inline float perimeter(const glm::vec3& min, const glm::vec3& max)
+    {
+        const auto size = max - min;
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    inline float mergedPerimeter(const glm::vec3& min0, const glm::vec3& max0, const glm::vec3& min1, const glm::vec3& max1)
+    {
+        return perimeter(glm::min(min0, min1), glm::max(max0, max1));
+    }
+}
+
+uint32_t Bvh::insert(Mesh& mesh, const BoundingSphere& boundingSphere)
+{
+    auto leaf = allocateNode();
+    auto box = sphereBox(boundingSphere, FAT_MARGIN_RATIO * boundingSphere.radius);
+
+    auto& node = m_nodes[leaf];
+    node.min = box.min;
+    node.max = box.max;
+    node.mesh = &mesh;
+    node.height = 0;
+
+    insertLeaf(leaf);
+    m_leavesCount += 1u;
+    return leaf;
+}
+
+void Bvh::remove(uint32_t leaf)
+{
+    removeLeaf(leaf);
+    freeNode(leaf);
+    m_leavesCount -= 1u;
+}
+
+bool Bvh::move(uint32_t leaf, const BoundingSphere& boundingSphere)
+{
+    auto& node = m_nodes[leaf];
+    const auto margin = FAT_MARGIN_RATIO * boundingSphere.radius;
+
+    // Still within the fat box, which is not too big either.
+    if (contains(node.min, node.max, sphereBox(boundingSphere, 0.f))) {
+        const auto largeBox = sphereBox(boundingSphere, 4.f * margin);
+        if (contains(largeBox.min, largeBox.max, {node.min, node.max})) {
+            return false;
+        }
+    }
+
+    removeLeaf(leaf);
+
+    const auto box = sphereBox(boundingSphere, margin);
+    node.min = box.min;
+    node.max = box.max;
+
+    insertLeaf(leaf);
+    return true;
+}
+
+// ----- Internal
+
+uint32_t Bvh::allocateNode()
+{
+    if (m_freeNode == NULL_NODE) {
+        m_nodes.emplace_back();
+        return m_nodes.size() - 1u;
+    }
+
+    auto index = m_freeNode;
+    m_freeNode = m_nodes[index].parent;
+    m_nodes[index] = Node();
+    return index;
+}
+
+void Bvh::freeNode(uint32_t index)
+{
+    auto& node = m_nodes[index];
+    node.mesh = nullptr;
+    node.height = -1;
+    node.parent = m_freeNode;
+    m_freeNode = index;
+}
+
+void Bvh::insertLeaf(uint32_t leaf)
+{
+    if (m_root == NULL_NODE) {
+        m_root = leaf;
+        m_nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Finding the best sibling, descending while it is cheaper than making a new parent here.
+    const auto leafMin = m_nodes[leaf].min;
+    const auto leafMax = m_nodes[leaf].max;
+    auto index = m_root;
+    while (!m_nodes[index].leaf()) {
+        const auto& node = m_nodes[index];
+        const auto area = perimeter(node.min, node.max);
+        const auto mergedArea = mergedPerimeter(node.min, node.max, leafMin, leafMax);
+
+        const auto cost = 2.f * mergedArea;
+        const auto inheritanceCost = 2.f * (mergedArea - area);
+
+        float childrenCosts[2];
+        for (auto i = 0u; i < 2u; ++i) {
+            const auto& child = m_nodes[node.children[i]];
+            childrenCosts[i] = mergedPerimeter(child.min, child.max, leafMin, leafMax) + inheritanceCost;
+            if (!child.leaf()) {
+                childrenCosts[i] -= perimeter(child.min, child.max);
+            }
+        }
+
+        if (cost < childrenCosts[0] && cost < childrenCosts[1]) break;
+        index = (childrenCosts[0] < childrenCosts[1]) ? node.children[0] : node.children[1];
+    }
+
+    // New parent for both the sibling and the leaf
+    const auto sibling = index;
+    const auto oldParent = m_nodes[sibling].parent;
+    const auto newParent = allocateNode();
+    m_nodes[newParent].parent = oldParent;
+    m_nodes[newParent].children[0] = sibling;
+    m_nodes[newParent].children[1] = leaf;
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        m_root = newParent;
+    }
+    else if (m_nodes[oldParent].children[0] == sibling) {
+        m_nodes[oldParent].children[0] = newParent;
+    }
+    else {
+        m_nodes[oldParent].children[1] = newParent;
+    }
+
+    refit(newParent);
+}
+
+void Bvh::removeLeaf(uint32_t leaf)
+{
+    if (leaf == m_root) {
+        m_root = NULL_NODE;
+        return;
+    }
+
+    // The sibling takes the place of the parent
+    const auto parent = m_nodes[leaf].parent;
+    const auto grandParent = m_nodes[parent].parent;
+    const auto sibling = (m_nodes[parent].children[0] == leaf) ? m_nodes[parent].children[1] : m_nodes[parent].children[0];
+    freeNode(parent);
+
+    m_nodes[sibling].parent = grandParent;
+    if (grandParent == NULL_NODE) {
+        m_root = sibling;
+        return;
+    }
+
+    if (m_nodes[grandParent].children[0] == parent) {
+        m_nodes[grandParent].children[0] = sibling;
+    }
+    else {
+        m_nodes[grandParent].children[1] = sibling;
+    }
+
+    refit(grandParent);
+}
+
+void Bvh::refit(uint32_t index)
+{
+    // Walking back to the root, fixing boxes and heights
+    while (index != NULL_NODE) {
+        index = balance(index);
+
+        auto& node = m_nodes[index];
+        const auto& child0 = m_nodes[node.children[0]];
+        const auto& child1 = m_nodes[node.children[1]];
+        node.min = glm::min(child0.min, child1.min);
+        node.max = glm::max(child0.max, child1.max);
+        node.height = 1 + std::max(child0.height, child1.height);
+
+        index = node.parent;
+    }
+}
+
+uint32_t Bvh::balance(uint32_t indexA)
+{
+    auto& a = m_nodes[indexA];
+    if (a.leaf() || a.height < 2) return indexA;
+
+    // Rotating the higher child up, if the subtree is unbalanced.
+    const auto balance = m_nodes[a.children[1]].height - m_nodes[a.children[0]].height;
+    if (balance >= -1 && balance <= 1) return indexA;
+
+    const auto higherSide = (balance > 1) ? 1u : 0u;
+    const auto indexB = a.children[1u - higherSide]; // Stays with A
+    const auto indexC = a.children[higherSide];      // Goes up
+    auto& b = m_nodes[indexB];
+    auto& c = m_nodes[indexC];
+
+    // C replaces A
+    c.parent = a.parent;
+    a.parent = indexC;
+    if (c.parent == NULL_NODE) {
+        m_root = indexC;
+    }
+    else if (m_nodes[c.parent].children[0] == indexA) {
+        m_nodes[c.parent].children[0] = indexC;
+    }
+    else {
+        m_nodes[c.parent].children[1] = indexC;
+    }
+
+    // C keeps its higher child, and gives the other one to A
+    const auto indexF = c.children[0];
+    const auto indexG = c.children[1];
+    auto& f = m_nodes[indexF];
+    auto& g = m_nodes[indexG];
+    const auto keptIndex = (f.height > g.height) ? indexF : indexG;
+    const auto givenIndex = (f.height > g.height) ? indexG : indexF;
+    auto& kept = m_nodes[keptIndex];
+    auto& given = m_nodes[givenIndex];
+
+    c.children[0] = indexA;
+    c.children[1] = keptIndex;
+    a.children[higherSide] = givenIndex;
+    given.parent = indexA;
+
+    a.min = glm::min(b.min, given.min);
+    a.max = glm::max(b.max, given.max);
+    a.height = 1 + std::max(b.height, given.height);
+
+    c.min = glm::min(a.min, kept.min);
+    c.max = glm::max(a.max, kept.max);
+    c.height = 1 + std::max(a.height, kept.height);
+
+    return indexC;
+}
@@ -34,6 +34,11 @@ RenderImage Camera::depthRenderImage() const
     return aft().foreDepthRenderImage();
 }
 
+void Camera::readback(ReadbackCallback callback, const ReadbackOptions& options)
+{
+    aft().foreReadback(std::move(callback), options);
+}
+
 void Camera::polygonMode(PolygonMode polygonMode)
 {
     m_polygonMode = polygonMode;
@@ -0,0 +1,146 @@
+#include "./depth-pyramid.hpp"
+
+#include <algorithm>
+#include <glm/common.hpp>
+#include <glm/vec4.hpp>
+#include <limits>
+
+using namespace lava;
+using namespace lava::magma;
+
+namespace {
+    // Clip-space w under which a point is considered behind the camera.
+    constexpr const float MIN_CLIP_W = 1e-4f;
+
+    /// Halve the resolution, keeping the farthest depth of each 2x2 block.
+    template <class Texel, class Decode>
+    void reduce(const Texel* texels, uint32_t width, uint32_t height, float* outDepths, Decode decode)
+    {
+        const auto outWidth = (width + 1u) / 2u;
+        const auto outHeight = (height + 1u) / 2u;
+
+        for (auto y = 0u; y < outHeight; ++y) {
+            const auto row0 = texels + (2u * y) * width;
+            const auto row1 = texels + std::min(2u * y + 1u, height - 1u) * width;
+            for (auto x = 0u; x < outWidth; ++x) {
+                const auto x0 = 2u * x;
+                const auto x1 = std::min(x0 + 1u, width - 1u);
+                const auto depth0 = std::max(decode(row0[x0]), decode(row0[x1]));
+                const auto depth1 = std::max(decode(row1[x0]), decode(row1[x1]));
+                outDepths[y * outWidth + x] = std::max(depth0, depth1);
+            }
+        }
+    }
+}
+
+void DepthPyramid::build(const void* depths, DepthFormat depthFormat, uint32_t width, uint32_t height,
+                         const glm::mat4& viewProjectionMatrix)
+{
+    m_valid = false;
+    if (width == 0u || height == 0u) return;
+
+    m_viewProjectionMatrix = viewProjectionMatrix;
+    m_width = width;
+    m_height = height;
+
+    // Levels, down to a single texel
+    m_levels.clear();
+    auto depthsCount = 0u;
+    do {
+        width = (width + 1u) / 2u;
+        height = (height + 1u) / 2u;
+        m_levels.emplace_back(Level{width, height, depthsCount});
+        depthsCount += width * height;
+    } while (width > 1u || height > 1u);
+    m_depths.resize(depthsCount);
+
+    // First level, decoding the depth format
+    if (depthFormat == DepthFormat::Float) {
+        reduce(reinterpret_cast<const float*>(depths), m_width, m_height, m_depths.data(), [](float depth) { return depth; });
+    }
+    else if (depthFormat == DepthFormat::Unorm16) {
+        reduce(reinterpret_cast<const uint16_t*>(depths), m_width, m_height, m_depths.data(),
+               [](uint16_t depth) { return depth / 65535.f; });
+    }
+    else {
+        reduce(reinterpret_cast<const uint32_t*>(depths), m_width, m_height, m_depths.data(),
+               [](uint32_t depth) { return (depth & 0xFFFFFFu) / 16777215.f; });
+    }
+
+    // Other levels, from the previous one
+    for (auto i = 1u; i < m_levels.size(); ++i) {
+        const auto& previousLevel = m_levels[i - 1u];
+        reduce(m_depths.data() + previousLevel.offset, previousLevel.width, previousLevel.height, m_depths.data() + m_levels[i].offset,
+               [](float depth) { return depth; });
+    }
+
+    m_valid = true;
+}
+
+bool DepthPyramid::canSee(const BoundingSphere& boundingSphere) const
+{
+    if (!m_valid) return true;
+
+    // Screen rectangle and nearest depth of the sphere's box,
+    // as seen when the depth has been rendered.
+    glm::vec3 ndcMin(std::numeric_limits<float>::max());
+    glm::vec3 ndcMax(std::numeric_limits<float>::lowest());
+    for (auto i = 0u; i < 8u; ++i) {
+        const glm::vec3 direction((i & 1u) ? 1.f : -1.f, (i & 2u) ? 1.f : -1.f, (i & 4u) ? 1.f : -1.f);
+        const auto clip = m_viewProjectionMatrix * glm::vec4(boundingSphere.center + boundingSphere.radius * direction, 1.f);
+
+        // Crossing the camera plane, nothing can be said.
+        if (clip.w <= MIN_CLIP_W) return true;
+
+        const auto ndc = glm::vec3(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+
+    // Not fully within what has been rendered, nothing can be said either.
+    if (ndcMin.z <= 0.f || ndcMin.x < -1.f || ndcMin.y < -1.f || ndcMax.x > 1.f || ndcMax.y > 1.f) return true;
+
+    const auto x0 = std::min(static_cast<uint32_t>((ndcMin.x * 0.5f + 0.5f) * m_width), m_width - 1u);
+    const auto x1 = std::min(static_cast<uint32_t>((ndcMax.x * 0.5f + 0.5f) * m_width), m_width - 1u);
+    const auto y0 = std::min(static_cast<uint32_t>((ndcMin.y * 0.5f + 0.5f) * m_height), m_height - 1u);
+    const auto y1 = std::min(static_cast<uint32_t>((ndcMax.y * 0.5f + 0.5f) * m_height), m_height - 1u);
+
+    // Level where the rectangle covers at most 2x2 texels,
+    // each texel of level i covering 2^(i+1) pixels wide.
+    const auto size = std::max(x1 - x0, y1 - y0) + 1u;
+    auto levelIndex = 0u;
+    while ((2u << levelIndex) < size && levelIndex + 1u < m_levels.size()) {
+        levelIndex += 1u;
+    }
+
+    const auto& level = m_levels[levelIndex];
+    const auto shift = levelIndex + 1u;
+    auto maxDepth = 0.f;
+    for (auto y = y0 >> shift; y <= std::min(y1 >> shift, level.height - 1u); ++y) {
+        for (auto x = x0 >> shift; x <= std::min(x1 >> shift, level.width - 1u); ++x) {
+            maxDepth = std::max(maxDepth, m_depths[level.offset + y * level.width + x]);
+        }
+    }
+
+    return ndcMin.z <= maxDepth;
+}
+
+uint32_t DepthPyramid::canSee(const chamber::math::SpheresSoa& boundingSpheres, uint32_t count, uint8_t* visibles) const
+{
+    if (!m_valid) return 0u;
+
+    auto occludedCount = 0u;
+    for (auto i = 0u; i < count; ++i) {
+        if (!visibles[i]) continue;
+
+        BoundingSphere boundingSphere;
+        boundingSphere.center = glm::vec3(boundingSpheres.x[i], boundingSpheres.y[i], boundingSpheres.z[i]);
+        boundingSphere.radius = boundingSpheres.radius[i];
+        if (!canSee(boundingSphere)) {
+            visibles[i] = 0u;
+            occludedCount += 1u;
+        }
+    }
+
+    return occludedCount;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <lava/chamber/math/batch.hpp>
+#include <lava/core/bounding-sphere.hpp>
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace lava::magma {
+    /**
+     * Max-depth pyramid of a rendered depth, for occlusion culling on the CPU.
+     *
+     * Bounding spheres are projected with the matrix the depth has been rendered with,
+     * and tested against the pyramid level where they cover at most 2x2 texels.
+     * Depths go from 0 (near) to 1 (far).
+     */
+    class DepthPyramid {
+    public:
+        enum class DepthFormat {
+            Float,   //!< 32 bits float.
+            Unorm16, //!< 16 bits normalized.
+            Unorm24, //!< 24 bits normalized within 32 bits, the upper ones being undefined.
+        };
+
+    public:
+        /// Build the levels from a depth of width x height texels.
+        void build(const void* depths, DepthFormat depthFormat, uint32_t width, uint32_t height, const glm::mat4& viewProjectionMatrix);
+
+        /// Forget the last depth, canSee() then always returns true.
+        void invalidate() { m_valid = false; }
+
+        /// Whether there is a pyramid to test against.
+        bool valid() const { return m_valid; }
+
+        /// Checks if any part of the bounding sphere might be seen.
+        bool canSee(const BoundingSphere& boundingSphere) const;
+
+        /// Checks multiple bounding spheres at once, only clearing visibles[i] of occluded ones.
+        /// Returns how many have been cleared.
+        uint32_t canSee(const chamber::math::SpheresSoa& boundingSpheres, uint32_t count, uint8_t* visibles) const;
+
+    private:
+        struct Level {
+            uint32_t width;
+            uint32_t height;
+            uint32_t offset; //!< In m_depths.
+        };
+
+    private:
+        bool m_valid = false;
+        glm::mat4 m_viewProjectionMatrix;
+        uint32_t m_width = 0u; //!< Of the source depth.
+        uint32_t m_height = 0u;
+        std::vector<Level> m_levels;
+        std::vector<float> m_depths;
+    };
+}
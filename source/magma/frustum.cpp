@@ -23,3 +23,22 @@ bool Frustum::canSee(const BoundingSphere& boundingSphere) const
            (glm::dot(boundingSphere.center, bottomNormal) - boundingSphere.radius <= bottomDistance) &&
            (glm::dot(boundingSphere.center, topNormal) - boundingSphere.radius <= topDistance);
 }
+
+void Frustum::canSee(const chamber::math::SpheresSoa& boundingSpheres, uint32_t count, uint8_t* visibles) const
+{
+    const auto frustumPlanes = planes();
+    chamber::math::spheresInsidePlanes(frustumPlanes.data(), frustumPlanes.size(), boundingSpheres, count, visibles);
+}
+
+std::array<glm::vec4, 6> Frustum::planes() const
+{
+    // Same tests as canSee, near being flipped to fit the dot(n, p) <= d form.
+    return {
+        glm::vec4(-forward, -near),
+        glm::vec4(forward, far),
+        glm::vec4(leftNormal, leftDistance),
+        glm::vec4(rightNormal, rightDistance),
+        glm::vec4(bottomNormal, bottomDistance),
+        glm::vec4(topNormal, topDistance),
+    };
+}
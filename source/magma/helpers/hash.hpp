@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstring>
+
+namespace lava::magma {
+    /**
+     * Hash raw data, possibly continuing a previous hash.
+     *
+     * FNV-1a-like, but eating 8 bytes at a time so that big buffers stay cheap.
+     * Good enough to tell contents apart, not meant to resist anything.
+     */
+    inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(data);
+        for (; size >= sizeof(uint64_t); bytes += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, bytes, sizeof(uint64_t));
+            hash = (hash ^ word) * 0x100000001b3ull;
+            hash ^= hash >> 32u;
+        }
+        for (; size > 0u; bytes += 1u, size -= 1u) {
+            hash = (hash ^ *bytes) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
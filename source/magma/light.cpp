@@ -8,6 +8,8 @@ Light::Light(Scene& scene)
     : m_scene(scene)
 {
     new (&aft()) LightAft(*this, m_scene);
+
+    m_shadowsCascadesRefreshPeriods.fill(1u);
 }
 
 Light::~Light()
@@ -22,6 +24,11 @@ RenderImage Light::shadowsRenderImage() const
     return aft().foreShadowsRenderImage();
 }
 
+void Light::shadowsCascadeRefreshPeriod(uint32_t cascadeIndex, uint32_t refreshPeriod)
+{
+    m_shadowsCascadesRefreshPeriods.at(cascadeIndex) = std::max(refreshPeriod, 1u);
+}
+
 // ----- Controller-only
 
 void Light::uboChanged()
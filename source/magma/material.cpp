@@ -127,6 +127,9 @@ const glm::vec4& Material::get_vec4(const std::string& uniformName) const
 void Material::initFromMaterialInfo(const std::string& hrid)
 {
     const auto& materialInfo = m_scene.engine().materialInfo(hrid);
+
+    // @note Unused data is cleared too, as it is part of MaterialAft::bindingsHash().
+    std::memset(&m_ubo, 0, sizeof(MaterialUbo));
     m_ubo.header.id = materialInfo.id;
 
     initAttributes(m_attributes, materialInfo.uniformDefinitions);
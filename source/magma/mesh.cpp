@@ -14,10 +14,18 @@ using namespace lava::chamber;
 using namespace lava::magma;
 
 namespace {
+    /// Up to that, vertices can be referred to with 16-bit indices.
+    constexpr const uint32_t MAX_NARROW_VERTICES_COUNT = 0x10000u;
+
     /// Initialize the targetIndices array from the vector view, fliping triangles is asked.
+    template <class TargetUInt, class UInt>
+    void fillIndices(std::vector<TargetUInt>& targetIndices, const VectorView<UInt>& indices, bool flipTriangles,
+                     uint32_t verticesCount);
+
+    /// Fill either 16-bit or 32-bit indices, as the vertices count requires, returns true for 32-bit ones.
     template <class UInt>
-    void setIndices(std::vector<uint16_t>& targetIndices, const VectorView<UInt>& indices, bool flipTriangles,
-                    uint32_t verticesCount);
+    bool setIndices(std::vector<uint16_t>& indices16, std::vector<uint32_t>& indices32, const VectorView<UInt>& indices,
+                    bool flipTriangles, uint32_t verticesCount);
 }
 
 Mesh::Mesh(Scene& scene, uint32_t instancesCount)
@@ -41,6 +49,13 @@ Mesh::~Mesh()
     aft().~MeshAft();
 }
 
+void Mesh::enabled(bool enabled)
+{
+    if (m_enabled == enabled) return;
+    m_enabled = enabled;
+    staticShadowsChanged();
+}
+
 // ----- Transform
 
 void Mesh::transform(const glm::mat4& transform, uint32_t instanceIndex)
@@ -52,7 +67,7 @@ void Mesh::transform(const glm::mat4& transform, uint32_t instanceIndex)
     glm::vec4 perspective;
     glm::decompose(instanceInfo.transform, instanceInfo.scaling, instanceInfo.rotation, instanceInfo.translation, skew, perspective);
 
-    m_boundingSphereDirty = true;
+    boundingSpheresChanged();
     updateUbo(instanceIndex);
 }
 
@@ -88,7 +103,7 @@ uint32_t Mesh::addInstance()
     m_ubos.emplace_back();
     m_instancesInfos.emplace_back();
 
-    m_boundingSphereDirty = true;
+    boundingSpheresChanged();
     updateUbo(instanceIndex);
     return instanceIndex;
 }
@@ -98,7 +113,7 @@ void Mesh::removeInstance()
     m_ubos.pop_back();
     m_instancesInfos.pop_back();
 
-    m_boundingSphereDirty = true;
+    boundingSpheresChanged();
 }
 
 // ----- Geometry
@@ -115,13 +130,14 @@ void Mesh::verticesPositions(const VectorView<glm::vec3>& positions)
     // as the middle of each axis range.
     glm::vec3 minRange = positions[0];
     glm::vec3 maxRange = minRange;
-    for (const auto& position : positions) {
-        if (position.x > maxRange.x) maxRange.x = position.x;
-        if (position.x < minRange.x) minRange.x = position.x;
-        if (position.y > maxRange.y) maxRange.y = position.y;
-        if (position.y < minRange.y) minRange.y = position.y;
-        if (position.z > maxRange.z) maxRange.z = position.z;
-        if (position.z < minRange.z) minRange.z = position.z;
+    if (positions.stride() == sizeof(glm::vec3)) {
+        chamber::math::minMax(&positions[0], positions.size(), minRange, maxRange);
+    }
+    else {
+        for (const auto& position : positions) {
+            minRange = glm::min(minRange, position);
+            maxRange = glm::max(maxRange, position);
+        }
     }
     m_boundingSphereGeometry.center = (minRange + maxRange) / 2.f;
     m_boundingBoxExtentGeometry = maxRange - minRange;
@@ -136,12 +152,12 @@ void Mesh::verticesPositions(const VectorView<glm::vec3>& positions)
 
         // Finding the bounding sphere radius.
         auto vertexVector = position - m_boundingSphereGeometry.center;
-        maxDistanceSquared = glm::dot(vertexVector, vertexVector);
+        maxDistanceSquared = std::max(maxDistanceSquared, glm::dot(vertexVector, vertexVector));
     }
 
     m_boundingSphereGeometry.radius = std::sqrt(maxDistanceSquared);
 
-    updateBoundingSpheres();
+    boundingSpheresChanged();
     aft().foreVerticesChanged();
 }
 
@@ -177,28 +193,32 @@ void Mesh::verticesTangents(const VectorView<glm::vec4>& tangents)
 
 void Mesh::indices(const VectorView<uint32_t>& indices, bool flipTriangles)
 {
-    setIndices(m_indices, indices, flipTriangles, m_vertices.size());
+    m_indicesWide = setIndices(m_indices16, m_indices32, indices, flipTriangles, m_vertices.size());
     aft().foreIndicesChanged();
+    staticShadowsChanged();
 }
 
 void Mesh::indices(const VectorView<uint16_t>& indices, bool flipTriangles)
 {
-    setIndices(m_indices, indices, flipTriangles, m_vertices.size());
+    m_indicesWide = setIndices(m_indices16, m_indices32, indices, flipTriangles, m_vertices.size());
     aft().foreIndicesChanged();
+    staticShadowsChanged();
 }
 
 void Mesh::indices(const VectorView<uint8_t>& indices, bool flipTriangles)
 {
-    setIndices(m_indices, indices, flipTriangles, m_vertices.size());
+    m_indicesWide = setIndices(m_indices16, m_indices32, indices, flipTriangles, m_vertices.size());
     aft().foreIndicesChanged();
+    staticShadowsChanged();
 }
 
 void Mesh::computeFlatNormals()
 {
-    for (auto i = 0u; i < m_indices.size(); i += 3u) {
-        auto i0 = m_indices[i];
-        auto i1 = m_indices[i + 1];
-        auto i2 = m_indices[i + 2];
+    const auto indicesCount = this->indicesCount();
+    for (auto i = 0u; i < indicesCount; i += 3u) {
+        auto i0 = index(i);
+        auto i1 = index(i + 1);
+        auto i2 = index(i + 2);
         auto& v0 = m_vertices[i0];
         auto& v1 = m_vertices[i1];
         auto& v2 = m_vertices[i2];
@@ -215,26 +235,26 @@ void Mesh::computeTangents()
     SMikkTSpaceInterface tsInterface;
     tsInterface.m_getNumFaces = [](const SMikkTSpaceContext* pContext) -> int {
         const auto& self = *reinterpret_cast<const Mesh*>(pContext->m_pUserData);
-        return self.m_indices.size() / 3;
+        return self.indicesCount() / 3;
     };
     tsInterface.m_getNumVerticesOfFace = [](const SMikkTSpaceContext* /* pContext */, const int /* iFace */) -> int { return 3; };
     tsInterface.m_getPosition = [](const SMikkTSpaceContext* pContext, float fvPosOut[], const int iFace, const int iVert) {
         const auto& self = *reinterpret_cast<const Mesh*>(pContext->m_pUserData);
-        auto vertexIndex = self.m_indices[3 * iFace + iVert];
+        auto vertexIndex = self.index(3 * iFace + iVert);
         fvPosOut[0] = self.m_vertices[vertexIndex].pos[0];
         fvPosOut[1] = self.m_vertices[vertexIndex].pos[1];
         fvPosOut[2] = self.m_vertices[vertexIndex].pos[2];
     };
     tsInterface.m_getNormal = [](const SMikkTSpaceContext* pContext, float fvNormOut[], const int iFace, const int iVert) {
         const auto& self = *reinterpret_cast<const Mesh*>(pContext->m_pUserData);
-        auto vertexIndex = self.m_indices[3 * iFace + iVert];
+        auto vertexIndex = self.index(3 * iFace + iVert);
         fvNormOut[0] = self.m_vertices[vertexIndex].normal[0];
         fvNormOut[1] = self.m_vertices[vertexIndex].normal[1];
         fvNormOut[2] = self.m_vertices[vertexIndex].normal[2];
     };
     tsInterface.m_getTexCoord = [](const SMikkTSpaceContext* pContext, float fvTexcOut[], const int iFace, const int iVert) {
         const auto& self = *reinterpret_cast<const Mesh*>(pContext->m_pUserData);
-        auto vertexIndex = self.m_indices[3 * iFace + iVert];
+        auto vertexIndex = self.index(3 * iFace + iVert);
         fvTexcOut[0] = self.m_vertices[vertexIndex].uv[0];
         fvTexcOut[1] = self.m_vertices[vertexIndex].uv[1];
     };
@@ -244,7 +264,7 @@ void Mesh::computeTangents()
     tsInterface.m_setTSpaceBasic = [](const SMikkTSpaceContext* pContext, const float fvTangent[], const float fSign,
                                       const int iFace, const int iVert) {
         auto& self = *reinterpret_cast<Mesh*>(pContext->m_pUserData);
-        auto vertexIndex = self.m_indices[3 * iFace + iVert];
+        auto vertexIndex = self.index(3 * iFace + iVert);
 
         Vertex v;
         v = self.m_vertices[vertexIndex];
@@ -268,13 +288,24 @@ void Mesh::computeTangents()
     // Regenerating indices and unlit vertices
     m_vertices = std::move(m_temporaryVertices);
     auto verticeCount = m_vertices.size();
-    m_indices.resize(verticeCount);
     m_unlitVertices.resize(verticeCount);
     for (auto i = 0u; i < verticeCount; ++i) {
-        m_indices[i] = i;
         m_unlitVertices[i].pos = m_vertices[i].pos;
     }
 
+    // @note Vertices being no more shared, indices might now need 32 bits.
+    m_indicesWide = (verticeCount > MAX_NARROW_VERTICES_COUNT);
+    m_indices16.resize(m_indicesWide ? 0u : verticeCount);
+    m_indices32.resize(m_indicesWide ? verticeCount : 0u);
+    for (auto i = 0u; i < verticeCount; ++i) {
+        if (m_indicesWide) {
+            m_indices32[i] = i;
+        }
+        else {
+            m_indices16[i] = i;
+        }
+    }
+
     aft().foreVerticesChanged();
     aft().foreIndicesChanged();
 
@@ -292,6 +323,35 @@ void Mesh::material(MaterialPtr material)
     m_material = std::move(material);
 }
 
+void Mesh::renderCategory(RenderCategory renderCategory)
+{
+    if (m_renderCategory == renderCategory) return;
+    m_renderCategory = renderCategory;
+
+    // Depthless meshes are not in the scene's BVH
+    m_scene.meshChanged(*this);
+    staticShadowsChanged();
+}
+
+void Mesh::shadowsCastable(bool shadowsCastable)
+{
+    if (m_shadowsCastable == shadowsCastable) return;
+
+    // Notifying both before and after, as only static casters are considered.
+    staticShadowsChanged();
+    m_shadowsCastable = shadowsCastable;
+    staticShadowsChanged();
+}
+
+void Mesh::shadowsStatic(bool shadowsStatic)
+{
+    if (m_shadowsStatic == shadowsStatic) return;
+
+    staticShadowsChanged();
+    m_shadowsStatic = shadowsStatic;
+    staticShadowsChanged();
+}
+
 // ----- Debug
 
 void Mesh::debugBoundingSphere(bool debugBoundingSphere)
@@ -315,6 +375,22 @@ void Mesh::debugBoundingSphere(bool debugBoundingSphere)
 
 // ----- Updates
 
+void Mesh::boundingSpheresChanged()
+{
+    staticShadowsChanged();
+
+    // @note The scene is told only once, it will update them when refitting its BVH.
+    if (m_boundingSphereDirty) return;
+    m_boundingSphereDirty = true;
+    m_scene.meshChanged(*this);
+}
+
+void Mesh::staticShadowsChanged()
+{
+    if (!m_shadowsStatic || !m_shadowsCastable) return;
+    m_scene.staticShadowsChanged();
+}
+
 void Mesh::updateUbo(uint32_t instanceIndex)
 {
     auto& ubo = m_ubos.at(instanceIndex);
@@ -335,7 +411,7 @@ void Mesh::updateTransform(uint32_t instanceIndex)
     instanceInfo.transform = glm::mat4(instanceInfo.rotation) * instanceInfo.transform;
     instanceInfo.transform[3] = glm::vec4(instanceInfo.translation, 1.f);
 
-    m_boundingSphereDirty = true;
+    boundingSpheresChanged();
     updateUbo(instanceIndex);
 }
 
@@ -343,9 +419,17 @@ void Mesh::updateBoundingSpheres()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_UPDATE);
 
+    const auto instancesCount = m_instancesInfos.size();
+    m_instancesBoundingSpheresX.resize(instancesCount);
+    m_instancesBoundingSpheresY.resize(instancesCount);
+    m_instancesBoundingSpheresZ.resize(instancesCount);
+    m_instancesBoundingSpheresRadius.resize(instancesCount);
+
     // Merging all bounding spheres of all instances.
     m_boundingSphere.radius = 0.f;
-    for (auto& instanceInfo : m_instancesInfos) {
+    for (auto i = 0u; i < instancesCount; ++i) {
+        auto& instanceInfo = m_instancesInfos[i];
+
         // @note The world-space bounding sphere is less
         // precise than the geometry-space one because it is based on the bounding box
         // and not the exact vertices.
@@ -353,6 +437,11 @@ void Mesh::updateBoundingSpheres()
         instanceBoundingSphere.center = glm::vec3(instanceInfo.transform * glm::vec4(m_boundingSphereGeometry.center, 1));
         instanceBoundingSphere.radius = glm::length((instanceInfo.scaling * m_boundingBoxExtentGeometry) / 2.f);
         m_boundingSphere = mergeBoundingSpheres(m_boundingSphere, instanceBoundingSphere);
+
+        m_instancesBoundingSpheresX[i] = instanceBoundingSphere.center.x;
+        m_instancesBoundingSpheresY[i] = instanceBoundingSphere.center.y;
+        m_instancesBoundingSpheresZ[i] = instanceBoundingSphere.center.z;
+        m_instancesBoundingSpheresRadius[i] = instanceBoundingSphere.radius;
     }
 
     if (m_debugBoundingSphere) {
@@ -364,9 +453,9 @@ void Mesh::updateBoundingSpheres()
 }
 
 namespace {
-    template <class UInt>
-    inline void setIndices(std::vector<uint16_t>& targetIndices, const VectorView<UInt>& indices, bool flipTriangles,
-                           uint32_t verticesCount)
+    template <class TargetUInt, class UInt>
+    inline void fillIndices(std::vector<TargetUInt>& targetIndices, const VectorView<UInt>& indices, bool flipTriangles,
+                            uint32_t verticesCount)
     {
         auto length = indices.size();
         targetIndices.resize(length);
@@ -375,7 +464,7 @@ namespace {
         if (indices[0] >= verticesCount || indices[length / 2] >= verticesCount) {
             logger.warning("magma.vulkan.mesh") << "Vertices count: " << verticesCount << std::endl;
             logger.warning("magma.vulkan.mesh")
-                << "Wrong vertex index: " << static_cast<uint16_t>(std::max(indices[0], indices[length / 2])) << std::endl;
+                << "Wrong vertex index: " << static_cast<uint32_t>(std::max(indices[0], indices[length / 2])) << std::endl;
             logger.error("magma.vulkan.mesh") << "Some indices are refering indices bigger than the vertices count." << std::endl;
         }
 
@@ -392,4 +481,19 @@ namespace {
             }
         }
     }
+
+    template <class UInt>
+    inline bool setIndices(std::vector<uint16_t>& indices16, std::vector<uint32_t>& indices32, const VectorView<UInt>& indices,
+                           bool flipTriangles, uint32_t verticesCount)
+    {
+        if (verticesCount > MAX_NARROW_VERTICES_COUNT) {
+            fillIndices(indices32, indices, flipTriangles, verticesCount);
+            indices16.clear();
+            return true;
+        }
+
+        fillIndices(indices16, indices, flipTriangles, verticesCount);
+        indices32.clear();
+        return false;
+    }
 }
@@ -43,7 +43,7 @@ VrEngine::Impl::Impl(VrEngine& engine)
 bool VrEngine::Impl::init()
 {
     if (!vr::VR_IsHmdPresent()) {
-        logger.info("magma.openvr.vr-engine") << "VR is not available." << std::endl;
+        $log_info("magma.openvr.vr-engine") << "VR is not available." << std::endl;
         return false;
     }
 
@@ -56,7 +56,7 @@ bool VrEngine::Impl::init()
         return false;
     }
 
-    logger.info("magma.openvr.vr-engine") << "VR enabled." << std::endl;
+    $log_info("magma.openvr.vr-engine") << "VR enabled." << std::endl;
     return true;
 }
 
@@ -109,4 +109,6 @@ void RenderEngine::forget(Texture& texture)
 
 //----- Extra
 
+$pimpl_method_const(RenderEngine, uint32_t, framesInFlightCount);
+$pimpl_method(RenderEngine, void, framesInFlightCount, uint32_t, framesInFlightCount);
 $pimpl_method(RenderEngine, void, logTrackingOnce);
@@ -14,4 +14,5 @@ IRenderTarget::Impl& WindowRenderTarget::interfaceImpl()
 
 $pimpl_method_const(WindowRenderTarget, lava::Extent2d, extent);
 $pimpl_method(WindowRenderTarget, void, extent, const Extent2d&, extent);
+$pimpl_method(WindowRenderTarget, void, readback, ReadbackCallback, callback, const ReadbackOptions&, options);
 $pimpl_attribute_v(WindowRenderTarget, lava::WsHandle, handle);
@@ -122,6 +122,7 @@ Mesh& Scene::makeMesh(uint32_t instancesCount)
     auto resource = m_meshAllocator.allocateSized<Mesh>(size, *this, instancesCount);
 
     m_meshes.emplace_back(resource);
+    m_changedMeshes.emplace_back(resource);
     aft().foreAdd(*resource);
     return *resource;
 }
@@ -193,6 +194,23 @@ void Scene::removeUnsafe(const Camera& camera)
 
 void Scene::removeUnsafe(const Mesh& mesh)
 {
+    m_changedMeshes.erase(std::remove(m_changedMeshes.begin(), m_changedMeshes.end(), &mesh), m_changedMeshes.end());
+
+    if (mesh.shadowsStatic() && mesh.shadowsCastable()) {
+        staticShadowsChanged();
+    }
+
+    auto iLeaf = m_meshesBvhLeaves.find(&mesh);
+    if (iLeaf != m_meshesBvhLeaves.end()) {
+        if (iLeaf->second != Bvh::NULL_NODE) {
+            m_meshesBvh.remove(iLeaf->second);
+        }
+        else {
+            m_depthlessMeshes.erase(std::find(m_depthlessMeshes.begin(), m_depthlessMeshes.end(), &mesh));
+        }
+        m_meshesBvhLeaves.erase(iLeaf);
+    }
+
     for (auto iMesh = m_meshes.begin(); iMesh != m_meshes.end(); ++iMesh) {
         if (*iMesh == &mesh) {
             m_meshAllocator.deallocate(*iMesh);
@@ -213,6 +231,53 @@ void Scene::removeUnsafe(const Flat& flat)
     }
 }
 
+// ----- Spatial queries
+
+void Scene::updateMeshesBvh()
+{
+    PROFILE_FUNCTION(PROFILER_COLOR_UPDATE);
+
+    // @note Updating a mesh's bounding sphere might change its debug mesh,
+    // which will then be added to the list, so we check the size at each iteration.
+    for (auto i = 0u; i < m_changedMeshes.size(); ++i) {
+        auto mesh = m_changedMeshes[i];
+        const bool depthless = (mesh->renderCategory() == RenderCategory::Depthless);
+
+        auto iLeaf = m_meshesBvhLeaves.find(mesh);
+        const bool added = (iLeaf == m_meshesBvhLeaves.end());
+        if (added) {
+            iLeaf = m_meshesBvhLeaves.emplace(mesh, Bvh::NULL_NODE).first;
+        }
+
+        auto& leaf = iLeaf->second;
+        const bool wasDepthless = (!added && leaf == Bvh::NULL_NODE);
+
+        if (depthless) {
+            if (leaf != Bvh::NULL_NODE) {
+                m_meshesBvh.remove(leaf);
+                leaf = Bvh::NULL_NODE;
+            }
+            if (!wasDepthless) {
+                m_depthlessMeshes.emplace_back(mesh);
+            }
+            continue;
+        }
+
+        if (wasDepthless) {
+            m_depthlessMeshes.erase(std::find(m_depthlessMeshes.begin(), m_depthlessMeshes.end(), mesh));
+        }
+
+        if (leaf == Bvh::NULL_NODE) {
+            leaf = m_meshesBvh.insert(*mesh, mesh->boundingSphere());
+        }
+        else {
+            m_meshesBvh.move(leaf, mesh->boundingSphere());
+        }
+    }
+
+    m_changedMeshes.clear();
+}
+
 // ----- Environment
 
 void Scene::environmentTexture(const TexturePtr& texture)
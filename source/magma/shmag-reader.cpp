@@ -1,5 +1,7 @@
 #include "./shmag-reader.hpp"
 
+#include "./helpers/hash.hpp"
+
 // @note Due to windows.h leaking so much BS into global namespace,
 // we cannot rely on using namespace lava::chamber.
 using namespace lava;
@@ -10,6 +12,182 @@ using namespace lava::magma;
 namespace {
     static uint32_t g_globalBasicOffset = 0u;
     static uint32_t g_globalTextureOffset = 0u;
+
+    /**
+     * Successfully read shmag files, keyed by their content.
+     *
+     * As global uniforms offsets depend on what was read before,
+     * the offsets at the start of the read are part of the key.
+     */
+    struct CacheKey {
+        uint64_t codeHash = 0u;
+        uint64_t codeSize = 0u;
+        uint32_t globalBasicOffset = 0u;
+        uint32_t globalTextureOffset = 0u;
+
+        bool operator==(const CacheKey& other) const
+        {
+            return codeHash == other.codeHash && codeSize == other.codeSize && globalBasicOffset == other.globalBasicOffset
+                   && globalTextureOffset == other.globalTextureOffset;
+        }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const
+        {
+            return key.codeHash ^ (key.globalBasicOffset * 31u + key.globalTextureOffset);
+        }
+    };
+
+    struct CacheEntry {
+        std::string processedString;
+        UniformDefinitions uniformDefinitions;
+        UniformDefinitions globalUniformDefinitions;
+        uint32_t globalBasicOffset = 0u;   //!< At the end of the read.
+        uint32_t globalTextureOffset = 0u; //!< At the end of the read.
+    };
+
+    // Hot-reloads add entries for each edit, everything is dropped once that many are stored.
+    constexpr const uint32_t CACHE_MAX_ENTRIES = 64u;
+    static std::unordered_map<CacheKey, CacheEntry, CacheKeyHash> g_cache;
+
+    /**
+     * The same entries are stored on disk, next to each shader,
+     * so that next runs do not lex unchanged files either.
+     * Files with another version or key are just ignored and overwritten.
+     * The version has to be bumped each time the parser output or this layout changes,
+     * otherwise stale files would be trusted.
+     */
+    constexpr const char CACHE_FILE_MAGIC[8] = {'s', 'h', 'm', 'a', 'g', 'c', 'c', 'h'};
+    constexpr const uint32_t CACHE_FILE_VERSION = 1u;
+
+    fs::Path cacheFilePath(const fs::Path& shaderPath)
+    {
+        auto path = shaderPath;
+        path += ".cache";
+        return path;
+    }
+
+    template <class T>
+    void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    bool readValue(std::istream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    void writeString(std::ostream& stream, const std::string& string)
+    {
+        writeValue(stream, static_cast<uint64_t>(string.size()));
+        stream.write(string.data(), string.size());
+    }
+
+    /// Bytes left to read, sizes read from the file cannot be bigger.
+    uint64_t remainingSize(std::istream& stream, uint64_t streamSize)
+    {
+        auto position = stream.tellg();
+        if (position < 0 || static_cast<uint64_t>(position) > streamSize) return 0u;
+        return streamSize - static_cast<uint64_t>(position);
+    }
+
+    // @note Sizes are checked before any allocation,
+    // as a corrupted file should just be ignored and we cannot rely on exceptions.
+    bool readString(std::istream& stream, uint64_t streamSize, std::string& string)
+    {
+        uint64_t size;
+        if (!readValue(stream, size)) return false;
+        if (size > remainingSize(stream, streamSize)) return false;
+        string.resize(size);
+        return static_cast<bool>(stream.read(string.data(), size));
+    }
+
+    void writeUniformDefinitions(std::ostream& stream, const UniformDefinitions& uniformDefinitions)
+    {
+        writeValue(stream, static_cast<uint32_t>(uniformDefinitions.size()));
+        for (const auto& uniformDefinition : uniformDefinitions) {
+            writeString(stream, uniformDefinition.name);
+            writeValue(stream, uniformDefinition.type);
+            writeValue(stream, uniformDefinition.fallback);
+            writeValue(stream, uniformDefinition.arraySize);
+            writeValue(stream, uniformDefinition.offset);
+        }
+    }
+
+    bool readUniformDefinitions(std::istream& stream, uint64_t streamSize, UniformDefinitions& uniformDefinitions)
+    {
+        // Even with empty names, each definition takes that many bytes in the file.
+        constexpr const uint64_t MIN_UNIFORM_DEFINITION_SIZE = sizeof(uint64_t) + sizeof(UniformType) + sizeof(UniformFallback)
+                                                               + sizeof(uint32_t) + sizeof(uint32_t);
+        constexpr const uint32_t MAX_ARRAY_SIZE = sizeof(UniformFallback::uintArrayValue) / sizeof(uint32_t);
+
+        uint32_t count;
+        if (!readValue(stream, count)) return false;
+        if (count > remainingSize(stream, streamSize) / MIN_UNIFORM_DEFINITION_SIZE) return false;
+        uniformDefinitions.resize(count);
+        for (auto& uniformDefinition : uniformDefinitions) {
+            if (!readString(stream, streamSize, uniformDefinition.name)) return false;
+            if (!readValue(stream, uniformDefinition.type)) return false;
+            if (!readValue(stream, uniformDefinition.fallback)) return false;
+            if (!readValue(stream, uniformDefinition.arraySize) || uniformDefinition.arraySize > MAX_ARRAY_SIZE) return false;
+            if (!readValue(stream, uniformDefinition.offset)) return false;
+        }
+        return true;
+    }
+
+    bool readCacheFile(const fs::Path& shaderPath, const CacheKey& cacheKey, CacheEntry& cacheEntry)
+    {
+        std::ifstream file(cacheFilePath(shaderPath), std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        const auto fileEnd = file.tellg();
+        if (fileEnd < 0 || !file.seekg(0)) return false;
+        const auto fileSize = static_cast<uint64_t>(fileEnd);
+
+        char magic[sizeof(CACHE_FILE_MAGIC)];
+        uint32_t version;
+        CacheKey fileCacheKey;
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_FILE_MAGIC, sizeof(magic)) != 0) return false;
+        if (!readValue(file, version) || version != CACHE_FILE_VERSION) return false;
+        if (!readValue(file, fileCacheKey.codeHash) || !readValue(file, fileCacheKey.codeSize)) return false;
+        if (!readValue(file, fileCacheKey.globalBasicOffset) || !readValue(file, fileCacheKey.globalTextureOffset)) return false;
+        if (!(fileCacheKey == cacheKey)) return false;
+
+        return readString(file, fileSize, cacheEntry.processedString)
+               && readUniformDefinitions(file, fileSize, cacheEntry.uniformDefinitions)
+               && readUniformDefinitions(file, fileSize, cacheEntry.globalUniformDefinitions)
+               && readValue(file, cacheEntry.globalBasicOffset) && readValue(file, cacheEntry.globalTextureOffset);
+    }
+
+    void writeCacheFile(const fs::Path& shaderPath, const CacheKey& cacheKey, const CacheEntry& cacheEntry)
+    {
+        // @note Not being able to write (read-only data) only means lexing again next time.
+        std::ofstream file(cacheFilePath(shaderPath), std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return;
+
+        file.write(CACHE_FILE_MAGIC, sizeof(CACHE_FILE_MAGIC));
+        writeValue(file, CACHE_FILE_VERSION);
+        writeValue(file, cacheKey.codeHash);
+        writeValue(file, cacheKey.codeSize);
+        writeValue(file, cacheKey.globalBasicOffset);
+        writeValue(file, cacheKey.globalTextureOffset);
+        writeString(file, cacheEntry.processedString);
+        writeUniformDefinitions(file, cacheEntry.uniformDefinitions);
+        writeUniformDefinitions(file, cacheEntry.globalUniformDefinitions);
+        writeValue(file, cacheEntry.globalBasicOffset);
+        writeValue(file, cacheEntry.globalTextureOffset);
+    }
+
+    void storeCacheEntry(const CacheKey& cacheKey, CacheEntry&& cacheEntry)
+    {
+        if (g_cache.size() >= CACHE_MAX_ENTRIES) {
+            g_cache.clear();
+        }
+        g_cache[cacheKey] = std::move(cacheEntry);
+    }
 }
 
 ShmagReader::ShmagReader(const fs::Path& shaderPath)
@@ -20,6 +198,29 @@ ShmagReader::ShmagReader(const fs::Path& shaderPath)
     buffer << fileStream.rdbuf();
     auto code = buffer.str();
 
+    // Unchanged files are not lexed again.
+    CacheKey cacheKey{hashBytes(code.data(), code.size()), code.size(), g_globalBasicOffset, g_globalTextureOffset};
+    auto cacheEntryIt = g_cache.find(cacheKey);
+    if (cacheEntryIt == g_cache.end()) {
+        CacheEntry cacheEntry;
+        if (readCacheFile(shaderPath, cacheKey, cacheEntry)) {
+            storeCacheEntry(cacheKey, std::move(cacheEntry));
+            cacheEntryIt = g_cache.find(cacheKey);
+        }
+    }
+
+    if (cacheEntryIt != g_cache.end()) {
+        const auto& cacheEntry = cacheEntryIt->second;
+        m_processedString = cacheEntry.processedString;
+        m_uniformDefinitions = cacheEntry.uniformDefinitions;
+        m_globalUniformDefinitions = cacheEntry.globalUniformDefinitions;
+        g_globalBasicOffset = cacheEntry.globalBasicOffset;
+        g_globalTextureOffset = cacheEntry.globalTextureOffset;
+        return;
+    }
+
+    // @note Any change to what is parsed below, and thus to the processed string
+    // or the uniform definitions, needs CACHE_FILE_VERSION to be bumped.
     m_lexer = std::make_unique<Lexer>(code);
 
     std::stringstream adaptedCode;
@@ -56,8 +257,16 @@ ShmagReader::ShmagReader(const fs::Path& shaderPath)
         }
     }
 
+    // The lexer tokens reference the code.
+    m_lexer = nullptr;
+
     if (m_errorsCount == 0u) {
         m_processedString = adaptedCode.str();
+
+        CacheEntry cacheEntry{m_processedString, m_uniformDefinitions, m_globalUniformDefinitions, g_globalBasicOffset,
+                              g_globalTextureOffset};
+        writeCacheFile(shaderPath, cacheKey, cacheEntry);
+        storeCacheEntry(cacheKey, std::move(cacheEntry));
     }
 }
 
@@ -760,7 +969,7 @@ std::string ShmagReader::parseString()
     if (token->type != chamber::TokenType::String) {
         errorExpected(chamber::TokenType::String);
     }
-    return token->string;
+    return std::string(token->string);
 }
 
 glm::vec2 ShmagReader::parseVec2()
@@ -833,7 +1042,7 @@ std::string ShmagReader::parseCurrentIdentifier()
     if (token->type != chamber::TokenType::Identifier) {
         errorExpected(chamber::TokenType::Identifier);
     }
-    return token->string;
+    return std::string(token->string);
 }
 
 void ShmagReader::remapBlock(std::stringstream& adaptedCode, const std::unordered_map<std::string, std::string>& extraMap,
@@ -843,13 +1052,14 @@ void ShmagReader::remapBlock(std::stringstream& adaptedCode, const std::unordere
     while (auto token = m_lexer->nextToken()) {
         auto tokenString = token->string;
         if (token->type == chamber::TokenType::Identifier) {
-            if (m_samplersMap.find(token->string) != m_samplersMap.end())
-                tokenString = m_samplersMap[token->string];
-            else if (m_samplerCubeName == token->string)
+            std::string identifier(token->string);
+            if (auto sampler = m_samplersMap.find(identifier); sampler != m_samplersMap.end())
+                tokenString = sampler->second;
+            else if (m_samplerCubeName == identifier)
                 tokenString = "materialCubeSamplers0";
-            else if (extraMap.find(token->string) != extraMap.end())
-                tokenString = extraMap.at(token->string);
-            else if (token->string == "return")
+            else if (auto extra = extraMap.find(identifier); extra != extraMap.end())
+                tokenString = extra->second;
+            else if (identifier == "return")
                 onReturn();
         }
 
@@ -868,14 +1078,13 @@ void ShmagReader::remapBlock(std::stringstream& adaptedCode, const std::unordere
     adaptedCode << std::endl;
 }
 
-std::string ShmagReader::limitSpacing(const std::string& spacing) const
+std::string ShmagReader::limitSpacing(std::string_view spacing) const
 {
-    auto newSpacing = spacing;
     auto lineReturnCount = std::count(spacing.begin(), spacing.end(), '\n');
     if (lineReturnCount > 1) {
-        newSpacing = "\n" + spacing.substr(spacing.rfind('\n'));
+        return "\n" + std::string(spacing.substr(spacing.rfind('\n')));
     }
-    return newSpacing;
+    return std::string(spacing);
 }
 
 // ----- Errors
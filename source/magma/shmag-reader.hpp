@@ -97,7 +97,7 @@ namespace lava::magma {
 
         bool getNotToken(chamber::TokenType tokenType, chamber::Lexer::Token* token = nullptr);
 
-        std::string limitSpacing(const std::string& spacing) const;
+        std::string limitSpacing(std::string_view spacing) const;
 
         // Errors
         void errorExpected(const std::string& expectedChoices);
@@ -3,6 +3,7 @@
 #include <lava/chamber/thread.hpp>
 #include <lava/magma/render-engine.hpp>
 
+#include "../aft-vulkan/config.hpp"
 #include "./stages/i-renderer-stage.hpp"
 #include "./wrappers.hpp"
 
@@ -11,8 +12,8 @@ namespace lava::magma::vulkan {
      * A thread that update a command buffer on-demand.
      * It encapsulates it own command pool and command buffers.
      *
-     * It holds multiple command buffers so that one can
-     * record twice without issue.
+     * It holds one command buffer per frame id, so that recording
+     * never resets one still used by a frame in flight.
      */
     class CommandBufferThread final : public chamber::Thread {
     public:
@@ -56,7 +57,7 @@ namespace lava::magma::vulkan {
 
         // Resources
         vk::UniqueCommandPool m_commandPool;
-        std::array<vk::UniqueCommandBuffer, 2> m_commandBuffers;
+        std::array<vk::UniqueCommandBuffer, FRAME_IDS_COUNT> m_commandBuffers;
         uint32_t m_bufferIndex = 0u; //!< Holds which command buffer has been used for last record.
     };
 }
@@ -0,0 +1,118 @@
+#include "./deletion-queue.hpp"
+
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr TrackerKey DEFERRED_DELETIONS_KEY("deferred-deletions");
+}
+
+DeletionQueue::~DeletionQueue()
+{
+    for (auto& frameFence : m_inFlightFences) {
+        m_device.waitForFences(1u, &frameFence.fence.get(), true, std::numeric_limits<uint64_t>::max());
+    }
+
+    for (auto& entry : m_entries) {
+        entry.callback();
+    }
+}
+
+void DeletionQueue::init(vk::Device device, vk::Queue graphicsQueue)
+{
+    m_device = device;
+    m_graphicsQueue = graphicsQueue;
+}
+
+void DeletionQueue::callLater(std::function<void()> callback)
+{
+    {
+        std::scoped_lock lock(m_mutex);
+        if (!m_shutdown) {
+            m_entries.push_back({m_frameIndex, std::move(callback)});
+            return;
+        }
+    }
+
+    callback();
+}
+
+void DeletionQueue::endFrame()
+{
+    std::scoped_lock lock(m_mutex);
+
+    // Nothing released this frame, no need for a fence.
+    if (m_shutdown || m_entries.empty() || m_entries.back().frameIndex != m_frameIndex) {
+        m_frameIndex += 1u;
+        return;
+    }
+
+    FrameFence frameFence;
+    frameFence.frameIndex = m_frameIndex;
+    if (!m_freeFences.empty()) {
+        frameFence.fence = std::move(m_freeFences.back());
+        m_freeFences.pop_back();
+    }
+    else {
+        auto result = m_device.createFenceUnique(vk::FenceCreateInfo());
+        frameFence.fence = vulkan::checkMove(result, "deletion-queue", "Unable to create fence.");
+    }
+
+    // An empty submission still signals only once all previous ones on the queue are complete.
+    m_graphicsQueue.submit(0u, nullptr, frameFence.fence.get());
+
+    m_inFlightFences.emplace_back(std::move(frameFence));
+    m_frameIndex += 1u;
+}
+
+void DeletionQueue::update()
+{
+    std::vector<Entry> retiredEntries;
+
+    {
+        std::scoped_lock lock(m_mutex);
+
+        // Fences are submitted on the same queue, so they are signaled in order.
+        auto retiredCount = 0u;
+        uint64_t retiredFrameIndex = 0u;
+        for (auto& frameFence : m_inFlightFences) {
+            if (m_device.getFenceStatus(frameFence.fence.get()) != vk::Result::eSuccess) break;
+            m_device.resetFences(1u, &frameFence.fence.get());
+            m_freeFences.emplace_back(std::move(frameFence.fence));
+            retiredFrameIndex = frameFence.frameIndex;
+            retiredCount += 1u;
+        }
+
+        if (retiredCount == 0u) return;
+        m_inFlightFences.erase(m_inFlightFences.begin(), m_inFlightFences.begin() + retiredCount);
+
+        // Entries are pushed with an increasing frame index.
+        auto entriesEnd = std::find_if(m_entries.begin(), m_entries.end(),
+                                       [retiredFrameIndex](const Entry& entry) { return entry.frameIndex > retiredFrameIndex; });
+        retiredEntries.assign(std::make_move_iterator(m_entries.begin()), std::make_move_iterator(entriesEnd));
+        m_entries.erase(m_entries.begin(), entriesEnd);
+    }
+
+    // @note Called outside of the lock, as destroying something might release other objects.
+    PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
+    tracker.add(DEFERRED_DELETIONS_KEY, retiredEntries.size());
+    for (auto& entry : retiredEntries) {
+        entry.callback();
+    }
+}
+
+void DeletionQueue::shutdown()
+{
+    std::vector<Entry> entries;
+
+    {
+        std::scoped_lock lock(m_mutex);
+        m_shutdown = true;
+        entries = std::move(m_entries);
+        m_entries.clear();
+    }
+
+    for (auto& entry : entries) {
+        entry.callback();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "./wrappers.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace lava::magma::vulkan {
+    /**
+     * Keeps objects alive until the GPU is done with the frame they were released in.
+     *
+     * Each frame ends with an empty submission on the graphics queue, fenced.
+     * As queue submissions complete in order, once that fence is signaled,
+     * nothing submitted during or before that frame can still be using the objects.
+     *
+     * Objects released after shutdown() are destroyed right away,
+     * the device being expected to be idle by then.
+     *
+     * Thread-safe.
+     */
+    class DeletionQueue {
+    public:
+        ~DeletionQueue();
+
+        void init(vk::Device device, vk::Queue graphicsQueue);
+
+        /// Take ownership of the object (a vk::Unique handle or anything movable) and destroy it later.
+        template <class T>
+        void destroyLater(T&& object)
+        {
+            auto holder = std::make_shared<std::decay_t<T>>(std::forward<T>(object));
+            callLater([holder]() {});
+        }
+
+        /// Call the function once the current frame has been retired.
+        void callLater(std::function<void()> callback);
+
+        /// Fence everything submitted so far as the current frame, and go to the next one.
+        void endFrame();
+
+        /// Run everything that was released during retired frames.
+        void update();
+
+        /// Run everything right now, the device should be idle.
+        void shutdown();
+
+    private:
+        struct Entry {
+            uint64_t frameIndex = 0u;
+            std::function<void()> callback;
+        };
+
+        struct FrameFence {
+            uint64_t frameIndex = 0u;
+            vk::UniqueFence fence;
+        };
+
+    private:
+        vk::Device m_device = nullptr;
+        vk::Queue m_graphicsQueue = nullptr;
+        bool m_shutdown = false;
+
+        std::mutex m_mutex;
+        uint64_t m_frameIndex = 0u;
+        std::vector<Entry> m_entries;
+        std::vector<FrameFence> m_inFlightFences; //!< Ordered by frame.
+        std::vector<vk::UniqueFence> m_freeFences;
+    };
+}
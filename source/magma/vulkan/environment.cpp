@@ -76,45 +76,23 @@ void Environment::computeRadiance()
 {
     if (!m_initialized) return;
 
-    // Temporary command buffer
-    auto& engine = m_scene.engine().impl();
-    auto& device = engine.device();
-    auto& queue = engine.graphicsQueue();
-    auto commandPool = engine.commandPool();
-
-    vk::CommandBufferAllocateInfo allocInfo;
-    allocInfo.level = vk::CommandBufferLevel::ePrimary;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    auto result = device.allocateCommandBuffersUnique(allocInfo);
-    auto commandBuffer = std::move(vulkan::checkMove(result, "environment", "Unable to create command buffer.")[0]);
+    auto commandBuffer = beginCommandBuffer();
 
     // ----- Radiance
 
     for (auto mipLevel = 0u; mipLevel < ENVIRONMENT_RADIANCE_MIP_LEVELS_COUNT; ++mipLevel) {
         for (auto faceIndex = 0u; faceIndex < 6u; ++faceIndex) {
-            // Record
-            vk::CommandBufferBeginInfo beginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
-            commandBuffer->begin(&beginInfo);
-
             m_radianceStage.render(commandBuffer.get(), faceIndex, mipLevel);
             m_radianceStage.imageHolder().changeLayout(vk::ImageLayout::eTransferSrcOptimal, commandBuffer.get());
+            fullBarrier(commandBuffer.get());
 
-            commandBuffer->end();
-
-            // Execute
-            vk::SubmitInfo submitInfo;
-            submitInfo.commandBufferCount = 1;
-            submitInfo.pCommandBuffers = &commandBuffer.get();
-            queue.submit(1, &submitInfo, nullptr);
-            queue.waitIdle();
-
-            // Copy image to the cube
-            m_radianceImageHolder.copy(m_radianceStage.image(), faceIndex, mipLevel);
+            // Copy image to the cube, before the stage renders the next face
+            m_radianceImageHolder.copy(commandBuffer.get(), m_radianceStage.image(), faceIndex, mipLevel);
+            fullBarrier(commandBuffer.get());
         }
     }
 
+    submitAndWait(commandBuffer.get());
     updateBindings();
 }
 
@@ -122,51 +100,78 @@ void Environment::computeIrradiance()
 {
     if (!m_initialized) return;
 
-    // Temporary command buffer
+    auto commandBuffer = beginCommandBuffer();
+
+    // ----- Irradiance
+
+    for (auto faceIndex = 0u; faceIndex < 6u; ++faceIndex) {
+        m_irradianceStage.render(commandBuffer.get(), faceIndex);
+        m_irradianceStage.imageHolder().changeLayout(vk::ImageLayout::eTransferSrcOptimal, commandBuffer.get());
+        fullBarrier(commandBuffer.get());
+
+        // Copy image to the cube, before the stage renders the next face
+        m_irradianceImageHolder.copy(commandBuffer.get(), m_irradianceStage.image(), faceIndex);
+        fullBarrier(commandBuffer.get());
+    }
+
+    submitAndWait(commandBuffer.get());
+    updateBindings();
+}
+
+vk::UniqueCommandBuffer Environment::beginCommandBuffer()
+{
     auto& engine = m_scene.engine().impl();
-    auto& device = engine.device();
-    auto& queue = engine.graphicsQueue();
-    auto commandPool = engine.commandPool();
 
     vk::CommandBufferAllocateInfo allocInfo;
     allocInfo.level = vk::CommandBufferLevel::ePrimary;
-    allocInfo.commandPool = commandPool;
+    allocInfo.commandPool = engine.commandPool();
     allocInfo.commandBufferCount = 1;
 
-    auto result = device.allocateCommandBuffersUnique(allocInfo);
+    auto result = engine.device().allocateCommandBuffersUnique(allocInfo);
     auto commandBuffer = std::move(vulkan::checkMove(result, "environment", "Unable to create command buffer.")[0]);
 
-    // ----- Irradiance
+    vk::CommandBufferBeginInfo beginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
+    commandBuffer->begin(&beginInfo);
 
-    for (auto faceIndex = 0u; faceIndex < 6u; ++faceIndex) {
-        // Record
-        vk::CommandBufferBeginInfo beginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
-        commandBuffer->begin(&beginInfo);
+    return commandBuffer;
+}
 
-        m_irradianceStage.render(commandBuffer.get(), faceIndex);
-        m_irradianceStage.imageHolder().changeLayout(vk::ImageLayout::eTransferSrcOptimal, commandBuffer.get());
+void Environment::fullBarrier(vk::CommandBuffer commandBuffer)
+{
+    // @note All faces are recorded in the same command buffer,
+    // so everything needs to be finished before going on.
+    vk::MemoryBarrier barrier;
+    barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands,
+                                  vk::DependencyFlags(), 1u, &barrier, 0u, nullptr, 0u, nullptr);
+}
+
+void Environment::submitAndWait(vk::CommandBuffer commandBuffer)
+{
+    auto& engine = m_scene.engine().impl();
+    commandBuffer.end();
 
-        commandBuffer->end();
+    // The environment texture might still be in the upload queue.
+    engine.uploadQueue().flush();
 
-        // Execute
-        vk::SubmitInfo submitInfo;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer.get();
-        queue.submit(1, &submitInfo, nullptr);
-        queue.waitIdle();
+    auto fenceResult = engine.device().createFenceUnique(vk::FenceCreateInfo());
+    auto fence = vulkan::checkMove(fenceResult, "environment", "Unable to create fence.");
 
-        // Copy image to the cube
-        m_irradianceImageHolder.copy(m_irradianceStage.image(), faceIndex);
-    }
+    vk::SubmitInfo submitInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    engine.graphicsQueue().submit(1, &submitInfo, fence.get());
 
-    updateBindings();
+    static const auto MAX = std::numeric_limits<uint64_t>::max();
+    engine.device().waitForFences(1u, &fence.get(), true, MAX);
 }
 
 void Environment::createResources()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
-    logger.info("magma.vulkan.environment") << "Set to generate " << ENVIRONMENT_RADIANCE_MIP_LEVELS_COUNT
+    $log_info("magma.vulkan.environment") << "Set to generate " << ENVIRONMENT_RADIANCE_MIP_LEVELS_COUNT
                                             << " mip levels for prefiltering." << std::endl;
 
     m_descriptorSet = m_scene.aft().environmentDescriptorHolder().allocateSet("environment");
@@ -26,6 +26,9 @@ namespace lava::magma {
     protected:
         void computeRadiance();
         void computeIrradiance();
+        vk::UniqueCommandBuffer beginCommandBuffer();
+        void fullBarrier(vk::CommandBuffer commandBuffer);
+        void submitAndWait(vk::CommandBuffer commandBuffer);
 
         void createResources();
 
@@ -31,3 +31,18 @@ void vulkan::endSingleTimeCommands(vk::Device device, vk::Queue queue, vk::Comma
     queue.waitIdle();
     device.freeCommandBuffers(commandPool, 1, &commandBuffer);
 }
+
+void vulkan::setViewportAndScissor(vk::CommandBuffer commandBuffer, const vk::Extent2D& extent)
+{
+    vk::Viewport viewport;
+    viewport.width = extent.width;
+    viewport.height = extent.height;
+    viewport.minDepth = 0.f;
+    viewport.maxDepth = 1.f;
+    commandBuffer.setViewport(0, 1, &viewport);
+
+    vk::Rect2D scissor;
+    scissor.offset = vk::Offset2D{0, 0};
+    scissor.extent = extent;
+    commandBuffer.setScissor(0, 1, &scissor);
+}
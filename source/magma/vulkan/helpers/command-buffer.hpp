@@ -6,4 +6,7 @@ namespace lava::magma::vulkan {
 
     /// End a previously started command.
     void endSingleTimeCommands(vk::Device device, vk::Queue queue, vk::CommandPool commandPool, vk::CommandBuffer commandBuffer);
+
+    /// Set the dynamic viewport and scissor of the pipelines to cover the whole extent.
+    void setViewportAndScissor(vk::CommandBuffer commandBuffer, const vk::Extent2D& extent);
 }
@@ -1,11 +1,15 @@
 #include "./buffer-holder.hpp"
 
-#include "../helpers/buffer.hpp"
 #include "../render-engine-impl.hpp"
 
 using namespace lava::magma::vulkan;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey UPLOADS_KEY("uploads.buffers");
+    constexpr TrackerKey UPLOADED_BYTES_KEY("uploads.buffers-bytes");
+}
+
 BufferHolder::BufferHolder(const RenderEngine::Impl& engine)
     : m_engine(engine)
 {
@@ -17,54 +21,65 @@ BufferHolder::BufferHolder(const RenderEngine::Impl& engine, const std::string&
     m_name = name;
 }
 
-void BufferHolder::create(BufferKind kind, vk::DeviceSize size)
+BufferHolder::~BufferHolder()
+{
+    destroyLater();
+}
+
+void BufferHolder::create(BufferKind kind, BufferCpuIo cpuIo, vk::DeviceSize size)
 {
     static const std::unordered_map<BufferKind, vk::BufferUsageFlags> kindToUsageFlagsMap({
         {BufferKind::ShaderUniform, vk::BufferUsageFlagBits::eUniformBuffer},
         {BufferKind::ShaderStorage, vk::BufferUsageFlagBits::eStorageBuffer},
         {BufferKind::ShaderVertex, vk::BufferUsageFlagBits::eVertexBuffer},
-        {BufferKind::ShaderIndex, vk::BufferUsageFlagBits::eIndexBuffer}
+        {BufferKind::ShaderIndex, vk::BufferUsageFlagBits::eIndexBuffer},
+        {BufferKind::Readback, vk::BufferUsageFlagBits::eTransferDst}
     });
 
-    if (m_kind == kind && m_size == size) return;
+    if (m_kind == kind && m_cpuIo == cpuIo && m_size == size) return;
     m_kind = kind;
+    m_cpuIo = cpuIo;
     m_size = size;
 
-    //----- Staging memory
+    vk::BufferUsageFlags usageFlags = kindToUsageFlagsMap.at(kind);
+    vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
 
-    bool needStagingMemory = true;
+    if (cpuIo == BufferCpuIo::None) {
+        usageFlags |= vk::BufferUsageFlagBits::eTransferDst;
+    }
+    else {
+        propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
 
-    if (needStagingMemory) {
-    vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eTransferSrc;
-    vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+    destroyLater();
 
-    vulkan::createBuffer(m_engine.device(), m_engine.physicalDevice(), size, usageFlags, propertyFlags, m_stagingBuffer,
-                         m_stagingMemory);
-    }
+    m_buffer = m_engine.memoryAllocator().createBuffer(size, usageFlags, propertyFlags, MemoryCategory::Buffer, m_memory);
 
-    //----- Final buffer
+    if (cpuIo == BufferCpuIo::None) {
+        m_engine.uploadQueue().created(m_buffer.get());
+    }
+}
 
-    vk::BufferUsageFlags usageFlags = kindToUsageFlagsMap.at(kind);
-    vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
+void BufferHolder::copy(const void* data, vk::DeviceSize size, vk::DeviceSize offset)
+{
+    tracker.add(UPLOADS_KEY);
+    tracker.add(UPLOADED_BYTES_KEY, size);
 
-    if (needStagingMemory) {
-        usageFlags |= vk::BufferUsageFlagBits::eTransferDst;
+    if (m_cpuIo == BufferCpuIo::Direct) {
+        memcpy(reinterpret_cast<uint8_t*>(m_memory.mappedData()) + offset, data, size);
+        return;
     }
 
-    vulkan::createBuffer(m_engine.device(), m_engine.physicalDevice(), size, usageFlags, propertyFlags, m_buffer, m_memory);
-    m_engine.deviceHolder().debugObjectName(m_memory.get(), m_name + ".buffer");
+    m_engine.uploadQueue().copy(m_buffer.get(), m_size, offset, data, size);
 }
 
-void BufferHolder::copy(const void* data, vk::DeviceSize size, vk::DeviceSize offset)
+// ----- Internal
+
+void BufferHolder::destroyLater()
 {
-    // Copy to staging
-    void* targetData;
-    vk::MemoryMapFlags memoryMapFlags;
-    m_engine.device().mapMemory(m_stagingMemory.get(), offset, size, memoryMapFlags, &targetData);
-    memcpy(targetData, data, size);
-    m_engine.device().unmapMemory(m_stagingMemory.get());
-
-    // And to final buffer
-    vulkan::copyBuffer(m_engine.device(), m_engine.transferQueue(), m_engine.transferCommandPool(), m_stagingBuffer.get(), m_buffer.get(),
-                       size, offset);
+    if (!m_buffer) return;
+
+    m_engine.uploadQueue().forget(m_buffer.get());
+    m_engine.deletionQueue().destroyLater(std::move(m_buffer));
+    m_engine.deletionQueue().destroyLater(std::move(m_memory));
 }
@@ -2,6 +2,7 @@
 
 #include <lava/magma/render-engine.hpp>
 
+#include "../memory-allocator.hpp"
 #include "../wrappers.hpp"
 
 namespace lava::magma::vulkan {
@@ -11,6 +12,12 @@ namespace lava::magma::vulkan {
         ShaderStorage, // StorageBuffer, staged memory
         ShaderVertex,  // VertexBuffer, staged memory
         ShaderIndex,   // IndexBuffer, staged memory
+        Readback,      // TransferDst, to be read by the host
+    };
+
+    enum class BufferCpuIo {
+        None,   // Device-local memory, copies are batched by the engine's upload queue
+        Direct, // Host-visible memory kept mapped, copies are plain memcpy
     };
 
     /**
@@ -22,11 +29,14 @@ namespace lava::magma::vulkan {
         BufferHolder() = delete;
         BufferHolder(const RenderEngine::Impl& engine);
         BufferHolder(const RenderEngine::Impl& engine, const std::string& name);
+        BufferHolder(BufferHolder&& other) = default;
+        ~BufferHolder();
 
         /// Allocate all buffer memory.
-        void create(BufferKind kind, vk::DeviceSize size);
+        void create(BufferKind kind, vk::DeviceSize size) { create(kind, BufferCpuIo::None, size); }
+        void create(BufferKind kind, BufferCpuIo cpuIo, vk::DeviceSize size);
 
-        /// Copy data to the buffer.
+        /// Copy data to the buffer, it will be visible to the next submitted frame.
         void copy(const void* data, vk::DeviceSize size, vk::DeviceSize offset = 0u);
 
         /// Helper function to copy data to the buffer.
@@ -36,18 +46,24 @@ namespace lava::magma::vulkan {
         const vk::Buffer& buffer() const { return m_buffer.get(); }
         vk::DeviceSize size() const { return m_size; }
 
+        /// Where to write directly, only valid with BufferCpuIo::Direct.
+        void* mappedData() const { return m_memory.mappedData(); }
+
+    protected:
+        /// Hand the current resources to the deletion queue, as the GPU might still be using them.
+        void destroyLater();
+
     private:
         // References
         const RenderEngine::Impl& m_engine;
         std::string m_name;
 
         // Resources
+        MemoryAllocation m_memory;
         vk::UniqueBuffer m_buffer;
-        vk::UniqueBuffer m_stagingBuffer;
-        vk::UniqueDeviceMemory m_memory;
-        vk::UniqueDeviceMemory m_stagingMemory;
 
         BufferKind m_kind = BufferKind::Unknown;
+        BufferCpuIo m_cpuIo = BufferCpuIo::None;
         vk::DeviceSize m_size = 0u;
     };
 }
@@ -140,7 +140,7 @@ void DeviceHolder::pickPhysicalDevice(vk::Instance instance, vk::SurfaceKHR* pSu
     logger.log().tab(1);
 
     auto physicalDevices = instance.enumeratePhysicalDevices().value;
-    logger.info("magma.vulkan.device-holder") << "Found " << physicalDevices.size() << " GPUs." << std::endl;
+    $log_info("magma.vulkan.device-holder") << "Found " << physicalDevices.size() << " GPUs." << std::endl;
 
     if (physicalDevices.size() == 0) {
         logger.error("magma.vulkan.device-holder") << "Unable to find GPU with Vulkan support." << std::endl;
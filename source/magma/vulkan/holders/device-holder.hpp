@@ -33,6 +33,7 @@ namespace lava::magma::vulkan {
         const vk::Queue& transferQueue() const { return m_transferQueue; }
         const vk::Queue& presentQueue() const { return m_presentQueue; }
         uint32_t graphicsQueueFamilyIndex() const { return m_queueFamilyIndices.graphics; }
+        uint32_t transferQueueFamilyIndex() const { return m_queueFamilyIndices.transfer; }
         uint32_t presentQueueFamilyIndex() const { return m_queueFamilyIndices.present; }
         vk::SampleCountFlagBits maxSampleCount() const { return m_maxSampleCount; }
 
@@ -0,0 +1,84 @@
+#include "./frames-in-flight-holder.hpp"
+
+#include "../render-engine-impl.hpp"
+
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr TrackerKey FRAME_LATENCY_KEY("frame-latency");
+}
+
+FramesInFlightHolder::FramesInFlightHolder(const RenderEngine::Impl& engine, const std::string& name)
+    : m_engine(engine)
+    , m_name(name)
+{
+}
+
+void FramesInFlightHolder::init(bool withSemaphores)
+{
+    PROFILE_FUNCTION(PROFILER_COLOR_INIT);
+
+    for (auto i = 0u; i < m_frames.size(); ++i) {
+        auto& frame = m_frames[i];
+
+        // @note Signaled, so that the first frames do not wait.
+        vk::FenceCreateInfo fenceCreateInfo;
+        fenceCreateInfo.flags = vk::FenceCreateFlagBits::eSignaled;
+
+        auto fenceResult = m_engine.device().createFenceUnique(fenceCreateInfo);
+        frame.fence = vulkan::checkMove(fenceResult, "frames-in-flight-holder", "Unable to create fence.");
+
+        if (!withSemaphores) continue;
+
+        vk::SemaphoreCreateInfo semaphoreCreateInfo;
+
+        auto imageAvailableResult = m_engine.device().createSemaphoreUnique(semaphoreCreateInfo);
+        frame.imageAvailableSemaphore = vulkan::checkMove(imageAvailableResult, "frames-in-flight-holder", "Unable to create semaphore.");
+        m_engine.deviceHolder().debugObjectName(frame.imageAvailableSemaphore.get(),
+                                                m_name + ".image-available." + std::to_string(i));
+
+        auto renderFinishedResult = m_engine.device().createSemaphoreUnique(semaphoreCreateInfo);
+        frame.renderFinishedSemaphore = vulkan::checkMove(renderFinishedResult, "frames-in-flight-holder", "Unable to create semaphore.");
+        m_engine.deviceHolder().debugObjectName(frame.renderFinishedSemaphore.get(),
+                                                m_name + ".render-finished." + std::to_string(i));
+    }
+}
+
+void FramesInFlightHolder::prepare()
+{
+    PROFILE_FUNCTION(PROFILER_COLOR_DRAW);
+
+    if (m_begun) {
+        m_index = (m_index + 1u) % m_frames.size();
+        m_begun = false;
+    }
+
+    const auto& device = m_engine.device();
+
+    // How many of the previous frames the GPU is still working on
+    auto pendingFramesCount = 0u;
+    for (const auto& frame : m_frames) {
+        if (device.getFenceStatus(frame.fence.get()) == vk::Result::eNotReady) {
+            pendingFramesCount += 1u;
+        }
+    }
+    tracker.sample(FRAME_LATENCY_KEY, pendingFramesCount);
+
+    // @note The current slot holds the oldest frame, and has to be retired to be reused.
+    // But when the engine allows fewer frames in flight, we wait for a more recent one,
+    // which also retires the oldest as frames complete in order.
+    const auto count = m_frames.size();
+    const auto framesInFlightCount = m_engine.framesInFlightCount();
+    const auto& fence = m_frames[(m_index + count - framesInFlightCount) % count].fence.get();
+
+    static const auto MAX = std::numeric_limits<uint64_t>::max();
+    device.waitForFences(1u, &fence, true, MAX);
+    device.waitForFences(1u, &m_frames[m_index].fence.get(), true, MAX);
+}
+
+void FramesInFlightHolder::begin()
+{
+    m_engine.device().resetFences(1u, &m_frames[m_index].fence.get());
+    m_begun = true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <lava/magma/render-engine.hpp>
+
+#include "../../aft-vulkan/config.hpp"
+#include "../wrappers.hpp"
+
+namespace lava::magma::vulkan {
+    /**
+     * A ring of per-frame synchronization objects for a render target.
+     *
+     * Each slot is used by one frame in flight, and can only be reused
+     * once the GPU has retired that frame, which its fence tells.
+     * If the engine allows fewer frames in flight than there are slots,
+     * preparing also waits for older frames.
+     */
+    class FramesInFlightHolder {
+    public:
+        FramesInFlightHolder(const RenderEngine::Impl& engine, const std::string& name);
+
+        /// Create the fences, and semaphores if the render target presents.
+        void init(bool withSemaphores);
+
+        /// Go to the next slot if the current one has been submitted, and wait until it can be used.
+        void prepare();
+
+        /// The current slot is about to be submitted, reset its fence.
+        void begin();
+
+        /// Index of the current slot, within [0 .. count()].
+        uint32_t index() const { return m_index; }
+        uint32_t count() const { return m_frames.size(); }
+
+        /// Signaled once the current frame has been retired.
+        vk::Fence fence() const { return m_frames[m_index].fence.get(); }
+
+        /// Signaled once the acquired swapchain image can be rendered to.
+        vk::Semaphore imageAvailableSemaphore() const { return m_frames[m_index].imageAvailableSemaphore.get(); }
+
+        /// Signaled once the current frame is rendered and can be presented.
+        vk::Semaphore renderFinishedSemaphore() const { return m_frames[m_index].renderFinishedSemaphore.get(); }
+
+    private:
+        struct Frame {
+            vk::UniqueFence fence;
+            vk::UniqueSemaphore imageAvailableSemaphore;
+            vk::UniqueSemaphore renderFinishedSemaphore;
+        };
+
+    private:
+        // References
+        const RenderEngine::Impl& m_engine;
+        std::string m_name;
+
+        // Resources
+        std::array<Frame, FRAMES_IN_FLIGHT_COUNT> m_frames;
+        uint32_t m_index = 0u;
+        bool m_begun = false; //!< Whether the current slot has been submitted.
+    };
+}
@@ -1,8 +1,6 @@
 #include "./image-holder.hpp"
 
-#include "../helpers/buffer.hpp"
 #include "../helpers/command-buffer.hpp"
-#include "../helpers/device.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
 
@@ -21,6 +19,11 @@ ImageHolder::ImageHolder(const RenderEngine::Impl& engine, const std::string& na
     m_name = name;
 }
 
+ImageHolder::~ImageHolder()
+{
+    destroyLater();
+}
+
 void ImageHolder::sampleCount(vk::SampleCountFlagBits sampleCount)
 {
     if (m_sampleCount == sampleCount) return;
@@ -100,9 +103,12 @@ void ImageHolder::create(ImageKind kind, vk::Format format, const vk::Extent2D&
     vk::AccessFlags dstAccessMask;
 
     // Depth
-    if (kind == ImageKind::Depth) {
+    if (kind == ImageKind::Depth || kind == ImageKind::CopyableDepth) {
         m_aspect = vk::ImageAspectFlagBits::eDepth;
         usageFlags = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
+        if (kind == ImageKind::CopyableDepth) {
+            usageFlags |= vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+        }
         memoryPropertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal;
         dstStageMask |= vk::PipelineStageFlagBits::eEarlyFragmentTests;
         dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
@@ -126,7 +132,8 @@ void ImageHolder::create(ImageKind kind, vk::Format format, const vk::Extent2D&
             m_layout = vk::ImageLayout::eUndefined;
         }
         else if (kind == ImageKind::RenderTexture) {
-            usageFlags = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled;
+            // @note TransferSrc so that the rendered image can be read back.
+            usageFlags = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc;
             m_layout = vk::ImageLayout::eShaderReadOnlyOptimal;
         }
         else if (kind == ImageKind::Input) {
@@ -155,24 +162,16 @@ void ImageHolder::create(ImageKind kind, vk::Format format, const vk::Extent2D&
         imageCreateInfo.flags = vk::ImageCreateFlagBits::eCubeCompatible;
     }
 
+    destroyLater();
+
     auto imageResult = m_engine.device().createImageUnique(imageCreateInfo);
     m_image = vulkan::checkMove(imageResult, "image-holder", "Unable to create image.");
+    m_lastKnownLayout = vk::ImageLayout::eUndefined;
 
     //---- Memory
 
-    auto memRequirements = m_engine.device().getImageMemoryRequirements(m_image.get());
-
-    vk::MemoryAllocateInfo allocInfo;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex =
-        findMemoryType(m_engine.physicalDevice(), memRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-    auto memoryResult = m_engine.device().allocateMemoryUnique(allocInfo);
-    m_memory = vulkan::checkMove(memoryResult, "image-holder", "Unable to allocate image memory.");
-
-    // @fixme Do we /really/ want to bind all image memories?
-    m_engine.deviceHolder().debugObjectName(m_memory.get(), "image-holder.memory." + m_name);
-    m_engine.device().bindImageMemory(m_image.get(), m_memory.get(), 0);
+    auto memoryCategory = (kind == ImageKind::Texture) ? MemoryCategory::Texture : MemoryCategory::Attachment;
+    m_engine.memoryAllocator().bindImage(m_image.get(), vk::MemoryPropertyFlagBits::eDeviceLocal, memoryCategory, m_memory);
 
     //----- Image view
 
@@ -191,10 +190,10 @@ void ImageHolder::create(ImageKind kind, vk::Format format, const vk::Extent2D&
 
     //----- Transition
 
+    m_engine.uploadQueue().created(m_image.get());
     if (m_layout != vk::ImageLayout::eUndefined) {
-        auto commandBuffer = beginSingleTimeCommands(m_engine.device(), m_engine.commandPool());
-        changeLayoutQuietly(m_layout, commandBuffer);
-        endSingleTimeCommands(m_engine.device(), m_engine.graphicsQueue(), m_engine.commandPool(), commandBuffer);
+        m_engine.uploadQueue().transition(uploadInfo(m_layout));
+        m_lastKnownLayout = m_layout;
     }
 
     if (!m_name.empty()) {
@@ -212,26 +211,6 @@ void ImageHolder::copy(const void* data, uint8_t layersCount, uint8_t layerOffse
     }
     vk::DeviceSize size = m_imageBytesLength * layersCount;
 
-    //----- Staging buffer
-
-    vk::UniqueBuffer stagingBuffer; // @fixme Why not use a buffer holder?
-    vk::UniqueDeviceMemory stagingBufferMemory;
-
-    vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eTransferSrc;
-    vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-
-    createBuffer(m_engine.device(), m_engine.physicalDevice(), size, usageFlags, propertyFlags, stagingBuffer,
-                 stagingBufferMemory);
-    m_engine.deviceHolder().debugObjectName(stagingBufferMemory.get(), "image-holder.staging-buffer-memory." + m_name);
-
-    //----- Copy indeed
-
-    void* targetData;
-    vk::MemoryMapFlags memoryMapFlags;
-    m_engine.device().mapMemory(stagingBufferMemory.get(), 0, size, memoryMapFlags, &targetData);
-    memcpy(targetData, data, size);
-    m_engine.device().unmapMemory(stagingBufferMemory.get());
-
     vk::BufferImageCopy bufferImageCopy;
     bufferImageCopy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
     bufferImageCopy.imageSubresource.baseArrayLayer = layerOffset;
@@ -239,14 +218,11 @@ void ImageHolder::copy(const void* data, uint8_t layersCount, uint8_t layerOffse
     bufferImageCopy.imageSubresource.mipLevel = 0;
     bufferImageCopy.imageExtent = vk::Extent3D{m_extent.width, m_extent.height, 1};
 
-    auto commandBuffer = beginSingleTimeCommands(m_engine.device(), m_engine.commandPool());
-    changeLayoutQuietly(vk::ImageLayout::eTransferDstOptimal, commandBuffer);
-    commandBuffer.copyBufferToImage(stagingBuffer.get(), m_image.get(), vk::ImageLayout::eTransferDstOptimal, 1, &bufferImageCopy);
-    changeLayoutQuietly(m_layout, commandBuffer);
-    endSingleTimeCommands(m_engine.device(), m_engine.graphicsQueue(), m_engine.commandPool(), commandBuffer);
+    m_engine.uploadQueue().copy(uploadInfo(m_layout), bufferImageCopy, data, size);
+    m_lastKnownLayout = m_layout;
 }
 
-void ImageHolder::copy(vk::Image sourceImage, uint8_t layerOffset, uint8_t mipLevel)
+void ImageHolder::copy(vk::CommandBuffer commandBuffer, vk::Image sourceImage, uint8_t layerOffset, uint8_t mipLevel)
 {
     PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
@@ -271,12 +247,10 @@ void ImageHolder::copy(vk::Image sourceImage, uint8_t layerOffset, uint8_t mipLe
     imageCopy.extent.height = height;
     imageCopy.extent.depth = 1;
 
-    auto commandBuffer = beginSingleTimeCommands(m_engine.device(), m_engine.commandPool());
     changeLayoutQuietly(vk::ImageLayout::eTransferDstOptimal, commandBuffer);
     commandBuffer.copyImage(sourceImage, vk::ImageLayout::eTransferSrcOptimal, m_image.get(), vk::ImageLayout::eTransferDstOptimal, 1,
                             &imageCopy);
     changeLayoutQuietly(m_layout, commandBuffer);
-    endSingleTimeCommands(m_engine.device(), m_engine.graphicsQueue(), m_engine.commandPool(), commandBuffer);
 }
 
 void ImageHolder::setup(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, uint8_t channels,
@@ -339,6 +313,8 @@ RenderImage ImageHolder::renderImage(uint32_t uuid) const
     renderImage.impl().view(m_view.get());
     renderImage.impl().layout(m_layout);
     renderImage.impl().channelCount(m_channels);
+    renderImage.impl().format(m_format);
+    renderImage.impl().extent(m_extent);
     return renderImage;
 }
 
@@ -355,15 +331,10 @@ void ImageHolder::savePng(const fs::Path& path, uint8_t layerOffset, uint8_t mip
 
     //----- Staging buffer
 
-    vk::UniqueBuffer stagingBuffer; // @fixme Why not use a BufferHolder?
-    vk::UniqueDeviceMemory stagingBufferMemory;
-
+    MemoryAllocation stagingMemory;
     vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eTransferDst;
     vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
-
-    createBuffer(m_engine.device(), m_engine.physicalDevice(), size, usageFlags, propertyFlags, stagingBuffer,
-                 stagingBufferMemory);
-    m_engine.deviceHolder().debugObjectName(stagingBufferMemory.get(), "image-holder.staging-buffer-memory." + m_name + "." + path.string());
+    auto stagingBuffer = m_engine.memoryAllocator().createBuffer(size, usageFlags, propertyFlags, MemoryCategory::Staging, stagingMemory);
 
     //----- Copy from device
 
@@ -374,6 +345,9 @@ void ImageHolder::savePng(const fs::Path& path, uint8_t layerOffset, uint8_t mip
     bufferImageCopy.imageSubresource.mipLevel = mipLevel;
     bufferImageCopy.imageExtent = vk::Extent3D{width, height, 1};
 
+    // Pending uploads and transitions need to be submitted first.
+    m_engine.uploadQueue().flush();
+
     auto commandBuffer = beginSingleTimeCommands(m_engine.device(), m_engine.commandPool());
     changeLayoutQuietly(vk::ImageLayout::eTransferSrcOptimal, commandBuffer);
     commandBuffer.copyImageToBuffer(m_image.get(), vk::ImageLayout::eTransferSrcOptimal, stagingBuffer.get(), 1, &bufferImageCopy);
@@ -384,10 +358,7 @@ void ImageHolder::savePng(const fs::Path& path, uint8_t layerOffset, uint8_t mip
 
     std::vector<uint32_t> pixels(width * height);
 
-    void* data;
-    vk::MemoryMapFlags memoryMapFlags;
-    m_engine.device().mapMemory(stagingBufferMemory.get(), 0, size, memoryMapFlags, &data);
-
+    const void* data = stagingMemory.mappedData();
     for (uint64_t j = 0u; j < height; ++j) {
         for (uint64_t i = 0u; i < width; ++i) {
             pixels[j * width + i] = extractPixelValue(data, width, i, j);
@@ -395,8 +366,6 @@ void ImageHolder::savePng(const fs::Path& path, uint8_t layerOffset, uint8_t mip
     }
 
     stbi_write_png(path.string().c_str(), width, height, 4u, pixels.data(), 0u);
-
-    m_engine.device().unmapMemory(stagingBufferMemory.get());
 }
 
 // ----- Internal
@@ -429,6 +398,28 @@ void ImageHolder::changeLayoutQuietly(vk::ImageLayout imageLayout, vk::CommandBu
     }
 }
 
+ImageUploadInfo ImageHolder::uploadInfo(vk::ImageLayout newLayout) const
+{
+    ImageUploadInfo info;
+    info.image = m_image.get();
+    info.subresourceRange.aspectMask = m_aspect;
+    info.subresourceRange.levelCount = m_mipLevelsCount;
+    info.subresourceRange.layerCount = m_layersCount;
+    info.oldLayout = m_lastKnownLayout;
+    info.newLayout = newLayout;
+    return info;
+}
+
+void ImageHolder::destroyLater()
+{
+    if (!m_image) return;
+
+    m_engine.uploadQueue().forget(m_image.get());
+    m_engine.deletionQueue().destroyLater(std::move(m_view));
+    m_engine.deletionQueue().destroyLater(std::move(m_image));
+    m_engine.deletionQueue().destroyLater(std::move(m_memory));
+}
+
 // Normalized as RGBA
 uint32_t ImageHolder::extractPixelValue(const void* data, uint64_t width, uint64_t i, uint64_t j) const
 {
@@ -3,16 +3,19 @@
 #include <lava/magma/render-engine.hpp>
 #include <lava/magma/render-image.hpp>
 
+#include "../memory-allocator.hpp"
+#include "../upload-queue.hpp"
 #include "../wrappers.hpp"
 
 namespace lava::magma::vulkan {
     enum class ImageKind {
         Unknown,
         TemporaryRenderTexture,     // Color | Sampled | TransferSrc    (Undefined layout)
-        RenderTexture,              // Color | Sampled                  (ShaderReadOnlyOptimal layout)
+        RenderTexture,              // Color | Sampled | TransferSrc    (ShaderReadOnlyOptimal layout)
         Texture,                    // Color | Sampled | TransferDst    (ShaderReadOnlyOptimal layout)
         Input,                      // Color | Input                    (ShaderReadOnlyOptimal layout)
         Depth,                      // DepthStencil | Sampled           (DepthStencilReadOnlyOptimal layout)
+        CopyableDepth,              // DepthStencil | Sampled | Transfer (DepthStencilReadOnlyOptimal layout)
     };
 
     /**
@@ -24,9 +27,13 @@ namespace lava::magma::vulkan {
         ImageHolder() = delete;
         ImageHolder(const RenderEngine::Impl& engine);
         ImageHolder(const RenderEngine::Impl& engine, const std::string& name);
+        ImageHolder(ImageHolder&& other) = default;
+        ~ImageHolder();
 
         vk::Image image() const { return m_image.get(); }
         vk::ImageView view() const { return m_view.get(); }
+        vk::Format format() const { return m_format; }
+        const vk::Extent2D& extent() const { return m_extent; }
         vk::SampleCountFlagBits sampleCount() const { return m_sampleCount; }
         void sampleCount(vk::SampleCountFlagBits m_sampleCount);
 
@@ -35,7 +42,7 @@ namespace lava::magma::vulkan {
                     uint8_t mipLevelsCount = 1u);
 
         /**
-         * Copy data to the image.
+         * Copy data to the image, through the engine's upload queue.
          * One can specify on which layer to start copying the data,
          * and how many to copy to.
          * Leaving layersCount to 0u means all layers.
@@ -43,13 +50,13 @@ namespace lava::magma::vulkan {
         void copy(const void* data, uint8_t layersCount = 0u, uint8_t layerOffset = 0u);
 
         /**
-         * Copy from a source image.
+         * Record a copy from a source image.
          * The offset and level concerns the target image.
          * The source one is supposed to be not be mip mapped and have no layer offset.
          *
          * @note The sourceImage should be in ImageLayout::eTransferSrcOptimal.
          */
-        void copy(vk::Image sourceImage, uint8_t layerOffset = 0u, uint8_t mipLevel = 0u);
+        void copy(vk::CommandBuffer commandBuffer, vk::Image sourceImage, uint8_t layerOffset = 0u, uint8_t mipLevel = 0u);
 
         /// Allocate and copy from raw bytes.
         void setup(const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, uint8_t channels,
@@ -77,6 +84,11 @@ namespace lava::magma::vulkan {
         // Adds to commands to the commandBuffer to change the layout. This won't change the return value of layout().
         void changeLayoutQuietly(vk::ImageLayout imageLayout, vk::CommandBuffer commandBuffer);
 
+        ImageUploadInfo uploadInfo(vk::ImageLayout newLayout) const;
+
+        /// Hand the current resources to the deletion queue, as the GPU might still be using them.
+        void destroyLater();
+
         uint32_t extractPixelValue(const void* data, uint64_t width, uint64_t i, uint64_t j) const;
 
     private:
@@ -94,8 +106,8 @@ namespace lava::magma::vulkan {
         uint8_t m_channels = 4u;
         uint8_t m_channelBytesLength = 1u;
         bool m_sampleCountChanged = true;
+        MemoryAllocation m_memory;
         vk::UniqueImage m_image;
-        vk::UniqueDeviceMemory m_memory;
         vk::UniqueImageView m_view;
         $attribute(vk::ImageLayout, layout, = vk::ImageLayout::eUndefined);
         $attribute(vk::ImageAspectFlagBits, aspect, = vk::ImageAspectFlagBits::eMetadata);
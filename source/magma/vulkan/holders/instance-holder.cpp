@@ -49,7 +49,7 @@ namespace {
             chamber::logger.warning(type) << message << std::endl;
         }
         else {
-            chamber::logger.info(type) << message << std::endl;
+            $log_info(type) << message << std::endl;
         }
 
         return 0;
@@ -219,5 +219,5 @@ void InstanceHolder::initValidationLayers(vk::InstanceCreateInfo& instanceCreate
     instanceCreateInfo.enabledLayerCount = m_validationLayers.size();
     instanceCreateInfo.ppEnabledLayerNames = m_validationLayers.data();
 
-    logger.info("magma.vulkan.instance-holder") << "Validation layers enabled." << std::endl;
+    $log_info("magma.vulkan.instance-holder") << "Validation layers enabled." << std::endl;
 }
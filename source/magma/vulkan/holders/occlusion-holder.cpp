@@ -0,0 +1,127 @@
+#include "./occlusion-holder.hpp"
+
+#include "../render-engine-impl.hpp"
+#include "./image-holder.hpp"
+
+using namespace lava::magma;
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    uint32_t texelSize(vk::Format format)
+    {
+        return (format == vk::Format::eD16Unorm || format == vk::Format::eD16UnormS8Uint) ? 2u : 4u;
+    }
+}
+
+OcclusionHolder::OcclusionHolder(const RenderEngine::Impl& engine, const std::string& name)
+    : m_engine(engine)
+    , m_name(name)
+{
+}
+
+void OcclusionHolder::beginFrame(uint32_t frameId)
+{
+    m_frameId = frameId;
+    m_pyramid.invalidate();
+
+    // @note The GPU is done with this frame id, as the engine does not
+    // allow more frames in flight than there are frame ids.
+    const auto& bufferHolder = m_bufferHolders[frameId];
+    if (!bufferHolder) return;
+
+    auto data = reinterpret_cast<uint8_t*>(bufferHolder->mappedData());
+    auto& header = *reinterpret_cast<Header*>(data);
+    if (!header.valid || header.width == 0u || header.height == 0u) return;
+
+    PROFILE_FUNCTION(PROFILER_COLOR_UPDATE);
+
+    const auto format = static_cast<vk::Format>(header.format);
+    auto depthFormat = DepthPyramid::DepthFormat::Unorm24;
+    if (format == vk::Format::eD32Sfloat || format == vk::Format::eD32SfloatS8Uint) {
+        depthFormat = DepthPyramid::DepthFormat::Float;
+    }
+    else if (texelSize(format) == 2u) {
+        depthFormat = DepthPyramid::DepthFormat::Unorm16;
+    }
+
+    m_pyramid.build(data + sizeof(Header), depthFormat, header.width, header.height, header.viewProjectionMatrix);
+
+    // Not to be reused if nothing is copied anymore.
+    header.valid = 0u;
+}
+
+void OcclusionHolder::record(vk::CommandBuffer commandBuffer, const ImageHolder& depthImageHolder,
+                             const glm::mat4& viewProjectionMatrix)
+{
+    // Multisampled images cannot be copied to buffers.
+    if (depthImageHolder.sampleCount() != vk::SampleCountFlagBits::e1) return;
+
+    const auto& extent = depthImageHolder.extent();
+    const auto format = depthImageHolder.format();
+    const vk::DeviceSize size = sizeof(Header) + texelSize(format) * extent.width * extent.height;
+
+    auto& bufferHolder = m_bufferHolders[m_frameId];
+    if (!bufferHolder) {
+        bufferHolder = std::make_unique<BufferHolder>(m_engine, m_name + ".depth#" + std::to_string(m_frameId));
+    }
+    if (bufferHolder->size() != size) {
+        bufferHolder->create(BufferKind::Readback, BufferCpuIo::Direct, size);
+        reinterpret_cast<Header*>(bufferHolder->mappedData())->valid = 0u;
+    }
+
+    // The header is written by the GPU too, so that it always matches the depth,
+    // even if this command buffer ends up not being submitted.
+    Header header;
+    header.viewProjectionMatrix = viewProjectionMatrix;
+    header.width = extent.width;
+    header.height = extent.height;
+    header.format = static_cast<uint32_t>(format);
+    header.valid = 1u;
+    commandBuffer.updateBuffer(bufferHolder->buffer(), 0u, sizeof(Header), &header);
+
+    //----- Copy
+
+    vk::ImageMemoryBarrier imageBarrier;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = depthImageHolder.image();
+    imageBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eDepth;
+    imageBarrier.subresourceRange.levelCount = 1u;
+    imageBarrier.subresourceRange.layerCount = 1u;
+    imageBarrier.oldLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+    imageBarrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    imageBarrier.srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+    imageBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eLateFragmentTests, vk::PipelineStageFlagBits::eTransfer,
+                                  vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    vk::BufferImageCopy bufferImageCopy;
+    bufferImageCopy.bufferOffset = sizeof(Header);
+    bufferImageCopy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
+    bufferImageCopy.imageSubresource.layerCount = 1u;
+    bufferImageCopy.imageExtent = vk::Extent3D{extent.width, extent.height, 1u};
+    commandBuffer.copyImageToBuffer(depthImageHolder.image(), vk::ImageLayout::eTransferSrcOptimal, bufferHolder->buffer(), 1u,
+                                    &bufferImageCopy);
+
+    //----- Back to the depth being sampled, and to the host reading the buffer
+
+    imageBarrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    imageBarrier.newLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+    imageBarrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+    imageBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eDepthStencilAttachmentRead
+                                 | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+
+    vk::BufferMemoryBarrier bufferBarrier;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    bufferBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+    bufferBarrier.buffer = bufferHolder->buffer();
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eEarlyFragmentTests
+                                      | vk::PipelineStageFlagBits::eHost,
+                                  vk::DependencyFlags(), 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <lava/magma/render-engine.hpp>
+
+#include "../../aft-vulkan/config.hpp"
+#include "../../depth-pyramid.hpp"
+#include "../wrappers.hpp"
+#include "./buffer-holder.hpp"
+
+#include <array>
+
+namespace lava::magma::vulkan {
+    class ImageHolder;
+}
+
+namespace lava::magma::vulkan {
+    /**
+     * Hierarchical-Z occlusion culling, done on the CPU.
+     *
+     * The depth of a frame is copied to a host-visible buffer, one per frame id,
+     * along with the view-projection matrix it has been rendered with.
+     * When the frame id comes back, the GPU is done with it, and a DepthPyramid is built.
+     * Bounding spheres are then tested against it.
+     *
+     * @note As the depth is some frames old, something appearing from behind
+     * an occluder might pop in a few frames late.
+     *
+     * Not thread-safe, each stage should have its own.
+     */
+    class OcclusionHolder {
+    public:
+        OcclusionHolder(const RenderEngine::Impl& engine, const std::string& name);
+
+        /// Build the pyramid from the depth copied the last time this frame id was used.
+        void beginFrame(uint32_t frameId);
+
+        /// Whether there is a pyramid to test against, canSee() always returns true otherwise.
+        bool valid() const { return m_pyramid.valid(); }
+
+        /// Checks if any part of the bounding sphere might be seen.
+        bool canSee(const BoundingSphere& boundingSphere) const { return m_pyramid.canSee(boundingSphere); }
+
+        /// Checks multiple bounding spheres at once, only clearing visibles[i] of occluded ones.
+        /// Returns how many have been cleared.
+        uint32_t canSee(const chamber::math::SpheresSoa& boundingSpheres, uint32_t count, uint8_t* visibles) const
+        {
+            return m_pyramid.canSee(boundingSpheres, count, visibles);
+        }
+
+        /**
+         * Record the copy of the depth image for a later frame.
+         *
+         * @note The image should be in DepthStencilReadOnlyOptimal layout,
+         * and be created as ImageKind::CopyableDepth. Multisampled ones are ignored.
+         */
+        void record(vk::CommandBuffer commandBuffer, const ImageHolder& depthImageHolder, const glm::mat4& viewProjectionMatrix);
+
+    private:
+        /// Written by the GPU before the depth itself.
+        struct Header {
+            glm::mat4 viewProjectionMatrix;
+            uint32_t width;
+            uint32_t height;
+            uint32_t format; //!< vk::Format of the depth.
+            uint32_t valid;
+        };
+
+    private:
+        const RenderEngine::Impl& m_engine;
+        std::string m_name;
+
+        std::array<std::unique_ptr<BufferHolder>, FRAME_IDS_COUNT> m_bufferHolders;
+        uint32_t m_frameId = 0u;
+
+        DepthPyramid m_pyramid;
+    };
+}
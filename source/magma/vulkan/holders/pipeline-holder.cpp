@@ -17,10 +17,12 @@ void PipelineHolder::init(uint32_t subpassIndex)
     initPipelineLayout();
 }
 
-void PipelineHolder::update(const vk::Extent2D& extent, vk::PolygonMode polygonMode)
+void PipelineHolder::update(vk::PolygonMode polygonMode)
 {
-    // Cannot reconstruct pipeline with an active GPU
-    m_engine.device().waitIdle();
+    // The GPU might still be using the previous pipeline
+    if (m_pipeline) {
+        m_engine.deletionQueue().destroyLater(std::move(m_pipeline));
+    }
 
     //--- Vertex input
 
@@ -61,26 +63,12 @@ void PipelineHolder::update(const vk::Extent2D& extent, vk::PolygonMode polygonM
 
     //--- Viewport state
 
-    vk::Rect2D scissor;
-    scissor.offset = vk::Offset2D{0, 0};
-    scissor.extent = extent;
-
-    vk::Viewport viewport;
-    viewport.width = extent.width;
-    viewport.height = extent.height;
-    viewport.minDepth = 0.f;
-    viewport.maxDepth = 1.f;
-
+    // @note Set by the command buffer, so that resizing does not rebuild the pipeline.
     vk::PipelineViewportStateCreateInfo viewportState;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
 
-    std::vector<vk::DynamicState> dynamicStates;
-    if (m_dynamicViewportEnabled) {
-        dynamicStates.emplace_back(vk::DynamicState::eViewport);
-    }
+    std::array<vk::DynamicState, 2> dynamicStates = {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
 
     vk::PipelineDynamicStateCreateInfo dynamicState;
     dynamicState.dynamicStateCount = dynamicStates.size();
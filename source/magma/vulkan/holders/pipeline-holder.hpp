@@ -51,7 +51,14 @@ namespace lava::magma::vulkan {
         PipelineHolder(RenderEngine::Impl& engine);
 
         void init(uint32_t subpassIndex);
-        void update(const vk::Extent2D& extent, vk::PolygonMode polygonMode = vk::PolygonMode::eFill);
+
+        /**
+         * (Re)create the pipeline.
+         *
+         * @note Viewport and scissor are always dynamic, so that the extent
+         * can change without rebuilding, the command buffer has to set them.
+         */
+        void update(vk::PolygonMode polygonMode = vk::PolygonMode::eFill);
 
         vk::Pipeline pipeline() const { return m_pipeline.get(); }
         vk::PipelineLayout pipelineLayout() const { return m_pipelineLayout.get(); }
@@ -88,9 +95,6 @@ namespace lava::magma::vulkan {
         /// Add a push constants range.
         void addPushConstantRange(uint32_t size);
 
-        /// Whether the pipeline should expect the command buffer to specify the viewport at each render.
-        void dynamicViewportEnabled(bool dynamicViewportEnabled) { m_dynamicViewportEnabled = dynamicViewportEnabled; }
-
         /**
          * Whether the pipeline is for a self-dependent pass.
          * This is used when then pass needs a pipeline barrier
@@ -135,6 +139,5 @@ namespace lava::magma::vulkan {
         vk::CullModeFlags m_cullMode;
         vk::SampleCountFlagBits m_sampleCount = vk::SampleCountFlagBits::e1;
         bool m_selfDependent = false;
-        bool m_dynamicViewportEnabled = false;
     };
 }
@@ -19,7 +19,10 @@ void RenderPassHolder::add(PipelineHolder& pipelineHolder)
 
 void RenderPassHolder::init()
 {
-    m_engine.device().waitIdle();
+    // The GPU might still be using the previous render pass
+    if (m_renderPass) {
+        m_engine.deletionQueue().destroyLater(std::move(m_renderPass));
+    }
 
     std::vector<vk::SubpassDescription> subpassDescriptions;
     std::vector<std::vector<vk::AttachmentReference>> attachmentsReferences(4 * m_pipelineHolders.size());
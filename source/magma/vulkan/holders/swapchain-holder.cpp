@@ -66,21 +66,20 @@ void SwapchainHolder::init(vk::SurfaceKHR surface, const vk::Extent2D& windowExt
 {
     createSwapchain(surface, windowExtent);
     createImageViews();
-    createSemaphore();
 }
 
 void SwapchainHolder::recreate(vk::SurfaceKHR surface, const vk::Extent2D& windowExtent)
 {
-    m_engine.device().waitIdle();
+    // @note Previous resources go through the deletion queue, as frames in flight might still use them.
     createSwapchain(surface, windowExtent);
     createImageViews();
 }
 
-vk::Result SwapchainHolder::acquireNextImage()
+vk::Result SwapchainHolder::acquireNextImage(vk::Semaphore semaphore)
 {
     static const auto MAX = std::numeric_limits<uint64_t>::max();
 
-    return m_engine.device().acquireNextImageKHR(m_swapchain.get(), MAX, m_imageAvailableSemaphore.get(), nullptr, &m_currentIndex);
+    return m_engine.device().acquireNextImageKHR(m_swapchain.get(), MAX, semaphore, nullptr, &m_currentIndex);
 }
 
 //----- Internal
@@ -106,6 +105,10 @@ void SwapchainHolder::createSwapchain(vk::SurfaceKHR surface, const vk::Extent2D
     createInfo.imageExtent = extent;
     createInfo.imageArrayLayers = 1;
     createInfo.imageUsage = vk::ImageUsageFlagBits::eColorAttachment;
+    m_readable = bool(details.capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc);
+    if (m_readable) {
+        createInfo.imageUsage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
     createInfo.preTransform = details.capabilities.currentTransform;
     createInfo.compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque;
     createInfo.presentMode = presentMode;
@@ -122,6 +125,9 @@ void SwapchainHolder::createSwapchain(vk::SurfaceKHR surface, const vk::Extent2D
 
     // Can't replace directly: the oldSwapchain has to be valid
     auto result = m_engine.device().createSwapchainKHRUnique(createInfo);
+    if (m_swapchain) {
+        m_engine.deletionQueue().destroyLater(std::move(m_swapchain));
+    }
     m_swapchain = vulkan::checkMove(result, "swapchain-holder", "Unable to create swapchain");
 
     // Retrieving image handles (we need to request the real image count as the implementation can require more)
@@ -138,6 +144,11 @@ void SwapchainHolder::createSwapchain(vk::SurfaceKHR surface, const vk::Extent2D
 
 void SwapchainHolder::createImageViews()
 {
+    if (!m_imageViews.empty()) {
+        m_engine.deletionQueue().destroyLater(std::move(m_imageViews));
+        m_imageViews.clear();
+    }
+
     m_imageViews.resize(m_images.size());
 
     for (uint32_t i = 0; i < m_images.size(); i++) {
@@ -157,13 +168,3 @@ void SwapchainHolder::createImageViews()
         m_engine.deviceHolder().debugObjectName(m_imageViews[i].get(), "swapchain." + std::to_string(i));
     }
 }
-
-void SwapchainHolder::createSemaphore()
-{
-    vk::SemaphoreCreateInfo createInfo;
-
-    auto result = m_engine.device().createSemaphoreUnique(createInfo);
-    m_imageAvailableSemaphore = vulkan::checkMove(result, "swapchain-holder", "Unable to create semaphore.");
-
-    m_engine.deviceHolder().debugObjectName(m_imageAvailableSemaphore.get(), "swapchain-holder.image-available");
-}
@@ -18,8 +18,8 @@ namespace lava::magma::vulkan {
         /// Recreate the swapchain (the extent or the surface changed).
         void recreate(vk::SurfaceKHR surface, const vk::Extent2D& windowExtent);
 
-        /// Acquire the next image.
-        vk::Result acquireNextImage();
+        /// Acquire the next image, the semaphore being signaled once it is available.
+        vk::Result acquireNextImage(vk::Semaphore semaphore);
 
         //----- Getters
 
@@ -28,12 +28,15 @@ namespace lava::magma::vulkan {
         /// Current index within the framebuffers.
         uint32_t currentIndex() const { return m_currentIndex; }
 
-        /// The semaphore used to signal the next image is available.
-        vk::Semaphore imageAvailableSemaphore() const { return m_imageAvailableSemaphore.get(); }
-
         /// The format chosen during initialization.
         vk::Format imageFormat() const { return m_imageFormat; }
 
+        /// The image for the current index.
+        vk::Image currentImage() const { return m_images[m_currentIndex]; }
+
+        /// Whether images can be copied from, to read them back.
+        bool readable() const { return m_readable; }
+
         /// All the image views.
         const std::vector<vk::UniqueImageView>& imageViews() const { return m_imageViews; }
 
@@ -43,7 +46,6 @@ namespace lava::magma::vulkan {
     protected:
         void createSwapchain(vk::SurfaceKHR surface, const vk::Extent2D& windowExtent);
         void createImageViews();
-        void createSemaphore();
 
     private:
         // References
@@ -56,10 +58,10 @@ namespace lava::magma::vulkan {
         vk::UniqueSwapchainKHR m_swapchain;
         std::vector<vk::Image> m_images;
         std::vector<vk::UniqueImageView> m_imageViews;
-        vk::UniqueSemaphore m_imageAvailableSemaphore;
 
         // Data
         uint32_t m_currentIndex = 0u;
         vk::Format m_imageFormat = vk::Format::eUndefined;
+        bool m_readable = false;
     };
 }
@@ -0,0 +1,94 @@
+#include "./visible-instances-holder.hpp"
+
+#include <lava/magma/frustum.hpp>
+#include <lava/magma/mesh.hpp>
+#include <lava/magma/ubos.hpp>
+
+#include "./occlusion-holder.hpp"
+
+using namespace lava::magma;
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr const uint32_t CHUNK_CAPACITY = 1024u;
+}
+
+VisibleInstancesHolder::VisibleInstancesHolder(const RenderEngine::Impl& engine, const std::string& name)
+    : m_engine(engine)
+    , m_name(name)
+{
+}
+
+void VisibleInstancesHolder::beginFrame(uint32_t frameId)
+{
+    m_frameId = frameId;
+    m_chunkIndex = 0u;
+    m_chunkUsed = 0u;
+}
+
+bool VisibleInstancesHolder::cull(Mesh& mesh, const Frustum& frustum, VisibleInstances& visibleInstances,
+                                  const OcclusionHolder* occlusionHolder)
+{
+    const auto instancesCount = mesh.instancesCount();
+
+    FrameVector<uint8_t> visibles(instancesCount, frameArena.local());
+    frustum.canSee(mesh.instancesBoundingSpheres(), instancesCount, visibles.data());
+
+    visibleInstances.occludedCount = 0u;
+    if (occlusionHolder != nullptr) {
+        visibleInstances.occludedCount = occlusionHolder->canSee(mesh.instancesBoundingSpheres(), instancesCount, visibles.data());
+    }
+
+    const uint32_t visibleCount = std::count(visibles.begin(), visibles.end(), 1u);
+    visibleInstances.count = visibleCount;
+    if (visibleCount == 0u) return false;
+
+    // Nothing to compact, the mesh's buffer can be used as is.
+    if (visibleCount == instancesCount) {
+        visibleInstances.buffer = nullptr;
+        visibleInstances.offset = 0u;
+        return true;
+    }
+
+    // Compacting
+    const auto& ubos = mesh.ubos();
+    auto visibleUbos = allocate(visibleCount, visibleInstances);
+    for (auto i = 0u; i < instancesCount; ++i) {
+        if (visibles[i]) {
+            *visibleUbos = ubos[i];
+            visibleUbos += 1u;
+        }
+    }
+
+    return true;
+}
+
+MeshUbo* VisibleInstancesHolder::allocate(uint32_t count, VisibleInstances& visibleInstances)
+{
+    // Finding some space, a chunk can only be grown if nothing has been bound from it yet.
+    auto& chunks = m_chunks[m_frameId];
+    if (m_chunkIndex < chunks.size() && m_chunkUsed > 0u && m_chunkUsed + count > chunks[m_chunkIndex].capacity) {
+        m_chunkIndex += 1u;
+        m_chunkUsed = 0u;
+    }
+
+    if (m_chunkIndex == chunks.size()) {
+        chunks.emplace_back(Chunk{{m_engine, m_name + ".chunk#" + std::to_string(m_chunkIndex)}});
+    }
+
+    auto& chunk = chunks[m_chunkIndex];
+    if (chunk.capacity < count) {
+        PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
+
+        chunk.capacity = std::max(count, CHUNK_CAPACITY);
+        chunk.holder.create(BufferKind::ShaderVertex, BufferCpuIo::Direct, sizeof(MeshUbo) * chunk.capacity);
+    }
+
+    auto ubos = reinterpret_cast<MeshUbo*>(chunk.holder.mappedData()) + m_chunkUsed;
+    visibleInstances.buffer = chunk.holder.buffer();
+    visibleInstances.offset = sizeof(MeshUbo) * m_chunkUsed;
+    visibleInstances.count = count;
+    m_chunkUsed += count;
+    return ubos;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <lava/magma/render-engine.hpp>
+#include <lava/magma/ubos.hpp>
+
+#include "../../aft-vulkan/config.hpp"
+#include "../wrappers.hpp"
+#include "./buffer-holder.hpp"
+
+#include <array>
+
+namespace lava::magma {
+    class Frustum;
+    class Mesh;
+}
+
+namespace lava::magma::vulkan {
+    class OcclusionHolder;
+}
+
+namespace lava::magma::vulkan {
+    /**
+     * Instances of a mesh that should be drawn,
+     * bound in place of the mesh's own instance buffer.
+     */
+    struct VisibleInstances {
+        vk::Buffer buffer = nullptr; //!< nullptr when all instances are visible.
+        vk::DeviceSize offset = 0u;
+        uint32_t count = 0u;
+        uint32_t occludedCount = 0u; //!< Within the frustum, but hidden behind others.
+    };
+
+    /**
+     * Per-instance frustum and occlusion culling of instanced meshes, done on the CPU.
+     *
+     * The data of visible instances is compacted into host-visible chunks, one set per frame id.
+     * Render queues also use these chunks to merge the instances of similar meshes.
+     * Chunks are only added or grown at the end, so that a buffer already bound
+     * during the current frame is never reallocated.
+     *
+     * Not thread-safe, each stage should have its own.
+     */
+    class VisibleInstancesHolder {
+    public:
+        VisibleInstancesHolder(const RenderEngine::Impl& engine, const std::string& name);
+
+        /// Forget what has been culled during the previous use of that frame id.
+        void beginFrame(uint32_t frameId);
+
+        /// Find the visible instances of the mesh, returns false if none is.
+        bool cull(Mesh& mesh, const Frustum& frustum, VisibleInstances& visibleInstances,
+                  const OcclusionHolder* occlusionHolder = nullptr);
+
+        /// Space for the data of some instances, valid until this frame id comes back.
+        MeshUbo* allocate(uint32_t count, VisibleInstances& visibleInstances);
+
+    private:
+        struct Chunk {
+            BufferHolder holder;
+            uint32_t capacity = 0u; //!< In instances.
+        };
+
+    private:
+        const RenderEngine::Impl& m_engine;
+        std::string m_name;
+
+        std::array<std::vector<Chunk>, FRAME_IDS_COUNT> m_chunks;
+        uint32_t m_frameId = 0u;
+        uint32_t m_chunkIndex = 0u;
+        uint32_t m_chunkUsed = 0u; //!< In instances.
+    };
+}
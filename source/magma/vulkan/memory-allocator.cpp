@@ -0,0 +1,347 @@
+#include "./memory-allocator.hpp"
+
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr const vk::DeviceSize MIN_NODE_SIZE = 256u;
+    constexpr const vk::DeviceSize MAX_BLOCK_SIZE = 64u * 1024u * 1024u;
+
+    constexpr TrackerKey CATEGORIES_USED_KEYS[MEMORY_CATEGORIES_COUNT] = {
+        TrackerKey("vulkan-memory.buffers-bytes"),
+        TrackerKey("vulkan-memory.staging-bytes"),
+        TrackerKey("vulkan-memory.textures-bytes"),
+        TrackerKey("vulkan-memory.attachments-bytes"),
+    };
+    constexpr TrackerKey CATEGORIES_COUNT_KEYS[MEMORY_CATEGORIES_COUNT] = {
+        TrackerKey("vulkan-memory.buffers-count"),
+        TrackerKey("vulkan-memory.staging-count"),
+        TrackerKey("vulkan-memory.textures-count"),
+        TrackerKey("vulkan-memory.attachments-count"),
+    };
+    constexpr TrackerKey BLOCKS_BYTES_KEY("vulkan-memory.blocks-bytes");
+    constexpr TrackerKey DEVICE_MEMORIES_KEY("vulkan-memory.device-memories");
+
+    uint8_t orderOf(vk::DeviceSize size)
+    {
+        uint8_t order = 0u;
+        while ((MIN_NODE_SIZE << order) < size) {
+            ++order;
+        }
+        return order;
+    }
+}
+
+// ----- MemoryAllocation
+
+MemoryAllocation::MemoryAllocation(MemoryAllocation&& other)
+{
+    *this = std::move(other);
+}
+
+MemoryAllocation& MemoryAllocation::operator=(MemoryAllocation&& other)
+{
+    if (this == &other) return *this;
+
+    reset();
+    m_allocator = other.m_allocator;
+    m_memory = other.m_memory;
+    m_offset = other.m_offset;
+    m_size = other.m_size;
+    m_mappedData = other.m_mappedData;
+    m_category = other.m_category;
+    m_poolIndex = other.m_poolIndex;
+    m_blockIndex = other.m_blockIndex;
+    m_order = other.m_order;
+
+    other.m_allocator = nullptr;
+    other.m_memory = nullptr;
+    other.m_mappedData = nullptr;
+    return *this;
+}
+
+MemoryAllocation::~MemoryAllocation()
+{
+    reset();
+}
+
+void MemoryAllocation::reset()
+{
+    if (m_allocator != nullptr && m_memory) {
+        m_allocator->free(*this);
+    }
+
+    m_allocator = nullptr;
+    m_memory = nullptr;
+    m_mappedData = nullptr;
+}
+
+// ----- MemoryAllocator
+
+MemoryAllocator::~MemoryAllocator()
+{
+    for (auto& pool : m_pools) {
+        for (auto& block : pool.blocks) {
+            if (block.usedSize != 0u) {
+                logger.warning("magma.vulkan.memory-allocator") << "Destroyed while some memory is still in use." << std::endl;
+            }
+            m_device.freeMemory(block.memory);
+        }
+    }
+}
+
+void MemoryAllocator::init(vk::Device device, vk::PhysicalDevice physicalDevice)
+{
+    m_device = device;
+    m_memoryProperties = physicalDevice.getMemoryProperties();
+}
+
+MemoryAllocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties,
+                                           bool linear, MemoryCategory category)
+{
+    // Host-visible memory stays mapped and is never flushed nor invalidated,
+    // so it has to be coherent, otherwise writes would need nonCoherentAtomSize-aligned flushes.
+    if (properties & vk::MemoryPropertyFlagBits::eHostVisible) {
+        properties |= vk::MemoryPropertyFlagBits::eHostCoherent;
+    }
+
+    MemoryAllocation allocation;
+    allocation.m_allocator = this;
+    allocation.m_size = requirements.size;
+    allocation.m_category = category;
+
+    auto memoryTypeIndex = 0u;
+    for (; memoryTypeIndex < m_memoryProperties.memoryTypeCount; ++memoryTypeIndex) {
+        if ((requirements.memoryTypeBits & (1u << memoryTypeIndex))
+            && (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & properties) == properties) {
+            break;
+        }
+    }
+
+    if (memoryTypeIndex == m_memoryProperties.memoryTypeCount) {
+        logger.error("magma.vulkan.memory-allocator") << "No memory type matches " << vk::to_string(properties) << "." << std::endl;
+    }
+
+    std::scoped_lock lock(m_mutex);
+
+    auto& categoryStats = m_categoriesStats[static_cast<uint32_t>(category)];
+    categoryStats.usedSize += requirements.size;
+    categoryStats.allocationsCount += 1u;
+
+    uint32_t poolIndex;
+    auto& pool = this->pool(memoryTypeIndex, linear, poolIndex);
+    auto order = orderOf(std::max(requirements.size, requirements.alignment));
+
+    // Too big for the blocks, dedicated memory.
+    if (order > pool.maxOrder) {
+        vk::MemoryAllocateInfo allocateInfo;
+        allocateInfo.allocationSize = requirements.size;
+        allocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+        auto memoryResult = m_device.allocateMemory(allocateInfo);
+        if (memoryResult.result != vk::Result::eSuccess) {
+            logger.error("magma.vulkan.memory-allocator")
+                << "Unable to allocate dedicated memory: " << vk::to_string(memoryResult.result) << "." << std::endl;
+        }
+
+        allocation.m_memory = memoryResult.value;
+        if (pool.hostVisible) {
+            vk::MemoryMapFlags memoryMapFlags;
+            m_device.mapMemory(allocation.m_memory, 0u, VK_WHOLE_SIZE, memoryMapFlags, &allocation.m_mappedData);
+        }
+        m_deviceMemoriesCount += 1u;
+        return allocation;
+    }
+
+    vk::DeviceSize offset = 0u;
+    auto blockIndex = 0u;
+    for (; blockIndex < pool.blocks.size(); ++blockIndex) {
+        if (allocateInBlock(pool.blocks[blockIndex], order, pool.maxOrder, offset)) break;
+    }
+
+    if (blockIndex == pool.blocks.size()) {
+        addBlock(pool);
+        allocateInBlock(pool.blocks[blockIndex], order, pool.maxOrder, offset);
+    }
+
+    auto& block = pool.blocks[blockIndex];
+    block.usedSize += MIN_NODE_SIZE << order;
+
+    allocation.m_memory = block.memory;
+    allocation.m_offset = offset;
+    allocation.m_poolIndex = poolIndex;
+    allocation.m_blockIndex = blockIndex;
+    allocation.m_order = order;
+    if (block.mappedData != nullptr) {
+        allocation.m_mappedData = block.mappedData + offset;
+    }
+
+    return allocation;
+}
+
+vk::UniqueBuffer MemoryAllocator::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+                                               MemoryCategory category, MemoryAllocation& allocation)
+{
+    vk::BufferCreateInfo createInfo;
+    createInfo.size = size;
+    createInfo.usage = usage;
+    createInfo.sharingMode = vk::SharingMode::eExclusive;
+
+    auto bufferResult = m_device.createBufferUnique(createInfo);
+    auto buffer = checkMove(bufferResult, "memory-allocator", "Unable to create buffer.");
+
+    auto requirements = m_device.getBufferMemoryRequirements(buffer.get());
+    allocation = allocate(requirements, properties, true, category);
+    m_device.bindBufferMemory(buffer.get(), allocation.memory(), allocation.offset());
+
+    return buffer;
+}
+
+void MemoryAllocator::bindImage(vk::Image image, vk::MemoryPropertyFlags properties, MemoryCategory category,
+                                MemoryAllocation& allocation)
+{
+    auto requirements = m_device.getImageMemoryRequirements(image);
+    allocation = allocate(requirements, properties, false, category);
+    m_device.bindImageMemory(image, allocation.memory(), allocation.offset());
+}
+
+void MemoryAllocator::trim()
+{
+    std::scoped_lock lock(m_mutex);
+
+    // @note Only trailing blocks are released, so that allocations' block indices stay valid.
+    for (auto& pool : m_pools) {
+        while (pool.blocks.size() > 1u && pool.blocks.back().usedSize == 0u) {
+            m_device.freeMemory(pool.blocks.back().memory);
+            m_blocksSize -= MIN_NODE_SIZE << pool.maxOrder;
+            m_deviceMemoriesCount -= 1u;
+            pool.blocks.pop_back();
+        }
+    }
+}
+
+void MemoryAllocator::track() const
+{
+    std::scoped_lock lock(m_mutex);
+
+    for (auto i = 0u; i < MEMORY_CATEGORIES_COUNT; ++i) {
+        tracker.gauge(CATEGORIES_USED_KEYS[i], m_categoriesStats[i].usedSize);
+        tracker.gauge(CATEGORIES_COUNT_KEYS[i], m_categoriesStats[i].allocationsCount);
+    }
+    tracker.gauge(BLOCKS_BYTES_KEY, m_blocksSize);
+    tracker.gauge(DEVICE_MEMORIES_KEY, m_deviceMemoriesCount);
+}
+
+// ----- Internal
+
+void MemoryAllocator::free(MemoryAllocation& allocation)
+{
+    std::scoped_lock lock(m_mutex);
+
+    auto& categoryStats = m_categoriesStats[static_cast<uint32_t>(allocation.m_category)];
+    categoryStats.usedSize -= allocation.m_size;
+    categoryStats.allocationsCount -= 1u;
+
+    if (allocation.m_poolIndex == -1u) {
+        m_device.freeMemory(allocation.m_memory);
+        m_deviceMemoriesCount -= 1u;
+        return;
+    }
+
+    auto& pool = m_pools[allocation.m_poolIndex];
+    auto& block = pool.blocks[allocation.m_blockIndex];
+    block.usedSize -= MIN_NODE_SIZE << allocation.m_order;
+
+    // Merging with free buddies as long as possible.
+    auto offset = allocation.m_offset;
+    auto order = allocation.m_order;
+    while (order < pool.maxOrder) {
+        auto buddyOffset = offset ^ (MIN_NODE_SIZE << order);
+        auto& freeNodes = block.freeNodes[order];
+        auto buddy = freeNodes.find(buddyOffset);
+        if (buddy == freeNodes.end()) break;
+
+        freeNodes.erase(buddy);
+        offset = std::min(offset, buddyOffset);
+        order += 1u;
+    }
+
+    block.freeNodes[order].emplace(offset);
+}
+
+MemoryAllocator::Pool& MemoryAllocator::pool(uint32_t memoryTypeIndex, bool linear, uint32_t& poolIndex)
+{
+    for (poolIndex = 0u; poolIndex < m_pools.size(); ++poolIndex) {
+        auto& pool = m_pools[poolIndex];
+        if (pool.memoryTypeIndex == memoryTypeIndex && pool.linear == linear) {
+            return pool;
+        }
+    }
+
+    const auto& memoryType = m_memoryProperties.memoryTypes[memoryTypeIndex];
+    const auto heapSize = m_memoryProperties.memoryHeaps[memoryType.heapIndex].size;
+
+    // Small heaps (like host-visible device-local ones) get smaller blocks.
+    auto& pool = m_pools.emplace_back();
+    pool.memoryTypeIndex = memoryTypeIndex;
+    pool.linear = linear;
+    pool.hostVisible = bool(memoryType.propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+    pool.maxOrder = orderOf(MAX_BLOCK_SIZE);
+    while (pool.maxOrder > 0u && (MIN_NODE_SIZE << pool.maxOrder) > heapSize / 8u) {
+        pool.maxOrder -= 1u;
+    }
+
+    return pool;
+}
+
+bool MemoryAllocator::allocateInBlock(Block& block, uint8_t order, uint8_t maxOrder, vk::DeviceSize& offset)
+{
+    // Smallest free node big enough.
+    auto freeOrder = order;
+    while (freeOrder <= maxOrder && block.freeNodes[freeOrder].empty()) {
+        freeOrder += 1u;
+    }
+    if (freeOrder > maxOrder) return false;
+
+    auto& freeNodes = block.freeNodes[freeOrder];
+    offset = *freeNodes.begin();
+    freeNodes.erase(freeNodes.begin());
+
+    // Splitting it, the second halves staying free.
+    while (freeOrder > order) {
+        freeOrder -= 1u;
+        block.freeNodes[freeOrder].emplace(offset + (MIN_NODE_SIZE << freeOrder));
+    }
+
+    return true;
+}
+
+void MemoryAllocator::addBlock(Pool& pool)
+{
+    const auto blockSize = MIN_NODE_SIZE << pool.maxOrder;
+
+    vk::MemoryAllocateInfo allocateInfo;
+    allocateInfo.allocationSize = blockSize;
+    allocateInfo.memoryTypeIndex = pool.memoryTypeIndex;
+
+    auto memoryResult = m_device.allocateMemory(allocateInfo);
+    if (memoryResult.result != vk::Result::eSuccess) {
+        logger.error("magma.vulkan.memory-allocator")
+            << "Unable to allocate a block of " << blockSize << " bytes: " << vk::to_string(memoryResult.result) << "." << std::endl;
+    }
+
+    auto& block = pool.blocks.emplace_back();
+    block.memory = memoryResult.value;
+    block.freeNodes.resize(pool.maxOrder + 1u);
+    block.freeNodes[pool.maxOrder].emplace(0u);
+
+    if (pool.hostVisible) {
+        void* mappedData = nullptr;
+        vk::MemoryMapFlags memoryMapFlags;
+        m_device.mapMemory(block.memory, 0u, VK_WHOLE_SIZE, memoryMapFlags, &mappedData);
+        block.mappedData = reinterpret_cast<uint8_t*>(mappedData);
+    }
+
+    m_blocksSize += blockSize;
+    m_deviceMemoriesCount += 1u;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "./wrappers.hpp"
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+
+namespace lava::magma::vulkan {
+    class MemoryAllocator;
+
+    /// What the memory is used for, only meaningful for statistics.
+    enum class MemoryCategory {
+        Buffer,     // Vertex, index, uniform and storage buffers
+        Staging,    // Transient host-visible buffers for transfers
+        Texture,    // Sampled images
+        Attachment, // Render targets and depth images
+    };
+
+    constexpr const uint32_t MEMORY_CATEGORIES_COUNT = 4u;
+
+    /**
+     * A range within some device memory, given back to the allocator when destroyed.
+     */
+    class MemoryAllocation {
+    public:
+        MemoryAllocation() = default;
+        MemoryAllocation(MemoryAllocation&& other);
+        MemoryAllocation& operator=(MemoryAllocation&& other);
+        MemoryAllocation(const MemoryAllocation&) = delete;
+        MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+        ~MemoryAllocation();
+
+        vk::DeviceMemory memory() const { return m_memory; }
+        vk::DeviceSize offset() const { return m_offset; }
+        vk::DeviceSize size() const { return m_size; }
+
+        /// Host-visible memory is kept mapped, this already takes offset() into account.
+        void* mappedData() const { return m_mappedData; }
+
+        /// Give the memory back.
+        void reset();
+
+        explicit operator bool() const { return m_memory; }
+
+    private:
+        friend class MemoryAllocator;
+
+        MemoryAllocator* m_allocator = nullptr;
+        vk::DeviceMemory m_memory = nullptr;
+        vk::DeviceSize m_offset = 0u;
+        vk::DeviceSize m_size = 0u;
+        void* m_mappedData = nullptr;
+
+        MemoryCategory m_category = MemoryCategory::Buffer;
+        uint32_t m_poolIndex = -1u; //!< -1u for dedicated memory.
+        uint32_t m_blockIndex = 0u;
+        uint8_t m_order = 0u;
+    };
+
+    /**
+     * Sub-allocates device memory from big blocks, with a buddy allocator.
+     *
+     * There is one pool per memory type and per tiling, so that linear resources (buffers)
+     * and optimal ones (images) never share a block and bufferImageGranularity can be ignored.
+     * Blocks are split in power-of-two nodes, each node being aligned to its size,
+     * which makes any power-of-two alignment free.
+     * Requests that do not fit in a block get a dedicated allocation.
+     *
+     * Thread-safe.
+     */
+    class MemoryAllocator {
+    public:
+        ~MemoryAllocator();
+
+        void init(vk::Device device, vk::PhysicalDevice physicalDevice);
+
+        /**
+         * Memory fitting the requirements, linear being true for buffers and linear-tiled images.
+         * Host-visible memory is always host-coherent too.
+         */
+        MemoryAllocation allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear,
+                                  MemoryCategory category);
+
+        /// Create a buffer bound to newly allocated memory.
+        vk::UniqueBuffer createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags properties,
+                                      MemoryCategory category, MemoryAllocation& allocation);
+
+        /// Bind an optimal-tiled image to newly allocated memory.
+        void bindImage(vk::Image image, vk::MemoryPropertyFlags properties, MemoryCategory category, MemoryAllocation& allocation);
+
+        /**
+         * Release the blocks that are completely free, keeping one per pool.
+         * This is the only defragmentation done, live allocations are never moved.
+         * Called by the engine every few hundred updates.
+         */
+        void trim();
+
+        /// Send usage statistics to the tracker.
+        void track() const;
+
+    protected:
+        friend class MemoryAllocation;
+        void free(MemoryAllocation& allocation);
+
+    private:
+        struct Block {
+            vk::DeviceMemory memory = nullptr;
+            uint8_t* mappedData = nullptr;
+            vk::DeviceSize usedSize = 0u;
+            std::vector<std::unordered_set<vk::DeviceSize>> freeNodes; //!< Offsets, per order.
+        };
+
+        struct Pool {
+            uint32_t memoryTypeIndex = 0u;
+            bool linear = true;
+            bool hostVisible = false;
+            uint8_t maxOrder = 0u; //!< Block size is MIN_NODE_SIZE << maxOrder.
+            std::vector<Block> blocks;
+        };
+
+        struct CategoryStats {
+            vk::DeviceSize usedSize = 0u;
+            uint32_t allocationsCount = 0u;
+        };
+
+    protected:
+        Pool& pool(uint32_t memoryTypeIndex, bool linear, uint32_t& poolIndex);
+        bool allocateInBlock(Block& block, uint8_t order, uint8_t maxOrder, vk::DeviceSize& offset);
+        void addBlock(Pool& pool);
+
+    private:
+        vk::Device m_device = nullptr;
+        vk::PhysicalDeviceMemoryProperties m_memoryProperties;
+
+        mutable std::mutex m_mutex;
+        std::vector<Pool> m_pools;
+        std::array<CategoryStats, MEMORY_CATEGORIES_COUNT> m_categoriesStats;
+        vk::DeviceSize m_blocksSize = 0u;
+        uint32_t m_deviceMemoriesCount = 0u;
+    };
+}
@@ -0,0 +1,361 @@
+#include "./readback-queue.hpp"
+
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr const uint32_t MAX_FREE_SLOTS = 8u;
+
+    constexpr TrackerKey READBACKS_KEY("readbacks");
+
+    vk::ImageMemoryBarrier imageBarrier(vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout,
+                                        vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask)
+    {
+        vk::ImageMemoryBarrier barrier;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcAccessMask = srcAccessMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.image = image;
+        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+        barrier.subresourceRange.levelCount = 1u;
+        barrier.subresourceRange.layerCount = 1u;
+        return barrier;
+    }
+}
+
+ReadbackQueue::~ReadbackQueue()
+{
+    for (auto& batch : m_inFlightBatches) {
+        m_device.waitForFences(1u, &batch.fence.get(), true, std::numeric_limits<uint64_t>::max());
+    }
+}
+
+void ReadbackQueue::init(vk::Device device, MemoryAllocator& memoryAllocator, vk::Queue graphicsQueue,
+                         uint32_t graphicsQueueFamilyIndex)
+{
+    m_device = device;
+    m_memoryAllocator = &memoryAllocator;
+    m_graphicsQueue = graphicsQueue;
+
+    vk::CommandPoolCreateInfo createInfo;
+    createInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+    createInfo.queueFamilyIndex = graphicsQueueFamilyIndex;
+
+    auto result = device.createCommandPoolUnique(createInfo);
+    m_commandPool = vulkan::checkMove(result, "readback-queue", "Unable to create command pool.");
+}
+
+void ReadbackQueue::read(const void* source, std::function<ReadbackImageInfo()> imageInfo, const ReadbackOptions& options,
+                         ReadbackCallback callback)
+{
+    std::scoped_lock lock(m_mutex);
+
+    Request request;
+    request.source = source;
+    request.imageInfo = std::move(imageInfo);
+    request.options = options;
+    request.callback = std::move(callback);
+    m_requests.emplace_back(std::move(request));
+}
+
+void ReadbackQueue::read(const void* source, const ReadbackOptions& options, ReadbackCallback callback)
+{
+    std::scoped_lock lock(m_mutex);
+
+    Request request;
+    request.source = source;
+    request.options = options;
+    request.callback = std::move(callback);
+    m_requests.emplace_back(std::move(request));
+}
+
+void ReadbackQueue::record(vk::CommandBuffer commandBuffer, const void* source, const ReadbackImageInfo& info)
+{
+    std::scoped_lock lock(m_mutex);
+
+    auto requestsCount = 0u;
+    for (auto& request : m_requests) {
+        if (request.source == source && !request.imageInfo) {
+            record(commandBuffer, info, request);
+            continue;
+        }
+        m_requests[requestsCount++] = std::move(request);
+    }
+    m_requests.resize(requestsCount);
+}
+
+void ReadbackQueue::flush()
+{
+    std::scoped_lock lock(m_mutex);
+
+    const bool knownRequests = std::any_of(m_requests.begin(), m_requests.end(),
+                                           [](const Request& request) { return static_cast<bool>(request.imageInfo); });
+    if (!knownRequests && m_recordedReads.empty()) return;
+
+    PROFILE_FUNCTION(PROFILER_COLOR_DRAW);
+
+    Batch batch;
+
+    if (knownRequests) {
+        vk::CommandBufferAllocateInfo allocInfo;
+        allocInfo.level = vk::CommandBufferLevel::ePrimary;
+        allocInfo.commandPool = m_commandPool.get();
+        allocInfo.commandBufferCount = 1u;
+
+        auto result = m_device.allocateCommandBuffersUnique(allocInfo);
+        batch.commandBuffer = std::move(vulkan::checkMove(result, "readback-queue", "Unable to create command buffer.")[0]);
+
+        vk::CommandBufferBeginInfo beginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
+        batch.commandBuffer->begin(&beginInfo);
+
+        auto requestsCount = 0u;
+        for (auto& request : m_requests) {
+            if (request.imageInfo) {
+                record(batch.commandBuffer.get(), request.imageInfo(), request);
+                continue;
+            }
+            m_requests[requestsCount++] = std::move(request);
+        }
+        m_requests.resize(requestsCount);
+
+        batch.commandBuffer->end();
+    }
+
+    tracker.add(READBACKS_KEY, m_recordedReads.size());
+    batch.reads = std::move(m_recordedReads);
+    m_recordedReads.clear();
+
+    // @note Even without a command buffer, the fence is signaled once
+    // everything submitted before, like the frame's reads, is done.
+    auto fenceResult = m_device.createFenceUnique(vk::FenceCreateInfo());
+    batch.fence = vulkan::checkMove(fenceResult, "readback-queue", "Unable to create fence.");
+
+    vk::SubmitInfo submitInfo;
+    if (batch.commandBuffer) {
+        submitInfo.commandBufferCount = 1u;
+        submitInfo.pCommandBuffers = &batch.commandBuffer.get();
+    }
+    m_graphicsQueue.submit(1u, &submitInfo, batch.fence.get());
+
+    m_inFlightBatches.emplace_back(std::move(batch));
+}
+
+void ReadbackQueue::update()
+{
+    std::vector<Read> doneReads;
+    std::vector<ReadbackCallback> failedCallbacks;
+
+    {
+        std::scoped_lock lock(m_mutex);
+        failedCallbacks.swap(m_failedCallbacks);
+
+        // All batches are fenced on the graphics queue, so they complete in order.
+        auto completedCount = 0u;
+        for (auto& batch : m_inFlightBatches) {
+            if (m_device.getFenceStatus(batch.fence.get()) != vk::Result::eSuccess) break;
+            std::move(batch.reads.begin(), batch.reads.end(), std::back_inserter(doneReads));
+            completedCount += 1u;
+        }
+
+        m_inFlightBatches.erase(m_inFlightBatches.begin(), m_inFlightBatches.begin() + completedCount);
+    }
+
+    // @note Callbacks are called without the lock, so that they can ask for more reads.
+    for (auto& callback : failedCallbacks) {
+        callback(ReadbackPixels());
+    }
+
+    if (doneReads.empty()) return;
+
+    PROFILE_FUNCTION(PROFILER_COLOR_UPDATE);
+
+    for (auto& read : doneReads) {
+        auto data = reinterpret_cast<uint8_t*>(read.slot.bufferMemory.mappedData());
+        const auto pixelsCount = read.extent.width * read.extent.height;
+
+        if (read.swizzle) {
+            for (auto i = 0u; i < pixelsCount; ++i) {
+                std::swap(data[4u * i], data[4u * i + 2u]);
+            }
+        }
+
+        ReadbackPixels pixels;
+        pixels.data = data;
+        pixels.extent = {read.extent.width, read.extent.height};
+        read.callback(pixels);
+    }
+
+    std::scoped_lock lock(m_mutex);
+    for (auto& read : doneReads) {
+        if (m_freeSlots.size() >= MAX_FREE_SLOTS) break;
+        m_freeSlots.emplace_back(std::move(read.slot));
+    }
+}
+
+void ReadbackQueue::forget(const void* source)
+{
+    std::scoped_lock lock(m_mutex);
+
+    // @note Reads already recorded do not need the source anymore.
+    auto requestsCount = 0u;
+    for (auto& request : m_requests) {
+        if (request.source == source) {
+            m_failedCallbacks.emplace_back(std::move(request.callback));
+            continue;
+        }
+        m_requests[requestsCount++] = std::move(request);
+    }
+    m_requests.resize(requestsCount);
+}
+
+// ----- Internal
+
+void ReadbackQueue::record(vk::CommandBuffer commandBuffer, const ReadbackImageInfo& info, Request& request)
+{
+    const auto& options = request.options;
+
+    if (info.format != vk::Format::eR8G8B8A8Unorm && info.format != vk::Format::eR8G8B8A8Srgb
+        && info.format != vk::Format::eB8G8R8A8Unorm && info.format != vk::Format::eB8G8R8A8Srgb) {
+        logger.warning("magma.vulkan.readback-queue") << "Cannot read back " << vk::to_string(info.format) << " images." << std::endl;
+        m_failedCallbacks.emplace_back(std::move(request.callback));
+        return;
+    }
+
+    // Region, clamped to the image
+    vk::Offset3D offset;
+    offset.x = std::min(options.x, info.extent.width);
+    offset.y = std::min(options.y, info.extent.height);
+    vk::Extent2D extent;
+    extent.width = info.extent.width - offset.x;
+    extent.height = info.extent.height - offset.y;
+    if (options.extent.width != 0u) extent.width = std::min(extent.width, options.extent.width);
+    if (options.extent.height != 0u) extent.height = std::min(extent.height, options.extent.height);
+
+    if (extent.width == 0u || extent.height == 0u) {
+        logger.warning("magma.vulkan.readback-queue") << "Reading back an empty region." << std::endl;
+        m_failedCallbacks.emplace_back(std::move(request.callback));
+        return;
+    }
+
+    const auto downscale = std::max(options.downscale, 1u);
+    const bool downscaled = (downscale > 1u);
+    vk::Extent2D readExtent;
+    readExtent.width = std::max(extent.width / downscale, 1u);
+    readExtent.height = std::max(extent.height / downscale, 1u);
+
+    Read read;
+    read.extent = readExtent;
+    read.swizzle = (info.format == vk::Format::eB8G8R8A8Unorm || info.format == vk::Format::eB8G8R8A8Srgb);
+    read.callback = std::move(request.callback);
+    read.slot = acquireSlot(4u * readExtent.width * readExtent.height, downscaled ? readExtent : vk::Extent2D(),
+                            downscaled ? info.format : vk::Format::eUndefined);
+
+    //----- Source to transfer, after whatever rendered it, and whatever sampled it, like the present pass
+
+    auto sourceBarrier = imageBarrier(info.image, info.layout, vk::ImageLayout::eTransferSrcOptimal,
+                                      vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eShaderRead,
+                                      vk::AccessFlagBits::eTransferRead);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eFragmentShader,
+                                  vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u,
+                                  &sourceBarrier);
+
+    //----- Copy, through a smaller image when downscaling
+
+    vk::BufferImageCopy bufferImageCopy;
+    bufferImageCopy.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    bufferImageCopy.imageSubresource.layerCount = 1u;
+    bufferImageCopy.imageExtent = vk::Extent3D{readExtent.width, readExtent.height, 1u};
+
+    if (downscaled) {
+        auto image = read.slot.image.get();
+
+        auto barrier = imageBarrier(image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::AccessFlags(),
+                                    vk::AccessFlagBits::eTransferWrite);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                      vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u, &barrier);
+
+        vk::ImageBlit imageBlit;
+        imageBlit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        imageBlit.srcSubresource.layerCount = 1u;
+        imageBlit.srcOffsets[0] = offset;
+        imageBlit.srcOffsets[1] = vk::Offset3D(offset.x + extent.width, offset.y + extent.height, 1);
+        imageBlit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+        imageBlit.dstSubresource.layerCount = 1u;
+        imageBlit.dstOffsets[1] = vk::Offset3D(readExtent.width, readExtent.height, 1);
+        commandBuffer.blitImage(info.image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, 1u,
+                                &imageBlit, vk::Filter::eLinear);
+
+        barrier = imageBarrier(image, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eTransferSrcOptimal,
+                               vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                                      vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u, &barrier);
+
+        commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, read.slot.buffer.get(), 1u, &bufferImageCopy);
+    }
+    else {
+        bufferImageCopy.imageOffset = offset;
+        commandBuffer.copyImageToBuffer(info.image, vk::ImageLayout::eTransferSrcOptimal, read.slot.buffer.get(), 1u,
+                                        &bufferImageCopy);
+    }
+
+    //----- Source back to its layout, and buffer visible to the host
+
+    sourceBarrier = imageBarrier(info.image, vk::ImageLayout::eTransferSrcOptimal, info.layout, vk::AccessFlagBits::eTransferRead,
+                                 vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite);
+
+    vk::BufferMemoryBarrier bufferBarrier;
+    bufferBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    bufferBarrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+    bufferBarrier.buffer = read.slot.buffer.get();
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(),
+                                  0u, nullptr, 1u, &bufferBarrier, 1u, &sourceBarrier);
+
+    m_recordedReads.emplace_back(std::move(read));
+}
+
+ReadbackQueue::Slot ReadbackQueue::acquireSlot(vk::DeviceSize bufferSize, const vk::Extent2D& imageExtent, vk::Format imageFormat)
+{
+    Slot slot;
+    if (!m_freeSlots.empty()) {
+        slot = std::move(m_freeSlots.back());
+        m_freeSlots.pop_back();
+    }
+
+    // @note Slots are only free once their read is done, so their resources can be replaced right away.
+    if (slot.bufferSize < bufferSize) {
+        slot.buffer.reset();
+        vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eTransferDst;
+        vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        slot.buffer = m_memoryAllocator->createBuffer(bufferSize, usageFlags, propertyFlags, MemoryCategory::Staging, slot.bufferMemory);
+        slot.bufferSize = bufferSize;
+    }
+
+    if (imageFormat == vk::Format::eUndefined) return slot;
+    if (slot.image && slot.imageFormat == imageFormat && slot.imageExtent == imageExtent) return slot;
+
+    vk::ImageCreateInfo imageCreateInfo;
+    imageCreateInfo.imageType = vk::ImageType::e2D;
+    imageCreateInfo.extent = vk::Extent3D{imageExtent.width, imageExtent.height, 1u};
+    imageCreateInfo.mipLevels = 1u;
+    imageCreateInfo.arrayLayers = 1u;
+    imageCreateInfo.format = imageFormat;
+    imageCreateInfo.tiling = vk::ImageTiling::eOptimal;
+    imageCreateInfo.initialLayout = vk::ImageLayout::eUndefined;
+    imageCreateInfo.usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+    imageCreateInfo.samples = vk::SampleCountFlagBits::e1;
+    imageCreateInfo.sharingMode = vk::SharingMode::eExclusive;
+
+    slot.image.reset();
+    auto imageResult = m_device.createImageUnique(imageCreateInfo);
+    slot.image = vulkan::checkMove(imageResult, "readback-queue", "Unable to create image.");
+    m_memoryAllocator->bindImage(slot.image.get(), vk::MemoryPropertyFlagBits::eDeviceLocal, MemoryCategory::Attachment,
+                                 slot.imageMemory);
+    slot.imageExtent = imageExtent;
+    slot.imageFormat = imageFormat;
+
+    return slot;
+}
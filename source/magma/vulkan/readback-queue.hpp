@@ -0,0 +1,115 @@
+#pragma once
+
+#include <lava/magma/readback.hpp>
+
+#include "./memory-allocator.hpp"
+#include "./wrappers.hpp"
+
+#include <mutex>
+
+namespace lava::magma::vulkan {
+    /// Image to read from, it is left in the same layout afterwards.
+    struct ReadbackImageInfo {
+        vk::Image image = nullptr;
+        vk::Format format = vk::Format::eUndefined; //!< 8-bit RGBA or BGRA.
+        vk::Extent2D extent;
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    };
+
+    /**
+     * Copies rendered images to host-visible buffers, and calls back once the GPU is done.
+     *
+     * Reads are identified by an opaque source, which should forget() them before being destroyed.
+     * Images that stay valid across frames, like cameras' ones, are read within flush(),
+     * their info being asked for only then, as the image or its layout might have changed since.
+     * Others, like swapchain images, can only be read by their owner while it records,
+     * so their reads are kept until the owner calls record().
+     *
+     * flush() is called once per frame, after the frame's submissions,
+     * and its fence covers everything recorded since the previous one.
+     * Completions are only polled by update(), so that nothing ever waits for the GPU.
+     * Buffers and downscaling images are recycled from one read to another.
+     *
+     * Thread-safe, callbacks being called from the thread calling update().
+     */
+    class ReadbackQueue {
+    public:
+        ~ReadbackQueue();
+
+        void init(vk::Device device, MemoryAllocator& memoryAllocator, vk::Queue graphicsQueue, uint32_t graphicsQueueFamilyIndex);
+
+        /// Read the image during next flush(), imageInfo being called then.
+        void read(const void* source, std::function<ReadbackImageInfo()> imageInfo, const ReadbackOptions& options,
+                  ReadbackCallback callback);
+
+        /// Read the source the next time its owner records it.
+        void read(const void* source, const ReadbackOptions& options, ReadbackCallback callback);
+
+        /// Record the pending reads of the source, the command buffer being submitted before next flush().
+        void record(vk::CommandBuffer commandBuffer, const void* source, const ReadbackImageInfo& info);
+
+        /**
+         * Submit the reads of known images, and fence everything recorded this frame.
+         *
+         * @note Submitting to the graphics queue, this should only be called from the thread rendering frames.
+         */
+        void flush();
+
+        /// Call back the reads that are done, or that failed.
+        void update();
+
+        /// Fail the pending reads of the source, because it is going to be destroyed.
+        void forget(const void* source);
+
+    private:
+        /// Where a read ends up.
+        struct Slot {
+            MemoryAllocation bufferMemory;
+            vk::UniqueBuffer buffer;
+            vk::DeviceSize bufferSize = 0u;
+
+            // Only used when downscaling.
+            MemoryAllocation imageMemory;
+            vk::UniqueImage image;
+            vk::Extent2D imageExtent;
+            vk::Format imageFormat = vk::Format::eUndefined;
+        };
+
+        struct Request {
+            const void* source = nullptr;
+            std::function<ReadbackImageInfo()> imageInfo; //!< Empty when the source's owner records it.
+            ReadbackOptions options;
+            ReadbackCallback callback;
+        };
+
+        struct Read {
+            Slot slot;
+            vk::Extent2D extent;
+            bool swizzle = false; //!< Whether the image was BGRA.
+            ReadbackCallback callback;
+        };
+
+        struct Batch {
+            std::vector<Read> reads;
+            vk::UniqueCommandBuffer commandBuffer;
+            vk::UniqueFence fence;
+        };
+
+    protected:
+        void record(vk::CommandBuffer commandBuffer, const ReadbackImageInfo& info, Request& request);
+        Slot acquireSlot(vk::DeviceSize bufferSize, const vk::Extent2D& imageExtent, vk::Format imageFormat);
+
+    private:
+        vk::Device m_device = nullptr;
+        MemoryAllocator* m_memoryAllocator = nullptr;
+        vk::Queue m_graphicsQueue = nullptr;
+
+        std::mutex m_mutex;
+        vk::UniqueCommandPool m_commandPool;
+        std::vector<Request> m_requests;
+        std::vector<Read> m_recordedReads; //!< Waiting for next flush() to be fenced.
+        std::vector<Batch> m_inFlightBatches;
+        std::vector<Slot> m_freeSlots;
+        std::vector<ReadbackCallback> m_failedCallbacks; //!< Called back with no pixels during next update().
+    };
+}
@@ -11,6 +11,23 @@
 using namespace lava::magma;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey DRAW_CALLS_FLAT_RENDERER_KEY("draw-calls.flat-renderer");
+    constexpr TrackerKey DRAW_CALLS_RENDERER_KEY("draw-calls.renderer");
+    constexpr TrackerKey DRAW_CALLS_SHADOWS_KEY("draw-calls.shadows");
+    constexpr TrackerKey CACHED_CASCADES_SHADOWS_KEY("cached-cascades.shadows");
+    constexpr TrackerKey STATIC_REDRAWS_SHADOWS_KEY("static-redraws.shadows");
+    constexpr TrackerKey INSTANCES_RENDERER_KEY("instances.renderer");
+    constexpr TrackerKey VISIBLE_INSTANCES_RENDERER_KEY("visible-instances.renderer");
+    constexpr TrackerKey OCCLUDED_INSTANCES_RENDERER_KEY("occluded-instances.renderer");
+    constexpr TrackerKey SKIPPED_BINDS_KEY("skipped-binds");
+    constexpr TrackerKey MERGED_DRAWS_KEY("merged-draws");
+    constexpr TrackerKey FRAME_LATENCY_KEY("frame-latency");
+
+    // Free memory blocks are kept that many updates, as they are often needed again right after.
+    constexpr const uint32_t MEMORY_TRIM_INTERVAL = 300u;
+}
+
 RenderEngine::Impl::Impl(RenderEngine& engine)
     : m_engine(engine)
     , m_dummyImageHolder{*this, "magma.vulkan.render-engine.dummy-image"}
@@ -29,6 +46,7 @@ RenderEngine::Impl::~Impl()
     vr::VR_Shutdown();
 
     device().waitIdle();
+    m_deletionQueue.shutdown();
 
     for (auto scene : m_scenes) {
         m_engine.sceneAllocator().deallocate(scene);
@@ -41,6 +59,15 @@ void RenderEngine::Impl::update()
 
     updateVr();
     updateShaders();
+    m_uploadQueue.update();
+    m_readbackQueue.update();
+    m_deletionQueue.update();
+
+    m_updatesSinceMemoryTrim += 1u;
+    if (m_updatesSinceMemoryTrim >= MEMORY_TRIM_INTERVAL) {
+        m_memoryAllocator.trim();
+        m_updatesSinceMemoryTrim = 0u;
+    }
 
     for (auto scene : m_scenes) {
         scene->aft().update();
@@ -76,22 +103,13 @@ void RenderEngine::Impl::draw()
     }
 
     // Wait for all scenes to be done with recording
-    for (auto sceneId = 0u; sceneId < m_scenes.size(); ++sceneId) {
-        auto scene = m_scenes[sceneId];
+    for (auto scene : m_scenes) {
         scene->aft().waitRecord();
-
-        // Tracking
-        if (m_logTracking) {
-            logger.info("magma.render-engine") << "Render scene " << sceneId << "." << std::endl;
-            logger.log().tab(1);
-            logger.log() << "draw-calls.flat-renderer: " << tracker.counter("draw-calls.flat-renderer") << std::endl;
-            logger.log() << "draw-calls.renderer: " << tracker.counter("draw-calls.renderer") << std::endl;
-            logger.log() << "draw-calls.shadows: " << tracker.counter("draw-calls.shadows") << std::endl;
-            logger.log().tab(-1);
-            m_logTracking = false;
-        }
     }
 
+    // Everything uploaded this frame goes in one submission, before the frame's ones
+    m_uploadQueue.flush();
+
     // Submit all the command buffers and present to the render targets
     for (auto renderTargetId = 0u; renderTargetId < m_renderTargetBundles.size(); ++renderTargetId) {
         auto& renderTargetBundle = m_renderTargetBundles[renderTargetId];
@@ -104,6 +122,49 @@ void RenderEngine::Impl::draw()
         const auto& commandBuffers = recordCommandBuffer(renderTargetId, currentIndex);
         renderTargetImpl.draw(commandBuffers);
     }
+
+    // Reads of this frame's images are fenced after everything else
+    m_readbackQueue.flush();
+
+    // Whatever has been released up to now can be destroyed once this frame is retired
+    m_deletionQueue.endFrame();
+
+    // Tracking, all threads are done recording for this frame
+    m_memoryAllocator.track();
+    frameArena.endFrame();
+    tracker.endFrame();
+
+    if (m_logTracking) {
+        logger.info("magma.render-engine") << "Render frame " << tracker.frame().frameId << "." << std::endl;
+        logger.log().tab(1);
+        logger.log() << "draw-calls.flat-renderer: " << tracker.counter(DRAW_CALLS_FLAT_RENDERER_KEY) << std::endl;
+        logger.log() << "draw-calls.renderer: " << tracker.counter(DRAW_CALLS_RENDERER_KEY) << std::endl;
+        logger.log() << "draw-calls.shadows: " << tracker.counter(DRAW_CALLS_SHADOWS_KEY) << std::endl;
+        logger.log() << "cached-cascades.shadows: " << tracker.counter(CACHED_CASCADES_SHADOWS_KEY) << std::endl;
+        logger.log() << "static-redraws.shadows: " << tracker.counter(STATIC_REDRAWS_SHADOWS_KEY) << std::endl;
+        logger.log() << "visible-instances.renderer: " << tracker.counter(VISIBLE_INSTANCES_RENDERER_KEY) << " / "
+                     << tracker.counter(INSTANCES_RENDERER_KEY) << std::endl;
+        logger.log() << "occluded-instances.renderer: " << tracker.counter(OCCLUDED_INSTANCES_RENDERER_KEY) << std::endl;
+        logger.log() << "skipped-binds: " << tracker.counter(SKIPPED_BINDS_KEY) << std::endl;
+        logger.log() << "merged-draws: " << tracker.counter(MERGED_DRAWS_KEY) << std::endl;
+        if (auto frameLatency = tracker.frame().find(FRAME_LATENCY_KEY)) {
+            logger.log() << "frame-latency: " << frameLatency->value << " (max " << frameLatency->max << ")" << std::endl;
+        }
+        logger.log().tab(-1);
+        m_logTracking = false;
+    }
+}
+
+void RenderEngine::Impl::framesInFlightCount(uint32_t framesInFlightCount)
+{
+    if (framesInFlightCount < 1u || framesInFlightCount > FRAMES_IN_FLIGHT_COUNT) {
+        logger.warning("magma.vulkan.render-engine") << "Frames in flight count should be between 1 and "
+                                                     << static_cast<uint32_t>(FRAMES_IN_FLIGHT_COUNT) << ", got "
+                                                     << framesInFlightCount << "." << std::endl;
+        framesInFlightCount = std::clamp(framesInFlightCount, 1u, static_cast<uint32_t>(FRAMES_IN_FLIGHT_COUNT));
+    }
+
+    m_framesInFlightCount = framesInFlightCount;
 }
 
 uint32_t RenderEngine::Impl::registerMaterialFromFile(const std::string& hrid, const fs::Path& shaderPath)
@@ -300,7 +361,7 @@ void RenderEngine::Impl::createCommandPools(vk::SurfaceKHR* pSurface)
 {
     PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
-    logger.info("magma.vulkan.render-engine") << "Creating command pool." << std::endl;
+    $log_info("magma.vulkan.render-engine") << "Creating command pool." << std::endl;
 
     auto queueFamilyIndices = vulkan::findQueueFamilies(physicalDevice(), pSurface);
 
@@ -310,19 +371,13 @@ void RenderEngine::Impl::createCommandPools(vk::SurfaceKHR* pSurface)
 
     auto result = device().createCommandPoolUnique(createInfo);
     m_commandPool = vulkan::checkMove(result, "render-engine", "Unable to create command pool.");
-
-    createInfo.queueFamilyIndex = queueFamilyIndices.transfer;
-    createInfo.flags = vk::CommandPoolCreateFlagBits(0x0);
-
-    result = device().createCommandPoolUnique(createInfo);
-    m_transferCommandPool = vulkan::checkMove(result, "render-engine", "Unable to create transfer command pool.");
 }
 
 void RenderEngine::Impl::createDummyTextures()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
 
-    logger.info("magma.vulkan.render-engine") << "Creating dummy textures." << std::endl;
+    $log_info("magma.vulkan.render-engine") << "Creating dummy textures." << std::endl;
 
     // Plain white
     std::vector<uint8_t> dummyData = {0xFF, 0xFF, 0xFF, 0xFF};
@@ -486,6 +541,11 @@ void RenderEngine::Impl::initVulkanDevice(vk::SurfaceKHR* pSurface)
     logger.log().tab(1);
 
     m_deviceHolder.init(instance(), pSurface, m_instanceHolder.debugEnabled(), m_engine.vr());
+    m_memoryAllocator.init(device(), physicalDevice());
+    m_uploadQueue.init(device(), m_memoryAllocator, transferQueue(), transferQueueFamilyIndex(), graphicsQueue(),
+                       graphicsQueueFamilyIndex());
+    m_readbackQueue.init(device(), m_memoryAllocator, graphicsQueue(), graphicsQueueFamilyIndex());
+    m_deletionQueue.init(device(), graphicsQueue());
 
     createCommandPools(pSurface);
     createDummyTextures();
@@ -5,11 +5,16 @@
 #include <lava/magma/render-targets/i-render-target.hpp>
 #include <lava/magma/scene.hpp>
 
+#include "../aft-vulkan/config.hpp"
+#include "./deletion-queue.hpp"
 #include "./holders/buffer-holder.hpp"
 #include "./holders/device-holder.hpp"
 #include "./holders/image-holder.hpp"
 #include "./holders/instance-holder.hpp"
+#include "./memory-allocator.hpp"
+#include "./readback-queue.hpp"
 #include "./shaders-manager.hpp"
+#include "./upload-queue.hpp"
 #include "./wrappers.hpp"
 
 namespace lava::magma {
@@ -32,6 +37,8 @@ namespace lava::magma {
         uint32_t addView(RenderImage renderImage, IRenderTarget& renderTarget, const Viewport& viewport);
         void removeView(uint32_t viewId);
         void logTrackingOnce() { m_logTracking = true; }
+        uint32_t framesInFlightCount() const { return m_framesInFlightCount; }
+        void framesInFlightCount(uint32_t framesInFlightCount);
 
         /**
          * @name Materials
@@ -65,10 +72,14 @@ namespace lava::magma {
         const vk::Queue& transferQueue() const { return m_deviceHolder.transferQueue(); }
         const vk::Queue& presentQueue() const { return m_deviceHolder.presentQueue(); }
         uint32_t graphicsQueueFamilyIndex() const { return m_deviceHolder.graphicsQueueFamilyIndex(); }
+        uint32_t transferQueueFamilyIndex() const { return m_deviceHolder.transferQueueFamilyIndex(); }
         uint32_t presentQueueFamilyIndex() const { return m_deviceHolder.presentQueueFamilyIndex(); }
+        vulkan::MemoryAllocator& memoryAllocator() const { return m_memoryAllocator; }
+        vulkan::UploadQueue& uploadQueue() const { return m_uploadQueue; }
+        vulkan::ReadbackQueue& readbackQueue() const { return m_readbackQueue; }
+        vulkan::DeletionQueue& deletionQueue() const { return m_deletionQueue; }
 
         vk::CommandPool commandPool() const { return m_commandPool.get(); }
-        vk::CommandPool transferCommandPool() const { return m_transferCommandPool.get(); }
 
         ShadersManager& shadersManager() { return m_shadersManager; }
         /// @}
@@ -130,13 +141,20 @@ namespace lava::magma {
     private:
         RenderEngine& m_engine;
         bool m_logTracking = false;
+        uint32_t m_framesInFlightCount = FRAMES_IN_FLIGHT_COUNT;
 
         vulkan::InstanceHolder m_instanceHolder;
         vulkan::DeviceHolder m_deviceHolder;
 
+        /// @note Mutable because holders only get a const engine, and it is thread-safe anyway.
+        mutable vulkan::MemoryAllocator m_memoryAllocator;
+        mutable vulkan::UploadQueue m_uploadQueue;
+        mutable vulkan::ReadbackQueue m_readbackQueue;
+        mutable vulkan::DeletionQueue m_deletionQueue;
+        uint32_t m_updatesSinceMemoryTrim = 0u;
+
         // Commands
         vk::UniqueCommandPool m_commandPool;
-        vk::UniqueCommandPool m_transferCommandPool;
 
         /// Shaders
         ShadersManager m_shadersManager{device()};
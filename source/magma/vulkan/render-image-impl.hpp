@@ -34,11 +34,19 @@ namespace lava::magma {
         uint32_t channelCount() const { return m_channelCount; }
         void channelCount(uint32_t channelCount) { m_channelCount = channelCount; }
 
+        vk::Format format() const { return m_format; }
+        void format(vk::Format format) { m_format = format; }
+
+        const vk::Extent2D& extent() const { return m_extent; }
+        void extent(const vk::Extent2D& extent) { m_extent = extent; }
+
     private:
         uint32_t m_uuid = 0u;
         vk::Image m_image = nullptr;
         vk::ImageView m_view = nullptr;
         vk::ImageLayout m_layout = vk::ImageLayout::eColorAttachmentOptimal;
         uint32_t m_channelCount = 4u;
+        vk::Format m_format = vk::Format::eUndefined;
+        vk::Extent2D m_extent;
     };
 }
@@ -0,0 +1,248 @@
+#include "./render-queue.hpp"
+
+#include <lava/magma/mesh.hpp>
+
+#include "../aft-vulkan/material-aft.hpp"
+#include "../aft-vulkan/mesh-aft.hpp"
+
+using namespace lava::magma;
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr TrackerKey SKIPPED_BINDS_KEY("skipped-binds");
+    constexpr TrackerKey MERGED_DRAWS_KEY("merged-draws");
+
+    /// Spread a hash over the specified number of bits, it only needs to be the same for the same hash.
+    inline uint64_t hashBits(uint64_t hash, uint32_t bitsCount)
+    {
+        return (hash * 0x9E3779B97F4A7C15ull) >> (64u - bitsCount);
+    }
+
+    /// Positive floats keep their order when their bits are compared as integers.
+    inline uint32_t depthBits(float depth)
+    {
+        if (!(depth > 0.f)) return 0u;
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(float));
+        return bits;
+    }
+}
+
+RenderQueue::RenderQueue(Order order)
+    : m_order(order)
+{
+}
+
+void RenderQueue::clear()
+{
+    m_draws.clear();
+    m_keys.clear();
+    m_indices.clear();
+    m_sorted = true;
+}
+
+void RenderQueue::add(const Mesh& mesh, float depth, const VisibleInstances* visibleInstances)
+{
+    const auto& meshAft = mesh.aft();
+    if (!meshAft.renderable()) return;
+
+    // State:       material (24) | geometry (24) | depth (16)
+    // BackToFront: reversed depth (32) | material (32)
+    const auto materialHash = meshAft.materialAft().bindingsHash();
+    uint64_t key;
+    if (m_order == Order::State) {
+        key = (hashBits(materialHash, 24u) << 40u) | (hashBits(meshAft.geometryId(), 24u) << 16u) | (depthBits(depth) >> 16u);
+    }
+    else {
+        key = (static_cast<uint64_t>(~depthBits(depth)) << 32u) | hashBits(materialHash, 32u);
+    }
+
+    Draw draw;
+    draw.mesh = &mesh;
+    draw.culledInstances = (visibleInstances != nullptr);
+    if (visibleInstances != nullptr) {
+        draw.visibleInstances = *visibleInstances;
+    }
+
+    m_draws.emplace_back(draw);
+    m_keys.emplace_back(key);
+    m_sorted = false;
+}
+
+void RenderQueue::sort()
+{
+    if (m_sorted) return;
+    m_sorted = true;
+
+    PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
+
+    // Keys are kept along draws, so that more can be added afterwards.
+    const uint32_t count = m_keys.size();
+    m_sortedKeys.assign(m_keys.begin(), m_keys.end());
+    m_indices.resize(count);
+    for (auto i = 0u; i < count; ++i) {
+        m_indices[i] = i;
+    }
+
+    if (count < 2u) return;
+
+    m_swapKeys.resize(count);
+    m_swapIndices.resize(count);
+
+    // Least significant digit first, 8 bits at a time, which keeps the order of equal keys.
+    for (auto shift = 0u; shift < 64u; shift += 8u) {
+        uint32_t offsets[256] = {0u};
+        for (auto key : m_sortedKeys) {
+            offsets[(key >> shift) & 0xFFu] += 1u;
+        }
+
+        // All keys share that digit, nothing would move.
+        if (offsets[(m_sortedKeys[0] >> shift) & 0xFFu] == count) continue;
+
+        auto offset = 0u;
+        for (auto& digitOffset : offsets) {
+            const auto digitCount = digitOffset;
+            digitOffset = offset;
+            offset += digitCount;
+        }
+
+        for (auto i = 0u; i < count; ++i) {
+            auto& digitOffset = offsets[(m_sortedKeys[i] >> shift) & 0xFFu];
+            m_swapKeys[digitOffset] = m_sortedKeys[i];
+            m_swapIndices[digitOffset] = m_indices[i];
+            digitOffset += 1u;
+        }
+
+        m_sortedKeys.swap(m_swapKeys);
+        m_indices.swap(m_swapIndices);
+    }
+}
+
+uint32_t RenderQueue::record(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex)
+{
+    return record(commandBuffer, pipelineLayout, materialDescriptorSetIndex, false);
+}
+
+uint32_t RenderQueue::recordUnlit(vk::CommandBuffer commandBuffer)
+{
+    return record(commandBuffer, nullptr, 0u, true);
+}
+
+// ----- Internal
+
+uint32_t RenderQueue::record(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex,
+                             bool unlit)
+{
+    PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
+
+    sort();
+
+    const MaterialAft* boundMaterial = nullptr;
+    vk::Buffer boundVertexBuffer = nullptr;
+    vk::Buffer boundInstanceBuffer = nullptr;
+    vk::DeviceSize boundInstanceOffset = 0u;
+    vk::Buffer boundIndexBuffer = nullptr;
+    uint32_t skippedBindsCount = 0u;
+    uint32_t mergedDrawsCount = 0u;
+    uint32_t drawCallsCount = 0u;
+
+    const uint32_t drawsCount = m_indices.size();
+    for (auto i = 0u; i < drawsCount;) {
+        const auto& draw = m_draws[m_indices[i]];
+        const auto& meshAft = draw.mesh->aft();
+
+        // The following draws of the same geometry and material are drawn along this one.
+        auto mergeCount = 1u;
+        if (m_batchingHolder != nullptr) {
+            while (i + mergeCount < drawsCount && mergeable(draw, m_draws[m_indices[i + mergeCount]], unlit)) {
+                mergeCount += 1u;
+            }
+        }
+
+        if (!unlit) {
+            const auto material = &meshAft.materialAft();
+            if (material != boundMaterial) {
+                material->render(commandBuffer, pipelineLayout, materialDescriptorSetIndex);
+                boundMaterial = material;
+            }
+            else {
+                skippedBindsCount += 1u;
+            }
+        }
+
+        const auto& vertexBuffer = unlit ? meshAft.unlitVertexBuffer() : meshAft.vertexBuffer();
+        if (vertexBuffer != boundVertexBuffer) {
+            vk::DeviceSize offsets[] = {0};
+            commandBuffer.bindVertexBuffers(0, 1, &vertexBuffer, offsets);
+            boundVertexBuffer = vertexBuffer;
+        }
+        else {
+            skippedBindsCount += 1u;
+        }
+
+        vk::Buffer instanceBuffer;
+        vk::DeviceSize instanceOffset;
+        uint32_t instancesCount;
+        if (mergeCount > 1u) {
+            // Gathering the instances of all merged meshes
+            instancesCount = 0u;
+            for (auto j = i; j < i + mergeCount; ++j) {
+                instancesCount += m_draws[m_indices[j]].mesh->instancesCount();
+            }
+
+            VisibleInstances mergedInstances;
+            auto ubos = m_batchingHolder->allocate(instancesCount, mergedInstances);
+            for (auto j = i; j < i + mergeCount; ++j) {
+                const auto& meshUbos = m_draws[m_indices[j]].mesh->ubos();
+                ubos = std::copy(meshUbos.begin(), meshUbos.end(), ubos);
+            }
+
+            instancesCount = meshAft.instances(&mergedInstances, instanceBuffer, instanceOffset);
+            mergedDrawsCount += mergeCount - 1u;
+        }
+        else {
+            instancesCount = meshAft.instances(draw.culledInstances ? &draw.visibleInstances : nullptr, instanceBuffer, instanceOffset);
+        }
+
+        if (instanceBuffer != boundInstanceBuffer || instanceOffset != boundInstanceOffset) {
+            commandBuffer.bindVertexBuffers(1, 1, &instanceBuffer, &instanceOffset);
+            boundInstanceBuffer = instanceBuffer;
+            boundInstanceOffset = instanceOffset;
+        }
+        else {
+            skippedBindsCount += 1u;
+        }
+
+        const auto& indexBuffer = meshAft.indexBuffer();
+        if (indexBuffer != boundIndexBuffer) {
+            commandBuffer.bindIndexBuffer(indexBuffer, 0, meshAft.indexType());
+            boundIndexBuffer = indexBuffer;
+        }
+        else {
+            skippedBindsCount += 1u;
+        }
+
+        commandBuffer.drawIndexed(meshAft.indicesCount(), instancesCount, 0, 0, 0);
+        drawCallsCount += 1u;
+        i += mergeCount;
+    }
+
+    tracker.add(SKIPPED_BINDS_KEY, skippedBindsCount);
+    tracker.add(MERGED_DRAWS_KEY, mergedDrawsCount);
+    return drawCallsCount;
+}
+
+bool RenderQueue::mergeable(const Draw& draw, const Draw& nextDraw, bool unlit) const
+{
+    // Compacted instances already live in a transient buffer, they are left as is.
+    if (draw.culledInstances && draw.visibleInstances.buffer) return false;
+    if (nextDraw.culledInstances && nextDraw.visibleInstances.buffer) return false;
+
+    const auto& meshAft = draw.mesh->aft();
+    const auto& nextMeshAft = nextDraw.mesh->aft();
+    // Keys being only hashes, this checks what is really bound.
+    if (meshAft.geometryId() == 0u || meshAft.geometryId() != nextMeshAft.geometryId()) return false;
+
+    return unlit || meshAft.materialAft().sameBindings(nextMeshAft.materialAft());
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "./holders/visible-instances-holder.hpp"
+#include "./wrappers.hpp"
+
+#include <vector>
+
+namespace lava::magma {
+    class Mesh;
+}
+
+namespace lava::magma::vulkan {
+    /**
+     * Meshes to be drawn within one subpass, ordered to avoid binding the same state twice.
+     *
+     * Each draw gets a 64-bit key and they are radix-sorted on it:
+     * - Order::State groups by material, then geometry, then goes front-to-back;
+     * - Order::BackToFront goes by depth first, as needed for blending.
+     *
+     * Materials and geometries are keyed by their content, not their address,
+     * so that meshes loaded multiple times from the same file end up next to each other.
+     * When a batching holder is set, such neighbours are merged into one draw,
+     * their instances being gathered in a transient buffer.
+     * Merging needs the same geometry id and the same material bindings, keys alone are never trusted.
+     *
+     * Recording only binds what differs from the previous draw,
+     * the pipeline being expected to stay the same all along.
+     *
+     * Not thread-safe, each recording thread should have its own.
+     */
+    class RenderQueue {
+    public:
+        enum class Order {
+            State,
+            BackToFront,
+        };
+
+    public:
+        RenderQueue(Order order = Order::State);
+
+        /// Where instances of merged draws are gathered, nothing is merged if nullptr.
+        VisibleInstancesHolder* batchingHolder() const { return m_batchingHolder; }
+        void batchingHolder(VisibleInstancesHolder* batchingHolder) { m_batchingHolder = batchingHolder; }
+
+        /// Forget all previous draws.
+        void clear();
+
+        /// Queue the mesh, depth being its distance to the camera.
+        void add(const Mesh& mesh, float depth, const VisibleInstances* visibleInstances = nullptr);
+
+        uint32_t size() const { return m_draws.size(); }
+        bool empty() const { return m_draws.empty(); }
+
+        /// Order draws along their keys, record() does it if not done since the last add().
+        void sort();
+
+        /**
+         * Sort and draw everything, binding materials at the specified descriptor set index.
+         *
+         * @return The count of draw calls issued, merged draws counting once.
+         */
+        uint32_t record(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex);
+
+        /// Sort and draw everything with only positions, no material being bound, returning the count of draw calls.
+        uint32_t recordUnlit(vk::CommandBuffer commandBuffer);
+
+    protected:
+        struct Draw {
+            const Mesh* mesh;
+            VisibleInstances visibleInstances;
+            bool culledInstances; //!< Whether visibleInstances should be used.
+        };
+
+        bool mergeable(const Draw& draw, const Draw& nextDraw, bool unlit) const;
+        uint32_t record(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, uint32_t materialDescriptorSetIndex,
+                        bool unlit);
+
+    private:
+        Order m_order;
+        VisibleInstancesHolder* m_batchingHolder = nullptr;
+        std::vector<Draw> m_draws;
+        std::vector<uint64_t> m_keys;
+        std::vector<uint32_t> m_indices; //!< Into m_draws, sorted along m_keys.
+        bool m_sorted = true;
+
+        // Sorting space, kept to not reallocate each frame.
+        std::vector<uint64_t> m_sortedKeys;
+        std::vector<uint64_t> m_swapKeys;
+        std::vector<uint32_t> m_swapIndices;
+    };
+}
@@ -13,6 +13,7 @@ using namespace lava::chamber;
 
 VrRenderTarget::Impl::Impl(RenderEngine& engine)
     : m_engine(engine)
+    , m_framesInFlightHolder(engine.impl(), "vr-render-target")
 {
     if (!m_engine.vr().enabled()) {
         logger.error("magma.vulkan.vr-render-target") << "Cannot use VrRenderTarget because "
@@ -31,12 +32,12 @@ void VrRenderTarget::Impl::init(uint32_t id)
 {
     m_id = id;
 
-    initFence();
+    m_framesInFlightHolder.init(false);
 
     // @note This is only the minimum recommended size, but this can be configurable.
     m_extent = m_engine.vr().renderTargetExtent();
 
-    logger.info("magma.vulkan.vr-render-target")
+    $log_info("magma.vulkan.vr-render-target")
         << "VR system recommend a size of " << m_extent.width << "x" << m_extent.height << std::endl;
 }
 
@@ -52,14 +53,9 @@ bool VrRenderTarget::Impl::prepare()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
 
-    // Waiting for previous rendering to be over
-    {
-        PROFILE_BLOCK("VrRenderTarget - waitForFences", PROFILER_COLOR_DRAW);
-
-        static const auto MAX = std::numeric_limits<uint64_t>::max();
-        m_engine.impl().device().waitForFences(1u, &m_fence.get(), true, MAX);
-        m_engine.impl().device().resetFences(1u, &m_fence.get());
-    }
+    // Waiting for the frame that used the same resources to be retired
+    m_framesInFlightHolder.prepare();
+    m_framesInFlightHolder.begin();
 
     return true;
 }
@@ -85,7 +81,7 @@ void VrRenderTarget::Impl::draw(const std::vector<vk::CommandBuffer>& commandBuf
     submitInfo.commandBufferCount = commandBuffers.size();
     submitInfo.pCommandBuffers = commandBuffers.data();
 
-    if (m_engine.impl().graphicsQueue().submit(1, &submitInfo, m_fence.get()) != vk::Result::eSuccess) {
+    if (m_engine.impl().graphicsQueue().submit(1, &submitInfo, m_framesInFlightHolder.fence()) != vk::Result::eSuccess) {
         logger.error("magma.vulkan.vr-render-target") << "Failed to submit draw command buffer." << std::endl;
     }
 
@@ -151,12 +147,3 @@ void VrRenderTarget::Impl::cleanup()
         m_scene->remove(*m_rightEyeCamera);
     }
 }
-
-void VrRenderTarget::Impl::initFence()
-{
-    vk::FenceCreateInfo createInfo;
-    createInfo.flags = vk::FenceCreateFlagBits::eSignaled;
-
-    auto result = m_scene->engine().impl().device().createFenceUnique(createInfo);
-    m_fence = vulkan::checkMove(result, "vr-render-target", "Unable to create fence.");
-}
@@ -7,7 +7,7 @@
 #include <lava/magma/camera-controllers/vr-eye-camera-controller.hpp>
 #include <lava/magma/render-engine.hpp>
 
-#include "../holders/swapchain-holder.hpp"
+#include "../holders/frames-in-flight-holder.hpp"
 #include "../wrappers.hpp"
 
 namespace lava::magma {
@@ -29,8 +29,8 @@ namespace lava::magma {
         void updateView(uint32_t, vk::ImageView, vk::ImageLayout, vk::Sampler) final {}
 
         uint32_t id() const final { return m_id; }
-        uint32_t currentBufferIndex() const final { return 0; }
-        uint32_t buffersCount() const final { return 1; }
+        uint32_t currentBufferIndex() const final { return m_framesInFlightHolder.index(); }
+        uint32_t buffersCount() const final { return m_framesInFlightHolder.count(); }
 
         // VrRenderTarget
         void bindScene(Scene& scene);
@@ -38,7 +38,6 @@ namespace lava::magma {
     protected:
         // Internal
         void cleanup();
-        void initFence();
 
     private:
         // References
@@ -54,6 +53,6 @@ namespace lava::magma {
 
         // Resources
         Extent2d m_extent;
-        vk::UniqueFence m_fence;
+        vulkan::FramesInFlightHolder m_framesInFlightHolder;
     };
 }
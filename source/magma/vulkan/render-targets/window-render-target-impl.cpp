@@ -11,6 +11,7 @@ WindowRenderTarget::Impl::Impl(RenderEngine& engine, WsHandle handle, const Exte
     : m_engine(engine.impl())
     , m_handle(handle)
     , m_presentStage(m_engine)
+    , m_framesInFlightHolder(m_engine, "window-render-target")
     , m_swapchainHolder(m_engine)
 {
     m_windowExtent.width = extent.width;
@@ -19,34 +20,36 @@ WindowRenderTarget::Impl::Impl(RenderEngine& engine, WsHandle handle, const Exte
     initSurface();
 }
 
+WindowRenderTarget::Impl::~Impl()
+{
+    // Reads that would have happened during next render() never will.
+    m_engine.readbackQueue().forget(this);
+}
+
 //----- IRenderTarget
 
 void WindowRenderTarget::Impl::init(uint32_t id)
 {
     m_id = id;
 
-    initFence();
+    m_framesInFlightHolder.init(true);
     initSwapchain();
     initPresentStage();
-    createSemaphore();
 }
 
 bool WindowRenderTarget::Impl::prepare()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
 
-    if (m_shouldWaitForFences) {
-        PROFILE_BLOCK("WindowRenderTarget - waitForFences", PROFILER_COLOR_DRAW);
-
-        // @fixme Are we forced to wait for fence before acquiring next image?
-        static const auto MAX = std::numeric_limits<uint64_t>::max();
-        m_engine.device().waitForFences(1u, &m_fence.get(), true, MAX);
-        m_engine.device().resetFences(1u, &m_fence.get());
-
-        m_shouldWaitForFences = false;
+    // @note Resizing a window sends many extent changes, only the last one matters.
+    if (m_windowExtentChanged) {
+        recreateSwapchain();
     }
 
-    auto result = m_swapchainHolder.acquireNextImage();
+    // Waiting for the frame that used the same resources to be retired
+    m_framesInFlightHolder.prepare();
+
+    auto result = m_swapchainHolder.acquireNextImage(m_framesInFlightHolder.imageAvailableSemaphore());
 
     if (result == vk::Result::eErrorOutOfDateKHR) {
         // @note We should not go this pass to often, it would mean that
@@ -56,15 +59,16 @@ bool WindowRenderTarget::Impl::prepare()
         return false;
     }
     else if (result == vk::Result::eSuboptimalKHR) {
+        // @note The image has been acquired and its semaphore will be signaled,
+        // so we still draw, otherwise that semaphore could not be reused.
         logger.warning("magma.vulkan.window-render-target") << "Suboptimal swapchain." << std::endl;
-        return false;
     }
     else if (result != vk::Result::eSuccess) {
         logger.error("magma.vulkan.window-render-target") << "Failed to acquire swapchain image." << std::endl;
         return false;
     }
 
-    m_shouldWaitForFences = true;
+    m_framesInFlightHolder.begin();
     return true;
 }
 
@@ -73,6 +77,13 @@ void WindowRenderTarget::Impl::render(vk::CommandBuffer commandBuffer)
     PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
 
     m_presentStage.render(commandBuffer);
+
+    vulkan::ReadbackImageInfo readbackInfo;
+    readbackInfo.image = m_swapchainHolder.currentImage();
+    readbackInfo.format = m_swapchainHolder.imageFormat();
+    readbackInfo.extent = m_swapchainHolder.extent();
+    readbackInfo.layout = vk::ImageLayout::ePresentSrcKHR;
+    m_engine.readbackQueue().record(commandBuffer, this, readbackInfo);
 }
 
 void WindowRenderTarget::Impl::draw(const std::vector<vk::CommandBuffer>& commandBuffers) const
@@ -80,7 +91,8 @@ void WindowRenderTarget::Impl::draw(const std::vector<vk::CommandBuffer>& comman
     PROFILE_FUNCTION(PROFILER_COLOR_DRAW);
 
     // Submit it to the queue
-    vk::Semaphore waitSemaphores[] = {m_swapchainHolder.imageAvailableSemaphore()};
+    vk::Semaphore waitSemaphores[] = {m_framesInFlightHolder.imageAvailableSemaphore()};
+    vk::Semaphore renderFinishedSemaphore = m_framesInFlightHolder.renderFinishedSemaphore();
     vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
 
     vk::SubmitInfo submitInfo;
@@ -88,11 +100,11 @@ void WindowRenderTarget::Impl::draw(const std::vector<vk::CommandBuffer>& comman
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &m_renderFinishedSemaphore.get();
+    submitInfo.pSignalSemaphores = &renderFinishedSemaphore;
     submitInfo.commandBufferCount = commandBuffers.size();
     submitInfo.pCommandBuffers = commandBuffers.data();
 
-    if (m_engine.graphicsQueue().submit(1, &submitInfo, m_fence.get()) != vk::Result::eSuccess) {
+    if (m_engine.graphicsQueue().submit(1, &submitInfo, m_framesInFlightHolder.fence()) != vk::Result::eSuccess) {
         logger.error("magma.vulkan.window-render-target") << "Failed to submit draw command buffer." << std::endl;
     }
 
@@ -101,7 +113,7 @@ void WindowRenderTarget::Impl::draw(const std::vector<vk::CommandBuffer>& comman
     // Submitting the image back to the swapchain
     vk::PresentInfoKHR presentInfo;
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = &m_renderFinishedSemaphore.get();
+    presentInfo.pWaitSemaphores = &renderFinishedSemaphore;
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = &m_swapchainHolder.swapchain();
     presentInfo.pImageIndices = &imageIndex;
@@ -141,8 +153,17 @@ void WindowRenderTarget::Impl::extent(const Extent2d& extent)
 {
     m_windowExtent.width = extent.width;
     m_windowExtent.height = extent.height;
+    m_windowExtentChanged = true;
+}
+
+void WindowRenderTarget::Impl::readback(ReadbackCallback callback, const ReadbackOptions& options)
+{
+    if (!m_swapchainHolder.readable()) {
+        logger.warning("magma.vulkan.window-render-target") << "Swapchain images cannot be read back on this surface." << std::endl;
+        return;
+    }
 
-    recreateSwapchain();
+    m_engine.readbackQueue().read(this, options, std::move(callback));
 }
 
 //----- Internal
@@ -156,17 +177,6 @@ void WindowRenderTarget::Impl::initPresentStage()
     m_presentStage.update(m_swapchainHolder.extent());
 }
 
-void WindowRenderTarget::Impl::initFence()
-{
-    PROFILE_FUNCTION(PROFILER_COLOR_INIT);
-
-    vk::FenceCreateInfo createInfo;
-    createInfo.flags = vk::FenceCreateFlagBits::eSignaled;
-
-    auto result = m_engine.device().createFenceUnique(createInfo);
-    m_fence = vulkan::checkMove(result, "window-render-target", "Unable to create fence.");
-}
-
 void WindowRenderTarget::Impl::initSurface()
 {
     PROFILE_FUNCTION(PROFILER_COLOR_INIT);
@@ -209,16 +219,5 @@ void WindowRenderTarget::Impl::recreateSwapchain()
 
     m_swapchainHolder.recreate(m_surface.get(), m_windowExtent);
     m_presentStage.update(m_swapchainHolder.extent());
-}
-
-void WindowRenderTarget::Impl::createSemaphore()
-{
-    PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
-
-    vk::SemaphoreCreateInfo createInfo;
-
-    auto result = m_engine.device().createSemaphoreUnique(createInfo);
-    m_renderFinishedSemaphore = vulkan::checkMove(result, "window-render-target", "Unable to create semaphore.");
-
-    m_engine.deviceHolder().debugObjectName(m_renderFinishedSemaphore.get(), "render-engine.render-finished");
+    m_windowExtentChanged = false;
 }
@@ -6,6 +6,7 @@
 
 #include <lava/magma/render-engine.hpp>
 
+#include "../holders/frames-in-flight-holder.hpp"
 #include "../holders/swapchain-holder.hpp"
 #include "../stages/present.hpp"
 #include "../wrappers.hpp"
@@ -14,6 +15,7 @@ namespace lava::magma {
     class WindowRenderTarget::Impl final : public IRenderTarget::Impl {
     public:
         Impl(RenderEngine& engine, WsHandle handle, const Extent2d& extent);
+        ~Impl();
 
         // IRenderTarget::Impl
         void init(uint32_t id) final;
@@ -27,22 +29,21 @@ namespace lava::magma {
         void updateView(uint32_t viewId, vk::ImageView imageView, vk::ImageLayout imageLayout, vk::Sampler sampler) final;
 
         uint32_t id() const final { return m_id; }
-        uint32_t currentBufferIndex() const final { return m_swapchainHolder.currentIndex(); }
-        uint32_t buffersCount() const final { return m_swapchainHolder.imagesCount(); }
+        uint32_t currentBufferIndex() const final { return m_framesInFlightHolder.index(); }
+        uint32_t buffersCount() const final { return m_framesInFlightHolder.count(); }
 
         // WindowRenderTarget
         inline Extent2d extent() const { return {m_windowExtent.width, m_windowExtent.height}; }
         void extent(const Extent2d& extent);
+        void readback(ReadbackCallback callback, const ReadbackOptions& options);
         WsHandle handle() const { return m_handle; }
 
     protected:
         // Internal
-        void initFence();
         void initSurface();
         void initSwapchain();
         void initPresentStage();
         void recreateSwapchain();
-        void createSemaphore();
 
     private:
         // References
@@ -52,11 +53,10 @@ namespace lava::magma {
 
         // Resources
         Present m_presentStage;
-        vk::UniqueSemaphore m_renderFinishedSemaphore;
-        vk::UniqueFence m_fence;
+        vulkan::FramesInFlightHolder m_framesInFlightHolder;
         vk::UniqueSurfaceKHR m_surface;
         vulkan::SwapchainHolder m_swapchainHolder;
         vk::Extent2D m_windowExtent;
-        bool m_shouldWaitForFences = true;
+        bool m_windowExtentChanged = false; //!< The swapchain is recreated once, during next prepare().
     };
 }
@@ -63,7 +63,7 @@ vk::ShaderModule ShadersManager::module(const std::string& shaderId, const Modul
         auto textCode = adaptGlslFile(shaderId, options.defines);
         auto resolvedShader = resolveShader(textCode);
 
-        logger.info("magma.vulkan.shaders-manager")
+        $log_info("magma.vulkan.shaders-manager")
             << "Reading GLSL shader file '" << shaderId << "' (" << resolvedShader.textCode.size() << "B)." << std::endl;
 
         auto code = vulkan::spvFromGlsl(shaderId, resolvedShader.textCode);
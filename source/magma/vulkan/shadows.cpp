@@ -76,6 +76,15 @@ void Shadows::update(uint32_t frameId)
     for (uint32_t i = 0; i < SHADOWS_CASCADES_COUNT; i++) {
         float splitDist = cascadeSplits[i];
 
+        // @note Cascades are offset so that the ones with the same period are not all refreshed during the same frame,
+        // the ones that are not keep the transform their shadow map has been drawn with.
+        const auto refreshPeriod = m_light->shadowsCascadeRefreshPeriod(i);
+        m_cascades[i].refreshed = (m_updatesCount == 0u) || ((m_updatesCount + i) % refreshPeriod == 0u);
+        if (!m_cascades[i].refreshed) {
+            lastSplitDist = splitDist;
+            continue;
+        }
+
         glm::vec3 frustumCorners[8] = {
             glm::vec3(-1.0f, 1.0f, -1.0f),  glm::vec3(1.0f, 1.0f, -1.0f),  glm::vec3(1.0f, -1.0f, -1.0f),
             glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(-1.0f, 1.0f, 1.0f),  glm::vec3(1.0f, 1.0f, 1.0f),
@@ -108,6 +117,15 @@ void Shadows::update(uint32_t frameId)
         }
         radius = std::ceil(radius * 16.0f) / 16.0f;
 
+        // Moving the volume by whole texels, within the light space, so that it stays still
+        // while the camera moves by less than one, keeping shadows edges steady and cached static shadows valid.
+        // @note The radius does not depend on the camera's position nor orientation.
+        const auto texelSize = 2.f * radius / SHADOW_MAP_SIZE;
+        const auto lightRotation = glm::lookAt(glm::vec3(0.f), lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
+        auto lightCenter = glm::vec3(lightRotation * glm::vec4(frustumCenter, 1.f));
+        lightCenter = glm::floor(lightCenter / texelSize) * texelSize;
+        frustumCenter = glm::vec3(glm::transpose(lightRotation) * glm::vec4(lightCenter, 1.f));
+
         glm::vec3 maxExtents = glm::vec3(radius);
         glm::vec3 minExtents = -maxExtents;
 
@@ -123,6 +141,7 @@ void Shadows::update(uint32_t frameId)
         lastSplitDist = cascadeSplits[i];
     }
 
+    m_updatesCount += 1u;
     updateBindings(frameId);
 }
 
@@ -30,6 +30,9 @@ namespace lava::magma {
         float cascadeSplitDepth(uint32_t cascadeIndex) const { return m_cascades[cascadeIndex].splitDepth; }
         const glm::mat4& cascadeTransform(uint32_t cascadeIndex) const { return m_cascades[cascadeIndex].transform; }
 
+        /// Whether the cascade has been refreshed during the last update, and its shadow map should be redrawn.
+        bool cascadeRefreshed(uint32_t cascadeIndex) const { return m_cascades[cascadeIndex].refreshed; }
+
     protected:
         void updateImagesBindings();
         void updateBindings(uint32_t frameId);
@@ -38,6 +41,7 @@ namespace lava::magma {
         struct Cascade {
             float splitDepth;
             glm::mat4 transform;
+            bool refreshed = false;
         };
 
     private:
@@ -45,6 +49,7 @@ namespace lava::magma {
         const Light* m_light = nullptr;
         const Camera* m_camera = nullptr;
         bool m_initialized = false;
+        uint32_t m_updatesCount = 0u;
 
         // Resources
         std::vector<vulkan::UboHolder> m_uboHolders;
@@ -10,6 +10,7 @@
 #include "../../aft-vulkan/light-aft.hpp"
 #include "../../aft-vulkan/mesh-aft.hpp"
 #include "../../aft-vulkan/scene-aft.hpp"
+#include "../helpers/command-buffer.hpp"
 #include "../helpers/format.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
@@ -17,6 +18,13 @@
 using namespace lava::magma;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey DRAW_CALLS_KEY("draw-calls.renderer");
+    constexpr TrackerKey INSTANCES_KEY("instances.renderer");
+    constexpr TrackerKey VISIBLE_INSTANCES_KEY("visible-instances.renderer");
+    constexpr TrackerKey OCCLUDED_INSTANCES_KEY("occluded-instances.renderer");
+}
+
 DeepDeferredStage::DeepDeferredStage(Scene& scene)
     : m_scene(scene)
     , m_renderPassHolder(m_scene.engine().impl())
@@ -30,7 +38,12 @@ DeepDeferredStage::DeepDeferredStage(Scene& scene)
     , m_gBufferSsboListBufferHolder(m_scene.engine().impl(), "stages.deep-deferred.ssbo-list")
     , m_finalImageHolder(m_scene.engine().impl(), "stages.deep-deferred.final")
     , m_depthImageHolder(m_scene.engine().impl(), "stages.deep-deferred.depth")
+    , m_visibleInstancesHolder(m_scene.engine().impl(), "stages.deep-deferred.visible-instances")
+    , m_occlusionHolder(m_scene.engine().impl(), "stages.deep-deferred.occlusion")
 {
+    // Entities loaded from the same file end up drawn at once.
+    m_geometryRenderQueue.batchingHolder(&m_visibleInstancesHolder);
+    m_depthlessRenderQueue.batchingHolder(&m_visibleInstancesHolder);
 }
 
 void DeepDeferredStage::init(const Camera& camera)
@@ -64,10 +77,10 @@ void DeepDeferredStage::rebuild()
     }
 
     if (m_rebuildPipelines) {
-        m_clearPipelineHolder.update(m_extent);
-        m_geometryPipelineHolder.update(m_extent, m_polygonMode);
-        m_depthlessPipelineHolder.update(m_extent, m_polygonMode);
-        m_epiphanyPipelineHolder.update(m_extent);
+        m_clearPipelineHolder.update();
+        m_geometryPipelineHolder.update(m_polygonMode);
+        m_depthlessPipelineHolder.update(m_polygonMode);
+        m_epiphanyPipelineHolder.update();
         m_rebuildPipelines = false;
     }
 
@@ -105,6 +118,7 @@ void DeepDeferredStage::record(vk::CommandBuffer commandBuffer, uint32_t frameId
     renderPassInfo.pClearValues = clearValues.data();
 
     commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, m_extent);
 
     //----- Clear pass
 
@@ -129,24 +143,61 @@ void DeepDeferredStage::record(vk::CommandBuffer commandBuffer, uint32_t frameId
     const auto& cameraFrustum = m_camera->frustum();
 
     // Draw all meshes
-    std::vector<Mesh*> depthlessMeshes;
-    for (auto mesh : m_scene.meshes()) {
-        if (m_camera->vrAimed() && !mesh->vrRenderable()) continue;
+    m_geometryRenderQueue.clear();
+    m_depthlessRenderQueue.clear();
+    m_visibleInstancesHolder.beginFrame(frameId);
+
+    // Hidden meshes are found with the depth of a previous frame
+    const bool occlusionCullingEnabled = m_camera->frustumCullingEnabled() && m_camera->occlusionCullingEnabled();
+    m_occlusionHolder.beginFrame(frameId);
+    const auto occlusionHolder = (occlusionCullingEnabled && m_occlusionHolder.valid()) ? &m_occlusionHolder : nullptr;
+
+    auto processMesh = [&](Mesh& mesh) {
+        if (m_camera->vrAimed() && !mesh.vrRenderable()) return;
+        tracker.add(INSTANCES_KEY, mesh.instancesCount());
+
+        const auto& boundingSphere = mesh.boundingSphere();
+        if (m_camera->frustumCullingEnabled() && !cameraFrustum.canSee(boundingSphere)) return;
+        if (occlusionHolder != nullptr && !occlusionHolder->canSee(boundingSphere)) {
+            tracker.add(OCCLUDED_INSTANCES_KEY, mesh.instancesCount());
+            return;
+        }
+
+        // Instances might be spread all around, each one is checked.
+        vulkan::VisibleInstances visibleInstances;
+        visibleInstances.count = mesh.instancesCount();
+        if (m_camera->frustumCullingEnabled() && mesh.instancesCount() > 1u) {
+            const bool anyVisible = m_visibleInstancesHolder.cull(mesh, cameraFrustum, visibleInstances, occlusionHolder);
+            tracker.add(OCCLUDED_INSTANCES_KEY, visibleInstances.occludedCount);
+            if (!anyVisible) return;
+        }
+        tracker.add(VISIBLE_INSTANCES_KEY, visibleInstances.count);
 
         // @todo Somehow, the deep-deferred renderer does not care about wireframes.
-        if (mesh->renderCategory() == RenderCategory::Depthless) {
-            depthlessMeshes.emplace_back(mesh);
-            continue;
+        if (mesh.renderCategory() == RenderCategory::Depthless) {
+            m_depthlessRenderQueue.add(mesh, 0.f, &visibleInstances);
+        }
+        else {
+            m_geometryRenderQueue.add(mesh, 0.f, &visibleInstances);
         }
+    };
 
-        const auto& boundingSphere = mesh->boundingSphere();
-        if (!m_camera->frustumCullingEnabled() || cameraFrustum.canSee(boundingSphere)) {
-            tracker.counter("draw-calls.renderer") += 1u;
-            mesh->aft().render(commandBuffer, m_geometryPipelineHolder.pipelineLayout(),
-                               GEOMETRY_MATERIAL_DESCRIPTOR_SET_INDEX);
+    if (m_camera->frustumCullingEnabled()) {
+        m_scene.meshesBvh().query(cameraFrustum, processMesh);
+        for (auto mesh : m_scene.depthlessMeshes()) {
+            processMesh(*mesh);
+        }
+    }
+    else {
+        for (auto mesh : m_scene.meshes()) {
+            processMesh(*mesh);
         }
     }
 
+    tracker.add(DRAW_CALLS_KEY,
+                m_geometryRenderQueue.record(commandBuffer, m_geometryPipelineHolder.pipelineLayout(),
+                                             GEOMETRY_MATERIAL_DESCRIPTOR_SET_INDEX));
+
     deviceHolder.debugEndRegion(commandBuffer);
 
     //----- Depthless pass
@@ -157,15 +208,9 @@ void DeepDeferredStage::record(vk::CommandBuffer commandBuffer, uint32_t frameId
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_depthlessPipelineHolder.pipeline());
 
     // Draw all meshes
-    for (auto mesh : depthlessMeshes) {
-        if (m_camera->vrAimed() && !mesh->vrRenderable()) continue;
-        const auto& boundingSphere = mesh->boundingSphere();
-        if (!m_camera->frustumCullingEnabled() || cameraFrustum.canSee(boundingSphere)) {
-            tracker.counter("draw-calls.renderer") += 1u;
-            mesh->aft().render(commandBuffer, m_depthlessPipelineHolder.pipelineLayout(),
-                               GEOMETRY_MATERIAL_DESCRIPTOR_SET_INDEX);
-        }
-    }
+    tracker.add(DRAW_CALLS_KEY,
+                m_depthlessRenderQueue.record(commandBuffer, m_depthlessPipelineHolder.pipelineLayout(),
+                                              GEOMETRY_MATERIAL_DESCRIPTOR_SET_INDEX));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -198,6 +243,11 @@ void DeepDeferredStage::record(vk::CommandBuffer commandBuffer, uint32_t frameId
 
     commandBuffer.endRenderPass();
 
+    if (occlusionCullingEnabled) {
+        const auto cameraMatrix = m_camera->projectionMatrix() * m_camera->viewMatrix();
+        m_occlusionHolder.record(commandBuffer, m_depthImageHolder, cameraMatrix);
+    }
+
     deviceHolder.debugEndRegion(commandBuffer);
 }
 
@@ -205,7 +255,6 @@ void DeepDeferredStage::extent(const vk::Extent2D& extent)
 {
     if (m_extent == extent) return;
     m_extent = extent;
-    m_rebuildPipelines = true;
     m_rebuildResources = true;
 }
 
@@ -472,8 +521,8 @@ void DeepDeferredStage::updateGeometryPassShaders(bool firstTime)
     m_depthlessPipelineHolder.add({shaderStageCreateFlags, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule, "main"});
 
     if (!firstTime) {
-        m_geometryPipelineHolder.update(m_extent);
-        m_depthlessPipelineHolder.update(m_extent);
+        m_geometryPipelineHolder.update();
+        m_depthlessPipelineHolder.update();
     }
 }
 
@@ -513,7 +562,7 @@ void DeepDeferredStage::updateEpiphanyPassShaders(bool firstTime)
     m_epiphanyPipelineHolder.add({shaderStageCreateFlags, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule, "main"});
 
     if (!firstTime) {
-        m_epiphanyPipelineHolder.update(m_extent);
+        m_epiphanyPipelineHolder.update();
     }
 }
 
@@ -541,7 +590,7 @@ void DeepDeferredStage::createResources()
     m_gBufferSsboListBufferHolder.create(vulkan::BufferKind::ShaderStorage, listSize);
     m_gBufferSsboDescriptorHolder.updateSet(m_gBufferSsboDescriptorSet.get(), m_gBufferSsboListBufferHolder.buffer(), listSize, 1);
 
-    logger.info("magma.vulkan.stages.deep-deferred")
+    $log_info("magma.vulkan.stages.deep-deferred")
         << "GBuffer sizes | header: " << headerSize / 1000000.f << "Mo | list: " << listSize / 1000000.f << "Mo." << std::endl;
 
     // Final
@@ -550,7 +599,8 @@ void DeepDeferredStage::createResources()
 
     // Depth
     auto depthFormat = vulkan::depthBufferFormat(m_scene.engine().impl().physicalDevice());
-    m_depthImageHolder.create(vulkan::ImageKind::Depth, depthFormat, m_extent);
+    // @note Copyable, so that it can be read back for occlusion culling.
+    m_depthImageHolder.create(vulkan::ImageKind::CopyableDepth, depthFormat, m_extent);
 }
 
 void DeepDeferredStage::createFramebuffers()
@@ -586,6 +636,10 @@ void DeepDeferredStage::createFramebuffers()
     createInfo.height = m_extent.height;
     createInfo.layers = 1;
 
+    if (m_framebuffer) {
+        m_scene.engine().impl().deletionQueue().destroyLater(std::move(m_framebuffer));
+    }
+
     auto result = m_scene.engine().impl().device().createFramebufferUnique(createInfo);
     m_framebuffer = vulkan::checkMove(result, "stages.deep-deferred", "Unable to create framebuffers.");
 }
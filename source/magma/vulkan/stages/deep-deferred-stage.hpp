@@ -8,8 +8,11 @@
 #include "../holders/buffer-holder.hpp"
 #include "../holders/descriptor-holder.hpp"
 #include "../holders/image-holder.hpp"
+#include "../holders/occlusion-holder.hpp"
 #include "../holders/pipeline-holder.hpp"
 #include "../holders/render-pass-holder.hpp"
+#include "../holders/visible-instances-holder.hpp"
+#include "../render-queue.hpp"
 
 namespace lava::magma {
     class Scene;
@@ -114,5 +117,11 @@ namespace lava::magma {
         vulkan::ImageHolder m_finalImageHolder;
         vulkan::ImageHolder m_depthImageHolder;
         vk::UniqueFramebuffer m_framebuffer;
+        vulkan::VisibleInstancesHolder m_visibleInstancesHolder;
+        vulkan::OcclusionHolder m_occlusionHolder;
+
+        // Render queues, one per subpass
+        vulkan::RenderQueue m_geometryRenderQueue;
+        vulkan::RenderQueue m_depthlessRenderQueue;
     };
 }
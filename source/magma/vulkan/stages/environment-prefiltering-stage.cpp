@@ -4,6 +4,7 @@
 
 #include "../../aft-vulkan/mesh-aft.hpp"
 #include "../../aft-vulkan/scene-aft.hpp"
+#include "../helpers/command-buffer.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
 
@@ -31,6 +32,7 @@ void EnvironmentPrefilteringStage::init(Algorithm algorithm)
 
     m_renderPassHolder.add(m_pipelineHolder);
     m_renderPassHolder.init();
+    m_pipelineHolder.update();
 
     logger.log().tab(-1);
 }
@@ -39,8 +41,6 @@ void EnvironmentPrefilteringStage::update(const vk::Extent2D& extent)
 {
     m_extent = extent;
 
-    m_pipelineHolder.update(extent);
-
     createResources();
     createFramebuffers();
 }
@@ -66,11 +66,6 @@ void EnvironmentPrefilteringStage::render(vk::CommandBuffer commandBuffer, uint8
         height /= 2;
     }
 
-    vk::Viewport viewport;
-    viewport.width = width;
-    viewport.height = height;
-    commandBuffer.setViewport(0, 1, &viewport);
-
     // Set render pass
     std::array<vk::ClearValue, 1> clearValues;
 
@@ -83,6 +78,7 @@ void EnvironmentPrefilteringStage::render(vk::CommandBuffer commandBuffer, uint8
     renderPassInfo.pClearValues = clearValues.data();
 
     commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, vk::Extent2D{width, height});
 
     //----- Pass
 
@@ -179,7 +175,6 @@ void EnvironmentPrefilteringStage::initPass()
     //----- Rasterization
 
     m_pipelineHolder.set(vk::CullModeFlagBits::eNone);
-    m_pipelineHolder.dynamicViewportEnabled(true);
 }
 
 void EnvironmentPrefilteringStage::createResources()
@@ -201,6 +196,10 @@ void EnvironmentPrefilteringStage::createFramebuffers()
     createInfo.height = m_extent.height;
     createInfo.layers = 1;
 
+    if (m_framebuffer) {
+        m_scene.engine().impl().deletionQueue().destroyLater(std::move(m_framebuffer));
+    }
+
     auto result = m_scene.engine().impl().device().createFramebufferUnique(createInfo);
     m_framebuffer = vulkan::checkMove(result, "stages.environment-prefiltering", "Unable to create framebuffers.");
 }
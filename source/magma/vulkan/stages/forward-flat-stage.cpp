@@ -7,6 +7,7 @@
 #include "../../aft-vulkan/camera-aft.hpp"
 #include "../../aft-vulkan/flat-aft.hpp"
 #include "../../aft-vulkan/scene-aft.hpp"
+#include "../helpers/command-buffer.hpp"
 #include "../helpers/format.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
@@ -14,6 +15,10 @@
 using namespace lava::magma;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey DRAW_CALLS_KEY("draw-calls.flat-renderer");
+}
+
 ForwardFlatStage::ForwardFlatStage(Scene& scene)
     : m_scene(scene)
     , m_renderPassHolder(m_scene.engine().impl())
@@ -47,7 +52,7 @@ void ForwardFlatStage::rebuild()
     }
 
     if (m_rebuildPipelines) {
-        m_pipelineHolder.update(m_extent);
+        m_pipelineHolder.update();
         m_rebuildPipelines = false;
     }
 
@@ -81,6 +86,7 @@ void ForwardFlatStage::record(vk::CommandBuffer commandBuffer, uint32_t /* frame
     renderPassInfo.pClearValues = clearValues.data();
 
     commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, m_extent);
 
     //----- Pass
 
@@ -93,7 +99,7 @@ void ForwardFlatStage::record(vk::CommandBuffer commandBuffer, uint32_t /* frame
 
     // Draw all flats
     for (auto flat : m_scene.flats()) {
-        tracker.counter("draw-calls.flat-renderer") += 1u;
+        tracker.add(DRAW_CALLS_KEY);
 
         flat->aft().render(commandBuffer, m_pipelineHolder.pipelineLayout(), FLAT_PUSH_CONSTANT_OFFSET, MATERIAL_DESCRIPTOR_SET_INDEX);
     }
@@ -111,7 +117,6 @@ void ForwardFlatStage::extent(const vk::Extent2D& extent)
 {
     if (m_extent == extent) return;
     m_extent = extent;
-    m_rebuildPipelines = true;
     m_rebuildResources = true;
 }
 
@@ -183,7 +188,7 @@ void ForwardFlatStage::updatePassShaders(bool firstTime)
     m_pipelineHolder.add({shaderStageCreateFlags, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule, "main"});
 
     if (!firstTime) {
-        m_pipelineHolder.update(m_extent);
+        m_pipelineHolder.update();
     }
 }
 
@@ -209,6 +214,10 @@ void ForwardFlatStage::createFramebuffers()
     createInfo.height = m_extent.height;
     createInfo.layers = 1;
 
+    if (m_framebuffer) {
+        m_scene.engine().impl().deletionQueue().destroyLater(std::move(m_framebuffer));
+    }
+
     auto result = m_scene.engine().impl().device().createFramebufferUnique(createInfo);
     m_framebuffer = vulkan::checkMove(result, "stages.forward-flat", "Unable to create framebuffers.");
 }
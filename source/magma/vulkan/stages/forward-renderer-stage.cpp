@@ -12,6 +12,7 @@
 #include "../../aft-vulkan/scene-aft.hpp"
 #include "../../g-buffer-data.hpp"
 #include "../environment.hpp"
+#include "../helpers/command-buffer.hpp"
 #include "../helpers/format.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
@@ -19,6 +20,13 @@
 using namespace lava::magma;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey DRAW_CALLS_KEY("draw-calls.renderer");
+    constexpr TrackerKey INSTANCES_KEY("instances.renderer");
+    constexpr TrackerKey VISIBLE_INSTANCES_KEY("visible-instances.renderer");
+    constexpr TrackerKey OCCLUDED_INSTANCES_KEY("occluded-instances.renderer");
+}
+
 ForwardRendererStage::ForwardRendererStage(Scene& scene)
     : m_scene(scene)
     , m_renderPassHolder(m_scene.engine().impl())
@@ -30,7 +38,15 @@ ForwardRendererStage::ForwardRendererStage(Scene& scene)
     , m_finalImageHolder(m_scene.engine().impl(), "stages.forward-renderer.final")
     , m_finalResolveImageHolder(m_scene.engine().impl(), "stages.forward-renderer.final-resolve")
     , m_depthImageHolder(m_scene.engine().impl(), "stages.forward-renderer.depth")
+    , m_visibleInstancesHolder(m_scene.engine().impl(), "stages.forward-renderer.visible-instances")
+    , m_occlusionHolder(m_scene.engine().impl(), "stages.forward-renderer.occlusion")
 {
+    // Entities loaded from the same file end up drawn at once.
+    m_opaqueRenderQueue.batchingHolder(&m_visibleInstancesHolder);
+    m_maskRenderQueue.batchingHolder(&m_visibleInstancesHolder);
+    m_depthlessRenderQueue.batchingHolder(&m_visibleInstancesHolder);
+    m_wireframeRenderQueue.batchingHolder(&m_visibleInstancesHolder);
+    m_translucentRenderQueue.batchingHolder(&m_visibleInstancesHolder);
 }
 
 void ForwardRendererStage::init(const Camera& camera)
@@ -66,11 +82,11 @@ void ForwardRendererStage::rebuild()
     }
 
     if (m_rebuildPipelines) {
-        m_opaquePipelineHolder.update(m_extent, m_polygonMode);
-        m_maskPipelineHolder.update(m_extent, m_polygonMode);
-        m_depthlessPipelineHolder.update(m_extent, m_polygonMode);
-        m_wireframePipelineHolder.update(m_extent, vk::PolygonMode::eLine);
-        m_translucentPipelineHolder.update(m_extent, m_polygonMode);
+        m_opaquePipelineHolder.update(m_polygonMode);
+        m_maskPipelineHolder.update(m_polygonMode);
+        m_depthlessPipelineHolder.update(m_polygonMode);
+        m_wireframePipelineHolder.update(vk::PolygonMode::eLine);
+        m_translucentPipelineHolder.update(m_polygonMode);
         m_rebuildPipelines = false;
     }
 
@@ -112,6 +128,7 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
     renderPassInfo.pClearValues = clearValues.data();
 
     commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, m_extent);
 
     //----- Opaque pass
 
@@ -134,51 +151,15 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
 
     // Set the camera
     m_camera->aft().render(commandBuffer, m_opaquePipelineHolder.pipelineLayout(), CAMERA_PUSH_CONSTANT_OFFSET);
-    const auto& cameraFrustum = m_camera->frustum();
 
     // Set the environment
     m_scene.aft().environment().render(commandBuffer, m_opaquePipelineHolder.pipelineLayout(), ENVIRONMENT_DESCRIPTOR_SET_INDEX);
 
-    // Draw all opaque meshes and sort others
-    struct TranslucentMesh {
-        const Mesh* mesh;
-        float distanceToCamera;
-    };
+    // Sort all meshes within their subpass
+    fillRenderQueues(frameId);
 
-    std::vector<const Mesh*> maskMeshes;
-    std::vector<const Mesh*> depthlessMeshes;
-    std::vector<const Mesh*> wireframedMeshes;
-    std::vector<TranslucentMesh> translucentMeshes;
-    for (auto mesh : m_scene.meshes()) {
-        if (m_camera->vrAimed() && !mesh->vrRenderable()) continue;
-
-        auto category = mesh->renderCategory();
-        if (category == RenderCategory::Depthless) {
-            depthlessMeshes.emplace_back(mesh);
-            continue;
-        }
-
-        const auto& boundingSphere = mesh->boundingSphere();
-        if (!m_camera->frustumCullingEnabled() || cameraFrustum.canSee(boundingSphere)) {
-            if (category == RenderCategory::Mask) {
-                maskMeshes.emplace_back(mesh);
-                continue;
-            }
-            else if (category == RenderCategory::Translucent) {
-                auto distanceToCamera = (cameraMatrix * glm::vec4(boundingSphere.center, 1.f)).z + boundingSphere.radius;
-                translucentMeshes.emplace_back(TranslucentMesh{mesh, distanceToCamera});
-                continue;
-            }
-            else if (category == RenderCategory::Wireframe) {
-                wireframedMeshes.emplace_back(mesh);
-                continue;
-            }
-
-            tracker.counter("draw-calls.renderer") += 1u;
-            mesh->aft().render(commandBuffer, m_opaquePipelineHolder.pipelineLayout(),
-                               MATERIAL_DESCRIPTOR_SET_INDEX);
-        }
-    }
+    tracker.add(DRAW_CALLS_KEY,
+                m_opaqueRenderQueue.record(commandBuffer, m_opaquePipelineHolder.pipelineLayout(), MATERIAL_DESCRIPTOR_SET_INDEX));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -189,11 +170,8 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_maskPipelineHolder.pipeline());
 
-    for (auto mesh : maskMeshes) {
-        tracker.counter("draw-calls.renderer") += 1u;
-        mesh->aft().render(commandBuffer, m_maskPipelineHolder.pipelineLayout(),
-                           MATERIAL_DESCRIPTOR_SET_INDEX);
-    }
+    tracker.add(DRAW_CALLS_KEY,
+                m_maskRenderQueue.record(commandBuffer, m_maskPipelineHolder.pipelineLayout(), MATERIAL_DESCRIPTOR_SET_INDEX));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -204,11 +182,8 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_depthlessPipelineHolder.pipeline());
 
-    for (auto mesh : depthlessMeshes) {
-        tracker.counter("draw-calls.renderer") += 1u;
-        mesh->aft().render(commandBuffer, m_depthlessPipelineHolder.pipelineLayout(),
-                           MATERIAL_DESCRIPTOR_SET_INDEX);
-    }
+    tracker.add(DRAW_CALLS_KEY,
+                m_depthlessRenderQueue.record(commandBuffer, m_depthlessPipelineHolder.pipelineLayout(), MATERIAL_DESCRIPTOR_SET_INDEX));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -221,10 +196,7 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_wireframePipelineHolder.pipeline());
 
     // Draw all wireframed meshes
-    for (auto mesh : wireframedMeshes) {
-        tracker.counter("draw-calls.renderer") += 1u;
-        mesh->aft().renderUnlit(commandBuffer);
-    }
+    tracker.add(DRAW_CALLS_KEY, m_wireframeRenderQueue.recordUnlit(commandBuffer));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -235,16 +207,10 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
     commandBuffer.nextSubpass(vk::SubpassContents::eInline);
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_translucentPipelineHolder.pipeline());
 
-    // Draw all translucent meshes
-    std::sort(translucentMeshes.begin(), translucentMeshes.end(), [](const TranslucentMesh& a, const TranslucentMesh& b) {
-        return a.distanceToCamera > b.distanceToCamera;
-    });
-
-    for (auto translucentMesh : translucentMeshes) {
-        tracker.counter("draw-calls.renderer") += 1u;
-        translucentMesh.mesh->aft().render(commandBuffer, m_translucentPipelineHolder.pipelineLayout(),
-                                           MATERIAL_DESCRIPTOR_SET_INDEX);
-    }
+    // Draw all translucent meshes, from back to front
+    tracker.add(DRAW_CALLS_KEY,
+                m_translucentRenderQueue.record(commandBuffer, m_translucentPipelineHolder.pipelineLayout(),
+                                                MATERIAL_DESCRIPTOR_SET_INDEX));
 
     deviceHolder.debugEndRegion(commandBuffer);
 
@@ -252,14 +218,101 @@ void ForwardRendererStage::record(vk::CommandBuffer commandBuffer, uint32_t fram
 
     commandBuffer.endRenderPass();
 
+    // Hidden meshes of next frames are found with this depth
+    if (m_camera->frustumCullingEnabled() && m_camera->occlusionCullingEnabled()) {
+        m_occlusionHolder.record(commandBuffer, m_depthImageHolder, cameraMatrix);
+    }
+
     deviceHolder.debugEndRegion(commandBuffer);
 }
 
+void ForwardRendererStage::fillRenderQueues(uint32_t frameId)
+{
+    PROFILE_FUNCTION(PROFILER_COLOR_RENDER);
+
+    auto cameraMatrix = m_camera->projectionMatrix() * m_camera->viewMatrix();
+    const auto& cameraFrustum = m_camera->frustum();
+
+    m_opaqueRenderQueue.clear();
+    m_maskRenderQueue.clear();
+    m_depthlessRenderQueue.clear();
+    m_wireframeRenderQueue.clear();
+    m_translucentRenderQueue.clear();
+    m_visibleInstancesHolder.beginFrame(frameId);
+
+    // Hidden meshes are found with the depth of a previous frame
+    const bool occlusionCullingEnabled = m_camera->frustumCullingEnabled() && m_camera->occlusionCullingEnabled();
+    m_occlusionHolder.beginFrame(frameId);
+    const auto occlusionHolder = (occlusionCullingEnabled && m_occlusionHolder.valid()) ? &m_occlusionHolder : nullptr;
+
+    auto processMesh = [&](Mesh& mesh) {
+        if (m_camera->vrAimed() && !mesh.vrRenderable()) return;
+
+        auto category = mesh.renderCategory();
+        if (category == RenderCategory::Depthless) {
+            m_depthlessRenderQueue.add(mesh, 0.f);
+            return;
+        }
+
+        tracker.add(INSTANCES_KEY, mesh.instancesCount());
+
+        const auto& boundingSphere = mesh.boundingSphere();
+        if (m_camera->frustumCullingEnabled() && !cameraFrustum.canSee(boundingSphere)) return;
+        if (occlusionHolder != nullptr && !occlusionHolder->canSee(boundingSphere)) {
+            tracker.add(OCCLUDED_INSTANCES_KEY, mesh.instancesCount());
+            return;
+        }
+
+        // Instances might be spread all around, each one is checked.
+        vulkan::VisibleInstances visibleInstances;
+        visibleInstances.count = mesh.instancesCount();
+        if (m_camera->frustumCullingEnabled() && mesh.instancesCount() > 1u) {
+            const bool anyVisible = m_visibleInstancesHolder.cull(mesh, cameraFrustum, visibleInstances, occlusionHolder);
+            tracker.add(OCCLUDED_INSTANCES_KEY, visibleInstances.occludedCount);
+            if (!anyVisible) return;
+        }
+
+        tracker.add(VISIBLE_INSTANCES_KEY, visibleInstances.count);
+
+        auto distanceToCamera = (cameraMatrix * glm::vec4(boundingSphere.center, 1.f)).z;
+        if (category == RenderCategory::Mask) {
+            m_maskRenderQueue.add(mesh, distanceToCamera, &visibleInstances);
+        }
+        else if (category == RenderCategory::Translucent) {
+            m_translucentRenderQueue.add(mesh, distanceToCamera + boundingSphere.radius, &visibleInstances);
+        }
+        else if (category == RenderCategory::Wireframe) {
+            m_wireframeRenderQueue.add(mesh, distanceToCamera, &visibleInstances);
+        }
+        else {
+            m_opaqueRenderQueue.add(mesh, distanceToCamera, &visibleInstances);
+        }
+    };
+
+    // Only meshes around the frustum are considered, depthless ones being always drawn.
+    if (m_camera->frustumCullingEnabled()) {
+        m_scene.meshesBvh().query(cameraFrustum, processMesh);
+        for (auto mesh : m_scene.depthlessMeshes()) {
+            processMesh(*mesh);
+        }
+    }
+    else {
+        for (auto mesh : m_scene.meshes()) {
+            processMesh(*mesh);
+        }
+    }
+
+    m_opaqueRenderQueue.sort();
+    m_maskRenderQueue.sort();
+    m_depthlessRenderQueue.sort();
+    m_wireframeRenderQueue.sort();
+    m_translucentRenderQueue.sort();
+}
+
 void ForwardRendererStage::extent(const vk::Extent2D& extent)
 {
     if (m_extent == extent) return;
     m_extent = extent;
-    m_rebuildPipelines = true;
     m_rebuildResources = true;
 }
 
@@ -675,11 +728,11 @@ void ForwardRendererStage::updatePassShaders(bool firstTime)
     m_translucentPipelineHolder.add({shaderStageCreateFlags, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule, "main"});
 
     if (!firstTime) {
-        m_opaquePipelineHolder.update(m_extent, m_polygonMode);
-        m_maskPipelineHolder.update(m_extent, m_polygonMode);
-        m_depthlessPipelineHolder.update(m_extent, m_polygonMode);
-        m_wireframePipelineHolder.update(m_extent, vk::PolygonMode::eLine);
-        m_translucentPipelineHolder.update(m_extent, m_polygonMode);
+        m_opaquePipelineHolder.update(m_polygonMode);
+        m_maskPipelineHolder.update(m_polygonMode);
+        m_depthlessPipelineHolder.update(m_polygonMode);
+        m_wireframePipelineHolder.update(vk::PolygonMode::eLine);
+        m_translucentPipelineHolder.update(m_polygonMode);
     }
 }
 
@@ -698,7 +751,8 @@ void ForwardRendererStage::createResources()
     // Depth
     auto depthFormat = vulkan::depthBufferFormat(m_scene.engine().impl().physicalDevice());
     m_depthImageHolder.sampleCount(m_sampleCount);
-    m_depthImageHolder.create(vulkan::ImageKind::Depth, depthFormat, m_extent);
+    // @note Copyable, so that it can be read back for occlusion culling.
+    m_depthImageHolder.create(vulkan::ImageKind::CopyableDepth, depthFormat, m_extent);
 }
 
 void ForwardRendererStage::createFramebuffers()
@@ -724,6 +778,10 @@ void ForwardRendererStage::createFramebuffers()
     createInfo.height = m_extent.height;
     createInfo.layers = 1;
 
+    if (m_framebuffer) {
+        m_scene.engine().impl().deletionQueue().destroyLater(std::move(m_framebuffer));
+    }
+
     auto result = m_scene.engine().impl().device().createFramebufferUnique(createInfo);
     m_framebuffer = vulkan::checkMove(result, "stages.forward-renderer", "Unable to create framebuffers.");
 }
@@ -7,8 +7,11 @@
 #include <lava/magma/ubos.hpp>
 
 #include "../holders/image-holder.hpp"
+#include "../holders/occlusion-holder.hpp"
 #include "../holders/pipeline-holder.hpp"
 #include "../holders/render-pass-holder.hpp"
+#include "../holders/visible-instances-holder.hpp"
+#include "../render-queue.hpp"
 
 namespace lava::magma {
     /**
@@ -41,6 +44,9 @@ namespace lava::magma {
 
         void changeRenderImageLayout(vk::ImageLayout imageLayout, vk::CommandBuffer commandBuffer) final;
 
+        /// CPU side of record(), culling and sorting the scene's meshes into the render queues.
+        void fillRenderQueues(uint32_t frameId);
+
     protected:
         void initOpaquePass();
         void initMaskPass();
@@ -81,5 +87,14 @@ namespace lava::magma {
         vulkan::ImageHolder m_finalResolveImageHolder;
         vulkan::ImageHolder m_depthImageHolder;
         vk::UniqueFramebuffer m_framebuffer;
+        vulkan::VisibleInstancesHolder m_visibleInstancesHolder;
+        vulkan::OcclusionHolder m_occlusionHolder;
+
+        // Render queues, one per subpass
+        vulkan::RenderQueue m_opaqueRenderQueue;
+        vulkan::RenderQueue m_maskRenderQueue;
+        vulkan::RenderQueue m_depthlessRenderQueue;
+        vulkan::RenderQueue m_wireframeRenderQueue;
+        vulkan::RenderQueue m_translucentRenderQueue{vulkan::RenderQueue::Order::BackToFront};
     };
 }
@@ -1,5 +1,6 @@
 #include "./present.hpp"
 
+#include "../helpers/command-buffer.hpp"
 #include "../helpers/descriptor.hpp"
 #include "../holders/swapchain-holder.hpp"
 #include "../render-engine-impl.hpp"
@@ -16,7 +17,7 @@ Present::Present(RenderEngine::Impl& engine)
     , m_renderPassHolder(engine)
     , m_pipelineHolder(engine)
     , m_descriptorHolder(engine)
-    , m_uboHolder(engine)
+    , m_uboHolders(make_array<FRAME_IDS_COUNT, vulkan::UboHolder>(engine))
 {
     m_viewInfos.reserve(MAX_VIEW_COUNT);
 }
@@ -30,7 +31,7 @@ void Present::init()
         logger.error("magma.vulkan.stages.present") << "No swapchain holder binded before initialization." << std::endl;
     }
 
-    if (m_descriptorSet) {
+    if (m_descriptorSets[0u]) {
         logger.warning("magma.vulkan.stages.present") << "Already initialized." << std::endl;
         return;
     }
@@ -50,25 +51,27 @@ void Present::init()
 
     m_descriptorHolder.uniformBufferSizes({1, MAX_VIEW_COUNT});
     m_descriptorHolder.combinedImageSamplerSizes({MAX_VIEW_COUNT});
-    m_descriptorHolder.init(1, vk::ShaderStageFlagBits::eFragment);
+    m_descriptorHolder.init(FRAME_IDS_COUNT, vk::ShaderStageFlagBits::eFragment);
     m_pipelineHolder.add(m_descriptorHolder.setLayout());
 
-    m_descriptorSet = m_descriptorHolder.allocateSet("present");
-
     // Mock-up samplers
     // @fixme Why would you want dummy sampler here?
     // Just make one that has no fancy stuff in it...
     const auto imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
     const auto& dummySampler = m_engine.dummySampler();
     const auto& dummyImageView = m_engine.dummyImageView();
-    for (auto i = 0u; i < MAX_VIEW_COUNT; ++i) {
-        vulkan::updateDescriptorSet(m_engine.device(), m_descriptorSet.get(), dummyImageView, dummySampler, imageLayout, 2u, i);
-    }
+    for (auto frameId = 0u; frameId < FRAME_IDS_COUNT; ++frameId) {
+        m_descriptorSets[frameId] = m_descriptorHolder.allocateSet("present." + std::to_string(frameId));
+        for (auto i = 0u; i < MAX_VIEW_COUNT; ++i) {
+            vulkan::updateDescriptorSet(m_engine.device(), m_descriptorSets[frameId].get(), dummyImageView, dummySampler, imageLayout,
+                                        2u, i);
+        }
 
-    //----- Uniform buffers
+        //----- Uniform buffers
 
-    m_uboHolder.init(m_descriptorSet.get(), m_descriptorHolder.uniformBufferBindingOffset(),
-                     {sizeof(ViewUbo), {sizeof(ViewportUbo), MAX_VIEW_COUNT}});
+        m_uboHolders[frameId].init(m_descriptorSets[frameId].get(), m_descriptorHolder.uniformBufferBindingOffset(),
+                                   {sizeof(ViewUbo), {sizeof(ViewportUbo), MAX_VIEW_COUNT}});
+    }
 
     //----- Attachments
 
@@ -83,6 +86,7 @@ void Present::init()
     m_renderPassHolder.init();
 
     m_pipelineHolder.init(0u);
+    m_pipelineHolder.update();
 
     logger.log().tab(-1);
 }
@@ -91,7 +95,6 @@ void Present::update(const vk::Extent2D& extent)
 {
     m_extent = extent;
 
-    m_pipelineHolder.update(extent);
     createFramebuffers();
 }
 
@@ -99,6 +102,13 @@ void Present::render(vk::CommandBuffer commandBuffer)
 {
     const auto frameIndex = m_swapchainHolder->currentIndex();
 
+    if (m_ubosDirty) {
+        // :InternalFrameId Views changed, they are written to the set that was used
+        // the longest ago, as the GPU is done with it.
+        m_currentFrameId = (m_currentFrameId + 1u) % FRAME_IDS_COUNT;
+        updateBindings();
+    }
+
     //----- Prologue
 
     // Set render pass
@@ -114,6 +124,7 @@ void Present::render(vk::CommandBuffer commandBuffer)
     renderPassInfo.pClearValues = clearValues.data();
 
     commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, m_extent);
 
     //----- Render
 
@@ -121,7 +132,7 @@ void Present::render(vk::CommandBuffer commandBuffer)
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelineHolder.pipeline());
 
     // Draw
-    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineHolder.pipelineLayout(), 0, 1, &m_descriptorSet.get(),
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, m_pipelineHolder.pipelineLayout(), 0, 1, &m_descriptorSets[m_currentFrameId].get(),
                                      0, nullptr);
     commandBuffer.draw(3, 1, 0, 0);
 
@@ -190,6 +201,12 @@ void Present::createFramebuffers()
 {
     auto& imageViews = m_swapchainHolder->imageViews();
 
+    // Frames in flight might still use the previous ones.
+    if (!m_framebuffers.empty()) {
+        m_engine.deletionQueue().destroyLater(std::move(m_framebuffers));
+        m_framebuffers.clear();
+    }
+
     m_framebuffers.resize(imageViews.size());
 
     for (size_t i = 0; i < imageViews.size(); i++) {
@@ -210,12 +227,20 @@ void Present::createFramebuffers()
 
 void Present::updateUbos()
 {
-    // @todo Better have uboDirty and update(dt)?
-    m_engine.device().waitIdle();
+    // Applied once per frame, when rendering.
+    m_ubosDirty = true;
+}
+
+void Present::updateBindings()
+{
+    m_ubosDirty = false;
+
+    auto& uboHolder = m_uboHolders[m_currentFrameId];
+    auto descriptorSet = m_descriptorSets[m_currentFrameId].get();
 
     ViewUbo viewUbo;
     viewUbo.count = m_viewInfos.size();
-    m_uboHolder.copy(0, viewUbo);
+    uboHolder.copy(0, viewUbo);
 
     // Sort based on depth
     std::vector<ViewInfo> sortedViewInfos;
@@ -237,7 +262,7 @@ void Present::updateUbos()
         viewportUbo.height = viewInfo.viewport.height;
         viewportUbo.channelCount = viewInfo.channelCount;
 
-        m_uboHolder.copy(1, viewportUbo, i);
-        vulkan::updateDescriptorSet(m_engine.device(), m_descriptorSet.get(), viewInfo.imageView, viewInfo.sampler, viewInfo.imageLayout, 2u, i);
+        uboHolder.copy(1, viewportUbo, i);
+        vulkan::updateDescriptorSet(m_engine.device(), descriptorSet, viewInfo.imageView, viewInfo.sampler, viewInfo.imageLayout, 2u, i);
     }
 }
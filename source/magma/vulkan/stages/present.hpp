@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../aft-vulkan/config.hpp"
 #include "../holders/descriptor-holder.hpp"
 #include "../holders/image-holder.hpp"
 #include "../holders/pipeline-holder.hpp"
@@ -38,6 +39,7 @@ namespace lava::magma {
     protected:
         void createFramebuffers();
         void updateUbos();
+        void updateBindings();
 
     protected:
         struct ViewInfo {
@@ -62,10 +64,12 @@ namespace lava::magma {
         vulkan::RenderPassHolder m_renderPassHolder;
         vulkan::PipelineHolder m_pipelineHolder;
         vulkan::DescriptorHolder m_descriptorHolder;
-        vulkan::UboHolder m_uboHolder;
-        vk::UniqueDescriptorSet m_descriptorSet;
+        std::array<vulkan::UboHolder, FRAME_IDS_COUNT> m_uboHolders;
+        std::array<vk::UniqueDescriptorSet, FRAME_IDS_COUNT> m_descriptorSets;
         std::vector<vk::UniqueFramebuffer> m_framebuffers;
 
         uint32_t m_nextViewId = 0u;
+        uint32_t m_currentFrameId = 0u; //!< Of the descriptor set in use, see :InternalFrameId.
+        bool m_ubosDirty = false;
     };
 }
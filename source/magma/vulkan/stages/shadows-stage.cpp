@@ -5,15 +5,88 @@
 
 #include "../../aft-vulkan/mesh-aft.hpp"
 #include "../../aft-vulkan/scene-aft.hpp"
+#include "../helpers/command-buffer.hpp"
 #include "../render-engine-impl.hpp"
 #include "../render-image-impl.hpp"
 
 using namespace lava::magma;
 using namespace lava::chamber;
 
+namespace {
+    constexpr TrackerKey DRAW_CALLS_KEY("draw-calls.shadows");
+    constexpr TrackerKey CACHED_CASCADES_KEY("cached-cascades.shadows");
+    constexpr TrackerKey STATIC_REDRAWS_KEY("static-redraws.shadows");
+
+    /// Planes (n, d) of the volume the view-projection matrix maps to the clip space, keeping dot(n, p) <= d.
+    std::array<glm::vec4, 6> clipPlanes(const glm::mat4& matrix)
+    {
+        const auto row = [&matrix](uint32_t i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+
+        // Clip space being -w <= x, y <= w and 0 <= z <= w, each plane keeps dot(r, (p, 1)) >= 0.
+        std::array<glm::vec4, 6> planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                                           row(3) - row(1), row(2),          row(3) - row(2)};
+        for (auto& plane : planes) {
+            plane = glm::vec4(-glm::vec3(plane), plane.w) / glm::length(glm::vec3(plane));
+        }
+        return planes;
+    }
+
+    /// Copy a whole depth image into another one, both being left in DepthStencilReadOnlyOptimal layout.
+    void copyDepth(vk::CommandBuffer commandBuffer, vk::Image source, vk::Image target, const vk::Extent2D& extent)
+    {
+        std::array<vk::ImageMemoryBarrier, 2> barriers;
+        barriers[0].image = source;
+        barriers[1].image = target;
+        for (auto& barrier : barriers) {
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eDepth;
+            barrier.subresourceRange.levelCount = 1u;
+            barrier.subresourceRange.layerCount = 1u;
+        }
+
+        // The source has just been drawn, the target might still be sampled by the previous frame.
+        barriers[0].oldLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+        barriers[0].newLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barriers[0].srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+        barriers[0].dstAccessMask = vk::AccessFlagBits::eTransferRead;
+        barriers[1].oldLayout = vk::ImageLayout::eUndefined;
+        barriers[1].newLayout = vk::ImageLayout::eTransferDstOptimal;
+        barriers[1].srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eShaderRead;
+        barriers[1].dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eFragmentShader,
+                                      vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), 0, nullptr, 0, nullptr,
+                                      barriers.size(), barriers.data());
+
+        vk::ImageCopy imageCopy;
+        imageCopy.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
+        imageCopy.srcSubresource.layerCount = 1u;
+        imageCopy.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eDepth;
+        imageCopy.dstSubresource.layerCount = 1u;
+        imageCopy.extent = vk::Extent3D{extent.width, extent.height, 1u};
+        commandBuffer.copyImage(source, vk::ImageLayout::eTransferSrcOptimal, target, vk::ImageLayout::eTransferDstOptimal, 1,
+                                &imageCopy);
+
+        // Both are going to be drawn into next.
+        barriers[0].oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barriers[0].newLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+        barriers[0].srcAccessMask = vk::AccessFlagBits::eTransferRead;
+        barriers[0].dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+        barriers[1].oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barriers[1].newLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+        barriers[1].srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barriers[1].dstAccessMask =
+            vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                      vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                                      vk::DependencyFlags(), 0, nullptr, 0, nullptr, barriers.size(), barriers.data());
+    }
+}
+
 void ShadowsStage::Cascade::init(RenderEngine& engine)
 {
     imageHolder = std::make_shared<vulkan::ImageHolder>(engine.impl(), "magma.vulkan.stages.shadows.cascade.image");
+    staticImageHolder = std::make_shared<vulkan::ImageHolder>(engine.impl(), "magma.vulkan.stages.shadows.cascade.static-image");
 }
 
 ShadowsStage::ShadowsStage(Scene& scene)
@@ -36,6 +109,7 @@ void ShadowsStage::init(const Light& light)
 
     m_renderPassHolder.add(m_pipelineHolder);
     m_renderPassHolder.init();
+    m_pipelineHolder.update();
 
     logger.log().tab(-1);
 }
@@ -44,8 +118,6 @@ void ShadowsStage::update(const vk::Extent2D& extent)
 {
     m_extent = extent;
 
-    m_pipelineHolder.update(extent);
-
     createResources();
 }
 
@@ -61,53 +133,40 @@ void ShadowsStage::record(vk::CommandBuffer commandBuffer, const Camera* camera)
     auto& cascades = m_cascades.at(camera);
     const auto& shadows = m_scene.aft().shadows(*m_light, *camera);
     const auto& deviceHolder = m_scene.engine().impl().deviceHolder();
+    const auto staticShadowsVersion = m_scene.staticShadowsVersion();
 
     for (auto i = 0u; i < SHADOWS_CASCADES_COUNT; ++i) {
-        deviceHolder.debugBeginRegion(commandBuffer, "shadows");
-
-        //----- Prologue
-
-        // Set render pass
-        std::array<vk::ClearValue, 1> clearValues;
-        clearValues[0].depthStencil = vk::ClearDepthStencilValue{2e23, 0u};
-
-        vk::RenderPassBeginInfo renderPassInfo;
-        renderPassInfo.renderPass = m_renderPassHolder.renderPass();
-        renderPassInfo.framebuffer = cascades[i].framebuffer.get();
-        renderPassInfo.renderArea.offset = vk::Offset2D{0, 0};
-        renderPassInfo.renderArea.extent = m_extent;
-        renderPassInfo.clearValueCount = clearValues.size();
-        renderPassInfo.pClearValues = clearValues.data();
-
-        commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
-
-        //----- Pass
+        auto& cascade = cascades[i];
 
-        deviceHolder.debugBeginRegion(commandBuffer, "shadows.pass");
-
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelineHolder.pipeline());
-
-        cascades[i].ubo.cascadeTransform = shadows.cascadeTransform(i);
-        commandBuffer.pushConstants(m_pipelineHolder.pipelineLayout(),
-                                    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
-                                    SHADOW_MAP_PUSH_CONSTANT_OFFSET, sizeof(ShadowMapUbo), &cascades[i].ubo);
-
-        // @fixme We could frustrum cull out of light's frustrum
-        // Draw all meshes
-        for (auto mesh : m_scene.meshes()) {
-            if (!mesh->shadowsCastable()) continue;
-            tracker.counter("draw-calls.shadows") += 1u;
-            mesh->aft().renderUnlit(commandBuffer);
+        // Cascades not refreshed keep their shadow map, which matches the transform they still have.
+        if (cascade.drawn && !shadows.cascadeRefreshed(i)) {
+            tracker.add(CACHED_CASCADES_KEY);
+            continue;
         }
 
-        // Draw
-        commandBuffer.draw(6, 1, 0, 0);
-
-        deviceHolder.debugEndRegion(commandBuffer);
+        deviceHolder.debugBeginRegion(commandBuffer, "shadows");
 
-        //----- Epilogue
+        cascade.ubo.cascadeTransform = shadows.cascadeTransform(i);
+        cascade.drawn = true;
+
+        if (!cascade.staticDrawn || cascade.staticShadowsVersion != staticShadowsVersion
+            || cascade.staticCascadeTransform != cascade.ubo.cascadeTransform) {
+            collectCasters(cascade.ubo, true, m_casters);
+            cascade.staticEmpty = m_casters.empty();
+            if (!cascade.staticEmpty) {
+                tracker.add(STATIC_REDRAWS_KEY);
+                recordCasters(commandBuffer, cascade.staticFramebuffer.get(), cascade.ubo, m_casters, true);
+            }
+            cascade.staticCascadeTransform = cascade.ubo.cascadeTransform;
+            cascade.staticShadowsVersion = staticShadowsVersion;
+            cascade.staticDrawn = true;
+        }
 
-        commandBuffer.endRenderPass();
+        collectCasters(cascade.ubo, false, m_casters);
+        if (!cascade.staticEmpty) {
+            copyDepth(commandBuffer, cascade.staticImageHolder->image(), cascade.imageHolder->image(), m_extent);
+        }
+        recordCasters(commandBuffer, cascade.framebuffer.get(), cascade.ubo, m_casters, cascade.staticEmpty);
 
         deviceHolder.debugEndRegion(commandBuffer);
     }
@@ -149,6 +208,7 @@ void ShadowsStage::initPass()
     // @todo Ensure that format is supported, and maybe let this be configurable
     vulkan::PipelineHolder::DepthStencilAttachment depthStencilAttachment;
     depthStencilAttachment.format = vk::Format::eD16Unorm;
+    depthStencilAttachment.clear = false;
     m_pipelineHolder.set(depthStencilAttachment);
 
     //----- Rasterization
@@ -172,6 +232,74 @@ void ShadowsStage::initPass()
     m_pipelineHolder.add(vertexInput);
 }
 
+void ShadowsStage::collectCasters(const ShadowMapUbo& ubo, bool staticCasters, std::vector<Mesh*>& casters) const
+{
+    casters.clear();
+
+    auto collectMesh = [&](Mesh& mesh) {
+        if (!mesh.shadowsCastable() || mesh.shadowsStatic() != staticCasters) return;
+        casters.emplace_back(&mesh);
+    };
+
+    const auto planes = clipPlanes(ubo.cascadeTransform);
+    m_scene.meshesBvh().query(planes.data(), planes.size(), collectMesh);
+    for (auto mesh : m_scene.depthlessMeshes()) {
+        collectMesh(*mesh);
+    }
+}
+
+void ShadowsStage::recordCasters(vk::CommandBuffer commandBuffer, vk::Framebuffer framebuffer, const ShadowMapUbo& ubo,
+                                 const std::vector<Mesh*>& casters, bool clear)
+{
+    const auto& deviceHolder = m_scene.engine().impl().deviceHolder();
+
+    //----- Prologue
+
+    // @note Nothing is cleared by the render pass, as dynamic casters are drawn over the static ones.
+    vk::RenderPassBeginInfo renderPassInfo;
+    renderPassInfo.renderPass = m_renderPassHolder.renderPass();
+    renderPassInfo.framebuffer = framebuffer;
+    renderPassInfo.renderArea.offset = vk::Offset2D{0, 0};
+    renderPassInfo.renderArea.extent = m_extent;
+
+    commandBuffer.beginRenderPass(&renderPassInfo, vk::SubpassContents::eInline);
+    vulkan::setViewportAndScissor(commandBuffer, m_extent);
+
+    //----- Pass
+
+    deviceHolder.debugBeginRegion(commandBuffer, "shadows.pass");
+
+    if (clear) {
+        vk::ClearAttachment clearAttachment;
+        clearAttachment.aspectMask = vk::ImageAspectFlagBits::eDepth;
+        clearAttachment.clearValue.depthStencil = vk::ClearDepthStencilValue{1.f, 0u};
+
+        vk::ClearRect clearRect;
+        clearRect.rect.extent = m_extent;
+        clearRect.layerCount = 1u;
+
+        commandBuffer.clearAttachments(1, &clearAttachment, 1, &clearRect);
+    }
+
+    if (!casters.empty()) {
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, m_pipelineHolder.pipeline());
+        commandBuffer.pushConstants(m_pipelineHolder.pipelineLayout(),
+                                    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
+                                    SHADOW_MAP_PUSH_CONSTANT_OFFSET, sizeof(ShadowMapUbo), &ubo);
+
+        for (auto mesh : casters) {
+            tracker.add(DRAW_CALLS_KEY);
+            mesh->aft().renderUnlit(commandBuffer);
+        }
+    }
+
+    deviceHolder.debugEndRegion(commandBuffer);
+
+    //----- Epilogue
+
+    commandBuffer.endRenderPass();
+}
+
 void ShadowsStage::createResources()
 {
     for (auto camera : m_scene.cameras()) {
@@ -190,12 +318,13 @@ void ShadowsStage::ensureResourcesForCamera(const Camera& camera)
         cascades[i].init(m_scene.engine());
 
         auto depthFormat = vk::Format::eD16Unorm;
-        cascades[i].imageHolder->create(vulkan::ImageKind::Depth, depthFormat, m_extent);
+        cascades[i].imageHolder->create(vulkan::ImageKind::CopyableDepth, depthFormat, m_extent);
+        cascades[i].staticImageHolder->create(vulkan::ImageKind::CopyableDepth, depthFormat, m_extent);
     }
 
     // Framebuffer
-    for (auto i = 0u; i < SHADOWS_CASCADES_COUNT; ++i) {
-        std::array<vk::ImageView, 1> attachments = {cascades[i].imageHolder->view()};
+    auto createFramebuffer = [this](const vulkan::ImageHolder& imageHolder) {
+        std::array<vk::ImageView, 1> attachments = {imageHolder.view()};
 
         vk::FramebufferCreateInfo createInfo;
         createInfo.renderPass = m_renderPassHolder.renderPass();
@@ -206,6 +335,11 @@ void ShadowsStage::ensureResourcesForCamera(const Camera& camera)
         createInfo.layers = 1;
 
         auto result = m_scene.engine().impl().device().createFramebufferUnique(createInfo);
-        cascades[i].framebuffer = vulkan::checkMove(result, "stages.shadows", "Unable to create framebuffers.");
+        return vulkan::checkMove(result, "stages.shadows", "Unable to create framebuffers.");
+    };
+
+    for (auto i = 0u; i < SHADOWS_CASCADES_COUNT; ++i) {
+        cascades[i].framebuffer = createFramebuffer(*cascades[i].imageHolder);
+        cascades[i].staticFramebuffer = createFramebuffer(*cascades[i].staticImageHolder);
     }
 }
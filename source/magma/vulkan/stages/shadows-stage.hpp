@@ -32,12 +32,33 @@ namespace lava::magma {
         void createResources();
         void ensureResourcesForCamera(const Camera& camera);
 
+        /// Find either the static or the dynamic casters within the volume of the cascade.
+        void collectCasters(const ShadowMapUbo& ubo, bool staticCasters, std::vector<Mesh*>& casters) const;
+
+        /// Draw the casters, over what the framebuffer holds unless cleared first.
+        void recordCasters(vk::CommandBuffer commandBuffer, vk::Framebuffer framebuffer, const ShadowMapUbo& ubo,
+                           const std::vector<Mesh*>& casters, bool clear);
+
     protected:
+        /**
+         * Static casters are drawn in their own layer, kept until one of them changes
+         * or the cascade's volume moves. It is copied to the shadow map before drawing the dynamic casters.
+         * When no static caster is within the volume, there is no such layer,
+         * and the shadow map is just cleared before drawing the dynamic casters.
+         */
         struct Cascade {
             // @fixme Why not unique_ptr, exactly?
             std::shared_ptr<vulkan::ImageHolder> imageHolder;
             vk::UniqueFramebuffer framebuffer;
             ShadowMapUbo ubo;
+            bool drawn = false;
+
+            std::shared_ptr<vulkan::ImageHolder> staticImageHolder;
+            vk::UniqueFramebuffer staticFramebuffer;
+            glm::mat4 staticCascadeTransform;
+            uint32_t staticShadowsVersion = 0u;
+            bool staticDrawn = false;
+            bool staticEmpty = true;
 
             void init(RenderEngine& engine);
         };
@@ -55,5 +76,8 @@ namespace lava::magma {
         // Cascade shadow maps
         // @todo For clarity, we might want a using CameraId = uint32_t somewhere.
         std::unordered_map<const Camera*, std::array<Cascade, SHADOWS_CASCADES_COUNT>> m_cascades; // Stored per cameraId
+
+        // Kept to prevent reallocations
+        std::vector<Mesh*> m_casters;
     };
 }
@@ -0,0 +1,504 @@
+#include "./upload-queue.hpp"
+
+using namespace lava::magma::vulkan;
+using namespace lava::chamber;
+
+namespace {
+    constexpr const uint32_t TRANSFER = 0u;
+    constexpr const uint32_t GRAPHICS = 1u;
+
+    constexpr const vk::DeviceSize STAGING_CHUNK_SIZE = 4u * 1024u * 1024u;
+    constexpr const vk::DeviceSize STAGING_ALIGNMENT = 16u; // Enough for any texel size
+    constexpr const uint32_t MAX_FREE_STAGING_CHUNKS = 4u;
+
+    constexpr TrackerKey UPLOAD_BATCHES_KEY("uploads.batches");
+    constexpr TrackerKey UPLOAD_TRANSFER_COPIES_KEY("uploads.transfer-queue-copies");
+    constexpr TrackerKey UPLOAD_GRAPHICS_COPIES_KEY("uploads.graphics-queue-copies");
+}
+
+UploadQueue::~UploadQueue()
+{
+    for (auto& batch : m_inFlightBatches) {
+        m_device.waitForFences(1u, &batch.fence.get(), true, std::numeric_limits<uint64_t>::max());
+    }
+}
+
+void UploadQueue::init(vk::Device device, MemoryAllocator& memoryAllocator, vk::Queue transferQueue,
+                       uint32_t transferQueueFamilyIndex, vk::Queue graphicsQueue, uint32_t graphicsQueueFamilyIndex)
+{
+    m_device = device;
+    m_memoryAllocator = &memoryAllocator;
+    m_transferQueue = transferQueue;
+    m_transferQueueFamilyIndex = transferQueueFamilyIndex;
+    m_graphicsQueue = graphicsQueue;
+    m_graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
+    m_separateTransfer = (transferQueueFamilyIndex != graphicsQueueFamilyIndex);
+
+    vk::CommandPoolCreateInfo createInfo;
+    createInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+
+    createInfo.queueFamilyIndex = transferQueueFamilyIndex;
+    auto result = device.createCommandPoolUnique(createInfo);
+    m_transferCommandPool = vulkan::checkMove(result, "upload-queue", "Unable to create transfer command pool.");
+
+    createInfo.queueFamilyIndex = graphicsQueueFamilyIndex;
+    result = device.createCommandPoolUnique(createInfo);
+    m_graphicsCommandPool = vulkan::checkMove(result, "upload-queue", "Unable to create graphics command pool.");
+
+    m_pendingBatch.ticket = 1u;
+}
+
+void UploadQueue::created(vk::Buffer buffer)
+{
+    std::scoped_lock lock(m_mutex);
+    m_createdBuffers.emplace(static_cast<VkBuffer>(buffer));
+}
+
+void UploadQueue::created(vk::Image image)
+{
+    std::scoped_lock lock(m_mutex);
+    m_createdImages.emplace(static_cast<VkImage>(image));
+}
+
+UploadTicket UploadQueue::copy(vk::Buffer buffer, vk::DeviceSize bufferSize, vk::DeviceSize offset, const void* data,
+                               vk::DeviceSize size)
+{
+    std::scoped_lock lock(m_mutex);
+
+    // Overwriting everything, previous copies are useless.
+    const bool whole = (offset == 0u && size == bufferSize);
+    if (whole) {
+        erase(m_pendingBatch.works[TRANSFER], buffer, nullptr);
+        erase(m_pendingBatch.works[GRAPHICS], buffer, nullptr);
+    }
+
+    // @note The transfer queue does not wait for the graphics one,
+    // so it cannot write to a resource previous frames might still be reading.
+    const bool unused = (m_createdBuffers.find(static_cast<VkBuffer>(buffer)) != m_createdBuffers.end());
+    const auto workIndex = (whole && unused && m_separateTransfer) ? TRANSFER : GRAPHICS;
+
+    BufferCopy bufferCopy;
+    bufferCopy.buffer = buffer;
+    bufferCopy.region.dstOffset = offset;
+    bufferCopy.region.size = size;
+    auto stagingData = stage(workIndex, size, bufferCopy.stagingBuffer, bufferCopy.region.srcOffset);
+    memcpy(stagingData, data, size);
+
+    m_pendingBatch.works[workIndex].bufferCopies.emplace_back(bufferCopy);
+    return m_pendingBatch.ticket;
+}
+
+UploadTicket UploadQueue::copy(const ImageUploadInfo& info, const vk::BufferImageCopy& region, const void* data, vk::DeviceSize size)
+{
+    std::scoped_lock lock(m_mutex);
+
+    const auto& range = info.subresourceRange;
+    const bool whole = (range.levelCount == 1u && region.imageSubresource.mipLevel == range.baseMipLevel
+                        && region.imageSubresource.baseArrayLayer == range.baseArrayLayer
+                        && region.imageSubresource.layerCount == range.layerCount);
+
+    ImageCopy imageCopy;
+    imageCopy.info = info;
+    imageCopy.region = region;
+
+    // Overwriting everything, previous copies or transitions are useless, and so is the content.
+    if (whole) {
+        erase(m_pendingBatch.works[TRANSFER], nullptr, info.image);
+        erase(m_pendingBatch.works[GRAPHICS], nullptr, info.image);
+        imageCopy.info.oldLayout = vk::ImageLayout::eUndefined;
+    }
+
+    const bool unused = (m_createdImages.find(static_cast<VkImage>(info.image)) != m_createdImages.end());
+    const auto workIndex = (whole && unused && m_separateTransfer) ? TRANSFER : GRAPHICS;
+
+    auto stagingData = stage(workIndex, size, imageCopy.stagingBuffer, imageCopy.region.bufferOffset);
+    memcpy(stagingData, data, size);
+
+    m_pendingBatch.works[workIndex].imageCopies.emplace_back(imageCopy);
+    return m_pendingBatch.ticket;
+}
+
+UploadTicket UploadQueue::transition(const ImageUploadInfo& info)
+{
+    std::scoped_lock lock(m_mutex);
+
+    ImageCopy imageCopy;
+    imageCopy.info = info;
+    m_pendingBatch.works[GRAPHICS].imageCopies.emplace_back(imageCopy);
+    return m_pendingBatch.ticket;
+}
+
+UploadTicket UploadQueue::flush()
+{
+    std::scoped_lock lock(m_mutex);
+
+    // Frames submitted from now on might use any of these.
+    m_createdBuffers.clear();
+    m_createdImages.clear();
+
+    auto& batch = m_pendingBatch;
+    const auto ticket = batch.ticket;
+    if (batch.works[TRANSFER].empty() && batch.works[GRAPHICS].empty()) {
+        return ticket - 1u;
+    }
+
+    PROFILE_FUNCTION(PROFILER_COLOR_ALLOCATION);
+
+    tracker.add(UPLOAD_BATCHES_KEY);
+    tracker.add(UPLOAD_TRANSFER_COPIES_KEY, batch.works[TRANSFER].bufferCopies.size() + batch.works[TRANSFER].imageCopies.size());
+    tracker.add(UPLOAD_GRAPHICS_COPIES_KEY, batch.works[GRAPHICS].bufferCopies.size() + batch.works[GRAPHICS].imageCopies.size());
+
+    // Transfer queue, signaling the graphics one when done
+    if (!batch.works[TRANSFER].empty()) {
+        recordTransfer(batch);
+
+        auto semaphoreResult = m_device.createSemaphoreUnique(vk::SemaphoreCreateInfo());
+        batch.semaphore = vulkan::checkMove(semaphoreResult, "upload-queue", "Unable to create semaphore.");
+
+        vk::SubmitInfo submitInfo;
+        submitInfo.commandBufferCount = 1u;
+        submitInfo.pCommandBuffers = &batch.works[TRANSFER].commandBuffer.get();
+        submitInfo.signalSemaphoreCount = 1u;
+        submitInfo.pSignalSemaphores = &batch.semaphore.get();
+        m_transferQueue.submit(1u, &submitInfo, nullptr);
+    }
+
+    // Graphics queue, fencing the whole batch
+    recordGraphics(batch);
+
+    auto fenceResult = m_device.createFenceUnique(vk::FenceCreateInfo());
+    batch.fence = vulkan::checkMove(fenceResult, "upload-queue", "Unable to create fence.");
+
+    const vk::PipelineStageFlags waitStageMask = vk::PipelineStageFlagBits::eTransfer;
+    vk::SubmitInfo submitInfo;
+    submitInfo.commandBufferCount = 1u;
+    submitInfo.pCommandBuffers = &batch.works[GRAPHICS].commandBuffer.get();
+    if (batch.semaphore) {
+        submitInfo.waitSemaphoreCount = 1u;
+        submitInfo.pWaitSemaphores = &batch.semaphore.get();
+        submitInfo.pWaitDstStageMask = &waitStageMask;
+    }
+    m_graphicsQueue.submit(1u, &submitInfo, batch.fence.get());
+
+    m_inFlightBatches.emplace_back(std::move(batch));
+    m_pendingBatch = Batch();
+    m_pendingBatch.ticket = ticket + 1u;
+    return ticket;
+}
+
+bool UploadQueue::done(UploadTicket ticket)
+{
+    std::scoped_lock lock(m_mutex);
+
+    if (ticket >= m_pendingBatch.ticket) {
+        return m_pendingBatch.works[TRANSFER].empty() && m_pendingBatch.works[GRAPHICS].empty();
+    }
+
+    for (const auto& batch : m_inFlightBatches) {
+        if (batch.ticket == ticket) {
+            return m_device.getFenceStatus(batch.fence.get()) == vk::Result::eSuccess;
+        }
+    }
+
+    return true;
+}
+
+void UploadQueue::wait(UploadTicket ticket)
+{
+    bool pending;
+    {
+        std::scoped_lock lock(m_mutex);
+        pending = (ticket >= m_pendingBatch.ticket);
+    }
+
+    if (pending) {
+        ticket = flush();
+    }
+
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const auto& batch : m_inFlightBatches) {
+            if (batch.ticket == ticket) {
+                m_device.waitForFences(1u, &batch.fence.get(), true, std::numeric_limits<uint64_t>::max());
+                break;
+            }
+        }
+    }
+
+    update();
+}
+
+void UploadQueue::update()
+{
+    std::scoped_lock lock(m_mutex);
+
+    // All batches are fenced on the graphics queue, so they complete in order.
+    auto completedCount = 0u;
+    for (auto& batch : m_inFlightBatches) {
+        if (m_device.getFenceStatus(batch.fence.get()) != vk::Result::eSuccess) break;
+        retire(batch);
+        completedCount += 1u;
+    }
+
+    m_inFlightBatches.erase(m_inFlightBatches.begin(), m_inFlightBatches.begin() + completedCount);
+}
+
+// ----- Internal
+
+void UploadQueue::forget(vk::Buffer buffer, vk::Image image)
+{
+    std::scoped_lock lock(m_mutex);
+
+    // @note Batches in flight have been submitted before the deletion queue's next frame fence,
+    // and the resource is kept alive until that one is signaled.
+    for (auto& work : m_pendingBatch.works) {
+        erase(work, buffer, image);
+    }
+
+    m_createdBuffers.erase(static_cast<VkBuffer>(buffer));
+    m_createdImages.erase(static_cast<VkImage>(image));
+}
+
+uint8_t* UploadQueue::stage(uint32_t workIndex, vk::DeviceSize size, vk::Buffer& stagingBuffer, vk::DeviceSize& stagingOffset)
+{
+    auto& stagingChunks = m_pendingBatch.works[workIndex].stagingChunks;
+
+    if (!stagingChunks.empty()) {
+        auto& chunk = stagingChunks.back();
+        auto offset = (chunk.used + STAGING_ALIGNMENT - 1u) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+        if (offset + size <= chunk.size) {
+            chunk.used = offset + size;
+            stagingBuffer = chunk.buffer.get();
+            stagingOffset = offset;
+            return reinterpret_cast<uint8_t*>(chunk.memory.mappedData()) + offset;
+        }
+    }
+
+    // Not enough space, recycling a chunk if possible.
+    // @note Chunks are never shared between queue families, so that no ownership transfer is needed.
+    StagingChunk chunk;
+    auto& freeChunks = m_freeStagingChunks[workIndex];
+    if (size <= STAGING_CHUNK_SIZE && !freeChunks.empty()) {
+        chunk = std::move(freeChunks.back());
+        freeChunks.pop_back();
+    }
+    else {
+        vk::BufferUsageFlags usageFlags = vk::BufferUsageFlagBits::eTransferSrc;
+        vk::MemoryPropertyFlags propertyFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+        chunk.size = std::max(size, STAGING_CHUNK_SIZE);
+        chunk.buffer = m_memoryAllocator->createBuffer(chunk.size, usageFlags, propertyFlags, MemoryCategory::Staging, chunk.memory);
+    }
+
+    chunk.used = size;
+    stagingBuffer = chunk.buffer.get();
+    stagingOffset = 0u;
+    auto data = reinterpret_cast<uint8_t*>(chunk.memory.mappedData());
+    stagingChunks.emplace_back(std::move(chunk));
+    return data;
+}
+
+void UploadQueue::erase(Work& work, vk::Buffer buffer, vk::Image image)
+{
+    auto& bufferCopies = work.bufferCopies;
+    bufferCopies.erase(std::remove_if(bufferCopies.begin(), bufferCopies.end(),
+                                      [buffer](const BufferCopy& bufferCopy) { return bufferCopy.buffer == buffer; }),
+                       bufferCopies.end());
+
+    auto& imageCopies = work.imageCopies;
+    imageCopies.erase(std::remove_if(imageCopies.begin(), imageCopies.end(),
+                                     [image](const ImageCopy& imageCopy) { return imageCopy.info.image == image; }),
+                      imageCopies.end());
+}
+
+vk::UniqueCommandBuffer UploadQueue::beginCommandBuffer(vk::CommandPool commandPool)
+{
+    vk::CommandBufferAllocateInfo allocInfo;
+    allocInfo.level = vk::CommandBufferLevel::ePrimary;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1u;
+
+    auto result = m_device.allocateCommandBuffersUnique(allocInfo);
+    auto commandBuffer = std::move(vulkan::checkMove(result, "upload-queue", "Unable to create command buffer.")[0]);
+
+    vk::CommandBufferBeginInfo beginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit};
+    commandBuffer->begin(&beginInfo);
+
+    return commandBuffer;
+}
+
+void UploadQueue::recordTransfer(Batch& batch)
+{
+    auto& work = batch.works[TRANSFER];
+    work.commandBuffer = beginCommandBuffer(m_transferCommandPool.get());
+    auto commandBuffer = work.commandBuffer.get();
+
+    //----- Prepare images, their previous content is discarded so no ownership is acquired
+
+    std::vector<vk::ImageMemoryBarrier> imageBarriers(work.imageCopies.size());
+    for (auto i = 0u; i < work.imageCopies.size(); ++i) {
+        const auto& info = work.imageCopies[i].info;
+        auto& barrier = imageBarriers[i];
+        barrier.oldLayout = vk::ImageLayout::eUndefined;
+        barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.image = info.image;
+        barrier.subresourceRange = info.subresourceRange;
+    }
+
+    if (!imageBarriers.empty()) {
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(),
+                                      0u, nullptr, 0u, nullptr, imageBarriers.size(), imageBarriers.data());
+    }
+
+    //----- Copies
+
+    for (const auto& bufferCopy : work.bufferCopies) {
+        commandBuffer.copyBuffer(bufferCopy.stagingBuffer, bufferCopy.buffer, 1u, &bufferCopy.region);
+    }
+
+    for (const auto& imageCopy : work.imageCopies) {
+        commandBuffer.copyBufferToImage(imageCopy.stagingBuffer, imageCopy.info.image, vk::ImageLayout::eTransferDstOptimal, 1u,
+                                        &imageCopy.region);
+    }
+
+    //----- Release ownership to the graphics queue, mirrored in recordGraphics
+
+    std::vector<vk::BufferMemoryBarrier> bufferBarriers(work.bufferCopies.size());
+    for (auto i = 0u; i < work.bufferCopies.size(); ++i) {
+        const auto& bufferCopy = work.bufferCopies[i];
+        auto& barrier = bufferBarriers[i];
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+        barrier.buffer = bufferCopy.buffer;
+        barrier.offset = bufferCopy.region.dstOffset;
+        barrier.size = bufferCopy.region.size;
+    }
+
+    for (auto i = 0u; i < work.imageCopies.size(); ++i) {
+        const auto& info = work.imageCopies[i].info;
+        auto& barrier = imageBarriers[i];
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = info.newLayout;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlags();
+        barrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+    }
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(),
+                                  0u, nullptr, bufferBarriers.size(), bufferBarriers.data(), imageBarriers.size(), imageBarriers.data());
+
+    commandBuffer.end();
+}
+
+void UploadQueue::recordGraphics(Batch& batch)
+{
+    auto& transferWork = batch.works[TRANSFER];
+    auto& work = batch.works[GRAPHICS];
+    work.commandBuffer = beginCommandBuffer(m_graphicsCommandPool.get());
+    auto commandBuffer = work.commandBuffer.get();
+
+    //----- Acquire ownership of what the transfer queue did
+
+    if (!transferWork.empty()) {
+        std::vector<vk::BufferMemoryBarrier> bufferBarriers(transferWork.bufferCopies.size());
+        for (auto i = 0u; i < transferWork.bufferCopies.size(); ++i) {
+            const auto& bufferCopy = transferWork.bufferCopies[i];
+            auto& barrier = bufferBarriers[i];
+            barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+            barrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+            barrier.buffer = bufferCopy.buffer;
+            barrier.offset = bufferCopy.region.dstOffset;
+            barrier.size = bufferCopy.region.size;
+        }
+
+        std::vector<vk::ImageMemoryBarrier> imageBarriers(transferWork.imageCopies.size());
+        for (auto i = 0u; i < transferWork.imageCopies.size(); ++i) {
+            const auto& info = transferWork.imageCopies[i].info;
+            auto& barrier = imageBarriers[i];
+            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+            barrier.newLayout = info.newLayout;
+            barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+            barrier.srcQueueFamilyIndex = m_transferQueueFamilyIndex;
+            barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIndex;
+            barrier.image = info.image;
+            barrier.subresourceRange = info.subresourceRange;
+        }
+
+        // @note The source stage matches the semaphore wait stage.
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands,
+                                      vk::DependencyFlags(), 0u, nullptr, bufferBarriers.size(), bufferBarriers.data(),
+                                      imageBarriers.size(), imageBarriers.data());
+    }
+
+    //----- Buffers, in place, after previous frames are done reading them
+
+    if (!work.bufferCopies.empty()) {
+        vk::MemoryBarrier barrier;
+        barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer,
+                                      vk::DependencyFlags(), 1u, &barrier, 0u, nullptr, 0u, nullptr);
+
+        for (const auto& bufferCopy : work.bufferCopies) {
+            commandBuffer.copyBuffer(bufferCopy.stagingBuffer, bufferCopy.buffer, 1u, &bufferCopy.region);
+        }
+
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands,
+                                      vk::DependencyFlags(), 1u, &barrier, 0u, nullptr, 0u, nullptr);
+    }
+
+    //----- Images, in submission order as they might concern the same image
+
+    for (const auto& imageCopy : work.imageCopies) {
+        const auto& info = imageCopy.info;
+
+        vk::ImageMemoryBarrier barrier;
+        barrier.image = info.image;
+        barrier.subresourceRange = info.subresourceRange;
+        barrier.oldLayout = info.oldLayout;
+        barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+
+        // Layout transition only
+        if (!imageCopy.stagingBuffer) {
+            barrier.newLayout = info.newLayout;
+            barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands,
+                                          vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u, &barrier);
+            continue;
+        }
+
+        barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer,
+                                      vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u, &barrier);
+
+        commandBuffer.copyBufferToImage(imageCopy.stagingBuffer, info.image, vk::ImageLayout::eTransferDstOptimal, 1u,
+                                        &imageCopy.region);
+
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = info.newLayout;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands,
+                                      vk::DependencyFlags(), 0u, nullptr, 0u, nullptr, 1u, &barrier);
+    }
+
+    commandBuffer.end();
+}
+
+void UploadQueue::retire(Batch& batch)
+{
+    for (auto workIndex = 0u; workIndex < batch.works.size(); ++workIndex) {
+        auto& freeChunks = m_freeStagingChunks[workIndex];
+        for (auto& chunk : batch.works[workIndex].stagingChunks) {
+            if (chunk.size == STAGING_CHUNK_SIZE && freeChunks.size() < MAX_FREE_STAGING_CHUNKS) {
+                freeChunks.emplace_back(std::move(chunk));
+            }
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "./memory-allocator.hpp"
+#include "./wrappers.hpp"
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+
+namespace lava::magma::vulkan {
+    /// Identifies a batch of uploads, increasing with each flush.
+    using UploadTicket = uint64_t;
+
+    /// Target of an image upload, barriers always cover the whole subresourceRange.
+    struct ImageUploadInfo {
+        vk::Image image = nullptr;
+        vk::ImageSubresourceRange subresourceRange;
+        vk::ImageLayout oldLayout = vk::ImageLayout::eUndefined;
+        vk::ImageLayout newLayout = vk::ImageLayout::eUndefined;
+    };
+
+    /**
+     * Accumulates staged copies to device-local resources and submits them all at once.
+     *
+     * Copies that overwrite a whole resource the GPU has never used go to the transfer queue,
+     * then are handed over to the graphics queue with ownership barriers.
+     * Anything else is done on the graphics queue directly, just after these ownership transfers,
+     * as previous frames might still be reading the resource, and partial copies need the previous content.
+     * When the transfer queue is the graphics one, everything goes there.
+     *
+     * Everything is flushed once per frame by the engine, before submitting the frame's command buffers.
+     * Anyone submitting work on the graphics queue outside of the frame should flush() first.
+     *
+     * Thread-safe.
+     */
+    class UploadQueue {
+    public:
+        ~UploadQueue();
+
+        void init(vk::Device device, MemoryAllocator& memoryAllocator, vk::Queue transferQueue, uint32_t transferQueueFamilyIndex,
+                  vk::Queue graphicsQueue, uint32_t graphicsQueueFamilyIndex);
+
+        /**
+         * Declare a freshly created resource, that no GPU work can be using yet.
+         * Its whole copies can go to the transfer queue until the next flush().
+         */
+        void created(vk::Buffer buffer);
+        void created(vk::Image image);
+
+        /// Stage data to be copied to the buffer, returning the ticket of the batch it will be part of.
+        UploadTicket copy(vk::Buffer buffer, vk::DeviceSize bufferSize, vk::DeviceSize offset, const void* data, vk::DeviceSize size);
+
+        /// Stage data to be copied to the image, the region's bufferOffset is ignored.
+        UploadTicket copy(const ImageUploadInfo& info, const vk::BufferImageCopy& region, const void* data, vk::DeviceSize size);
+
+        /// Change the layout of the image, done on the graphics queue.
+        UploadTicket transition(const ImageUploadInfo& info);
+
+        /**
+         * Submit everything that has been staged, returning the ticket of that batch.
+         *
+         * @note Submitting to queues, this should only be called from the thread rendering frames.
+         */
+        UploadTicket flush();
+
+        /// Whether the batch has been completely executed.
+        bool done(UploadTicket ticket);
+
+        /// Block until the batch has been completely executed, flushing first if needed.
+        void wait(UploadTicket ticket);
+
+        /// Recycle the staging memory of completed batches.
+        void update();
+
+        /// Drop the pending copies to the resource, because it is going to be destroyed.
+        void forget(vk::Buffer buffer) { forget(buffer, nullptr); }
+        void forget(vk::Image image) { forget(nullptr, image); }
+
+    private:
+        struct StagingChunk {
+            MemoryAllocation memory;
+            vk::UniqueBuffer buffer;
+            vk::DeviceSize size = 0u;
+            vk::DeviceSize used = 0u;
+        };
+
+        struct BufferCopy {
+            vk::Buffer buffer = nullptr;
+            vk::Buffer stagingBuffer = nullptr;
+            vk::BufferCopy region;
+        };
+
+        struct ImageCopy {
+            ImageUploadInfo info;
+            vk::Buffer stagingBuffer = nullptr; //!< nullptr for a layout transition only.
+            vk::BufferImageCopy region;
+        };
+
+        /// What one queue does within a batch.
+        struct Work {
+            std::vector<BufferCopy> bufferCopies;
+            std::vector<ImageCopy> imageCopies;
+            std::vector<StagingChunk> stagingChunks;
+            vk::UniqueCommandBuffer commandBuffer;
+
+            bool empty() const { return bufferCopies.empty() && imageCopies.empty(); }
+        };
+
+        struct Batch {
+            UploadTicket ticket = 0u;
+            std::array<Work, 2u> works; //!< Transfer then graphics.
+            vk::UniqueSemaphore semaphore;
+            vk::UniqueFence fence;
+        };
+
+    protected:
+        void forget(vk::Buffer buffer, vk::Image image);
+        uint8_t* stage(uint32_t workIndex, vk::DeviceSize size, vk::Buffer& stagingBuffer, vk::DeviceSize& stagingOffset);
+        void erase(Work& work, vk::Buffer buffer, vk::Image image);
+        vk::UniqueCommandBuffer beginCommandBuffer(vk::CommandPool commandPool);
+        void recordTransfer(Batch& batch);
+        void recordGraphics(Batch& batch);
+        void retire(Batch& batch);
+
+    private:
+        vk::Device m_device = nullptr;
+        MemoryAllocator* m_memoryAllocator = nullptr;
+        vk::Queue m_transferQueue = nullptr;
+        vk::Queue m_graphicsQueue = nullptr;
+        uint32_t m_transferQueueFamilyIndex = -1u;
+        uint32_t m_graphicsQueueFamilyIndex = -1u;
+        bool m_separateTransfer = false;
+
+        std::mutex m_mutex;
+        vk::UniqueCommandPool m_transferCommandPool;
+        vk::UniqueCommandPool m_graphicsCommandPool;
+        Batch m_pendingBatch;
+        std::vector<Batch> m_inFlightBatches;
+        std::array<std::vector<StagingChunk>, 2u> m_freeStagingChunks;
+
+        // Created since the last flush, so not in any frame yet.
+        std::unordered_set<VkBuffer> m_createdBuffers;
+        std::unordered_set<VkImage> m_createdImages;
+    };
+}
@@ -89,7 +89,12 @@ void ColliderComponent::addMeshNodeShape(const MeshNode& node)
         for (auto& primitive : node.group->primitives()) {
             auto& unlitVertices = primitive->unlitVertices();
             VectorView<glm::vec3> vertices(reinterpret_cast<uint8_t*>(unlitVertices.data()) + offsetof(magma::UnlitVertex, pos), unlitVertices.size(), sizeof(magma::UnlitVertex));
-            rigidBody.addMeshShape(transform, vertices, primitive->indices());
+            if (primitive->indicesWide()) {
+                rigidBody.addMeshShape(transform, vertices, primitive->indices32());
+            }
+            else {
+                rigidBody.addMeshShape(transform, vertices, primitive->indices16());
+            }
         }
     }
 
@@ -160,12 +160,12 @@ float MeshComponent::distanceFrom(const Ray& ray, PickPrecision pickPrecision) c
 
             // Check against primitive's triangles
             const auto& transform = primitive->transform(node.instanceIndex);
-            const auto& indices = primitive->indices();
+            const auto indicesCount = primitive->indicesCount();
             const auto& vertices = primitive->unlitVertices();
-            for (auto i = 0u; i < indices.size(); i += 3) {
-                auto p0 = glm::vec3(transform * glm::vec4(vertices[indices[i]].pos, 1.f));
-                auto p1 = glm::vec3(transform * glm::vec4(vertices[indices[i + 1]].pos, 1.f));
-                auto p2 = glm::vec3(transform * glm::vec4(vertices[indices[i + 2]].pos, 1.f));
+            for (auto i = 0u; i < indicesCount; i += 3) {
+                auto p0 = glm::vec3(transform * glm::vec4(vertices[primitive->index(i)].pos, 1.f));
+                auto p1 = glm::vec3(transform * glm::vec4(vertices[primitive->index(i + 1)].pos, 1.f));
+                auto p2 = glm::vec3(transform * glm::vec4(vertices[primitive->index(i + 2)].pos, 1.f));
 
                 float t = intersectTriangle(ray, p0, p1, p2);
                 if (t > 0.f && (distance == 0.f || t < distance)) {
@@ -44,21 +44,25 @@ Font::Font(GameEngine& engine, const std::vector<std::string>& paths, uint32_t s
 std::vector<Font::GlyphInfo> Font::glyphsInfos(u8string_view u8Text, bool skipBlank)
 {
     std::vector<GlyphInfo> glyphsInfos;
+    this->glyphsInfos(u8Text, glyphsInfos, skipBlank);
+    return glyphsInfos;
+}
+
+void Font::glyphsInfos(u8string_view u8Text, std::vector<GlyphInfo>& glyphsInfos, bool skipBlank)
+{
+    glyphsInfos.clear();
+    glyphsInfos.reserve(u8Text.size());
+
+    auto& codepoints = m_codepoints;
+    codepoints.resize(u8Text.size());
+    codepoints.resize(utf8Decode(u8Text, codepoints.data()));
 
     bool textureChanged = false;
     float advance = 0.f;
 
-    uint8_t bytesLength;
-    auto u = reinterpret_cast<const uint8_t*>(u8Text.data());
-    auto c = utf8Codepoint(u, bytesLength);
-    u += bytesLength;
-
-    uint32_t i = bytesLength;
-    uint32_t totalBytes = u8Text.size();
-    while (i <= totalBytes) {
-        auto nextC = utf8Codepoint(u, bytesLength);
-        u += bytesLength;
-        i += bytesLength;
+    for (auto i = 0u; i < codepoints.size(); ++i) {
+        auto c = codepoints[i];
+        auto nextC = (i + 1u < codepoints.size()) ? codepoints[i + 1u] : 0u;
 
         // Add the glyph to the texture if it does not exist yet
         auto pGlyphInfo = m_glyphsInfos.find(c);
@@ -80,33 +84,29 @@ std::vector<Font::GlyphInfo> Font::glyphsInfos(u8string_view u8Text, bool skipBl
         const auto& fontInfo = *pGlyphInfo->second.fontInfo;
         auto kernAdvance = stbtt_GetCodepointKernAdvance(&fontInfo.stbFont, c, nextC) * fontInfo.glyphsScale / float(fontInfo.glyphMaxHeight);
         advance += pGlyphInfo->second.advance + kernAdvance;
-        c = nextC;
     }
 
     if (textureChanged) {
         m_texture->loadFromMemory(m_pixels.data(), m_textureWidth, m_textureHeight, 1u);
     }
-
-    return glyphsInfos;
 }
 
 Font::GlyphInfo Font::glyphInfoAtByte(u8string_view u8Text, uint32_t byteIndex)
 {
+    auto& codepoints = m_codepoints;
+    auto& byteOffsets = m_byteOffsets;
+    codepoints.resize(u8Text.size());
+    byteOffsets.resize(u8Text.size());
+    auto codepointsCount = utf8Decode(u8Text, codepoints.data(), byteOffsets.data());
+
     GlyphInfo glyphInfo;
     bool textureChanged = false;
 
-    uint8_t bytesLength;
-    auto u = reinterpret_cast<const uint8_t*>(u8Text.data());
-    auto c = utf8Codepoint(u, bytesLength);
-    u += bytesLength;
-
-    uint32_t i = bytesLength;
-    uint32_t totalBytes = u8Text.size();
-    while (i <= totalBytes) {
-        bool interestingByte = (i > byteIndex);
-        auto nextC = utf8Codepoint(u, bytesLength);
-        u += bytesLength;
-        i += bytesLength;
+    for (auto i = 0u; i < codepointsCount; ++i) {
+        auto c = codepoints[i];
+        auto nextC = (i + 1u < codepointsCount) ? codepoints[i + 1u] : 0u;
+        auto endByte = (i + 1u < codepointsCount) ? byteOffsets[i + 1u] : u8Text.size();
+        bool interestingByte = (endByte > byteIndex);
 
         // Add the glyph to the texture if it does not exist yet
         auto pGlyphInfo = m_glyphsInfos.find(c);
@@ -129,7 +129,6 @@ Font::GlyphInfo Font::glyphInfoAtByte(u8string_view u8Text, uint32_t byteIndex)
         const auto& fontInfo = *pGlyphInfo->second.fontInfo;
         auto kernAdvance = stbtt_GetCodepointKernAdvance(&fontInfo.stbFont, c, nextC) * fontInfo.glyphsScale / float(fontInfo.glyphMaxHeight);
         glyphInfo.xOffset += pGlyphInfo->second.advance + kernAdvance;
-        c = nextC;
     }
 
     if (textureChanged) {
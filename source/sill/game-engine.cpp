@@ -102,7 +102,7 @@ void GameEngine::run()
             m_fpsElapsedTime += elapsedTime;
 
             if (m_fpsElapsedTime > std::chrono::nanoseconds(1'000'000'000)) {
-                logger.info("sill.game-engine")
+                $log_info("sill.game-engine")
                     << std::setprecision(3) << std::chrono::duration<float>(elapsedTime).count() * 1000.f << "ms " << m_fpsCount
                     << "FPS" << std::endl;
                 m_fpsCount = 0u;
@@ -18,7 +18,7 @@ using namespace lava::sill;
 namespace {
 
     struct CacheData {
-        std::unique_ptr<ThreadPool> threadPool;
+        std::vector<JobHandle> textureJobs;
         std::unordered_map<uint32_t, magma::TexturePtr> textures;
         std::unordered_map<uint32_t, magma::MaterialPtr> materials;
         std::unordered_map<uint32_t, RenderCategory> renderCategories;
@@ -52,11 +52,7 @@ namespace {
         // Will be set later in an other thread.
         cacheData.textures[textureIndex] = nullptr;
 
-        if (!cacheData.threadPool) {
-            cacheData.threadPool = std::make_unique<ThreadPool>();
-        }
-
-        cacheData.threadPool->job([&renderEngine, &cacheData, textureIndex, imageVectorView, pixelsCallback] {
+        auto textureJob = defaultThreadPool().job([&renderEngine, &cacheData, textureIndex, imageVectorView, pixelsCallback] {
             // @todo We might want to choose the number of channels one day...
             int texWidth, texHeight;
             auto pixels = stbi_load_from_memory(imageVectorView.data(), imageVectorView.size(), &texWidth, &texHeight, nullptr,
@@ -78,6 +74,7 @@ namespace {
 
             stbi_image_free(pixels);
         });
+        cacheData.textureJobs.emplace_back(std::move(textureJob));
     }
 
     void setOrmTexture(magma::RenderEngine& renderEngine, magma::Material& material, uint32_t occlusionTextureIndex,
@@ -393,8 +390,8 @@ std::function<uint32_t(IMesh&)> makers::glbMeshMaker(const std::string& fileName
         iMesh.nodeMatrix(iMeshRootNodeIndex, rotationMatrixFromAxes(Axis::PositiveZ, Axis::PositiveX, Axis::PositiveY));
 
         // Bind all uniforms to textures once that are all done loaded
-        if (cacheData.threadPool) {
-            cacheData.threadPool->wait();
+        for (const auto& textureJob : cacheData.textureJobs) {
+            defaultThreadPool().wait(textureJob);
         }
 
         for (const auto& it : cacheData.pendingUniformBindings) {
@@ -88,8 +88,9 @@ TextGeometry sill::textGeometry(GameEngine& engine, const u8string& u8Text, cons
     float yOffset = 0.f;
     auto glyphsCount = 0u;
     FloatExtent2d globalTextExtent;
+    std::vector<Font::GlyphInfo> glyphsInfos;
     for (auto& textLine : splitAsViews(u8Text, '\n')) {
-        const auto glyphsInfos = font.glyphsInfos(textLine);
+        font.glyphsInfos(textLine, glyphsInfos);
         const auto textLineExtent = glyphsExtent(glyphsInfos);
 
         // @note These operation are valid because this is a left to right language
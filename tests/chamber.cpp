@@ -0,0 +1,203 @@
+#include "./test.hpp"
+
+#include <lava/chamber/math/batch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <sstream>
+
+using namespace lava;
+using namespace lava::tests;
+
+namespace {
+    // Not multiples of 4 nor 8 on purpose, so that vectorized loops leave some scalar tail.
+    const std::vector<uint32_t> COUNTS = {1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 33u, 100u};
+
+    // SIMD kernels do not round the same way as glm, but should stay close.
+    constexpr const float EPSILON = 1e-4f;
+
+    bool near(float a, float b)
+    {
+        return std::abs(a - b) <= EPSILON * std::max(1.f, std::max(std::abs(a), std::abs(b)));
+    }
+
+    bool near(const glm::vec3& a, const glm::vec3& b)
+    {
+        return near(a.x, b.x) && near(a.y, b.y) && near(a.z, b.z);
+    }
+
+    bool near(const glm::quat& a, const glm::quat& b)
+    {
+        return near(a.x, b.x) && near(a.y, b.y) && near(a.z, b.z) && near(a.w, b.w);
+    }
+
+    std::string what(const std::string& kernel, uint32_t count, uint32_t i)
+    {
+        std::stringstream stream;
+        stream << kernel << " differs from glm with count " << count << " at index " << i;
+        return stream.str();
+    }
+
+    class Random {
+    public:
+        float next(float min = -10.f, float max = 10.f) { return std::uniform_real_distribution<float>(min, max)(m_engine); }
+        glm::vec3 nextVec3() { return glm::vec3(next(), next(), next()); }
+        glm::quat nextQuat() { return glm::normalize(glm::quat(next(-1.f, 1.f), next(-1.f, 1.f), next(-1.f, 1.f), next(-1.f, 1.f))); }
+
+        glm::mat4 nextTransform()
+        {
+            auto transform = glm::translate(glm::mat4(1.f), nextVec3());
+            transform = transform * glm::mat4_cast(nextQuat());
+            return glm::scale(transform, glm::vec3(next(0.1f, 3.f), next(0.1f, 3.f), next(0.1f, 3.f)));
+        }
+
+    private:
+        std::mt19937 m_engine{42u};
+    };
+
+    void registerMathTests(TestRunner& runner)
+    {
+        runner.add("chamber.math.transform-points", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                const auto matrix = random.nextTransform();
+                std::vector<glm::vec3> points(count);
+                for (auto& point : points) point = random.nextVec3();
+
+                std::vector<glm::vec3> outPoints(count);
+                chamber::math::transformPoints(matrix, points.data(), outPoints.data(), count);
+                for (auto i = 0u; i < count; ++i) {
+                    const auto expected = glm::vec3(matrix * glm::vec4(points[i], 1.f));
+                    TestRunner::check(near(outPoints[i], expected), what("transformPoints", count, i));
+                }
+
+                // In place
+                chamber::math::transformPoints(matrix, points.data(), points.data(), count);
+                for (auto i = 0u; i < count; ++i) {
+                    TestRunner::check(near(points[i], outPoints[i]), what("transformPoints (in place)", count, i));
+                }
+            }
+        });
+
+        runner.add("chamber.math.transform-spheres", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                const auto matrix = random.nextTransform();
+                std::vector<BoundingSphere> spheres(count);
+                for (auto& sphere : spheres) {
+                    sphere.center = random.nextVec3();
+                    sphere.radius = random.next(0.f, 5.f);
+                }
+
+                std::vector<BoundingSphere> outSpheres(count);
+                chamber::math::transformSpheres(matrix, spheres.data(), outSpheres.data(), count);
+
+                const auto scale = std::max(glm::length(glm::vec3(matrix[0])),
+                                            std::max(glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2]))));
+                for (auto i = 0u; i < count; ++i) {
+                    const auto expectedCenter = glm::vec3(matrix * glm::vec4(spheres[i].center, 1.f));
+                    const auto expectedRadius = spheres[i].radius * scale;
+                    TestRunner::check(near(outSpheres[i].center, expectedCenter) && near(outSpheres[i].radius, expectedRadius),
+                                      what("transformSpheres", count, i));
+                }
+            }
+        });
+
+        runner.add("chamber.math.min-max", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                std::vector<glm::vec3> points(count);
+                for (auto& point : points) point = random.nextVec3();
+
+                auto expectedMin = points[0];
+                auto expectedMax = points[0];
+                for (const auto& point : points) {
+                    expectedMin = glm::min(expectedMin, point);
+                    expectedMax = glm::max(expectedMax, point);
+                }
+
+                glm::vec3 min;
+                glm::vec3 max;
+                chamber::math::minMax(points.data(), count, min, max);
+                TestRunner::check(min == expectedMin && max == expectedMax, what("minMax", count, 0u));
+            }
+        });
+
+        runner.add("chamber.math.spheres-inside-planes", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                std::vector<glm::vec4> planes(6u);
+                for (auto& plane : planes) plane = glm::vec4(glm::normalize(random.nextVec3()), random.next(0.f, 10.f));
+
+                std::vector<float> x(count), y(count), z(count), radius(count);
+                for (auto i = 0u; i < count; ++i) {
+                    x[i] = random.next();
+                    y[i] = random.next();
+                    z[i] = random.next();
+                    radius[i] = random.next(0.f, 3.f);
+                }
+
+                std::vector<uint8_t> visibles(count, 2u);
+                chamber::math::spheresInsidePlanes(planes.data(), planes.size(), {x.data(), y.data(), z.data(), radius.data()}, count,
+                                                   visibles.data());
+                for (auto i = 0u; i < count; ++i) {
+                    const glm::vec3 center(x[i], y[i], z[i]);
+                    auto expected = true;
+                    for (const auto& plane : planes) {
+                        expected = expected && (glm::dot(glm::vec3(plane), center) - radius[i] <= plane.w);
+                    }
+                    TestRunner::check(visibles[i] == (expected ? 1u : 0u), what("spheresInsidePlanes", count, i));
+                }
+            }
+        });
+
+        runner.add("chamber.math.nlerp", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                std::vector<glm::quat> q0s(count), q1s(count);
+                std::vector<float> ts(count);
+                for (auto i = 0u; i < count; ++i) {
+                    q0s[i] = random.nextQuat();
+                    q1s[i] = random.nextQuat();
+                    ts[i] = random.next(0.f, 1.f);
+                }
+
+                std::vector<glm::quat> outQuats(count);
+                chamber::math::nlerp(q0s.data(), q1s.data(), ts.data(), outQuats.data(), count);
+                for (auto i = 0u; i < count; ++i) {
+                    const auto q1 = (glm::dot(q0s[i], q1s[i]) < 0.f) ? -q1s[i] : q1s[i];
+                    const auto expected = glm::normalize(glm::lerp(q0s[i], q1, ts[i]));
+                    TestRunner::check(near(outQuats[i], expected), what("nlerp", count, i));
+                }
+            }
+        });
+
+        runner.add("chamber.math.slerp", [] {
+            Random random;
+            for (auto count : COUNTS) {
+                std::vector<glm::quat> q0s(count), q1s(count);
+                std::vector<float> ts(count);
+                for (auto i = 0u; i < count; ++i) {
+                    q0s[i] = random.nextQuat();
+                    q1s[i] = random.nextQuat();
+                    ts[i] = random.next(0.f, 1.f);
+                }
+
+                std::vector<glm::quat> outQuats(count);
+                chamber::math::slerp(q0s.data(), q1s.data(), ts.data(), outQuats.data(), count);
+                for (auto i = 0u; i < count; ++i) {
+                    TestRunner::check(near(outQuats[i], glm::slerp(q0s[i], q1s[i], ts[i])), what("slerp", count, i));
+                }
+            }
+        });
+    }
+}
+
+void tests::registerChamberTests(TestRunner& runner)
+{
+    registerMathTests(runner);
+}
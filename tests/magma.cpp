@@ -0,0 +1,102 @@
+#include "./test.hpp"
+
+#include <magma/depth-pyramid.hpp>
+
+#include <cmath>
+#include <sstream>
+
+using namespace lava;
+using namespace lava::tests;
+
+namespace {
+    constexpr const uint32_t DEPTH_WIDTH = 64u;
+    constexpr const uint32_t DEPTH_HEIGHT = 48u;
+
+    // Rendered with an identity matrix, positions are directly normalized device coordinates.
+    constexpr const float OCCLUDER_DEPTH = 0.2f;
+    constexpr const float OCCLUDER_HALF_SIZE = 0.5f;
+
+    /// A far depth everywhere, but for the occluder in the middle of the screen.
+    template <class Texel, class Encode>
+    std::vector<Texel> occluderDepths(Encode encode)
+    {
+        std::vector<Texel> depths(DEPTH_WIDTH * DEPTH_HEIGHT);
+        for (auto y = 0u; y < DEPTH_HEIGHT; ++y) {
+            for (auto x = 0u; x < DEPTH_WIDTH; ++x) {
+                const auto ndcX = (x + 0.5f) / DEPTH_WIDTH * 2.f - 1.f;
+                const auto ndcY = (y + 0.5f) / DEPTH_HEIGHT * 2.f - 1.f;
+                const bool occluded = std::abs(ndcX) < OCCLUDER_HALF_SIZE && std::abs(ndcY) < OCCLUDER_HALF_SIZE;
+                depths[y * DEPTH_WIDTH + x] = encode(occluded ? OCCLUDER_DEPTH : 1.f);
+            }
+        }
+        return depths;
+    }
+
+    void checkOcclusion(magma::DepthPyramid& depthPyramid, const std::string& formatName)
+    {
+        // Behind the occluder, in front of it, and beside it.
+        std::vector<float> x = {0.f, 0.f, 0.75f};
+        std::vector<float> y = {0.f, 0.f, 0.75f};
+        std::vector<float> z = {0.6f, 0.1f, 0.6f};
+        std::vector<float> radius = {0.1f, 0.05f, 0.1f};
+
+        std::vector<uint8_t> visibles(x.size(), 1u);
+        auto culledCount = depthPyramid.canSee({x.data(), y.data(), z.data(), radius.data()}, x.size(), visibles.data());
+        auto visibleCount = 0u;
+        for (auto visible : visibles) {
+            visibleCount += visible;
+        }
+
+        std::stringstream what;
+        what << "with " << formatName << " depth, " << culledCount << " culled and " << visibleCount << " visible";
+        TestRunner::check(culledCount == 1u && visibleCount == 2u, what.str() + ", expected 1 culled and 2 visible");
+        TestRunner::check(!visibles[0u], what.str() + ", the mesh behind the occluder should be culled");
+
+        BoundingSphere boundingSphere;
+        boundingSphere.center = glm::vec3(x[0u], y[0u], z[0u]);
+        boundingSphere.radius = radius[0u];
+        TestRunner::check(!depthPyramid.canSee(boundingSphere), what.str() + ", the single sphere check should cull it too");
+    }
+
+    void registerOcclusionTests(TestRunner& runner)
+    {
+        runner.add("magma.depth-pyramid.occlusion", [] {
+            magma::DepthPyramid depthPyramid;
+            const glm::mat4 viewProjectionMatrix(1.f);
+
+            auto floatDepths = occluderDepths<float>([](float depth) { return depth; });
+            depthPyramid.build(floatDepths.data(), magma::DepthPyramid::DepthFormat::Float, DEPTH_WIDTH, DEPTH_HEIGHT,
+                               viewProjectionMatrix);
+            checkOcclusion(depthPyramid, "float");
+
+            auto unorm16Depths = occluderDepths<uint16_t>([](float depth) { return static_cast<uint16_t>(depth * 65535.f); });
+            depthPyramid.build(unorm16Depths.data(), magma::DepthPyramid::DepthFormat::Unorm16, DEPTH_WIDTH, DEPTH_HEIGHT,
+                               viewProjectionMatrix);
+            checkOcclusion(depthPyramid, "16 bits");
+
+            // Upper bits set, as they are undefined.
+            auto unorm24Depths = occluderDepths<uint32_t>(
+                [](float depth) { return static_cast<uint32_t>(depth * 16777215.f) | 0xFF000000u; });
+            depthPyramid.build(unorm24Depths.data(), magma::DepthPyramid::DepthFormat::Unorm24, DEPTH_WIDTH, DEPTH_HEIGHT,
+                               viewProjectionMatrix);
+            checkOcclusion(depthPyramid, "24 bits");
+        });
+
+        runner.add("magma.depth-pyramid.invalid", [] {
+            magma::DepthPyramid depthPyramid;
+            auto depths = occluderDepths<float>([](float depth) { return depth; });
+            depthPyramid.build(depths.data(), magma::DepthPyramid::DepthFormat::Float, DEPTH_WIDTH, DEPTH_HEIGHT, glm::mat4(1.f));
+            depthPyramid.invalidate();
+
+            std::vector<float> x = {0.f}, y = {0.f}, z = {0.6f}, radius = {0.1f};
+            std::vector<uint8_t> visibles = {1u};
+            auto culledCount = depthPyramid.canSee({x.data(), y.data(), z.data(), radius.data()}, 1u, visibles.data());
+            TestRunner::check(culledCount == 0u && visibles[0u], "Nothing should be culled without a pyramid");
+        });
+    }
+}
+
+void tests::registerMagmaTests(TestRunner& runner)
+{
+    registerOcclusionTests(runner);
+}
@@ -0,0 +1,41 @@
+/**
+ * Checks optimized code against straightforward references.
+ *
+ * Usage: lava-tests [--filter <substring>]
+ *
+ * Exits with a failure code if any test failed.
+ */
+
+#include "./test.hpp"
+
+#include <cstring>
+#include <iostream>
+
+using namespace lava::tests;
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+
+    for (auto i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    TestRunner runner;
+    registerChamberTests(runner);
+    registerMagmaTests(runner);
+
+    auto failedTestsCount = runner.run(filter);
+    if (failedTestsCount != 0u) {
+        std::cout << failedTestsCount << " tests failed." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
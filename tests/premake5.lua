@@ -0,0 +1,12 @@
+------------------------------------------
+-- Tests - Correctness of optimized code --
+------------------------------------------
+
+project "lava-tests"
+    kind "ConsoleApp"
+    files "*.cpp"
+    useChamber()
+
+    -- Internals that do not need a device, included as <magma/...>
+    includedirs "../source"
+    files "../source/magma/depth-pyramid.cpp"
@@ -0,0 +1,45 @@
+#include "./test.hpp"
+
+#include <iostream>
+
+using namespace lava::tests;
+
+namespace {
+    uint32_t g_failedChecksCount = 0u;
+}
+
+void TestRunner::add(const std::string& name, Function function)
+{
+    m_tests.emplace_back(Test{name, std::move(function)});
+}
+
+uint32_t TestRunner::run(const std::string& filter)
+{
+    auto failedTestsCount = 0u;
+    for (const auto& test : m_tests) {
+        if (test.name.find(filter) == std::string::npos) continue;
+
+        g_failedChecksCount = 0u;
+        test.function();
+
+        if (g_failedChecksCount == 0u) {
+            std::cout << "[ OK ] " << test.name << std::endl;
+        }
+        else {
+            std::cout << "[FAIL] " << test.name << " (" << g_failedChecksCount << " failed checks)" << std::endl;
+            failedTestsCount += 1u;
+        }
+    }
+    return failedTestsCount;
+}
+
+void TestRunner::check(bool condition, const std::string& what)
+{
+    if (condition) return;
+
+    // Only the first failures of a test are detailed.
+    if (g_failedChecksCount < 5u) {
+        std::cout << "       " << what << std::endl;
+    }
+    g_failedChecksCount += 1u;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace lava::tests {
+    /**
+     * Runs registered tests and reports failed checks.
+     *
+     * A test is a function calling check() for each expectation,
+     * it keeps going after a failure so that all of them are reported.
+     */
+    class TestRunner {
+    public:
+        using Function = std::function<void()>;
+
+    public:
+        /// Register a test, named "module.subject.case".
+        void add(const std::string& name, Function function);
+
+        /// Run all tests which name contains the filter, returns the count of failed ones.
+        uint32_t run(const std::string& filter = "");
+
+        /// Record an expectation of the running test.
+        static void check(bool condition, const std::string& what);
+
+    private:
+        struct Test {
+            std::string name;
+            Function function;
+        };
+
+    private:
+        std::vector<Test> m_tests;
+    };
+
+    void registerChamberTests(TestRunner& runner);
+    void registerMagmaTests(TestRunner& runner);
+}